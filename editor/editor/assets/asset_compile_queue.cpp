@@ -0,0 +1,101 @@
+#include "asset_compile_queue.h"
+
+#include <engine/threading/threader.h>
+#include <logging/logging.h>
+
+#include <algorithm>
+#include <exception>
+
+namespace ace
+{
+
+asset_compile_queue::asset_compile_queue(std::size_t max_parallel) : max_parallel_(std::max<std::size_t>(1, max_parallel))
+{
+}
+
+void asset_compile_queue::push(threader& thr, const fs::path& output, job_t job)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if(queued_.count(output) > 0)
+    {
+        // Already waiting, the newest request wins.
+        auto it = std::find_if(std::begin(queue_),
+                               std::end(queue_),
+                               [&](const entry& e)
+                               {
+                                   return e.output == output;
+                               });
+        if(it != std::end(queue_))
+        {
+            it->job = std::move(job);
+        }
+        return;
+    }
+
+    queued_.emplace(output);
+    queue_.push_back({output, std::move(job)});
+
+    pump(thr);
+}
+
+void asset_compile_queue::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock,
+               [this]()
+               {
+                   return queue_.empty() && running_.empty();
+               });
+}
+
+void asset_compile_queue::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+    queued_.clear();
+    done_.notify_all();
+}
+
+void asset_compile_queue::pump(threader& thr)
+{
+    for(auto it = std::begin(queue_); it != std::end(queue_) && running_.size() < max_parallel_;)
+    {
+        // Wait for the previous compilation of the same output to finish.
+        if(running_.count(it->output) > 0)
+        {
+            ++it;
+            continue;
+        }
+
+        auto e = std::move(*it);
+        it = queue_.erase(it);
+        queued_.erase(e.output);
+        running_.emplace(e.output);
+
+        thr.pool->schedule(
+            [this, &thr, e = std::move(e)]()
+            {
+                // A failed job must still release its output, or waiters block and it never compiles again.
+                try
+                {
+                    e.job();
+                }
+                catch(const std::exception& ex)
+                {
+                    APPLOG_ERROR("Compiling {} failed: {}", e.output.string(), ex.what());
+                }
+                catch(...)
+                {
+                    APPLOG_ERROR("Compiling {} failed.", e.output.string());
+                }
+
+                std::lock_guard<std::mutex> lock(mutex_);
+                running_.erase(e.output);
+                pump(thr);
+                done_.notify_all();
+            });
+    }
+}
+
+} // namespace ace
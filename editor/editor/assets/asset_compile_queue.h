@@ -0,0 +1,76 @@
+#pragma once
+#include <filesystem/filesystem.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <set>
+
+namespace ace
+{
+struct threader;
+
+/**
+ * @class asset_compile_queue
+ * @brief Bounded queue of asset compilations running on the thread pool.
+ *
+ * At most max_parallel compilations run at once, so external tools like
+ * shaderc and texturec don't flood the machine and the pool stays
+ * available for asset loading. Requests for an output that is already
+ * queued are merged and an output is never compiled twice at the same time.
+ */
+class asset_compile_queue
+{
+public:
+    using job_t = std::function<void()>;
+
+    /**
+     * @brief Constructs the queue.
+     * @param max_parallel Max number of compilations running at once.
+     */
+    explicit asset_compile_queue(std::size_t max_parallel);
+
+    /**
+     * @brief Queues the compilation of an output.
+     * @param thr The threader whose pool runs the jobs.
+     * @param output The compiled output.
+     * @param job The compilation job.
+     */
+    void push(threader& thr, const fs::path& output, job_t job);
+
+    /**
+     * @brief Blocks until all queued compilations are done.
+     */
+    void wait();
+
+    /**
+     * @brief Drops all compilations that did not start yet.
+     */
+    void clear();
+
+private:
+    struct entry
+    {
+        fs::path output;
+        job_t job;
+    };
+
+    /// Starts queued jobs while there are free slots. Expects the mutex to be locked.
+    void pump(threader& thr);
+
+    /// Mutex guarding the queue.
+    std::mutex mutex_;
+    /// Signaled when a job finishes.
+    std::condition_variable done_;
+    /// Jobs waiting for a free slot.
+    std::deque<entry> queue_;
+    /// Outputs waiting in the queue.
+    std::set<fs::path> queued_;
+    /// Outputs being compiled right now.
+    std::set<fs::path> running_;
+    /// Max number of jobs running at once.
+    std::size_t max_parallel_{1};
+};
+} // namespace ace
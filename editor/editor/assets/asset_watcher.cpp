@@ -22,7 +22,7 @@
 #include <graphics/graphics.h>
 #include <logging/logging.h>
 
-#include <fstream>
+#include <algorithm>
 #include <set>
 
 namespace ace
@@ -31,72 +31,12 @@ namespace
 {
 using namespace std::literals;
 
-void resolve_includes(const fs::path& filePath, std::set<fs::path>& processedFiles)
-{
-    if(!processedFiles.insert(filePath).second)
-    {
-        return; // Avoid processing the same file multiple times
-    }
-
-    std::ifstream file(filePath);
-    if(!file.is_open())
-    {
-        // std::cerr << "Failed to open file: " << filePath << '\n';
-        return;
-    }
-
-    const std::string includeKeyword = "#include";
-    const std::string bgfxIncludePath = "/path/to/bgfx/include"; // Assuming bgfx include path is known
-
-    std::string line;
-    while(std::getline(file, line))
-    {
-        // Trim leading whitespace
-        line.erase(0, line.find_first_not_of(" \t"));
-
-        // Check for #include directive
-        if(line.compare(0, includeKeyword.length(), includeKeyword) == 0)
-        {
-            // Find the start and end of the include path
-            size_t start = line.find_first_of("\"<") + 1;
-            size_t end = line.find_last_of("\">");
-
-            if(start == std::string::npos || end == std::string::npos || start >= end)
-            {
-                // std::cerr << "Invalid include directive: " << line << '\n';
-                continue;
-            }
-
-            std::string includePath = line.substr(start, end - start);
-            fs::path resolvedPath;
-
-            if(line[start - 1] == '<' && line[end] == '>')
-            {
-                // Resolve system include path (e.g., bgfx_shader.sh)
-                // resolvedPath = fs::path(bgfxIncludePath) / includePath;
-                continue;
-            }
-            else
-            {
-                // Resolve local include path relative to the current file
-                resolvedPath = filePath.parent_path() / includePath;
-            }
-
-            resolvedPath = fs::absolute(resolvedPath);
-            // std::cout << "Resolved include: " << resolvedPath << '\n';
-
-            // Recurse into the included file
-            resolve_includes(resolvedPath, processedFiles);
-        }
-    }
-}
-
 auto has_depencency(const fs::path& file, const fs::path& dep_to_check) -> bool
 {
-    std::set<fs::path> dependecies;
-    resolve_includes(file, dependecies);
-
-    return dependecies.contains(dep_to_check);
+    fs::error_code err;
+    auto dependencies = asset_compiler::get_dependencies(file);
+    auto dep = fs::absolute(dep_to_check, err).lexically_normal();
+    return std::find(std::begin(dependencies), std::end(dependencies), dep) != std::end(dependencies);
 }
 
 auto remove_meta_tag(const fs::path& synced_path) -> fs::path
@@ -273,8 +213,26 @@ auto watch_assets_depenencies(rtti::context& ctx, const fs::path& dir, const fs:
     return fs::watcher::watch(watch_dir, true, true, 500ms, callback);
 }
 
+template<typename T>
+void compile_if_changed(asset_manager& am, const fs::path& ref_path, const fs::path& output, bool is_initial_listing)
+{
+    // On startup only what changed since the last compile is rebuilt.
+    // Later modifications always compile so that reimporting works.
+    auto compile_key = asset_compiler::get_compile_key(ref_path);
+    if(is_initial_listing && asset_compiler::is_up_to_date(compile_key, output))
+    {
+        return;
+    }
+
+    if(asset_compiler::compile<T>(am, ref_path, output))
+    {
+        asset_compiler::save_compile_key(compile_key, output);
+    }
+}
+
 template<typename T>
 static void add_to_syncer(rtti::context& ctx,
+                          asset_compile_queue& queue,
                           std::vector<uint64_t>& watchers,
                           fs::syncer& syncer,
                           const fs::path& dir,
@@ -284,28 +242,21 @@ static void add_to_syncer(rtti::context& ctx,
     auto& ts = ctx.get<threader>();
     auto& am = ctx.get<asset_manager>();
 
-    auto on_modified =
-        [&ts, &am](const std::string& ext, const auto& ref_path, const auto& synced_paths, bool is_initial_listing)
+    auto on_modified = [&ts, &am, &queue](const std::string& ext,
+                                          const auto& ref_path,
+                                          const auto& synced_paths,
+                                          bool is_initial_listing)
     {
         auto paths = remove_meta_tag(synced_paths);
 
         for(const auto& output : paths)
         {
-            fs::error_code err;
-            if(is_initial_listing && fs::exists(output, err))
-            {
-                continue;
-            }
-            auto task = ts.pool->schedule(
-                [&am, ref_path, output]()
-                {
-                    asset_compiler::compile<T>(am, ref_path, output);
-                });
-
-            //        if(is_initial_listing)
-            //        {
-            //            task.wait();
-            //        }
+            queue.push(ts,
+                       output,
+                       [&am, ref_path, output, is_initial_listing]()
+                       {
+                           compile_if_changed<T>(am, ref_path, output, is_initial_listing);
+                       });
         }
     };
 
@@ -319,6 +270,7 @@ static void add_to_syncer(rtti::context& ctx,
 
 template<>
 void add_to_syncer<gfx::shader>(rtti::context& ctx,
+                                asset_compile_queue& queue,
                                 std::vector<uint64_t>& watchers,
                                 fs::syncer& syncer,
                                 const fs::path& dir,
@@ -328,8 +280,10 @@ void add_to_syncer<gfx::shader>(rtti::context& ctx,
     auto& ts = ctx.get<threader>();
     auto& am = ctx.get<asset_manager>();
 
-    auto on_modified =
-        [&ts, &am](const std::string& ext, const auto& ref_path, const auto& synced_paths, bool is_initial_listing)
+    auto on_modified = [&ts, &am, &queue](const std::string& ext,
+                                          const auto& ref_path,
+                                          const auto& synced_paths,
+                                          bool is_initial_listing)
     {
         auto paths = remove_meta_tag(synced_paths);
         if(paths.empty())
@@ -348,21 +302,12 @@ void add_to_syncer<gfx::shader>(rtti::context& ctx,
                 continue;
             }
 
-            fs::error_code err;
-            if(is_initial_listing && fs::exists(output, err))
-            {
-                continue;
-            }
-
-            auto task = ts.pool->schedule(
-                [&am, ref_path, output]()
-                {
-                    asset_compiler::compile<gfx::shader>(am, ref_path, output);
-                });
-            //        if(is_initial_listing)
-            //        {
-            //            task.wait();
-            //        }
+            queue.push(ts,
+                       output,
+                       [&am, ref_path, output, is_initial_listing]()
+                       {
+                           compile_if_changed<gfx::shader>(am, ref_path, output, is_initial_listing);
+                       });
         }
     };
 
@@ -457,6 +402,16 @@ void asset_watcher::setup_meta_syncer(rtti::context& ctx,
                 meta.uid = asset_database::generate_id(ref_path);
                 meta.type = ext;
             }
+
+            if(!meta.importer && ex::is_format<gfx::texture>(ext))
+            {
+                meta.importer = std::make_shared<texture_importer_meta>();
+            }
+
+            if(!meta.importer && ex::is_format<audio_clip>(ext))
+            {
+                meta.importer = std::make_shared<audio_importer_meta>();
+            }
             am.add_asset_info_for_path(ref_path, meta);
 
             save_to_file(synced_path.string(), meta);
@@ -477,6 +432,12 @@ void asset_watcher::setup_meta_syncer(rtti::context& ctx,
         watchers.emplace_back(id);
     }
 
+    for(const auto& dep_ex : ex::get_suported_dependencies_formats<mesh>())
+    {
+        auto id = watch_assets_depenencies<mesh>(ctx, data_dir, "*" + dep_ex);
+        watchers.emplace_back(id);
+    }
+
     syncer.sync(data_dir, meta_dir);
 
     if(wait)
@@ -516,22 +477,23 @@ void asset_watcher::setup_cache_syncer(rtti::context& ctx,
         }
     };
 
-    add_to_syncer<gfx::texture>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<gfx::shader>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<mesh>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<material>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<animation_clip>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<prefab>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<scene_prefab>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<physics_material>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<audio_clip>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
-    add_to_syncer<script>(ctx, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<gfx::texture>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<gfx::shader>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<mesh>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<material>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<animation_clip>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<prefab>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<scene_prefab>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<physics_material>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<audio_clip>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
+    add_to_syncer<script>(ctx, compile_queue_, watchers, syncer, cache_dir, on_removed, on_renamed);
 
     syncer.sync(meta_dir, cache_dir);
 
     if(wait)
     {
         auto& ts = ctx.get<threader>();
+        compile_queue_.wait();
         ts.pool->wait_all();
     }
 }
@@ -582,6 +544,9 @@ auto asset_watcher::deinit(rtti::context& ctx) -> bool
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
 
     unwatch_assets(ctx, "engine:/");
+
+    compile_queue_.clear();
+    compile_queue_.wait();
     return true;
 }
 
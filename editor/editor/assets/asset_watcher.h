@@ -1,10 +1,13 @@
 #pragma once
+#include "asset_compile_queue.h"
+
 #include <context/context.hpp>
 #include <filesystem/syncer.h>
 #include <ospp/event.h>
 
 #include <deque>
 #include <mutex>
+#include <thread>
 
 namespace ace
 {
@@ -45,6 +48,8 @@ private:
     };
 
     std::map<std::string, watched> watched_protocols_{};
+    /// Compilations of changed assets, bounded to leave the pool free for loading.
+    asset_compile_queue compile_queue_{std::thread::hardware_concurrency() / 2};
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 
 };
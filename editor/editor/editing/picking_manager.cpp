@@ -7,14 +7,60 @@
 
 #include <engine/assets/asset_manager.h>
 #include <engine/ecs/components/transform_component.h>
+#include <engine/ecs/ecs.h>
+#include <engine/engine.h>
 #include <engine/events.h>
 #include <engine/rendering/ecs/components/model_component.h>
 #include <engine/rendering/material.h>
 #include <engine/rendering/mesh.h>
 #include <engine/rendering/model.h>
 
+#include <limits>
+
 namespace ace
 {
+namespace
+{
+/// Transform dirty flag cleared by the scene bvh.
+constexpr uint8_t picking_dirty_id = 2;
+
+auto raycast_model(entt::handle entity, const math::vec3& origin, const math::vec3& direction, float& distance)
+    -> bool
+{
+    const auto& transform_comp = entity.get<transform_component>();
+    const auto& model_comp = entity.get<model_component>();
+
+    auto lod = model_comp.get_model().get_lod(0);
+    if(!lod || !lod.is_ready())
+    {
+        return false;
+    }
+
+    auto mesh = lod.get();
+    const math::mat4& world_transform = transform_comp.get_transform_global();
+    const auto& submesh_transforms = model_comp.get_submesh_transforms();
+    const auto& submeshes = mesh->get_submeshes();
+
+    bool hit = false;
+    for(uint32_t i = 0; i < submeshes.size(); ++i)
+    {
+        // Skinned submeshes are tested in their bind pose.
+        bool has_pose = !submeshes[i]->skinned && i < submesh_transforms.transforms.size();
+        const auto& transform = has_pose ? submesh_transforms.transforms[i] : world_transform;
+
+        // The direction is not normalized, so hit distances stay in world ray units.
+        const auto inverse = math::inverse(transform);
+        math::vec3 local_origin(inverse * math::vec4(origin, 1.0f));
+        math::vec3 local_direction(inverse * math::vec4(direction, 0.0f));
+
+        hit |= mesh->raycast_submesh(i, local_origin, local_direction, distance);
+    }
+
+    return hit;
+}
+
+} // namespace
+
 constexpr int picking_manager::tex_id_dim;
 void picking_manager::on_frame_render(rtti::context& ctx, delta_t dt)
 {
@@ -285,12 +331,175 @@ void picking_manager::request_pick(math::vec2 pos, const camera& cam)
     pick_camera.set_far_clip(far_clip);
     pick_camera.look_at(pick_eye, pick_at, pick_up);
 
+    if(mode_ == pick_mode::cpu || !gfx::is_supported(BGFX_CAPS_TEXTURE_BLIT))
+    {
+        auto& ctx = engine::context();
+        auto& ec = ctx.get<ecs>();
+        auto& em = ctx.get<editing_manager>();
+
+        auto picked_entity = raycast(ec.get_scene(), pos, cam);
+        if(picked_entity)
+        {
+            em.select(picked_entity);
+        }
+        else
+        {
+            em.unselect();
+        }
+        return;
+    }
+
     pick_camera_ = pick_camera;
 
     reading_ = 0;
     start_readback_ = true;
 }
 
+void picking_manager::set_pick_mode(pick_mode mode)
+{
+    mode_ = mode;
+}
+
+auto picking_manager::get_pick_mode() const -> pick_mode
+{
+    return mode_;
+}
+
+auto picking_manager::raycast(scene& scn, math::vec2 pos, const camera& cam) -> entt::handle
+{
+    math::vec3 origin;
+    math::vec3 direction;
+    if(!cam.viewport_to_ray(pos, origin, direction))
+    {
+        return {};
+    }
+
+    update_scene_bvh(scn);
+
+    entt::handle picked_entity;
+    scene_bvh_.raycast(origin,
+                       direction,
+                       std::numeric_limits<float>::max(),
+                       [&](std::uint32_t item, float& max_distance)
+                       {
+                           auto entity = scene_entities_[item];
+                           if(raycast_model(entity, origin, direction, max_distance))
+                           {
+                               picked_entity = entity;
+                           }
+                       });
+
+    return picked_entity;
+}
+
+auto picking_manager::query_rect(scene& scn, math::vec2 min, math::vec2 max, const camera& cam)
+    -> std::vector<entt::handle>
+{
+    const auto& viewport_pos = cam.get_viewport_pos();
+    const auto& viewport_size = cam.get_viewport_size();
+    if(viewport_size.width == 0 || viewport_size.height == 0)
+    {
+        return {};
+    }
+
+    // The rectangle in normalized device coordinates.
+    auto to_ndc = [&](math::vec2 p)
+    {
+        return math::vec2(2.0f * (p.x - float(viewport_pos.x)) / float(viewport_size.width) - 1.0f,
+                          1.0f - 2.0f * (p.y - float(viewport_pos.y)) / float(viewport_size.height));
+    };
+    auto ndc_min = math::min(to_ndc(min), to_ndc(max));
+    auto ndc_max = math::max(to_ndc(min), to_ndc(max));
+    auto ndc_size = math::max(ndc_max - ndc_min, math::vec2(math::epsilon<float>()));
+    auto ndc_center = (ndc_min + ndc_max) * 0.5f;
+
+    // Stretch the rectangle over the whole clip space and cull against the resulting frustum.
+    math::mat4 crop = math::scale(math::mat4(1.0f), math::vec3(2.0f / ndc_size.x, 2.0f / ndc_size.y, 1.0f)) *
+                      math::translate(math::mat4(1.0f), math::vec3(-ndc_center.x, -ndc_center.y, 0.0f));
+
+    math::frustum frustum(cam.get_view(), math::transform(crop * cam.get_projection().get_matrix()), false);
+
+    update_scene_bvh(scn);
+
+    std::vector<entt::handle> result;
+    scene_bvh_.query(
+        [&](const math::bbox& bounds)
+        {
+            return frustum.classify_aabb(bounds) != math::volume_query::outside;
+        },
+        [&](std::uint32_t item)
+        {
+            if(frustum.classify_aabb(scene_bounds_[item]) != math::volume_query::outside)
+            {
+                result.emplace_back(scene_entities_[item]);
+            }
+        });
+
+    return result;
+}
+
+auto picking_manager::is_scene_bvh_valid(scene& scn) -> bool
+{
+    if(scene_registry_ != scn.registry.get())
+    {
+        return false;
+    }
+
+    size_t index = 0;
+    bool valid = true;
+    scn.registry->view<transform_component, model_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& model_comp)
+        {
+            if(!valid)
+                return;
+
+            auto lod = model_comp.get_model().get_lod(0);
+            if(!lod || !lod.is_ready())
+                return;
+
+            valid = index < scene_entities_.size() && scene_entities_[index].entity() == e &&
+                    scene_meshes_[index] == lod.get().get() && !transform_comp.is_dirty(picking_dirty_id);
+            ++index;
+        });
+
+    return valid && index == scene_entities_.size();
+}
+
+void picking_manager::update_scene_bvh(scene& scn)
+{
+    if(is_scene_bvh_valid(scn))
+    {
+        return;
+    }
+
+    scene_entities_.clear();
+    scene_bounds_.clear();
+    scene_meshes_.clear();
+    scene_registry_ = scn.registry.get();
+
+    scn.registry->view<transform_component, model_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& model_comp)
+        {
+            auto& model = model_comp.get_model();
+            if(!model.is_valid())
+                return;
+
+            auto lod = model.get_lod(0);
+            if(!lod || !lod.is_ready())
+                return;
+
+            const auto& mesh = lod.get();
+            const auto& world_transform = transform_comp.get_transform_global();
+            transform_comp.set_dirty(picking_dirty_id, false);
+
+            scene_entities_.emplace_back(scn.create_entity(e));
+            scene_bounds_.emplace_back(math::bbox::mul(mesh->get_bounds(), world_transform));
+            scene_meshes_.emplace_back(mesh.get());
+        });
+
+    scene_bvh_.build(scene_bounds_);
+}
+
 auto picking_manager::get_pick_texture() const -> const std::shared_ptr<gfx::texture>&
 {
     return blit_tex_;
@@ -2,6 +2,7 @@
 
 #include <base/basetypes.hpp>
 #include <engine/assets/asset_handle.h>
+#include <engine/ecs/scene.h>
 #include <engine/rendering/camera.h>
 #include <engine/rendering/gpu_program.h>
 #include <hpp/optional.hpp>
@@ -14,10 +15,23 @@ struct texture;
 
 namespace ace
 {
+class mesh;
 
 class picking_manager
 {
 public:
+    /**
+     * @enum pick_mode
+     * @brief How a pick request is resolved.
+     */
+    enum class pick_mode
+    {
+        /// Render an id buffer and read it back a few frames later. Pixel exact, needs texture blits.
+        gpu,
+        /// Cast a ray against the scene and mesh bvhs on the cpu. Same frame, skinned meshes use their bind pose.
+        cpu,
+    };
+
     picking_manager();
     ~picking_manager();
 
@@ -33,7 +47,43 @@ public:
 
     auto get_pick_texture() const -> const std::shared_ptr<gfx::texture>&;
 
+    void set_pick_mode(pick_mode mode);
+    auto get_pick_mode() const -> pick_mode;
+
+    /**
+     * @brief Finds the closest model under a viewport position on the cpu.
+     * Skinned meshes are tested in their bind pose, a posed character can be missed
+     * where it moved away from it.
+     * @param scn The scene to pick from.
+     * @param pos The viewport position.
+     * @param cam The camera the scene is viewed with.
+     * @return The picked entity or an invalid handle.
+     */
+    auto raycast(scene& scn, math::vec2 pos, const camera& cam) -> entt::handle;
+
+    /**
+     * @brief Finds all models whose world bounds overlap a viewport rectangle.
+     * Used for box selection.
+     * @param scn The scene to pick from.
+     * @param min The top left corner of the rectangle in viewport space.
+     * @param max The bottom right corner of the rectangle in viewport space.
+     * @param cam The camera the scene is viewed with.
+     * @return The entities inside the rectangle.
+     */
+    auto query_rect(scene& scn, math::vec2 min, math::vec2 max, const camera& cam) -> std::vector<entt::handle>;
+
 private:
+    /**
+     * @brief Rebuilds the bvh over the world bounds of every ready model of the scene,
+     * unless no transform, model or entity changed since the last build.
+     */
+    void update_scene_bvh(scene& scn);
+
+    /**
+     * @brief Checks if the bvh still matches the models of the scene.
+     */
+    auto is_scene_bvh_valid(scene& scn) -> bool;
+
     /// surface used to render into
     std::shared_ptr<gfx::frame_buffer> surface_;
     ///
@@ -52,5 +102,17 @@ private:
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 
     hpp::optional<camera> pick_camera_{};
+
+    pick_mode mode_{pick_mode::gpu};
+    /// Hierarchy over the world bounds of the pickable entities.
+    math::bvh scene_bvh_;
+    /// Pickable entities, indexed by the bvh items.
+    std::vector<entt::handle> scene_entities_;
+    /// World bounds of the pickable entities.
+    std::vector<math::bbox> scene_bounds_;
+    /// Meshes the bounds were taken from.
+    std::vector<const mesh*> scene_meshes_;
+    /// Registry the bvh was built from.
+    const entt::registry* scene_registry_{};
 };
 } // namespace ace
@@ -2,6 +2,8 @@
 
 #include <engine/animation/animation.h>
 #include <engine/assets/asset_manager.h>
+#include <engine/assets/impl/asset_compiler.h>
+#include <engine/assets/impl/asset_reader.h>
 #include <engine/audio/audio_clip.h>
 #include <engine/defaults/defaults.h>
 #include <engine/ecs/components/transform_component.h>
@@ -14,40 +16,114 @@
 #include <engine/rendering/material.h>
 #include <engine/rendering/mesh.h>
 #include <engine/scripting/script.h>
+#include <engine/threading/threader.h>
 #include <graphics/render_pass.h>
 #include <graphics/texture.h>
 
+#include <base/hash.hpp>
 #include <filesystem/filesystem.h>
 #include <filesystem/watcher.h>
 
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
 namespace ace
 {
 
 namespace
 {
 
+constexpr std::uint32_t index_version = 1;
+
+auto get_content_hash(const std::string& key) -> std::uint64_t
+{
+    // The compile key covers the source, its import settings, its dependencies and the tools.
+    // Both it and the hash are the same for every build, so the cache survives editor updates.
+    auto path = asset_reader::resolve_compiled_path(key);
+    auto content = asset_compiler::load_compile_key(path);
+    if(content.empty())
+    {
+        // Nothing stored a key for the output, hash what was compiled instead.
+        std::ifstream stream(path, std::ios::binary);
+        content.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+
+    std::uint64_t seed = utils::stable_hash_seed;
+    utils::stable_hash_combine(seed, key);
+    utils::stable_hash_combine(seed, content);
+    return seed;
+}
+
+auto read_tile(const fs::path& path, std::uint64_t offset) -> std::vector<std::uint8_t>
+{
+    std::ifstream stream(path, std::ios::binary);
+    if(!stream)
+    {
+        return {};
+    }
+
+    std::vector<std::uint8_t> pixels(thumbnail_manager::thumbnail_atlas::tile_bytes);
+    stream.seekg(std::streamoff(offset));
+    stream.read(reinterpret_cast<char*>(pixels.data()), std::streamsize(pixels.size()));
+    if(stream.gcount() != std::streamsize(pixels.size()))
+    {
+        return {};
+    }
+
+    return pixels;
+}
+
+auto write_tile(const fs::path& path, std::uint64_t offset, const std::vector<std::uint8_t>& pixels) -> bool
+{
+    fs::error_code ec;
+    if(!fs::exists(path, ec))
+    {
+        std::ofstream create(path, std::ios::binary);
+    }
+
+    std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+    if(!stream)
+    {
+        APPLOG_WARNING("Failed to write thumbnail cache page {}", path.string());
+        return false;
+    }
+
+    stream.seekp(std::streamoff(offset));
+    stream.write(reinterpret_cast<const char*>(pixels.data()), std::streamsize(pixels.size()));
+    stream.flush();
+    return stream.good();
+}
+
 template<typename T>
 auto make_thumbnail(thumbnail_manager::generator& gen, const asset_handle<T>& asset) -> gfx::texture::ptr
 {
     auto& thumbnail = gen.thumbnails[asset.uid()];
-    auto current_fbo = thumbnail.get();
 
-    if(gen.remaining > 0 && thumbnail.needs_regeneration)
+    if(!thumbnail.cache_checked)
     {
-        auto& scn = gen.get_scene();
-        scn.unload();
-        auto& ctx = engine::context();
-        defaults::create_default_3d_scene_for_asset_preview(ctx, scn, asset, {256, 256});
-
-        delta_t dt(0.016667f);
+        thumbnail.cache_checked = true;
+        thumbnail.hash = get_content_hash(asset.id());
+        gen.load_from_cache(asset.uid(), thumbnail);
+    }
 
-        auto& rpath = ctx.get<rendering_system>();
-        rpath.prepare_scene(scn, dt);
-        auto new_fbo = rpath.render_scene(scn, dt);
-        thumbnail.set(new_fbo);
+    if(thumbnail.needs_regeneration && !thumbnail.loading)
+    {
+        // Rendering is deferred to the next frame so that only items which are
+        // still on screen get rendered, within the frame budget.
+        gen.request_render(asset.uid(),
+                           [asset](scene& scn)
+                           {
+                               auto& ctx = engine::context();
+                               defaults::create_default_3d_scene_for_asset_preview(
+                                   ctx,
+                                   scn,
+                                   asset,
+                                   {thumbnail_manager::thumbnail_size, thumbnail_manager::thumbnail_size});
+                           });
     }
 
-    return current_fbo;
+    return thumbnail.get();
 }
 
 template<typename T>
@@ -196,16 +272,30 @@ auto thumbnail_manager::get_thumbnail(const fs::path& path) -> gfx::texture::ptr
 
 void thumbnail_manager::regenerate_thumbnail(const hpp::uuid& uid)
 {
-    gen_.thumbnails[uid].needs_regeneration = true;
+    auto& thumbnail = gen_.thumbnails[uid];
+    thumbnail.needs_regeneration = true;
+    thumbnail.cache_checked = false;
+    thumbnail.loading = false;
+    gen_.atlas.remove(uid);
 }
 void thumbnail_manager::remove_thumbnail(const hpp::uuid& uid)
 {
     gen_.thumbnails.erase(uid);
+    gen_.atlas.remove(uid);
 }
 
 void thumbnail_manager::clear_thumbnails()
 {
     gen_.thumbnails.clear();
+    gen_.requests.clear();
+
+    // The gpu may still write into pending readbacks, so they are only marked.
+    for(auto& readback : gen_.readbacks)
+    {
+        readback.discard = true;
+    }
+
+    gen_.atlas.close();
 }
 
 auto thumbnail_manager::init(rtti::context& ctx) -> bool
@@ -214,6 +304,7 @@ auto thumbnail_manager::init(rtti::context& ctx) -> bool
 
     auto& ev = ctx.get<events>();
     ev.on_frame_update.connect(sentinel_, this, &thumbnail_manager::on_frame_update);
+    ev.on_frame_render.connect(sentinel_, 800, this, &thumbnail_manager::on_frame_render);
 
     auto& am = ctx.get<asset_manager>();
     thumbnails_.transparent = am.get_asset<gfx::texture>("engine:/data/textures/transparent.png");
@@ -239,19 +330,33 @@ auto thumbnail_manager::deinit(rtti::context& ctx) -> bool
 {
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
 
+    gen_.atlas.close();
+
     return true;
 }
 
 void thumbnail_manager::on_frame_update(rtti::context& ctx, delta_t)
 {
+    gen_.frame++;
     gen_.reset();
 }
 
+void thumbnail_manager::on_frame_render(rtti::context& ctx, delta_t)
+{
+    gen_.process_readbacks();
+    gen_.process_requests();
+
+    if(gen_.atlas.dirty)
+    {
+        gen_.atlas.save_index();
+    }
+}
+
 auto thumbnail_manager::generated_thumbnail::get() -> gfx::texture::ptr
 {
     if(!thumbnail)
     {
-        return nullptr;
+        return texture;
     }
 
     return thumbnail->get_texture();
@@ -260,6 +365,14 @@ auto thumbnail_manager::generated_thumbnail::get() -> gfx::texture::ptr
 void thumbnail_manager::generated_thumbnail::set(gfx::frame_buffer::ptr fbo)
 {
     thumbnail = fbo;
+    texture.reset();
+    needs_regeneration = false;
+}
+
+void thumbnail_manager::generated_thumbnail::set(gfx::texture::ptr tex)
+{
+    texture = tex;
+    thumbnail.reset();
     needs_regeneration = false;
 }
 
@@ -289,4 +402,432 @@ void thumbnail_manager::generator::reset_wait()
     wait_frames = 1;
 }
 
+void thumbnail_manager::generator::request_render(const hpp::uuid& uid, std::function<void(scene&)> create_scene)
+{
+    auto it = std::find_if(std::begin(requests),
+                           std::end(requests),
+                           [&](const request& r)
+                           {
+                               return r.uid == uid;
+                           });
+
+    if(it != std::end(requests))
+    {
+        it->frame = frame;
+        return;
+    }
+
+    requests.emplace_back(request{uid, frame, std::move(create_scene)});
+}
+
+void thumbnail_manager::generator::load_from_cache(const hpp::uuid& uid, generated_thumbnail& thumbnail)
+{
+    if(!atlas.is_open() && fs::has_known_protocol("app:/thumbnails"))
+    {
+        atlas.open(fs::resolve_protocol("app:/thumbnails"));
+    }
+
+    const auto* entry = atlas.find(uid, thumbnail.hash);
+    if(entry == nullptr)
+    {
+        return;
+    }
+
+    auto [path, offset] = atlas.get_location(entry->slot);
+    auto format = entry->format;
+    auto hash = thumbnail.hash;
+    thumbnail.loading = true;
+
+    auto& thr = engine::context().get<threader>();
+
+    std::weak_ptr<int> weak_sentinel = sentinel;
+    thr.pool
+        ->schedule(
+            [path = path, offset = offset, io_mutex = atlas.io_mutex]()
+            {
+                std::lock_guard<std::mutex> lock(*io_mutex);
+                return read_tile(path, offset);
+            })
+        .then(itc::main_thread::get_id(),
+              [this, weak_sentinel, uid, hash, format](auto f)
+              {
+                  if(weak_sentinel.expired())
+                  {
+                      return;
+                  }
+
+                  auto it = thumbnails.find(uid);
+                  if(it == std::end(thumbnails) || !it->second.loading || it->second.hash != hash)
+                  {
+                      return;
+                  }
+
+                  auto& thumbnail = it->second;
+                  thumbnail.loading = false;
+
+                  auto pixels = f.get();
+                  if(pixels.empty())
+                  {
+                      // Broken tile, it gets rendered again the next time it is drawn.
+                      atlas.remove(uid);
+                      return;
+                  }
+
+                  auto tex = std::make_shared<gfx::texture>(thumbnail_size,
+                                                            thumbnail_size,
+                                                            false,
+                                                            1,
+                                                            format,
+                                                            BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP,
+                                                            gfx::copy(pixels.data(), std::uint32_t(pixels.size())));
+                  thumbnail.set(tex);
+              });
+}
+
+void thumbnail_manager::generator::process_requests()
+{
+    // Items not drawn during the last frame went off screen.
+    // They are requested again once they become visible.
+    requests.erase(std::remove_if(std::begin(requests),
+                                  std::end(requests),
+                                  [&](const request& r)
+                                  {
+                                      return r.frame + 1 < frame;
+                                  }),
+                   std::end(requests));
+
+    using clock_t = std::chrono::steady_clock;
+    const auto start = clock_t::now();
+
+    auto it = std::begin(requests);
+    for(; it != std::end(requests) && remaining > 0; ++it)
+    {
+        // At least one thumbnail per frame, so progress is made with any budget.
+        if(it != std::begin(requests) && clock_t::now() - start >= budget)
+        {
+            break;
+        }
+
+        auto found = thumbnails.find(it->uid);
+        if(found == std::end(thumbnails) || !found->second.needs_regeneration || found->second.loading)
+        {
+            continue;
+        }
+
+        auto& thumbnail = found->second;
+
+        auto& scn = get_scene();
+        scn.unload();
+        it->create_scene(scn);
+
+        delta_t dt(0.016667f);
+
+        auto& rpath = engine::context().get<rendering_system>();
+        rpath.prepare_scene(scn, dt);
+
+        // Lights are skipped while their programs load, the thumbnail would be cached without them.
+        if(!rpath.is_lighting_ready(scn))
+        {
+            scn.unload();
+            break;
+        }
+
+        auto new_fbo = rpath.render_scene(scn, dt);
+        thumbnail.set(new_fbo);
+
+        start_readback(it->uid, thumbnail);
+    }
+
+    requests.erase(std::begin(requests), it);
+}
+
+void thumbnail_manager::generator::start_readback(const hpp::uuid& uid, const generated_thumbnail& thumbnail)
+{
+    if(!atlas.is_open() || !gfx::is_supported(BGFX_CAPS_TEXTURE_BLIT))
+    {
+        return;
+    }
+
+    auto tex = thumbnail.thumbnail ? thumbnail.thumbnail->get_texture() : nullptr;
+    if(!tex || tex->info.storageSize != thumbnail_atlas::tile_bytes)
+    {
+        return;
+    }
+
+    for(auto& readback : readbacks)
+    {
+        if(readback.uid == uid)
+        {
+            readback.discard = true;
+        }
+    }
+
+    auto& readback = readbacks.emplace_back();
+    readback.uid = uid;
+    readback.hash = thumbnail.hash;
+    readback.format = tex->info.format;
+    readback.pixels.resize(thumbnail_atlas::tile_bytes);
+
+    // Render targets can't be read directly, blit to a cpu texture first.
+    readback.blit = std::make_shared<gfx::texture>(
+        tex->info.width,
+        tex->info.height,
+        false,
+        1,
+        tex->info.format,
+        BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK | BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT |
+            BGFX_SAMPLER_MIP_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+
+    gfx::render_pass pass("thumbnail_blit");
+    gfx::blit(pass.id, readback.blit->native_handle(), 0, 0, tex->native_handle());
+    readback.frame = gfx::read_texture(readback.blit->native_handle(), readback.pixels.data());
+}
+
+void thumbnail_manager::generator::process_readbacks()
+{
+    const auto render_frame = gfx::get_render_frame();
+
+    auto& thr = engine::context().get<threader>();
+
+    for(auto it = std::begin(readbacks); it != std::end(readbacks);)
+    {
+        auto& readback = *it;
+        if(readback.frame > render_frame)
+        {
+            ++it;
+            continue;
+        }
+
+        if(!readback.discard && atlas.is_open())
+        {
+            // The tile goes to a slot no index entry points at. The entry is committed once the
+            // tile is written, so a crash or exit never leaves the index pointing at garbage.
+            auto slot = atlas.reserve();
+            auto [path, offset] = atlas.get_location(slot);
+
+            std::weak_ptr<int> weak_sentinel = sentinel;
+            thr.pool
+                ->schedule(
+                    [path = path, offset = offset, io_mutex = atlas.io_mutex, pixels = std::move(readback.pixels)]()
+                    {
+                        std::lock_guard<std::mutex> lock(*io_mutex);
+                        return write_tile(path, offset, pixels);
+                    })
+                .then(itc::main_thread::get_id(),
+                      [this, weak_sentinel, uid = readback.uid, hash = readback.hash, format = readback.format, slot](
+                          auto f)
+                      {
+                          if(weak_sentinel.expired())
+                          {
+                              return;
+                          }
+
+                          auto it = thumbnails.find(uid);
+                          bool current = it != std::end(thumbnails) && it->second.hash == hash;
+                          if(!f.get() || !current)
+                          {
+                              atlas.release(slot);
+                              return;
+                          }
+
+                          atlas.commit(uid, hash, format, slot);
+                      });
+        }
+
+        it = readbacks.erase(it);
+    }
+}
+
+auto thumbnail_manager::thumbnail_atlas::open(const fs::path& directory) -> bool
+{
+    close();
+
+    fs::error_code ec;
+    fs::create_directories(directory, ec);
+    if(ec)
+    {
+        APPLOG_WARNING("Failed to create thumbnail cache {}", directory.string());
+        return false;
+    }
+
+    dir = directory;
+
+    std::ifstream stream(dir / "index.txt");
+    if(!stream)
+    {
+        return true;
+    }
+
+    // A layout change invalidates the whole cache.
+    std::uint32_t version{};
+    std::uint32_t bytes{};
+    if(!(stream >> version >> bytes) || version != index_version || bytes != tile_bytes)
+    {
+        dirty = true;
+        return true;
+    }
+
+    std::string suid;
+    entry e;
+    std::uint32_t format{};
+    while(stream >> suid >> e.hash >> e.slot >> format)
+    {
+        auto uid = hpp::uuid::from_string(suid);
+        if(!uid)
+        {
+            continue;
+        }
+
+        e.format = gfx::texture_format(format);
+        entries[uid.value()] = e;
+        slot_count = std::max(slot_count, e.slot + 1);
+    }
+
+    std::vector<bool> used(slot_count, false);
+    for(const auto& kvp : entries)
+    {
+        used[kvp.second.slot] = true;
+    }
+
+    for(std::uint32_t slot = 0; slot < slot_count; ++slot)
+    {
+        if(!used[slot])
+        {
+            free_slots.emplace_back(slot);
+        }
+    }
+
+    return true;
+}
+
+void thumbnail_manager::thumbnail_atlas::close()
+{
+    if(is_open() && dirty)
+    {
+        save_index();
+    }
+
+    dir.clear();
+    entries.clear();
+    free_slots.clear();
+    reserved.clear();
+    slot_count = 0;
+    dirty = false;
+}
+
+auto thumbnail_manager::thumbnail_atlas::is_open() const -> bool
+{
+    return !dir.empty();
+}
+
+auto thumbnail_manager::thumbnail_atlas::find(const hpp::uuid& uid, std::uint64_t hash) const -> const entry*
+{
+    auto it = entries.find(uid);
+    if(it == std::end(entries) || it->second.hash != hash)
+    {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+auto thumbnail_manager::thumbnail_atlas::reserve() -> std::uint32_t
+{
+    std::uint32_t slot{};
+    if(!free_slots.empty())
+    {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }
+    else
+    {
+        slot = slot_count++;
+    }
+
+    reserved.emplace(slot);
+    return slot;
+}
+
+void thumbnail_manager::thumbnail_atlas::release(std::uint32_t slot)
+{
+    // Slots reserved before a close belong to no open atlas anymore.
+    if(reserved.erase(slot) == 0)
+    {
+        return;
+    }
+
+    free_slots.emplace_back(slot);
+}
+
+void thumbnail_manager::thumbnail_atlas::commit(const hpp::uuid& uid,
+                                                std::uint64_t hash,
+                                                gfx::texture_format format,
+                                                std::uint32_t slot)
+{
+    if(reserved.erase(slot) == 0)
+    {
+        return;
+    }
+
+    dirty = true;
+
+    auto it = entries.find(uid);
+    if(it != std::end(entries))
+    {
+        // The old tile stayed valid until now, its slot is reused from here on.
+        free_slots.emplace_back(it->second.slot);
+    }
+
+    entry e;
+    e.hash = hash;
+    e.slot = slot;
+    e.format = format;
+    entries[uid] = e;
+}
+
+void thumbnail_manager::thumbnail_atlas::remove(const hpp::uuid& uid)
+{
+    auto it = entries.find(uid);
+    if(it == std::end(entries))
+    {
+        return;
+    }
+
+    free_slots.emplace_back(it->second.slot);
+    entries.erase(it);
+    dirty = true;
+}
+
+void thumbnail_manager::thumbnail_atlas::save_index()
+{
+    dirty = false;
+
+    if(!is_open())
+    {
+        return;
+    }
+
+    std::ofstream stream(dir / "index.txt", std::ios::trunc);
+    if(!stream)
+    {
+        APPLOG_WARNING("Failed to save thumbnail cache index {}", dir.string());
+        return;
+    }
+
+    stream << index_version << " " << tile_bytes << "\n";
+    for(const auto& kvp : entries)
+    {
+        const auto& e = kvp.second;
+        stream << hpp::to_string(kvp.first) << " " << e.hash << " " << e.slot << " " << std::uint32_t(e.format) << "\n";
+    }
+}
+
+auto thumbnail_manager::thumbnail_atlas::get_location(std::uint32_t slot) const
+    -> std::pair<fs::path, std::uint64_t>
+{
+    auto page = slot / tiles_per_page;
+    auto offset = std::uint64_t(slot % tiles_per_page) * tile_bytes;
+    return {dir / fmt::format("page_{}.bin", page), offset};
+}
+
 } // namespace ace
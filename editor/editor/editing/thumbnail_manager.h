@@ -2,6 +2,7 @@
 
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
+#include <filesystem/filesystem.h>
 #include <graphics/frame_buffer.h>
 #include <graphics/shader.h>
 #include <graphics/texture.h>
@@ -9,21 +10,117 @@
 #include <engine/assets/asset_handle.h>
 #include <engine/ecs/scene.h>
 
+#include <chrono>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <set>
+
 namespace ace
 {
 struct thumbnail_manager
 {
+    /// Size in pixels of a generated thumbnail.
+    static constexpr std::uint32_t thumbnail_size = 256;
+
     struct generated_thumbnail
     {
         auto get() -> gfx::texture::ptr;
         void set(gfx::frame_buffer::ptr fbo);
+        void set(gfx::texture::ptr tex);
 
         bool needs_regeneration{true};
+        /// The disk cache was already queried for this content hash.
+        bool cache_checked{false};
+        /// A tile is being read from the disk cache.
+        bool loading{false};
+        /// Hash of the compiled asset the thumbnail was made from.
+        std::uint64_t hash{};
         gfx::frame_buffer::ptr thumbnail;
+        /// Thumbnail loaded from the disk cache.
+        gfx::texture::ptr texture;
+    };
+
+    /**
+     * @struct thumbnail_atlas
+     * @brief On-disk cache of generated thumbnails keyed by asset uuid and content hash.
+     *
+     * Tiles are packed into page files of fixed-size slots and an index file maps
+     * every uuid to its slot. Tiles are read and written on the thread pool.
+     */
+    struct thumbnail_atlas
+    {
+        /// Number of tiles in a page file.
+        static constexpr std::uint32_t tiles_per_page = 64;
+        /// Size in bytes of a RGBA8 tile.
+        static constexpr std::uint32_t tile_bytes = thumbnail_size * thumbnail_size * 4;
+
+        struct entry
+        {
+            std::uint64_t hash{};
+            std::uint32_t slot{};
+            gfx::texture_format format{gfx::texture_format::RGBA8};
+        };
+
+        auto open(const fs::path& directory) -> bool;
+        void close();
+        auto is_open() const -> bool;
+
+        auto find(const hpp::uuid& uid, std::uint64_t hash) const -> const entry*;
+        /// Takes a slot for a tile being written, no entry points at it until it is committed.
+        auto reserve() -> std::uint32_t;
+        /// Hands back a reserved slot whose tile was dropped.
+        void release(std::uint32_t slot);
+        /// Points the entry of an uuid at a fully written tile. Ignored if the slot is not reserved.
+        void commit(const hpp::uuid& uid, std::uint64_t hash, gfx::texture_format format, std::uint32_t slot);
+        void remove(const hpp::uuid& uid);
+        void save_index();
+
+        /// Page file and byte offset of a slot.
+        auto get_location(std::uint32_t slot) const -> std::pair<fs::path, std::uint64_t>;
+
+        fs::path dir;
+        std::map<hpp::uuid, entry> entries;
+        std::vector<std::uint32_t> free_slots;
+        std::uint32_t slot_count{};
+        /// Slots of tiles being written, dropped on close so late writes are never committed.
+        std::set<std::uint32_t> reserved;
+        bool dirty{};
+        /// Serializes page file access between pool tasks.
+        std::shared_ptr<std::mutex> io_mutex = std::make_shared<std::mutex>();
     };
 
     struct generator
     {
+        /**
+         * @struct request
+         * @brief A thumbnail requested by the ui that has to be rendered.
+         */
+        struct request
+        {
+            hpp::uuid uid;
+            /// Frame the thumbnail was last drawn on.
+            std::uint64_t frame{};
+            /// Builds the preview scene of the asset.
+            std::function<void(scene&)> create_scene;
+        };
+
+        /**
+         * @struct readback
+         * @brief A rendered thumbnail being copied back to the cpu for the disk cache.
+         */
+        struct readback
+        {
+            hpp::uuid uid;
+            std::uint64_t hash{};
+            gfx::texture_format format{};
+            gfx::texture::ptr blit;
+            std::vector<std::uint8_t> pixels;
+            std::uint32_t frame{};
+            /// Superseded by a newer render or removed, the pixels are dropped.
+            bool discard{};
+        };
+
         std::map<hpp::uuid, generated_thumbnail> thumbnails;
 
         auto get_scene() -> scene&;
@@ -32,16 +129,38 @@ struct thumbnail_manager
 
         void reset_wait();
 
+        void request_render(const hpp::uuid& uid, std::function<void(scene&)> create_scene);
+        void load_from_cache(const hpp::uuid& uid, generated_thumbnail& thumbnail);
+        void process_requests();
+        void process_readbacks();
+        void start_readback(const hpp::uuid& uid, const generated_thumbnail& thumbnail);
+
         int remaining{0};
 
         std::array<scene, 3> scenes;
 
         int wait_frames{};
-    };
 
+        /// Max cpu time spent on rendering thumbnails per frame.
+        std::chrono::microseconds budget{std::chrono::milliseconds(4)};
+
+        /// Current ui frame, requests older than the last frame are off screen.
+        std::uint64_t frame{};
+
+        /// Pending renders in the order they were first drawn.
+        std::vector<request> requests;
+
+        /// In flight readbacks. A list keeps the pixel buffers stable while the gpu writes into them.
+        std::list<readback> readbacks;
+
+        thumbnail_atlas atlas;
+
+        std::shared_ptr<int> sentinel = std::make_shared<int>(0);
+    };
     auto init(rtti::context& ctx) -> bool;
     auto deinit(rtti::context& ctx) -> bool;
     void on_frame_update(rtti::context& ctx, delta_t);
+    void on_frame_render(rtti::context& ctx, delta_t);
 
     template<typename T>
     auto get_thumbnail(const asset_handle<T>& asset) -> gfx::texture::ptr;
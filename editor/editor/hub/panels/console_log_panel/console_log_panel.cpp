@@ -74,42 +74,125 @@ console_log_panel::console_log_panel()
 
 void console_log_panel::sink_it_(const details::log_msg& msg)
 {
+    auto log_msg = msg;
+    log_msg.color_range_start = 0;
+    log_msg.color_range_end = 0;
+    log_msg.source = {};
+    memory_buf_t formatted;
+    formatter_->format(log_msg, formatted);
+    log_entry entry;
+    entry.formatted.resize(formatted.size());
+    std::memcpy(entry.formatted.data(), formatted.data(), formatted.size() * sizeof(char));
+
+    entry.source.filename = msg.source.filename;
+    entry.source.funcname = msg.source.funcname;
+    entry.source.line = msg.source.line;
+
+    entry.level = msg.level;
+
+    // Never wait for the ui, drop the record instead.
+    if(!queue_.try_push(std::move(entry)))
     {
-        std::lock_guard<std::recursive_mutex> lock(entries_mutex_);
-
-        auto log_msg = msg;
-        log_msg.color_range_start = 0;
-        log_msg.color_range_end = 0;
-        log_msg.source = {};
-        memory_buf_t formatted;
-        formatter_->format(log_msg, formatted);
-        log_entry entry;
-        entry.formatted.resize(formatted.size());
-        std::memcpy(entry.formatted.data(), formatted.data(), formatted.size() * sizeof(char));
-
-        entry.source.filename = msg.source.filename;
-        entry.source.funcname = msg.source.funcname;
-        entry.source.line = msg.source.line;
+        dropped_++;
+    }
+}
 
-        entry.level = msg.level;
+void console_log_panel::flush_()
+{
+}
 
+void console_log_panel::consume_entries()
+{
+    auto push_entry = [&](log_entry&& entry)
+    {
         entry.id = current_id_++;
         entries_.emplace_back(std::move(entry));
+
+        if(entries_.size() > max_entries)
+        {
+            entries_.pop_front();
+        }
+
+        const auto& added = entries_.back();
+        if(!filter_dirty_ && pass_filter(added))
+        {
+            visible_.emplace_back(added.id);
+        }
+
+        has_new_entries_ = true;
+    };
+
+    log_entry entry;
+    while(queue_.try_pop(entry))
+    {
+        push_entry(std::move(entry));
+    }
+
+    auto dropped = dropped_.exchange(0);
+    if(dropped > 0)
+    {
+        log_entry warning;
+        auto text = fmt::format("{} log messages were dropped.\n", dropped);
+        warning.formatted.resize(text.size());
+        std::memcpy(warning.formatted.data(), text.data(), text.size() * sizeof(char));
+        warning.level = level::warn;
+        push_entry(std::move(warning));
+    }
+
+    // Forget the visible entries which were pushed out of the history.
+    auto first_id = entries_.empty() ? current_id_ : entries_.front().id;
+    while(!visible_.empty() && visible_.front() < first_id)
+    {
+        visible_.pop_front();
     }
-    has_new_entries_ = true;
 }
 
-void console_log_panel::flush_()
+auto console_log_panel::pass_filter(const log_entry& entry) const -> bool
 {
+    if(!enabled_categories_[entry.level])
+    {
+        return false;
+    }
+
+    return filter_.PassFilter(entry.formatted.data(), entry.formatted.data() + entry.formatted.size());
 }
 
-void console_log_panel::clear_log()
+void console_log_panel::update_filter()
 {
+    if(filter_text_ != filter_.InputBuf)
     {
-        std::lock_guard<std::recursive_mutex> lock(entries_mutex_);
-        entries_.clear();
-        selected_log_ = {};
+        filter_text_ = filter_.InputBuf;
+        filter_dirty_ = true;
     }
+
+    if(!filter_dirty_)
+    {
+        return;
+    }
+
+    filter_dirty_ = false;
+
+    visible_.clear();
+    for(const auto& entry : entries_)
+    {
+        if(pass_filter(entry))
+        {
+            visible_.emplace_back(entry.id);
+        }
+    }
+}
+
+auto console_log_panel::get_entry(uint64_t id) const -> const log_entry&
+{
+    return entries_[size_t(id - entries_.front().id)];
+}
+
+void console_log_panel::clear_log()
+{
+    consume_entries();
+    entries_.clear();
+    visible_.clear();
+    selected_log_ = {};
     has_new_entries_ = false;
 }
 
@@ -143,6 +226,7 @@ void console_log_panel::draw_filter_button(level::level_enum level)
     if(ImGui::MenuItem(icons[level], nullptr, enabled_categories_[level]))
     {
         enabled_categories_[level] = !enabled_categories_[level];
+        filter_dirty_ = true;
     }
     ImGui::PopStyleColor();
     ImGui::ItemTooltip(fmt::format("Enables/Disables {} logs.", levels[level]).c_str());
@@ -249,28 +333,16 @@ void console_log_panel::draw()
     }
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 1)); // Tighten spacing
 
-    std::lock_guard<std::recursive_mutex> lock(entries_mutex_);
-    display_entries_t entries;
-    {
-        for(const auto& msg : entries_)
-        {
-            if(!enabled_categories_[msg.level])
-                continue;
-
-            if(!filter_.PassFilter(msg.formatted.data(), msg.formatted.data() + msg.formatted.size()))
-                continue;
-
-            entries.emplace_back(msg);
-        }
-    }
+    update_filter();
+    consume_entries();
 
     ImGuiListClipper clipper;
-    clipper.Begin(int(entries.size()));
+    clipper.Begin(int(visible_.size()));
     while(clipper.Step())
     {
         for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
         {
-            const auto& msg = entries[i];
+            const auto& msg = get_entry(visible_[i]);
 
             if(selected_log_)
             {
@@ -310,22 +382,14 @@ void console_log_panel::draw()
 
 auto console_log_panel::draw_last_log() -> bool
 {
-    log_entry msg;
+    consume_entries();
 
-    {
-        std::lock_guard<std::recursive_mutex> lock(entries_mutex_);
-        if(!entries_.empty())
-        {
-            msg = entries_.back();
-        }
-    }
-
-    if(msg.formatted.empty())
+    if(entries_.empty() || entries_.back().formatted.empty())
     {
         return false;
     }
 
-    draw_log(msg, 1);
+    draw_log(entries_.back(), 1);
 
     return true;
 }
@@ -347,8 +411,6 @@ void console_log_panel::draw_last_log_button()
 
 void console_log_panel::draw_details()
 {
-    std::lock_guard<std::recursive_mutex> lock(entries_mutex_);
-
     if(selected_log_)
     {
         const auto& msg = *selected_log_;
@@ -2,7 +2,6 @@
 #include <editor/imgui/integration/imgui.h>
 
 #include <hpp/optional.hpp>
-#include <hpp/ring_buffer.hpp>
 #include <hpp/small_vector.hpp>
 
 // #include <console/console.h>
@@ -10,12 +9,108 @@
 
 #include <array>
 #include <atomic>
+#include <cstdint>
+#include <deque>
 #include <string>
 
 namespace ace
 {
 
-class console_log_panel : public sinks::base_sink<std::mutex> //, public console
+/**
+ * @class mpsc_ring_buffer
+ * @brief Bounded lock-free queue with many producers and a single consumer.
+ *
+ * Every slot carries a sequence number telling whether it is free for the
+ * producer of a given position or ready for the consumer. Producers never wait,
+ * pushing into a full queue fails instead.
+ */
+template<typename T, size_t Capacity>
+class mpsc_ring_buffer
+{
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    mpsc_ring_buffer()
+    {
+        for(size_t i = 0; i < Capacity; ++i)
+        {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Pushes a value. Safe to call from any thread.
+     * @return False if the queue is full.
+     */
+    auto try_push(T&& value) -> bool
+    {
+        auto pos = head_.load(std::memory_order_relaxed);
+        for(;;)
+        {
+            auto& s = slots_[pos & (Capacity - 1)];
+            auto seq = s.sequence.load(std::memory_order_acquire);
+            auto diff = std::intptr_t(seq) - std::intptr_t(pos);
+            if(diff == 0)
+            {
+                if(head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    s.value = std::move(value);
+                    s.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if(diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Pops the oldest value. Only the consumer thread may call it.
+     * @return False if the queue is empty.
+     */
+    auto try_pop(T& value) -> bool
+    {
+        auto& s = slots_[tail_ & (Capacity - 1)];
+        auto seq = s.sequence.load(std::memory_order_acquire);
+        if(std::intptr_t(seq) - std::intptr_t(tail_ + 1) < 0)
+        {
+            return false;
+        }
+
+        value = std::move(s.value);
+        s.sequence.store(tail_ + Capacity, std::memory_order_release);
+        ++tail_;
+        return true;
+    }
+
+private:
+    struct slot
+    {
+        std::atomic<size_t> sequence{};
+        T value{};
+    };
+
+    std::array<slot, Capacity> slots_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) size_t tail_{0};
+};
+
+/**
+ * @class console_log_panel
+ * @brief Shows the log records of the application.
+ *
+ * The sink formats records on the logging thread and pushes them into a lock-free
+ * queue, so the ui never blocks producers. The ui thread drains the queue into its
+ * own history and keeps the list of entries passing the filters up to date
+ * incrementally.
+ */
+class console_log_panel : public sinks::base_sink<details::null_mutex> //, public console
 {
 public:
     using mem_buf = hpp::small_vector<char, 250>;
@@ -37,8 +132,11 @@ public:
         uint64_t id{};
     };
 
-    using display_entries_t = hpp::small_vector<log_entry, 1024>;
-    using entries_t = hpp::stack_ringbuffer<log_entry, 1024>;
+    /// Max number of entries kept in the history.
+    static constexpr size_t max_entries = 1024;
+
+    using entries_t = std::deque<log_entry>;
+    using queue_t = mpsc_ring_buffer<log_entry, 1024>;
 
     console_log_panel();
     void sink_it_(const details::log_msg& msg) override;
@@ -59,19 +157,33 @@ private:
     auto has_new_entries() const -> bool;
     void set_has_new_entries(bool val);
 
+    void consume_entries();
+    auto pass_filter(const log_entry& entry) const -> bool;
+    void update_filter();
+    auto get_entry(uint64_t id) const -> const log_entry&;
+
     auto draw_log(const log_entry& msg, int num_lines) -> bool;
     void draw_range(const hpp::string_view& formatted, size_t start, size_t end);
     void draw_filter_button(level::level_enum level);
 
     std::array<bool, size_t(level::n_levels)> enabled_categories_{};
 
-    std::recursive_mutex entries_mutex_;
-    ///
+    /// Records pushed by the sink, drained by the ui thread.
+    queue_t queue_;
+    /// Number of records dropped because the queue was full.
+    std::atomic<uint64_t> dropped_{};
+    /// History owned by the ui thread, ids are consecutive.
     entries_t entries_;
+    /// Ids of the entries passing the filters.
+    std::deque<uint64_t> visible_;
     ///
     std::atomic<bool> has_new_entries_ = {false};
 
     ImGuiTextFilter filter_;
+    /// Filter text the visible entries were built with.
+    std::string filter_text_;
+    /// The visible entries have to be rebuilt.
+    bool filter_dirty_{true};
 
     uint64_t current_id_{};
     hpp::optional<log_entry> selected_log_{};
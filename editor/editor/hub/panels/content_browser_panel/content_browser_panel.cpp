@@ -152,12 +152,11 @@ void process_drag_drop_target(const fs::path& absolute_path)
 
 auto draw_item(const content_browser_item& item)
 {
-    bool is_directory = item.entry.entry.is_directory();
-    const auto& absolute_path = item.entry.entry.path();
+    const auto& absolute_path = item.entry.path;
     const auto& name = item.entry.stem;
     const auto& filename = item.entry.filename;
     const auto& file_ext = item.entry.extension;
-    const auto& file_type = ex::get_type(file_ext, is_directory);
+    const auto& file_type = item.entry.type;
     enum class entry_action
     {
         none,
@@ -395,6 +394,9 @@ void content_browser_panel::init(rtti::context& ctx)
 
 void content_browser_panel::deinit(rtti::context& ctx)
 {
+    index_.deinit();
+    root_.clear();
+    search_results_.clear();
     filter_ = {};
 }
 
@@ -415,19 +417,33 @@ void content_browser_panel::draw(rtti::context& ctx)
 
     const auto root_path = fs::resolve_protocol("app:/data");
 
-    fs::error_code err;
-    if(root_ != root_path || !fs::exists(cache_.get_path(), err))
+    if(root_ != root_path)
     {
         root_ = root_path;
+
+        auto& thr = ctx.get<threader>();
+        index_.init(root_,
+                    [&thr](std::function<void()> task)
+                    {
+                        thr.pool->schedule(std::move(task));
+                    });
         set_cache_path(root_);
     }
 
+    index_.update(2ms);
+
     if(!em.focused_data.focus_path.empty())
     {
         set_cache_path(em.focused_data.focus_path);
         em.focused_data.focus_path.clear();
     }
 
+    // The opened directory was removed or renamed.
+    if(index_.is_ready() && index_.find(current_path_) == content_index::invalid_index)
+    {
+        set_cache_path(root_);
+    }
+
     auto avail = ImGui::GetContentRegionAvail();
     if(avail.x < 1.0f || avail.y < 1.0f)
     {
@@ -438,10 +454,7 @@ void content_browser_panel::draw(rtti::context& ctx)
     {
         // ImGui::WindowTimeBlock block(ImGui::GetFont(ImGui::Font::Mono));
 
-        if(fs::is_directory(root_path, err))
-        {
-            draw_details(ctx, root_path);
-        }
+        draw_details(ctx, index_.find(root_path));
     }
     ImGui::EndChild();
 
@@ -454,8 +467,7 @@ void content_browser_panel::draw(rtti::context& ctx)
     }
     ImGui::EndChild();
 
-    const auto& current_path = cache_.get_path();
-    process_drag_drop_target(current_path);
+    process_drag_drop_target(current_path_);
 
     if(refresh_ > 0)
     {
@@ -463,12 +475,18 @@ void content_browser_panel::draw(rtti::context& ctx)
     }
 }
 
-void content_browser_panel::draw_details(rtti::context& ctx, const fs::path& path)
+void content_browser_panel::draw_details(rtti::context& ctx, content_index::index_t dir)
 {
+    if(dir == content_index::invalid_index)
+    {
+        return;
+    }
+
     {
         ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanFullWidth;
 
-        const auto& selected_path = cache_.get_path();
+        const auto& path = index_.get(dir).path;
+        const auto& selected_path = current_path_;
         if(selected_path == path)
         {
             flags |= ImGuiTreeNodeFlags_Selected;
@@ -487,14 +505,14 @@ void content_browser_panel::draw_details(rtti::context& ctx, const fs::path& pat
 
         if(open)
         {
-            const fs::directory_iterator it(path);
-            for(const auto& p : it)
+            // Directories are sorted first.
+            for(auto child : index_.get_children(dir))
             {
-                if(fs::is_directory(p.status()))
+                if(!index_.get(child).is_directory)
                 {
-                    const auto& path = p.path();
-                    draw_details(ctx, path);
+                    break;
                 }
+                draw_details(ctx, child);
             }
 
             ImGui::TreePop();
@@ -514,7 +532,7 @@ void content_browser_panel::draw_as_explorer(rtti::context& ctx, const fs::path&
     auto& tm = ctx.get<thumbnail_manager>();
 
     const float size = ImGui::GetFrameHeight() * 6.0f * scale_;
-    const auto hierarchy = fs::split_until(cache_.get_path(), root_path);
+    const auto hierarchy = fs::split_until(current_path_, root_path);
 
     ImGui::DrawFilterWithHint(filter_, ICON_MDI_FILE_SEARCH " Search...", 200.0f);
     ImGui::DrawItemActivityOutline();
@@ -577,7 +595,7 @@ void content_browser_panel::draw_as_explorer(rtti::context& ctx, const fs::path&
     ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize |
                              ImGuiWindowFlags_NoSavedSettings;
 
-    fs::path current_path = cache_.get_path();
+    fs::path current_path = current_path_;
 
     if(ImGui::BeginChild("assets_content", ImGui::GetContentRegionAvail(), false, flags))
     {
@@ -585,9 +603,9 @@ void content_browser_panel::draw_as_explorer(rtti::context& ctx, const fs::path&
 
         bool is_popup_opened = false;
 
-        auto process_cache_entry = [&](const auto& cache_entry)
+        auto process_cache_entry = [&](const content_index::entry& cache_entry)
         {
-            const auto& absolute_path = cache_entry.entry.path();
+            const auto& absolute_path = cache_entry.path;
             const auto& name = cache_entry.stem;
             const auto& filename = cache_entry.filename;
             const auto& relative = cache_entry.protocol_path;
@@ -689,7 +707,7 @@ void content_browser_panel::draw_as_explorer(rtti::context& ctx, const fs::path&
                     em.select(entry);
                 };
 
-                if(fs::is_directory(cache_entry.entry.status()))
+                if(cache_entry.is_directory)
                 {
                     item.on_double_click = [&]()
                     {
@@ -702,40 +720,38 @@ void content_browser_panel::draw_as_explorer(rtti::context& ctx, const fs::path&
             }
         };
 
-        auto cache_size = cache_.size();
+        const auto current = index_.find(current_path_);
+
+        std::string search_text = filter_.InputBuf;
+        search_text.erase(0, search_text.find_first_not_of(' '));
+        search_text.erase(search_text.find_last_not_of(' ') + 1);
 
-        if(!filter_.IsActive())
+        if(current != content_index::invalid_index && search_text.empty())
         {
+            const auto& children = index_.get_children(current);
             ImGui::ItemBrowser(size,
-                               cache_size,
+                               children.size(),
                                [&](int index)
                                {
-                                   auto& cache_entry = cache_[index];
-                                   process_cache_entry(cache_entry);
+                                   process_cache_entry(index_.get(children[index]));
                                });
         }
-        else
+        else if(current != content_index::invalid_index)
         {
-            std::vector<fs::directory_cache::cache_entry> filtered_entries;
-            for(size_t index = 0; index < cache_size; ++index)
+            // Searches the opened directory and everything below it.
+            if(search_text != search_text_ || current != search_scope_ || index_.get_version() != search_version_)
             {
-                const auto& cache_entry = cache_[index];
-
-                const auto& name = cache_entry.stem;
-                const auto& filename = cache_entry.filename;
-
-                if(filter_.PassFilter(name.c_str()))
-                {
-                    filtered_entries.emplace_back(cache_entry);
-                }
+                search_text_ = search_text;
+                search_scope_ = current;
+                search_version_ = index_.get_version();
+                index_.filter(search_text_, search_scope_, search_results_);
             }
 
             ImGui::ItemBrowser(size,
-                               filtered_entries.size(),
+                               search_results_.size(),
                                [&](int index)
                                {
-                                   auto& cache_entry = filtered_entries[index];
-                                   process_cache_entry(cache_entry);
+                                   process_cache_entry(index_.get(search_results_[index]));
                                });
         }
 
@@ -760,7 +776,7 @@ void content_browser_panel::context_menu(rtti::context& ctx)
 
         if(ImGui::Selectable("Open in Explorer"))
         {
-            fs::show_in_graphical_env(cache_.get_path());
+            fs::show_in_graphical_env(current_path_);
         }
 
         ImGui::Separator();
@@ -784,7 +800,7 @@ void content_browser_panel::context_create_menu(rtti::context& ctx)
     {
         if(ImGui::MenuItem("Folder"))
         {
-            const auto available = get_new_file(cache_.get_path(), "New Folder");
+            const auto available = get_new_file(current_path_, "New Folder");
             fs::error_code err;
             fs::create_directory(available, err);
         }
@@ -795,7 +811,7 @@ void content_browser_panel::context_create_menu(rtti::context& ctx)
         {
             auto& am = ctx.get<asset_manager>();
 
-            const auto available = get_new_file(cache_.get_path(), "New Material", ex::get_format<material>());
+            const auto available = get_new_file(current_path_, "New Material", ex::get_format<material>());
             const auto key = fs::convert_to_protocol(available).generic_string();
 
             auto new_mat_future = am.get_asset_from_instance<material>(key, std::make_shared<pbr_material>());
@@ -807,7 +823,7 @@ void content_browser_panel::context_create_menu(rtti::context& ctx)
             auto& am = ctx.get<asset_manager>();
 
             const auto available =
-                get_new_file(cache_.get_path(), "New Physics Material", ex::get_format<physics_material>());
+                get_new_file(current_path_, "New Physics Material", ex::get_format<physics_material>());
             const auto key = fs::convert_to_protocol(available).generic_string();
 
             auto new_mat_future =
@@ -821,11 +837,11 @@ void content_browser_panel::context_create_menu(rtti::context& ctx)
 
 void content_browser_panel::set_cache_path(const fs::path& path)
 {
-    if(cache_.get_path() == path)
+    if(current_path_ == path)
     {
         return;
     }
-    cache_.set_path(path);
+    current_path_ = path;
     refresh_ = 3;
 }
 
@@ -848,7 +864,7 @@ void content_browser_panel::on_import(rtti::context& ctx, const std::vector<std:
         fs::path filename = p.filename();
 
         auto task = ts.pool->schedule(
-            [opened = cache_.get_path()](const fs::path& path, const fs::path& filename)
+            [opened = current_path_](const fs::path& path, const fs::path& filename)
             {
                 fs::error_code err;
                 fs::path dir = opened / filename;
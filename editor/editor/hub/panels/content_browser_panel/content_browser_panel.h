@@ -1,6 +1,7 @@
 #pragma once
+#include "content_index.h"
+
 #include <editor/imgui/integration/imgui.h>
-#include <filesystem/cache.hpp>
 
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
@@ -13,13 +14,13 @@ struct content_browser_item
     using on_action_t = std::function<void()>;
     using on_rename_t = std::function<void(const std::string&)>;
 
-    content_browser_item(const fs::directory_cache::cache_entry& e)
+    content_browser_item(const content_index::entry& e)
         : entry(e)
     {
 
     }
 
-    const fs::directory_cache::cache_entry& entry;
+    const content_index::entry& entry;
     on_action_t on_click;
     on_action_t on_double_click;
     on_action_t on_delete;
@@ -42,7 +43,7 @@ public:
     void on_frame_ui_render(rtti::context& ctx, const char* name);
 private:
     void draw(rtti::context& ctx);
-    void draw_details(rtti::context& ctx, const fs::path& root_path);
+    void draw_details(rtti::context& ctx, content_index::index_t dir);
 
     void draw_as_explorer(rtti::context& ctx, const fs::path& root_path);
     void context_menu(rtti::context& ctx);
@@ -51,9 +52,16 @@ private:
     void import(rtti::context& ctx);
     void on_import(rtti::context& ctx, const std::vector<std::string>& paths);
 
-    fs::directory_cache cache_;
+    content_index index_;
+    fs::path current_path_;
 
     ImGuiTextFilter filter_;
+    /// Search results, refreshed when the text, scope or index changes
+    std::vector<content_index::index_t> search_results_;
+    std::string search_text_;
+    content_index::index_t search_scope_{content_index::invalid_index};
+    std::uint64_t search_version_{};
+
     fs::path root_;
     int refresh_{};
     float scale_ = 0.65f;
@@ -0,0 +1,674 @@
+#include "content_index.h"
+
+#include <engine/assets/impl/asset_extensions.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace ace
+{
+using namespace std::literals;
+namespace
+{
+
+auto get_key(const fs::path& path) -> std::string
+{
+    auto key = path.lexically_normal().make_preferred().string();
+    if(key.size() > 1 && key.back() == char(fs::path::preferred_separator))
+    {
+        key.pop_back();
+    }
+    return key;
+}
+
+auto to_lower(const std::string& str) -> std::string
+{
+    std::string result(str.size(), '\0');
+    std::transform(std::begin(str),
+                   std::end(str),
+                   std::begin(result),
+                   [](unsigned char c)
+                   {
+                       return static_cast<char>(std::tolower(c));
+                   });
+    return result;
+}
+
+auto get_trigram_count(const std::string& str) -> std::size_t
+{
+    return str.size() < 3 ? 0 : str.size() - 2;
+}
+
+auto get_trigram(const std::string& str, std::size_t pos) -> std::uint32_t
+{
+    return (std::uint32_t(std::uint8_t(str[pos])) << 16) | (std::uint32_t(std::uint8_t(str[pos + 1])) << 8) |
+           std::uint32_t(std::uint8_t(str[pos + 2]));
+}
+
+auto starts_with(const std::string& str, const std::string& prefix) -> bool
+{
+    return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+content_index::~content_index()
+{
+    deinit();
+}
+
+void content_index::init(const fs::path& root, const std::function<void(std::function<void()>)>& schedule)
+{
+    deinit();
+
+    root_ = root;
+    add(root_, true, invalid_index);
+
+    shared_ = std::make_shared<shared_state>();
+
+    // The initial listing walks the whole project, keep it off the calling thread.
+    schedule(
+        [shared = shared_, root]()
+        {
+            auto callback = [weak_shared = std::weak_ptr<shared_state>(shared)](const auto& entries, bool)
+            {
+                auto shared = weak_shared.lock();
+                if(!shared)
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                if(shared->stopped)
+                {
+                    return;
+                }
+
+                for(const auto& e : entries)
+                {
+                    auto& c = shared->changes.emplace_back();
+                    c.status = e.status;
+                    c.path = e.path;
+                    c.last_path = e.last_path;
+                    c.size = e.size;
+                    c.is_directory = e.type == fs::file_type::directory;
+                }
+            };
+
+            auto id = fs::watcher::watch(root / "*", true, true, 500ms, callback);
+
+            bool stopped{};
+            {
+                std::lock_guard<std::mutex> lock(shared->mutex);
+                stopped = shared->stopped;
+                shared->watch_id = id;
+                // the initial listing was delivered from within watch()
+                shared->ready = true;
+            }
+
+            if(stopped)
+            {
+                fs::watcher::unwatch(id);
+            }
+        });
+}
+
+void content_index::deinit()
+{
+    if(shared_)
+    {
+        std::uint64_t id{};
+        {
+            std::lock_guard<std::mutex> lock(shared_->mutex);
+            shared_->stopped = true;
+            id = shared_->watch_id;
+        }
+
+        if(id != 0)
+        {
+            fs::watcher::unwatch(id);
+        }
+        shared_.reset();
+    }
+
+    root_.clear();
+    entries_.clear();
+    free_.clear();
+    lookup_.clear();
+    names_.clear();
+    names_dirty_ = true;
+    trigrams_.clear();
+    postings_ = 0;
+    stale_postings_ = 0;
+    pending_.clear();
+    pending_pos_ = 0;
+    ready_ = false;
+    version_++;
+}
+
+void content_index::update(clock_t::duration budget)
+{
+    if(shared_)
+    {
+        std::lock_guard<std::mutex> lock(shared_->mutex);
+        pending_.insert(std::end(pending_),
+                        std::make_move_iterator(std::begin(shared_->changes)),
+                        std::make_move_iterator(std::end(shared_->changes)));
+        shared_->changes.clear();
+        ready_ = shared_->ready;
+    }
+
+    // The initial listing of a large project arrives at once, spread it over frames.
+    const auto start = clock_t::now();
+    while(pending_pos_ < pending_.size())
+    {
+        apply(pending_[pending_pos_++]);
+
+        if((pending_pos_ % 64) == 0 && clock_t::now() - start > budget)
+        {
+            break;
+        }
+    }
+
+    if(pending_pos_ == pending_.size())
+    {
+        pending_.clear();
+        pending_pos_ = 0;
+    }
+}
+
+auto content_index::get_root() const -> const fs::path&
+{
+    return root_;
+}
+
+auto content_index::get(index_t index) const -> const entry&
+{
+    return entries_[index];
+}
+
+auto content_index::find(const fs::path& path) const -> index_t
+{
+    auto it = lookup_.find(get_key(path));
+    if(it == lookup_.end())
+    {
+        return invalid_index;
+    }
+    return it->second;
+}
+
+auto content_index::get_children(index_t index) -> const std::vector<index_t>&
+{
+    auto& e = entries_[index];
+    if(e.children_dirty)
+    {
+        std::sort(std::begin(e.children),
+                  std::end(e.children),
+                  [&](index_t lhs, index_t rhs)
+                  {
+                      const auto& l = entries_[lhs];
+                      const auto& r = entries_[rhs];
+                      if(l.is_directory != r.is_directory)
+                      {
+                          return l.is_directory;
+                      }
+                      return l.search_name < r.search_name;
+                  });
+        e.children_dirty = false;
+    }
+    return e.children;
+}
+
+auto content_index::is_inside(index_t index, index_t dir) const -> bool
+{
+    for(auto i = entries_[index].parent; i != invalid_index; i = entries_[i].parent)
+    {
+        if(i == dir)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void content_index::search(const std::string& text, index_t scope, std::vector<index_t>& result)
+{
+    result.clear();
+
+    const auto query = to_lower(text);
+    if(query.empty() || scope >= entries_.size())
+    {
+        return;
+    }
+
+    if(query.size() < 3)
+    {
+        if(names_dirty_)
+        {
+            names_.clear();
+            for(index_t i = 0; i < entries_.size(); ++i)
+            {
+                if(entries_[i].alive && entries_[i].parent != invalid_index)
+                {
+                    names_.emplace_back(entries_[i].search_name, i);
+                }
+            }
+            std::sort(std::begin(names_), std::end(names_));
+            names_dirty_ = false;
+        }
+
+        auto it = std::lower_bound(std::begin(names_), std::end(names_), std::make_pair(query, index_t(0)));
+        for(; it != std::end(names_) && starts_with(it->first, query); ++it)
+        {
+            if(is_inside(it->second, scope))
+            {
+                result.emplace_back(it->second);
+            }
+        }
+    }
+    else
+    {
+        if(stale_postings_ > postings_ / 2)
+        {
+            rebuild_trigrams();
+        }
+
+        // Every match contains all trigrams of the query, start from the rarest one.
+        const std::vector<index_t>* candidates = nullptr;
+        for(std::size_t i = 0; i < get_trigram_count(query); ++i)
+        {
+            auto it = trigrams_.find(get_trigram(query, i));
+            if(it == trigrams_.end())
+            {
+                return;
+            }
+
+            if(candidates == nullptr || it->second.size() < candidates->size())
+            {
+                candidates = &it->second;
+            }
+        }
+
+        for(auto index : *candidates)
+        {
+            const auto& e = entries_[index];
+            if(e.alive && e.search_name.find(query) != std::string::npos && is_inside(index, scope))
+            {
+                result.emplace_back(index);
+            }
+        }
+
+        // Reused slots can be listed under several trigrams of the same name.
+        std::sort(std::begin(result), std::end(result));
+        result.erase(std::unique(std::begin(result), std::end(result)), std::end(result));
+    }
+
+    std::sort(std::begin(result),
+              std::end(result),
+              [&](index_t lhs, index_t rhs)
+              {
+                  const auto& l = entries_[lhs];
+                  const auto& r = entries_[rhs];
+                  const bool l_prefix = starts_with(l.search_name, query);
+                  const bool r_prefix = starts_with(r.search_name, query);
+                  if(l_prefix != r_prefix)
+                  {
+                      return l_prefix;
+                  }
+                  if(l.is_directory != r.is_directory)
+                  {
+                      return l.is_directory;
+                  }
+                  return l.search_name < r.search_name;
+              });
+}
+
+void content_index::filter(const std::string& filter, index_t scope, std::vector<index_t>& result)
+{
+    result.clear();
+
+    std::vector<std::string> include;
+    std::vector<std::string> exclude;
+
+    std::size_t begin = 0;
+    while(begin <= filter.size())
+    {
+        auto end = std::min(filter.find(',', begin), filter.size());
+        auto term = filter.substr(begin, end - begin);
+        begin = end + 1;
+
+        term.erase(0, term.find_first_not_of(' '));
+        term.erase(term.find_last_not_of(' ') + 1);
+        if(term.empty())
+        {
+            continue;
+        }
+
+        if(term[0] == '-')
+        {
+            if(term.size() > 1)
+            {
+                exclude.emplace_back(to_lower(term.substr(1)));
+            }
+        }
+        else
+        {
+            include.emplace_back(std::move(term));
+        }
+    }
+
+    if(include.empty() && exclude.empty())
+    {
+        return;
+    }
+
+    if(include.empty())
+    {
+        for(index_t i = 0; i < entries_.size(); ++i)
+        {
+            if(entries_[i].alive && is_inside(i, scope))
+            {
+                result.emplace_back(i);
+            }
+        }
+
+        std::sort(std::begin(result),
+                  std::end(result),
+                  [&](index_t lhs, index_t rhs)
+                  {
+                      const auto& l = entries_[lhs];
+                      const auto& r = entries_[rhs];
+                      if(l.is_directory != r.is_directory)
+                      {
+                          return l.is_directory;
+                      }
+                      return l.search_name < r.search_name;
+                  });
+    }
+    else
+    {
+        // Results of the first terms come first, entries matching several terms are listed once.
+        std::vector<index_t> matches;
+        std::vector<bool> listed(entries_.size(), false);
+        for(const auto& term : include)
+        {
+            search(term, scope, matches);
+            for(auto index : matches)
+            {
+                if(!listed[index])
+                {
+                    listed[index] = true;
+                    result.emplace_back(index);
+                }
+            }
+        }
+    }
+
+    result.erase(std::remove_if(std::begin(result),
+                                std::end(result),
+                                [&](index_t index)
+                                {
+                                    const auto& name = entries_[index].search_name;
+                                    return std::any_of(std::begin(exclude),
+                                                       std::end(exclude),
+                                                       [&](const std::string& term)
+                                                       {
+                                                           return name.find(term) != std::string::npos;
+                                                       });
+                                }),
+                 std::end(result));
+}
+
+auto content_index::get_version() const -> std::uint64_t
+{
+    return version_;
+}
+
+auto content_index::is_ready() const -> bool
+{
+    return ready_ && pending_pos_ == pending_.size();
+}
+
+void content_index::apply(const change& c)
+{
+    switch(c.status)
+    {
+        case fs::watcher::entry_status::created:
+        case fs::watcher::entry_status::modified:
+        {
+            upsert(c.path, c.is_directory, c.size);
+        }
+        break;
+
+        case fs::watcher::entry_status::removed:
+        {
+            auto index = find(c.path);
+            if(index != invalid_index && entries_[index].parent != invalid_index)
+            {
+                remove(index);
+            }
+        }
+        break;
+
+        case fs::watcher::entry_status::renamed:
+        {
+            // Children of a renamed directory are reported too, but were
+            // already moved along with it.
+            auto from = find(c.last_path);
+            auto to = find(c.path);
+            if(from != invalid_index && to == invalid_index && entries_[from].parent != invalid_index)
+            {
+                move(from, c.path);
+            }
+            else if(from != invalid_index && to != invalid_index && from != to && entries_[from].parent != invalid_index)
+            {
+                remove(from);
+            }
+
+            upsert(c.path, c.is_directory, c.size);
+        }
+        break;
+
+        default:
+            break;
+    }
+}
+
+auto content_index::upsert(const fs::path& path, bool is_directory, std::uintmax_t size) -> index_t
+{
+    auto index = find(path);
+    if(index == invalid_index)
+    {
+        const auto key = get_key(path);
+        const auto root_key = get_key(root_);
+        if(key.size() <= root_key.size() || !starts_with(key, root_key) ||
+           key[root_key.size()] != char(fs::path::preferred_separator))
+        {
+            return invalid_index;
+        }
+
+        // The parent may not have been reported yet.
+        auto parent = find(path.parent_path());
+        if(parent == invalid_index)
+        {
+            parent = upsert(path.parent_path(), true, 0);
+        }
+        if(parent == invalid_index)
+        {
+            return invalid_index;
+        }
+
+        index = add(path, is_directory, parent);
+    }
+
+    auto& e = entries_[index];
+    e.size = size;
+    if(e.is_directory != is_directory)
+    {
+        e.is_directory = is_directory;
+        e.type = ex::get_type(e.extension, is_directory);
+        if(e.parent != invalid_index)
+        {
+            entries_[e.parent].children_dirty = true;
+        }
+        version_++;
+    }
+
+    return index;
+}
+
+auto content_index::add(const fs::path& path, bool is_directory, index_t parent) -> index_t
+{
+    index_t index{};
+    if(!free_.empty())
+    {
+        index = free_.back();
+        free_.pop_back();
+    }
+    else
+    {
+        index = static_cast<index_t>(entries_.size());
+        entries_.emplace_back();
+    }
+
+    auto& e = entries_[index];
+    e = {};
+    e.alive = true;
+    e.is_directory = is_directory;
+    set_path(e, path);
+
+    lookup_[get_key(path)] = index;
+    if(parent != invalid_index)
+    {
+        link(index, parent);
+    }
+    add_trigrams(index);
+
+    names_dirty_ = true;
+    version_++;
+    return index;
+}
+
+void content_index::remove(index_t index)
+{
+    // Copied, removing a child unlinks it from this list.
+    auto children = entries_[index].children;
+    for(auto child : children)
+    {
+        remove(child);
+    }
+
+    unlink(index);
+
+    auto& e = entries_[index];
+    lookup_.erase(get_key(e.path));
+    stale_postings_ += get_trigram_count(e.search_name);
+    e = {};
+    free_.emplace_back(index);
+
+    names_dirty_ = true;
+    version_++;
+}
+
+void content_index::move(index_t index, const fs::path& path)
+{
+    unlink(index);
+
+    {
+        auto& e = entries_[index];
+        lookup_.erase(get_key(e.path));
+        stale_postings_ += get_trigram_count(e.search_name);
+        set_path(e, path);
+        lookup_[get_key(path)] = index;
+    }
+    add_trigrams(index);
+
+    auto parent = find(path.parent_path());
+    if(parent == invalid_index)
+    {
+        parent = upsert(path.parent_path(), true, 0);
+    }
+    if(parent != invalid_index)
+    {
+        link(index, parent);
+    }
+
+    // Names below are unchanged, only the paths are rebased.
+    std::vector<index_t> stack(entries_[index].children);
+    while(!stack.empty())
+    {
+        auto child = stack.back();
+        stack.pop_back();
+
+        auto& c = entries_[child];
+        lookup_.erase(get_key(c.path));
+        set_path(c, entries_[c.parent].path / c.filename);
+        lookup_[get_key(c.path)] = child;
+
+        stack.insert(std::end(stack), std::begin(c.children), std::end(c.children));
+    }
+
+    names_dirty_ = true;
+    version_++;
+}
+
+void content_index::set_path(entry& e, const fs::path& path)
+{
+    const auto filename = path.filename();
+    e.path = path;
+    e.protocol_path = fs::convert_to_protocol(path).generic_string();
+    e.filename = filename.string();
+    e.stem = filename.stem().string();
+    e.extension = filename.extension().string();
+    e.search_name = to_lower(e.filename);
+    e.type = ex::get_type(e.extension, e.is_directory);
+}
+
+void content_index::link(index_t index, index_t parent)
+{
+    entries_[index].parent = parent;
+
+    auto& p = entries_[parent];
+    p.children.emplace_back(index);
+    p.children_dirty = true;
+}
+
+void content_index::unlink(index_t index)
+{
+    auto& e = entries_[index];
+    if(e.parent == invalid_index)
+    {
+        return;
+    }
+
+    auto& siblings = entries_[e.parent].children;
+    siblings.erase(std::remove(std::begin(siblings), std::end(siblings), index), std::end(siblings));
+    e.parent = invalid_index;
+}
+
+void content_index::add_trigrams(index_t index)
+{
+    const auto& name = entries_[index].search_name;
+    for(std::size_t i = 0; i < get_trigram_count(name); ++i)
+    {
+        trigrams_[get_trigram(name, i)].emplace_back(index);
+    }
+    postings_ += get_trigram_count(name);
+}
+
+void content_index::rebuild_trigrams()
+{
+    trigrams_.clear();
+    postings_ = 0;
+    stale_postings_ = 0;
+
+    for(index_t i = 0; i < entries_.size(); ++i)
+    {
+        if(entries_[i].alive)
+        {
+            add_trigrams(i);
+        }
+    }
+}
+
+} // namespace ace
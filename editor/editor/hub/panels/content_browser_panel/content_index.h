@@ -0,0 +1,214 @@
+#pragma once
+
+#include <filesystem/filesystem.h>
+#include <filesystem/watcher.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class content_index
+ * @brief Project wide table of files and directories maintained from watcher events.
+ *
+ * The watcher reports changes from its own thread. They are queued and applied on the
+ * UI thread by update(), so listing and searching never touch the filesystem and need
+ * no locking. Entries live in a flat table addressed by index, with per directory child
+ * lists, a sorted name array for prefix search and trigram postings for substring search.
+ */
+class content_index
+{
+public:
+    using index_t = std::uint32_t;
+    using clock_t = std::chrono::steady_clock;
+
+    /// Marks a missing entry.
+    static constexpr index_t invalid_index = std::numeric_limits<index_t>::max();
+
+    /**
+     * @struct entry
+     * @brief A file or directory of the project.
+     */
+    struct entry
+    {
+        /// Absolute path.
+        fs::path path;
+        /// Path with the protocol, e.g. app:/data/textures/wood.png
+        std::string protocol_path;
+        /// File name with extension.
+        std::string filename;
+        /// File name without extension.
+        std::string stem;
+        /// Extension with the dot.
+        std::string extension;
+        /// Lower case file name used for searching.
+        std::string search_name;
+        /// Asset type name shown on the item, empty when unknown.
+        std::string type;
+        /// Size in bytes.
+        std::uintmax_t size{};
+        /// Parent directory, invalid for the root.
+        index_t parent{invalid_index};
+        /// Children of a directory, directories first then by name once sorted.
+        std::vector<index_t> children;
+        /// Whether the children need sorting.
+        bool children_dirty{};
+        /// Whether the entry is a directory.
+        bool is_directory{};
+        /// Whether the slot is in use.
+        bool alive{};
+    };
+
+    content_index() = default;
+    ~content_index();
+
+    content_index(const content_index&) = delete;
+    auto operator=(const content_index&) -> content_index& = delete;
+
+    /**
+     * @brief Starts indexing a directory. The initial listing is done by a background task.
+     * @param root The directory to index.
+     * @param schedule Runs the initial listing, e.g. on a thread pool.
+     */
+    void init(const fs::path& root, const std::function<void(std::function<void()>)>& schedule);
+
+    /**
+     * @brief Stops watching and clears the table.
+     */
+    void deinit();
+
+    /**
+     * @brief Applies queued changes within a time budget.
+     * @param budget Time after which the rest is left for the next call.
+     */
+    void update(clock_t::duration budget);
+
+    /**
+     * @brief Gets the indexed root directory.
+     */
+    auto get_root() const -> const fs::path&;
+
+    /**
+     * @brief Gets an entry by index.
+     */
+    auto get(index_t index) const -> const entry&;
+
+    /**
+     * @brief Finds an entry by absolute path.
+     * @return Its index or invalid_index.
+     */
+    auto find(const fs::path& path) const -> index_t;
+
+    /**
+     * @brief Gets the sorted children of a directory.
+     */
+    auto get_children(index_t index) -> const std::vector<index_t>&;
+
+    /**
+     * @brief Checks if an entry is below a directory.
+     */
+    auto is_inside(index_t index, index_t dir) const -> bool;
+
+    /**
+     * @brief Finds entries below a directory whose name contains the text.
+     *
+     * Names starting with the text come first. Short texts only match name prefixes.
+     * @param text The text to search for, case insensitive.
+     * @param scope The directory to search in, recursively.
+     * @param result Receives the matching entries.
+     */
+    void search(const std::string& text, index_t scope, std::vector<index_t>& result);
+
+    /**
+     * @brief Searches with the syntax of ImGuiTextFilter.
+     *
+     * Terms are comma separated, an entry matches any of them. Terms starting with '-'
+     * exclude the entries containing them, with only those every entry not excluded matches.
+     * @param filter The filter text.
+     * @param scope The directory to search in, recursively.
+     * @param result Receives the matching entries.
+     */
+    void filter(const std::string& filter, index_t scope, std::vector<index_t>& result);
+
+    /**
+     * @brief Gets a counter that changes whenever entries are added, removed or renamed.
+     */
+    auto get_version() const -> std::uint64_t;
+
+    /**
+     * @brief Checks if the initial listing has been received and applied.
+     */
+    auto is_ready() const -> bool;
+
+private:
+    /// A change reported by the watcher.
+    struct change
+    {
+        fs::watcher::entry_status status{};
+        fs::path path;
+        fs::path last_path;
+        std::uintmax_t size{};
+        bool is_directory{};
+    };
+
+    /// State shared with the watcher thread.
+    struct shared_state
+    {
+        std::mutex mutex;
+        std::vector<change> changes;
+        std::uint64_t watch_id{};
+        bool ready{};
+        bool stopped{};
+    };
+
+    void apply(const change& c);
+    auto upsert(const fs::path& path, bool is_directory, std::uintmax_t size) -> index_t;
+    auto add(const fs::path& path, bool is_directory, index_t parent) -> index_t;
+    void remove(index_t index);
+    void move(index_t index, const fs::path& path);
+    void set_path(entry& e, const fs::path& path);
+    void link(index_t index, index_t parent);
+    void unlink(index_t index);
+    void add_trigrams(index_t index);
+    void rebuild_trigrams();
+
+    /// Indexed directory.
+    fs::path root_;
+    /// Flat table, removed slots are reused.
+    std::vector<entry> entries_;
+    /// Removed slots.
+    std::vector<index_t> free_;
+    /// Absolute path to index.
+    std::unordered_map<std::string, index_t> lookup_;
+    /// Names sorted for prefix search, rebuilt lazily.
+    std::vector<std::pair<std::string, index_t>> names_;
+    /// Whether names_ is out of date.
+    bool names_dirty_{true};
+    /// Entries of every trigram. May hold stale indices, matches are verified.
+    std::unordered_map<std::uint32_t, std::vector<index_t>> trigrams_;
+    /// Number of postings, including stale ones.
+    std::size_t postings_{};
+    /// Number of postings left behind by removed or renamed entries.
+    std::size_t stale_postings_{};
+    /// Changes received but not yet applied.
+    std::vector<change> pending_;
+    /// Next change of pending_ to apply.
+    std::size_t pending_pos_{};
+    /// Whether the initial listing was received.
+    bool ready_{};
+    /// State shared with the watcher callback.
+    std::shared_ptr<shared_state> shared_;
+    /// Bumped on structural changes.
+    std::uint64_t version_{};
+};
+
+} // namespace ace
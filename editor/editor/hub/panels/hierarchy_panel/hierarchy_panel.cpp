@@ -13,9 +13,13 @@
 #include <engine/ecs/components/transform_component.h>
 #include <engine/ecs/ecs.h>
 #include <engine/rendering/ecs/components/model_component.h>
+#include <engine/threading/threader.h>
 
 #include <filesystem/filesystem.h>
 
+#include <algorithm>
+#include <cctype>
+
 namespace ace
 {
 
@@ -388,28 +392,22 @@ void check_context_menu(graph_context& ctx, entt::handle entity)
     ImGui::PopStyleColor();
 }
 
-void draw_entity(graph_context& ctx, entt::handle entity)
+auto draw_entity(graph_context& ctx, entt::handle entity, bool has_children, bool expanded) -> bool
 {
-    if(!entity)
-    {
-        return;
-    }
 
     const auto& name = get_entity_tag(entity);
     ImGui::PushID(static_cast<int>(entity.entity()));
 
-    ImGuiTreeNodeFlags flags =
-        ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowOverlap | ImGuiTreeNodeFlags_OpenOnArrow;
+    // Rows are flattened, so nodes never push onto the tree stack.
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_AllowOverlap |
+                               ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 
     if(ctx.em.is_selected(entity))
     {
         flags |= ImGuiTreeNodeFlags_Selected;
     }
 
-    auto& trans_comp = entity.get<transform_component>();
-    bool no_children = trans_comp.get_children().empty();
-
-    if(no_children)
+    if(!has_children)
     {
         flags |= ImGuiTreeNodeFlags_Leaf;
     }
@@ -435,6 +433,7 @@ void draw_entity(graph_context& ctx, entt::handle entity)
     col = ImLerp(col, ImVec4(0.8f, 0.4f, 0.4f, 1.0f), float(is_submesh) * 0.5f);
 
     ImGui::PushStyleColor(ImGuiCol_Text, col);
+    ImGui::SetNextItemOpen(expanded);
     bool opened = ImGui::TreeNodeEx(label.c_str(), flags);
     ImGui::PopStyleColor();
 
@@ -522,24 +521,196 @@ void draw_entity(graph_context& ctx, entt::handle entity)
         }
     }
 
-    if(opened)
+    ImGui::PopID();
+
+    return opened;
+}
+
+auto get_roots(entt::registry& registry) -> std::vector<entt::handle>
+{
+    std::vector<entt::handle> roots;
+    registry.view<transform_component, root_component>().each(
+        [&](auto e, auto&& comp, auto&& tag)
+        {
+            roots.emplace_back(comp.get_owner());
+        });
+    return roots;
+}
+
+using search_terms = hierarchy_panel::search_terms;
+
+/**
+ * @brief Gathers every node of the hierarchy in depth first order, so each node comes after its parent.
+ */
+auto gather_search_nodes(entt::registry& registry) -> hierarchy_panel::search_nodes_t
+{
+    hierarchy_panel::search_nodes_t nodes;
+    nodes.reserve(registry.view<transform_component>().size());
+
+    auto roots = get_roots(registry);
+
+    std::vector<std::pair<entt::handle, int32_t>> stack;
+    for(auto it = roots.rbegin(); it != roots.rend(); ++it)
     {
-        if(!no_children)
+        stack.emplace_back(*it, -1);
+    }
+
+    while(!stack.empty())
+    {
+        auto [entity, parent] = stack.back();
+        stack.pop_back();
+
+        if(!entity)
+        {
+            continue;
+        }
+
+        auto& node = nodes.emplace_back();
+        node.entity = entity.entity();
+        node.parent = parent;
+        node.depth = parent < 0 ? 0 : nodes[parent].depth + 1;
+
+        if(auto tag = entity.try_get<tag_component>())
+        {
+            node.name = tag->tag;
+        }
+
+        auto index = int32_t(nodes.size() - 1);
+        const auto& children = entity.get<transform_component>().get_children();
+        for(auto it = children.rbegin(); it != children.rend(); ++it)
+        {
+            stack.emplace_back(*it, index);
+        }
+    }
+
+    return nodes;
+}
+
+auto to_lower(std::string text) -> std::string
+{
+    std::transform(text.begin(),
+                   text.end(),
+                   text.begin(),
+                   [](unsigned char c)
+                   {
+                       return char(std::tolower(c));
+                   });
+    return text;
+}
+
+/**
+ * @brief Splits the search text into terms, comma separated, like ImGuiTextFilter does.
+ */
+auto parse_search_terms(const std::string& text) -> search_terms
+{
+    search_terms terms;
+
+    size_t begin = 0;
+    while(begin <= text.size())
+    {
+        auto end = std::min(text.find(',', begin), text.size());
+        auto term = text.substr(begin, end - begin);
+        begin = end + 1;
+
+        auto first = term.find_first_not_of(' ');
+        auto last = term.find_last_not_of(' ');
+        if(first == std::string::npos)
         {
-            const auto& children = trans_comp.get_children();
-            for(auto& child : children)
+            continue;
+        }
+        term = to_lower(term.substr(first, last - first + 1));
+
+        if(term[0] == '-')
+        {
+            if(term.size() > 1)
             {
-                if(child)
-                {
-                    draw_entity(ctx, child);
-                }
+                terms.exclude.emplace_back(term.substr(1));
             }
         }
+        else
+        {
+            terms.include.emplace_back(std::move(term));
+        }
+    }
+
+    return terms;
+}
 
-        ImGui::TreePop();
+/**
+ * @brief Case insensitive search of a lower case term.
+ */
+auto contains_term(const std::string& name, const std::string& term) -> bool
+{
+    auto it = std::search(name.begin(),
+                          name.end(),
+                          term.begin(),
+                          term.end(),
+                          [](char lhs, char rhs)
+                          {
+                              return char(std::tolower((unsigned char)lhs)) == rhs;
+                          });
+    return it != name.end();
+}
+
+auto pass_search_terms(const search_terms& terms, const std::string& name) -> bool
+{
+    for(const auto& term : terms.exclude)
+    {
+        if(contains_term(name, term))
+        {
+            return false;
+        }
     }
 
-    ImGui::PopID();
+    if(terms.include.empty())
+    {
+        return true;
+    }
+
+    return std::any_of(terms.include.begin(),
+                       terms.include.end(),
+                       [&](const std::string& term)
+                       {
+                           return contains_term(name, term);
+                       });
+}
+
+/**
+ * @brief Keeps the nodes matching the terms together with all of their ancestors.
+ */
+auto filter_search_nodes(entt::registry& registry,
+                         const hierarchy_panel::search_nodes_t& nodes,
+                         const search_terms& terms) -> hierarchy_panel::rows_t
+{
+    std::vector<uint8_t> visible(nodes.size(), 0);
+    std::vector<uint8_t> has_children(nodes.size(), 0);
+
+    // Children always follow their parent, so walking backwards settles every subtree before its parent.
+    for(size_t i = nodes.size(); i-- > 0;)
+    {
+        const auto& node = nodes[i];
+        if(!visible[i] && pass_search_terms(terms, node.name))
+        {
+            visible[i] = 1;
+        }
+
+        if(visible[i] && node.parent >= 0)
+        {
+            visible[node.parent] = 1;
+            has_children[node.parent] = 1;
+        }
+    }
+
+    hierarchy_panel::rows_t rows;
+    for(size_t i = 0; i < nodes.size(); ++i)
+    {
+        if(visible[i])
+        {
+            rows.push_back({entt::handle(registry, nodes[i].entity), nodes[i].depth, bool(has_children[i])});
+        }
+    }
+
+    return rows;
 }
 } // namespace
 
@@ -564,6 +735,11 @@ void hierarchy_panel::on_frame_ui_render(rtti::context& ctx, const char* name)
         graph_context gctx(ctx);
         gctx.panels = parent_;
 
+        ImGui::DrawFilterWithHint(filter_, ICON_MDI_SELECT_SEARCH " Search...", ImGui::GetContentRegionAvail().x);
+        ImGui::DrawItemActivityOutline();
+
+        update_rows(ctx);
+
         ImGuiWindowFlags flags = ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize |
                                  ImGuiWindowFlags_NoSavedSettings;
 
@@ -571,11 +747,46 @@ void hierarchy_panel::on_frame_ui_render(rtti::context& ctx, const char* name)
         {
             check_context_menu(gctx, {});
 
-            gctx.ec.get_scene().registry->view<transform_component, root_component>().each(
-                [&](auto e, auto&& comp, auto&& tag)
+            bool searching = filter_.IsActive();
+            const float indent_spacing = ImGui::GetStyle().IndentSpacing;
+
+            // Only the rows in view are submitted.
+            ImGuiListClipper clipper;
+            clipper.Begin(int(rows_.size()));
+            while(clipper.Step())
+            {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
                 {
-                    draw_entity(gctx, comp.get_owner());
-                });
+                    const auto& row = rows_[i];
+                    if(!row.entity.valid())
+                    {
+                        // Destroyed since the rows were built, keep the row height until the next rebuild.
+                        ImGui::AlignTextToFramePadding();
+                        ImGui::TextUnformatted("");
+                        continue;
+                    }
+
+                    const float indent = float(row.depth) * indent_spacing;
+                    if(indent > 0.0f)
+                    {
+                        ImGui::Indent(indent);
+                    }
+
+                    bool expanded = searching || expanded_.count(row.entity.entity()) > 0;
+                    bool opened = draw_entity(gctx, row.entity, row.has_children, expanded);
+
+                    if(indent > 0.0f)
+                    {
+                        ImGui::Unindent(indent);
+                    }
+
+                    if(!searching && row.has_children && opened != expanded)
+                    {
+                        set_expanded(row.entity.entity(), opened);
+                    }
+                }
+            }
+            clipper.End();
         }
         ImGui::EndChild();
         check_drag(gctx, {});
@@ -585,4 +796,130 @@ void hierarchy_panel::on_frame_ui_render(rtti::context& ctx, const char* name)
     update_editing();
 }
 
+void hierarchy_panel::set_expanded(entt::entity entity, bool expanded)
+{
+    if(expanded)
+    {
+        expanded_.insert(entity);
+    }
+    else
+    {
+        expanded_.erase(entity);
+    }
+
+    dirty_ = true;
+}
+
+void hierarchy_panel::update_rows(rtti::context& ctx)
+{
+    auto& registry = *ctx.get<ecs>().get_scene().registry;
+
+    auto version = get_hierarchy_version(registry);
+    std::string search_text = filter_.IsActive() ? filter_.InputBuf : "";
+
+    if(&registry != registry_ || version != version_ || search_text != search_text_)
+    {
+        dirty_ = true;
+    }
+
+    if(!dirty_)
+    {
+        return;
+    }
+
+    if(&registry != registry_)
+    {
+        expanded_.clear();
+    }
+
+    // Names are snapshotted once per search, not on every keystroke.
+    if(&registry != registry_ || version != version_ || search_text_.empty() || search_text.empty())
+    {
+        search_nodes_.reset();
+    }
+
+    registry_ = &registry;
+    version_ = version;
+    search_text_ = search_text;
+    dirty_ = false;
+
+    if(search_text_.empty())
+    {
+        ++search_id_;
+        build_rows(registry);
+    }
+    else
+    {
+        start_search(ctx, registry);
+    }
+}
+
+void hierarchy_panel::build_rows(entt::registry& registry)
+{
+    rows_.clear();
+
+    auto roots = get_roots(registry);
+
+    // Walk only the expanded part of the tree, the cost follows what can be shown.
+    std::vector<std::pair<entt::handle, uint32_t>> stack;
+    for(auto it = roots.rbegin(); it != roots.rend(); ++it)
+    {
+        stack.emplace_back(*it, 0);
+    }
+
+    while(!stack.empty())
+    {
+        auto [entity, depth] = stack.back();
+        stack.pop_back();
+
+        if(!entity)
+        {
+            continue;
+        }
+
+        const auto& children = entity.get<transform_component>().get_children();
+        rows_.push_back({entity, depth, !children.empty()});
+
+        if(!children.empty() && expanded_.count(entity.entity()) > 0)
+        {
+            for(auto it = children.rbegin(); it != children.rend(); ++it)
+            {
+                stack.emplace_back(*it, depth + 1);
+            }
+        }
+    }
+}
+
+void hierarchy_panel::start_search(rtti::context& ctx, entt::registry& registry)
+{
+    // Results of searches started before this one are dropped when they arrive.
+    auto id = ++search_id_;
+
+    auto& thr = ctx.get<threader>();
+
+    if(!search_nodes_)
+    {
+        search_nodes_ = std::make_shared<const search_nodes_t>(gather_search_nodes(registry));
+    }
+
+    // The terms are parsed here, ImGui allocations are not thread safe.
+    std::weak_ptr<int> weak_sentinel = sentinel_;
+    thr.pool
+        ->schedule(
+            [registry = &registry, nodes = search_nodes_, terms = parse_search_terms(search_text_)]()
+            {
+                return filter_search_nodes(*registry, *nodes, terms);
+            })
+        .then(itc::main_thread::get_id(),
+              [this, weak_sentinel, id](auto f)
+              {
+                  if(weak_sentinel.expired() || id != search_id_)
+                  {
+                      return;
+                  }
+
+                  rows_ = f.get();
+              });
+}
+
 } // namespace ace
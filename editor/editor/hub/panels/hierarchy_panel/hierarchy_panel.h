@@ -5,6 +5,12 @@
 #include <context/context.hpp>
 #include "../entity_panel.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
 namespace ace
 {
 class hierarchy_panel : public entity_panel
@@ -16,6 +22,78 @@ public:
 
     void on_frame_ui_render(rtti::context& ctx, const char* name);
 
+    /**
+     * @brief A row of the flattened hierarchy.
+     */
+    struct row
+    {
+        entt::handle entity;
+        uint32_t depth{};
+        bool has_children{};
+    };
+
+    using rows_t = std::vector<row>;
+
+    /**
+     * @brief Snapshot of a node taken on the main thread for the background search.
+     */
+    struct search_node
+    {
+        entt::entity entity{};
+        int32_t parent{-1};
+        uint32_t depth{};
+        std::string name;
+    };
+
+    using search_nodes_t = std::vector<search_node>;
+
+    /**
+     * @brief Search terms parsed on the main thread, with the include/exclude syntax of ImGuiTextFilter.
+     */
+    struct search_terms
+    {
+        /// Lower case terms a name must contain one of, any name passes when empty.
+        std::vector<std::string> include;
+        /// Lower case terms, written with a leading '-', a name must contain none of.
+        std::vector<std::string> exclude;
+    };
+
 private:
+    /**
+     * @brief Rebuilds the rows if the hierarchy, the expanded nodes or the search text changed.
+     */
+    void update_rows(rtti::context& ctx);
+
+    /**
+     * @brief Flattens the expanded part of the tree into rows.
+     */
+    void build_rows(entt::registry& registry);
+
+    /**
+     * @brief Filters the whole tree on the thread pool, the rows are replaced once it completes.
+     */
+    void start_search(rtti::context& ctx, entt::registry& registry);
+
+    void set_expanded(entt::entity entity, bool expanded);
+
+    /// Flattened rows of the visible part of the tree.
+    rows_t rows_;
+
+    /// Entities whose children are shown.
+    std::unordered_set<entt::entity> expanded_;
+
+    /// Registry and hierarchy version the rows were built from.
+    entt::registry* registry_{};
+    std::uint64_t version_{};
+    bool dirty_{true};
+
+    ImGuiTextFilter filter_;
+    std::string search_text_;
+    std::uint64_t search_id_{};
+
+    /// Nodes searched while the search stays open, gathered again when the hierarchy changes.
+    std::shared_ptr<const search_nodes_t> search_nodes_;
+
+    std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 };
 } // namespace ace
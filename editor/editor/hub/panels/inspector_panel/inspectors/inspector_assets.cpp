@@ -6,6 +6,7 @@
 #include <engine/assets/asset_manager.h>
 #include <engine/assets/impl/asset_extensions.h>
 #include <engine/assets/impl/asset_writer.h>
+#include <engine/meta/assets/asset_database.hpp>
 #include <engine/audio/audio_clip.h>
 #include <engine/physics/physics_material.h>
 
@@ -37,6 +38,11 @@ auto reimport(const asset_handle<T>& asset)
     fs::watcher::touch(resolve_path(asset.id()), false);
 }
 
+auto get_meta_path(const std::string& key) -> fs::path
+{
+    return resolve_path(fs::replace(key, ":/data", ":/meta").generic_string() + ".meta");
+}
+
 template<typename T>
 bool process_drag_drop_target(asset_manager& am, asset_handle<T>& entry)
 {
@@ -317,8 +323,25 @@ auto inspector_asset_handle_texture::inspect(rtti::context& ctx,
         }
         if(ImGui::BeginTabItem("Import"))
         {
+            if(import_meta.uid != data.uid())
+            {
+                import_meta = {};
+                load_from_file(get_meta_path(data.id()).string(), import_meta);
+            }
+
             ImGui::TextUnformatted("Import options");
 
+            if(import_meta.importer)
+            {
+                auto import_result = ::ace::inspect(ctx, *import_meta.importer);
+
+                // Saving the meta file triggers a recompile of the texture.
+                if(import_result.edit_finished)
+                {
+                    save_to_file(get_meta_path(data.id()).string(), import_meta);
+                }
+            }
+
             if(ImGui::Button("Reimport"))
             {
                 reimport(data);
@@ -2,6 +2,7 @@
 
 #include "inspector.h"
 #include <engine/assets/asset_handle.h>
+#include <engine/assets/asset_storage.h>
 
 namespace gfx
 {
@@ -33,6 +34,9 @@ struct inspector_asset_handle_texture : public inspector_asset_handle
     auto inspect_as_property(rtti::context& ctx, asset_handle<gfx::texture>& data) -> inspect_result;
     auto inspect(rtti::context& ctx, rttr::variant& var, const var_info& info, const meta_getter& get_metadata)
         -> inspect_result;
+
+    /// Meta of the inspected texture holding its import settings.
+    asset_meta import_meta;
 };
 REFLECT_INSPECTOR_INLINE(inspector_asset_handle_texture, asset_handle<gfx::texture>)
 
@@ -2,6 +2,8 @@
 #include "../panels_defs.h"
 
 #include <engine/profiler/profiler.h>
+#include <engine/rendering/renderer.h>
+#include <engine/rendering/texture_streamer.h>
 
 #include <graphics/graphics.h>
 #include <math/math.h>
@@ -134,7 +136,52 @@ static void resource_bar(const char* _name,
     }
 }
 
-void draw_statistics(bool& enable_profiler)
+void draw_texture_streaming(rtti::context& ctx)
+{
+    auto& streamer = ctx.get<texture_streamer>();
+    const auto& stats = streamer.get_stats();
+
+    static SampleData resident_mem_samples;
+    resident_mem_samples.pushSample(float(stats.resident_bytes) / 1024 / 1024);
+
+    ImGui::PushFont(ImGui::Font::Mono);
+
+    char strResident[64];
+    bx::prettify(strResident, BX_COUNTOF(strResident), stats.resident_bytes);
+
+    char strBudget[64];
+    bx::prettify(strBudget, BX_COUNTOF(strBudget), stats.budget_bytes);
+
+    char strWanted[64];
+    bx::prettify(strWanted, BX_COUNTOF(strWanted), stats.wanted_bytes);
+
+    char strFull[64];
+    bx::prettify(strFull, BX_COUNTOF(strFull), stats.full_bytes);
+
+    ImGui::Text("Resident: %s / %s", strResident, strBudget);
+    ImGui::PlotLines("##Streamed Texture mem",
+                     resident_mem_samples.m_values,
+                     resident_mem_samples.kNumSamples,
+                     resident_mem_samples.m_offset,
+                     nullptr,
+                     0.0f,
+                     float(stats.budget_bytes) / 1024 / 1024,
+                     ImVec2(ImGui::GetContentRegionAvail().x, 50));
+    ImGui::Text("Wanted:   %s", strWanted);
+    ImGui::Text("All Mips: %s", strFull);
+    ImGui::Text("Textures: %u (%u fully resident)", stats.textures, stats.fully_resident);
+    ImGui::Text("Pending: %u, In: %u, Evicted: %u", stats.pending, stats.streamed_in, stats.evicted);
+
+    int budget_mb = int(stats.budget_bytes / 1024 / 1024);
+    if(ImGui::DragInt("Budget (MB)", &budget_mb, 1.0f, 16, 16384))
+    {
+        streamer.set_budget(std::uint64_t(budget_mb) * 1024 * 1024);
+    }
+
+    ImGui::PopFont();
+}
+
+void draw_statistics(rtti::context& ctx, bool& enable_profiler)
 {
     auto& io = ImGui::GetIO();
 
@@ -237,6 +284,9 @@ void draw_statistics(bool& enable_profiler)
             ImGui::Text("Total Comp Calls: %u", stats->numCompute);
             ImGui::Text("Total Blit Calls: %u", stats->numBlit);
 
+            const auto& occlusion = ctx.get<renderer>().get_occlusion_stats();
+            ImGui::Text("Occlusion Culled: %u / %u", occlusion.culled, occlusion.tested);
+
             ImGui::PopFont();
         }
 
@@ -320,6 +370,11 @@ void draw_statistics(bool& enable_profiler)
 
             ImGui::PopFont();
         }
+        if(ImGui::CollapsingHeader(ICON_MDI_IMAGE_MULTIPLE "\tTexture Streaming"))
+        {
+            draw_texture_streaming(ctx);
+        }
+
         if(ImGui::CollapsingHeader(ICON_MDI_PUZZLE "\tResources"))
         {
             const auto caps = gfx::get_caps();
@@ -520,7 +575,7 @@ void statistics_panel::on_frame_ui_render(rtti::context& ctx, const char* name)
     if(ImGui::Begin(name, nullptr, ImGuiWindowFlags_MenuBar))
     {
         draw_menubar(ctx);
-        draw_statistics(enable_profiler_);
+        draw_statistics(ctx, enable_profiler_);
     }
     ImGui::End();
 }
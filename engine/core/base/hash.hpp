@@ -1,6 +1,8 @@
 #pragma once
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <type_traits>
 
 namespace utils
 {
@@ -10,4 +12,36 @@ inline void hash_combine(std::size_t& seed, const T& v)
     std::hash<T> hasher;
     seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
+
+/// Seed of a stable hash, the offset basis of 64 bit FNV-1a.
+constexpr std::uint64_t stable_hash_seed = 0xcbf29ce484222325ull;
+
+/**
+ * @brief Adds bytes to a 64 bit FNV-1a hash.
+ *
+ * Unlike std::hash the result does not depend on the build or the standard library,
+ * so it can be persisted.
+ */
+inline void stable_hash_combine(std::uint64_t& seed, const void* data, std::size_t size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        seed ^= bytes[i];
+        seed *= 0x100000001b3ull;
+    }
+}
+
+template<class T, std::enable_if_t<std::is_arithmetic<T>::value, int> = 0>
+inline void stable_hash_combine(std::uint64_t& seed, T v)
+{
+    stable_hash_combine(seed, &v, sizeof(v));
+}
+
+inline void stable_hash_combine(std::uint64_t& seed, const std::string& v)
+{
+    // The size keeps consecutive strings apart.
+    stable_hash_combine(seed, std::uint64_t(v.size()));
+    stable_hash_combine(seed, v.data(), v.size());
+}
 } // namespace utils
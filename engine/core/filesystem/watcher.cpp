@@ -1,7 +1,20 @@
 #include "watcher.h"
+#include <algorithm>
+#include <set>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 #include <base/platform/thread.hpp>
+
+#if ACE_PLATFORM_LINUX
+#include <climits>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#include <unistd.h>
+#endif
 namespace fs
 {
 using namespace std::literals;
@@ -87,8 +100,313 @@ auto visit_wild_card_path(const fs::path& path,
     return path_filter;
 }
 
+/// Time without new native events after which the coalesced changes are reported.
+constexpr auto native_quiet_time = 50ms;
+
+struct native_event
+{
+    enum flags : std::uint32_t
+    {
+        /// Created, removed or modified
+        changed = 1 << 0,
+        /// First half of a rename, paired by cookie
+        moved_from = 1 << 1,
+        /// Second half of a rename, paired by cookie
+        moved_to = 1 << 2,
+        /// The watched directory itself was removed or moved
+        self = 1 << 3,
+        /// The watch is gone
+        ignored = 1 << 4,
+        /// Events were dropped
+        overflow = 1 << 5,
+    };
+
+    int wd = -1;
+    std::uint32_t flags = 0;
+    std::uint32_t cookie = 0;
+    std::string name;
+};
+
+auto get_child_prefix(const std::string& key) -> std::string
+{
+    return key + char(fs::path::preferred_separator);
+}
+
+auto is_same_or_child(const std::string& parent, const std::string& key) -> bool
+{
+    if(key.compare(0, parent.size(), parent) != 0)
+    {
+        return false;
+    }
+    return key.size() == parent.size() || key[parent.size()] == char(fs::path::preferred_separator);
+}
+
+auto rebase_path(const std::string& key, const std::string& from, const fs::path& to) -> fs::path
+{
+    return fs::path(to.string() + key.substr(from.size()));
+}
+
+// Visits and erases the element keyed by path and all elements below it.
+// Children sort right after "path/", separately from siblings like "path-1".
+template<typename Map, typename Visitor>
+void extract_path_range(Map& container, const std::string& key, Visitor&& visitor)
+{
+    auto it = container.find(key);
+    if(it != container.end())
+    {
+        visitor(it->first, it->second);
+        container.erase(it);
+    }
+
+    const auto prefix = get_child_prefix(key);
+    it = container.lower_bound(prefix);
+    while(it != container.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+    {
+        visitor(it->first, it->second);
+        it = container.erase(it);
+    }
+}
+
+auto is_network_filesystem(const fs::path& path) -> bool
+{
+#if ACE_PLATFORM_LINUX
+    struct statfs info{};
+    if(statfs(path.c_str(), &info) != 0)
+    {
+        return true;
+    }
+
+    // Change notifications are not delivered for modifications made by other
+    // machines on these.
+    switch(static_cast<std::uint32_t>(info.f_type))
+    {
+        case 0x6969:     // nfs
+        case 0x517b:     // smb
+        case 0xff534d42: // cifs
+        case 0xfe534d42: // smb2
+        case 0x65735546: // fuse, sshfs and friends
+        case 0x01021997: // 9p
+        case 0x73757245: // coda
+        case 0x5346414f: // afs
+        case 0x6b414653: // kafs
+        case 0x00c36400: // ceph
+        case 0x47504653: // gpfs
+            return true;
+        default:
+            return false;
+    }
+#else
+    return true;
+#endif
+}
+
 } // namespace
 
+class watcher::backend
+{
+public:
+    backend()
+    {
+#if ACE_PLATFORM_LINUX
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+    }
+
+    ~backend()
+    {
+#if ACE_PLATFORM_LINUX
+        if(fd_ >= 0)
+        {
+            ::close(fd_);
+        }
+        if(wake_fd_ >= 0)
+        {
+            ::close(wake_fd_);
+        }
+#endif
+    }
+
+    backend(const backend&) = delete;
+    auto operator=(const backend&) -> backend& = delete;
+
+    auto is_valid() const -> bool
+    {
+        return fd_ >= 0 && wake_fd_ >= 0;
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : supports ()
+    /// <summary>
+    /// Checks if changes under the path are reported natively.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    auto supports(const fs::path& path) const -> bool
+    {
+        return is_valid() && !is_network_filesystem(path);
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : add ()
+    /// <summary>
+    /// Starts watching a directory. Watchers share the descriptor of the same
+    /// directory so it is reference counted. Returns -1 on failure, e.g. when
+    /// the watch limit is reached.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    auto add(const fs::path& dir) -> int
+    {
+#if ACE_PLATFORM_LINUX
+        constexpr std::uint32_t mask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+                                       IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+                                       IN_ONLYDIR | IN_EXCL_UNLINK;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        int wd = inotify_add_watch(fd_, dir.c_str(), mask);
+        if(wd >= 0)
+        {
+            refs_[wd]++;
+        }
+        return wd;
+#else
+        return -1;
+#endif
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : remove ()
+    /// <summary>
+    /// Releases a reference to a watch descriptor.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void remove(int wd)
+    {
+#if ACE_PLATFORM_LINUX
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = refs_.find(wd);
+        if(it == refs_.end())
+        {
+            return;
+        }
+
+        if(--it->second == 0)
+        {
+            refs_.erase(it);
+            inotify_rm_watch(fd_, wd);
+        }
+#endif
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : read ()
+    /// <summary>
+    /// Reads all pending events without blocking.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    template<typename Visitor>
+    void read(Visitor&& visitor)
+    {
+#if ACE_PLATFORM_LINUX
+        while(true)
+        {
+            auto len = ::read(fd_, buffer_.data(), buffer_.size());
+            if(len <= 0)
+            {
+                break;
+            }
+
+            const char* ptr = buffer_.data();
+            const char* end = ptr + len;
+            while(ptr < end)
+            {
+                const auto* ev = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + ev->len;
+
+                native_event e;
+                e.wd = ev->wd;
+                e.cookie = ev->cookie;
+                if(ev->len > 0)
+                {
+                    e.name = ev->name;
+                }
+
+                if(ev->mask & IN_Q_OVERFLOW)
+                {
+                    e.flags |= native_event::overflow;
+                }
+                if(ev->mask & IN_IGNORED)
+                {
+                    e.flags |= native_event::ignored;
+
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    refs_.erase(ev->wd);
+                }
+                if(ev->mask & IN_MOVED_FROM)
+                {
+                    e.flags |= native_event::moved_from;
+                }
+                if(ev->mask & IN_MOVED_TO)
+                {
+                    e.flags |= native_event::moved_to;
+                }
+                if(ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+                {
+                    e.flags |= native_event::self;
+                }
+                if(ev->mask & (IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB))
+                {
+                    e.flags |= native_event::changed;
+                }
+
+                visitor(e);
+            }
+        }
+#endif
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : wait ()
+    /// <summary>
+    /// Blocks until events arrive, wake() is called or the timeout expires.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void wait(clock_t::duration timeout)
+    {
+#if ACE_PLATFORM_LINUX
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+        ms = std::clamp<decltype(ms)>(ms, 0, INT_MAX);
+
+        pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        ::poll(fds, 2, static_cast<int>(ms));
+
+        if(fds[1].revents & POLLIN)
+        {
+            eventfd_t value{};
+            eventfd_read(wake_fd_, &value);
+        }
+#endif
+    }
+
+    void wake()
+    {
+#if ACE_PLATFORM_LINUX
+        eventfd_write(wake_fd_, 1);
+#endif
+    }
+
+private:
+    /// Notification descriptor
+    int fd_ = -1;
+    /// Descriptor used to interrupt wait()
+    int wake_fd_ = -1;
+    /// Guards refs_
+    std::mutex mutex_;
+    /// Number of watchers sharing each watch descriptor
+    std::map<int, int> refs_;
+    /// Read buffer, only used by the watching thread
+    std::vector<char> buffer_ = std::vector<char>(64 * 1024);
+};
+
 class watcher::impl
 {
 public:
@@ -165,6 +483,14 @@ public:
     {
         root_ = path;
 
+        if(!filter_.empty())
+        {
+            std::string full = (root_ / filter_).string();
+            size_t wildcard_pos = full.find('*');
+            filter_before_ = full.substr(0, wildcard_pos);
+            filter_after_ = full.substr(wildcard_pos + 1);
+        }
+
         observed_changes changes;
 
         // make sure we store all initial write time
@@ -195,6 +521,11 @@ public:
         }
     }
 
+    ~impl()
+    {
+        stop_native();
+    }
+
     void pause()
     {
         paused_ = true;
@@ -464,6 +795,457 @@ public:
         }
     }
 
+    //-----------------------------------------------------------------------------
+    //  Name : start_native ()
+    /// <summary>
+    /// Switches from polling to native notifications. Only wild card watches
+    /// are supported, a single watched path is cheap to poll.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    auto start_native(backend& native) -> bool
+    {
+        if(filter_.empty() || !native.supports(root_))
+        {
+            return false;
+        }
+
+        native_ = &native;
+        if(!add_native_tree(root_, nullptr))
+        {
+            stop_native();
+            return false;
+        }
+
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : stop_native ()
+    /// <summary>
+    /// Releases all native watches and drops the pending changes.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void stop_native()
+    {
+        if(native_ == nullptr)
+        {
+            return;
+        }
+
+        for(const auto& kvp : native_dirs_)
+        {
+            native_->remove(kvp.first);
+        }
+
+        native_ = nullptr;
+        native_dirs_.clear();
+        native_paths_.clear();
+        dirty_.clear();
+        moves_.clear();
+        pending_moves_.clear();
+        pending_ = false;
+        rescan_ = false;
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : on_native_event ()
+    /// <summary>
+    /// Records a native event. Events are coalesced per path and reported by
+    /// update_native() once no new ones arrive for a short while.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void on_native_event(const native_event& e, clock_t::time_point now)
+    {
+        if(native_ == nullptr)
+        {
+            return;
+        }
+
+        if(e.flags & native_event::overflow)
+        {
+            rescan_ = true;
+            schedule_flush(now);
+            return;
+        }
+
+        auto it = native_dirs_.find(e.wd);
+        if(it == native_dirs_.end())
+        {
+            return;
+        }
+
+        if(e.flags & native_event::ignored)
+        {
+            // Nothing reports changes under the root anymore.
+            if(it->second == root_)
+            {
+                fallback_ = true;
+            }
+
+            native_paths_.erase(it->second.string());
+            native_dirs_.erase(it);
+            return;
+        }
+
+        auto path = e.name.empty() ? it->second : it->second / e.name;
+        if(e.flags & native_event::moved_from)
+        {
+            pending_moves_[e.cookie] = path;
+        }
+        else if(e.flags & native_event::moved_to)
+        {
+            auto from = pending_moves_.find(e.cookie);
+            if(from != pending_moves_.end())
+            {
+                moves_.emplace_back(from->second, path);
+                pending_moves_.erase(from);
+            }
+            else
+            {
+                // moved in from outside the watched tree
+                dirty_.emplace(path.string());
+            }
+        }
+        else
+        {
+            dirty_.emplace(path.string());
+        }
+
+        schedule_flush(now);
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : update_native ()
+    /// <summary>
+    /// Reports the coalesced changes when due. Returns how long the watching
+    /// thread may sleep before calling it again.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    auto update_native(clock_t::time_point now) -> clock_t::duration
+    {
+        if(pending_ && !paused_ && now >= flush_at_)
+        {
+            flush_native();
+        }
+
+        if(fallback_)
+        {
+            fallback_ = false;
+            stop_native();
+
+            watch();
+            last_poll_ = now;
+            return poll_interval_;
+        }
+
+        if(!pending_)
+        {
+            return clock_t::duration::max();
+        }
+
+        // keep accumulating until resumed
+        if(paused_)
+        {
+            return poll_interval_;
+        }
+
+        return flush_at_ - now;
+    }
+
+    void schedule_flush(clock_t::time_point now)
+    {
+        if(!pending_)
+        {
+            pending_ = true;
+            first_event_ = now;
+        }
+
+        // Wait for the burst to settle, but never longer than a poll would.
+        flush_at_ = std::min(now + native_quiet_time, first_event_ + poll_interval_);
+    }
+
+    void flush_native()
+    {
+        pending_ = false;
+
+        if(rescan_)
+        {
+            // Events were lost, fall back to a full poll with rename guessing.
+            rescan_ = false;
+            dirty_.clear();
+            moves_.clear();
+            pending_moves_.clear();
+
+            if(!add_native_tree(root_, nullptr))
+            {
+                fallback_ = true;
+                return;
+            }
+
+            watch();
+            return;
+        }
+
+        // The kernel queues both halves of a rename together and the queue is
+        // drained before flushing, so sources left unpaired were moved out.
+        for(const auto& kvp : pending_moves_)
+        {
+            dirty_.emplace(kvp.second.string());
+        }
+        pending_moves_.clear();
+
+        observed_changes changes;
+
+        // current path -> index in changes.entries
+        std::unordered_map<std::string, size_t> renamed;
+        for(const auto& move : moves_)
+        {
+            move_entries(move.first, move.second, changes, renamed);
+        }
+        moves_.clear();
+
+        auto dirty = std::move(dirty_);
+        dirty_.clear();
+        for(const auto& key : dirty)
+        {
+            refresh_entry(key, changes);
+        }
+
+        if(!changes.entries.empty() && callback_)
+        {
+            callback_(changes.entries, false);
+        }
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : move_entries ()
+    /// <summary>
+    /// Applies a paired rename to the cached entries and native watches.
+    /// Everything below a renamed directory is reported as renamed as well.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void move_entries(const fs::path& from,
+                      const fs::path& to,
+                      observed_changes& changes,
+                      std::unordered_map<std::string, size_t>& renamed)
+    {
+        const auto from_key = from.string();
+
+        std::vector<watcher::entry> moved;
+        extract_path_range(entries_,
+                           from_key,
+                           [&moved](const std::string&, watcher::entry& e)
+                           {
+                               moved.emplace_back(std::move(e));
+                           });
+
+        for(auto& e : moved)
+        {
+            auto old_key = e.path.string();
+            e.path = rebase_path(old_key, from_key, to);
+            auto new_key = e.path.string();
+
+            // replaced by the move
+            auto dest = entries_.find(new_key);
+            if(dest != entries_.end())
+            {
+                dest->second.status = watcher::entry_status::removed;
+                changes.entries.push_back(dest->second);
+                entries_.erase(dest);
+            }
+
+            e.status = watcher::entry_status::renamed;
+
+            // renamed again within the same batch, keep the original path
+            auto it = renamed.find(old_key);
+            if(it != renamed.end())
+            {
+                auto index = it->second;
+                renamed.erase(it);
+
+                changes.entries[index].path = e.path;
+                e.last_path = changes.entries[index].last_path;
+                renamed[new_key] = index;
+            }
+            else
+            {
+                e.last_path = fs::path(old_key);
+                changes.entries.push_back(e);
+                renamed[new_key] = changes.entries.size() - 1;
+            }
+
+            entries_[new_key] = std::move(e);
+        }
+
+        std::vector<std::pair<int, fs::path>> dirs;
+        extract_path_range(native_paths_,
+                           from_key,
+                           [&](const std::string& key, int wd)
+                           {
+                               dirs.emplace_back(wd, rebase_path(key, from_key, to));
+                           });
+        for(auto& dir : dirs)
+        {
+            native_paths_[dir.second.string()] = dir.first;
+            native_dirs_[dir.first] = std::move(dir.second);
+        }
+
+        // Changes recorded before the rename still use the old paths.
+        std::vector<std::string> remapped;
+        for(const auto& key : dirty_)
+        {
+            if(is_same_or_child(from_key, key))
+            {
+                remapped.emplace_back(rebase_path(key, from_key, to).string());
+            }
+        }
+        dirty_.insert(remapped.begin(), remapped.end());
+        dirty_.emplace(to.string());
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : refresh_entry ()
+    /// <summary>
+    /// Compares a path touched by native events with its cached entry.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void refresh_entry(const std::string& key, observed_changes& changes)
+    {
+        fs::path path(key);
+        fs::error_code err;
+        auto status = fs::status(path, err);
+
+        if(!fs::exists(status))
+        {
+            extract_path_range(entries_,
+                               key,
+                               [&changes](const std::string&, watcher::entry& e)
+                               {
+                                   e.status = watcher::entry_status::removed;
+                                   changes.entries.push_back(e);
+                               });
+
+            // Deleted directories drop their watches by themselves, moved out
+            // ones keep reporting and are released here.
+            extract_path_range(native_paths_,
+                               key,
+                               [this](const std::string&, int wd)
+                               {
+                                   native_dirs_.erase(wd);
+                                   native_->remove(wd);
+                               });
+
+            if(path == root_)
+            {
+                fallback_ = true;
+            }
+            return;
+        }
+
+        // New directories may already have contents by the time they are watched.
+        if(recursive_ && fs::is_directory(status) && native_paths_.count(key) == 0)
+        {
+            if(!add_native_tree(path, &changes))
+            {
+                fallback_ = true;
+            }
+            return;
+        }
+
+        if(matches(key))
+        {
+            poll_entry(path, changes);
+        }
+    }
+
+    //-----------------------------------------------------------------------------
+    //  Name : add_native_tree ()
+    /// <summary>
+    /// Watches a directory and, if recursive, all directories below it. When
+    /// changes are given, the contents are also compared with the cache.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    auto add_native_tree(const fs::path& dir, observed_changes* changes) -> bool
+    {
+        if(!add_native_dir(dir))
+        {
+            return false;
+        }
+
+        if(changes && matches(dir.string()))
+        {
+            poll_entry(dir, *changes);
+        }
+
+        fs::error_code err;
+        const auto visit = [&](const fs::directory_entry& entry)
+        {
+            if(recursive_ && entry.is_directory(err) && !add_native_dir(entry.path()))
+            {
+                return false;
+            }
+
+            if(changes && matches(entry.path().string()))
+            {
+                poll_entry(entry.path(), *changes);
+            }
+            return true;
+        };
+
+        if(recursive_)
+        {
+            for(const auto& entry : fs::recursive_directory_iterator(dir, err))
+            {
+                if(!visit(entry))
+                {
+                    return false;
+                }
+            }
+        }
+        else if(changes)
+        {
+            for(const auto& entry : fs::directory_iterator(dir, err))
+            {
+                visit(entry);
+            }
+        }
+
+        return true;
+    }
+
+    auto add_native_dir(const fs::path& dir) -> bool
+    {
+        auto key = dir.string();
+        if(native_paths_.count(key) > 0)
+        {
+            return true;
+        }
+
+        int wd = native_->add(dir);
+        if(wd < 0)
+        {
+            return false;
+        }
+
+        // Same directory under a new path, e.g. after an unpaired rename.
+        auto it = native_dirs_.find(wd);
+        if(it != native_dirs_.end())
+        {
+            native_->remove(wd);
+            native_paths_.erase(it->second.string());
+        }
+
+        native_dirs_[wd] = dir;
+        native_paths_[key] = wd;
+        return true;
+    }
+
+    auto matches(const std::string& key) const -> bool
+    {
+        return (filter_before_.empty() || key.find(filter_before_) != std::string::npos) &&
+               (filter_after_.empty() || key.find(filter_after_) != std::string::npos);
+    }
+
 protected:
     friend class watcher;
 
@@ -486,6 +1268,35 @@ protected:
     std::atomic<bool> paused_ = {false};
 
     observed_changes buffered_changes_;
+
+    /// Wild card split around the '*', matched against full paths
+    std::string filter_before_;
+    std::string filter_after_;
+
+    /// Native notifications, null while polling
+    backend* native_ = nullptr;
+    /// Native setup was attempted
+    bool native_checked_ = false;
+    /// Watched directory of each watch descriptor
+    std::map<int, fs::path> native_dirs_;
+    /// Watch descriptor of each watched directory
+    std::map<std::string, int> native_paths_;
+    /// Paths touched since the last flush
+    std::set<std::string> dirty_;
+    /// Paired renames since the last flush, in order
+    std::vector<std::pair<fs::path, fs::path>> moves_;
+    /// Rename sources waiting for their destination, by cookie
+    std::map<std::uint32_t, fs::path> pending_moves_;
+    /// There are changes to report
+    bool pending_ = false;
+    /// When the first pending change arrived
+    clock_t::time_point first_event_;
+    /// When the pending changes are reported
+    clock_t::time_point flush_at_;
+    /// Events were lost and the tree has to be polled
+    bool rescan_ = false;
+    /// Native notifications stopped working, revert to polling
+    bool fallback_ = false;
 };
 
 static watcher& get_watcher()
@@ -592,8 +1403,27 @@ void watcher::close()
     }
 }
 
+void watcher::notify()
+{
+    cv_.notify_all();
+
+    if(backend_)
+    {
+        backend_->wake();
+    }
+}
+
 void watcher::start()
 {
+    if(!backend_)
+    {
+        backend_ = std::make_unique<backend>();
+        if(!backend_->is_valid())
+        {
+            backend_.reset();
+        }
+    }
+
     watching_ = true;
     thread_ = std::thread(
         [this]()
@@ -612,12 +1442,41 @@ void watcher::start()
                     watchers = watchers_;
                 }
 
+                if(backend_)
+                {
+                    auto now = clock_t::now();
+                    backend_->read(
+                        [&](const native_event& e)
+                        {
+                            for(auto& pair : watchers)
+                            {
+                                pair.second->on_native_event(e, now);
+                            }
+                        });
+                }
+
                 for(auto& pair : watchers)
                 {
                     auto watcher = pair.second;
 
+                    if(backend_ && !watcher->native_checked_)
+                    {
+                        watcher->native_checked_ = true;
+                        if(watcher->start_native(*backend_))
+                        {
+                            // catch up with changes made since the initial listing
+                            watcher->watch();
+                        }
+                    }
+
                     auto now = clock_t::now();
 
+                    if(watcher->native_)
+                    {
+                        sleep_time = std::min(sleep_time, watcher->update_native(now));
+                        continue;
+                    }
+
                     auto diff = (watcher->last_poll_ + watcher->poll_interval_) - now;
                     if(diff <= clock_t::duration(0))
                     {
@@ -632,8 +1491,15 @@ void watcher::start()
                     }
                 }
 
-                std::unique_lock<std::mutex> lock(mutex_);
-                cv_.wait_for(lock, sleep_time);
+                if(backend_)
+                {
+                    backend_->wait(sleep_time);
+                }
+                else
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait_for(lock, sleep_time);
+                }
             }
         });
 }
@@ -691,7 +1557,7 @@ auto watcher::watch_impl(const fs::path& path,
             std::lock_guard<std::mutex> lock(wd.mutex_);
             wd.watchers_.emplace(key, std::move(imp));
         }
-        wd.cv_.notify_all();
+        wd.notify();
         return key;
     }
 
@@ -706,7 +1572,7 @@ void watcher::unwatch_impl(std::uint64_t key)
         std::lock_guard<std::mutex> lock(wd.mutex_);
         wd.watchers_.erase(key);
     }
-    wd.cv_.notify_all();
+    wd.notify();
 }
 
 void watcher::unwatch_all_impl()
@@ -716,7 +1582,7 @@ void watcher::unwatch_all_impl()
         std::lock_guard<std::mutex> lock(wd.mutex_);
         wd.watchers_.clear();
     }
-    wd.cv_.notify_all();
+    wd.notify();
 }
 
 auto to_string(const watcher::entry& e) -> std::string
@@ -47,6 +47,10 @@ public:
     /// std::function. A list of modified files or directory is passed as argument
     /// of the callback. Use this version only if you are watching multiple files
     /// or a directory.
+    /// Wild card watches use native change notifications where available
+    /// (inotify on Linux) and poll_interval then only bounds how long changes
+    /// are coalesced before the callback. Polling is the fallback, e.g. on
+    /// network filesystems or when the native watch limit is reached.
     /// </summary>
     //-----------------------------------------------------------------------------
     static auto watch(const fs::path& path,
@@ -133,6 +137,15 @@ protected:
 
     static void unwatch_all_impl();
 
+    //-----------------------------------------------------------------------------
+    //  Name : notify ()
+    /// <summary>
+    /// Wakes up the watching thread so that it picks up added or removed
+    /// watchers and pending native notifications.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void notify();
+
     /// Mutex for the file watchers
     std::mutex mutex_;
     /// Atomic bool sync
@@ -141,6 +154,9 @@ protected:
     std::condition_variable cv_;
     /// Thread that polls for changes
     std::thread thread_;
+    /// Native change notifications (inotify on Linux), null when unavailable
+    class backend;
+    std::unique_ptr<backend> backend_;
     /// Registered file watchers
     class impl;
     std::map<std::uint64_t, std::shared_ptr<impl>> watchers_;
@@ -0,0 +1,341 @@
+#include "render_graph.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace gfx
+{
+
+render_graph::builder::builder(render_graph& graph, std::uint32_t pass) : graph_(graph), pass_(pass)
+{
+}
+
+auto render_graph::builder::create(const hpp::string_view& name, const texture_desc& desc) -> handle
+{
+    handle h{std::uint32_t(graph_.resources_.size())};
+
+    auto& res = graph_.resources_.emplace_back();
+    res.name = std::string(name);
+    res.type = resource_type::texture;
+    res.key = transient_pool::make_key(desc.size, desc.format, desc.flags);
+
+    return write(h);
+}
+
+auto render_graph::builder::read(handle h) -> handle
+{
+    assert(h.valid() && h.index < graph_.resources_.size() && "Reading an unknown resource");
+    add_unique(graph_.passes_[pass_].reads, h);
+    return h;
+}
+
+auto render_graph::builder::write(handle h) -> handle
+{
+    assert(h.valid() && h.index < graph_.resources_.size() && "Writing an unknown resource");
+    add_unique(graph_.passes_[pass_].writes, h);
+
+    auto& writers = graph_.resources_[h.index].writers;
+    if(writers.empty() || writers.back() != pass_)
+    {
+        writers.emplace_back(pass_);
+    }
+    return h;
+}
+
+void render_graph::builder::side_effect()
+{
+    graph_.passes_[pass_].side_effect = true;
+}
+
+render_graph::resources::resources(render_graph& graph) : graph_(graph)
+{
+}
+
+auto render_graph::resources::get_texture(handle h) const -> const texture::ptr&
+{
+    const auto& res = graph_.get_resource(h);
+    assert(res.type == resource_type::texture && "Resource is not a texture");
+    assert(res.tex && "Texture is not allocated, is it declared by the pass?");
+    return res.tex;
+}
+
+auto render_graph::resources::get_frame_buffer(handle h) const -> const frame_buffer::ptr&
+{
+    const auto& res = graph_.get_resource(h);
+    assert(res.type == resource_type::frame_buffer && "Resource is not a frame buffer");
+    return res.fbo;
+}
+
+auto render_graph::resources::get_frame_buffer(std::initializer_list<handle> attachments) const -> frame_buffer::ptr
+{
+    std::vector<texture::ptr> textures;
+    textures.reserve(attachments.size());
+    for(const auto& h : attachments)
+    {
+        textures.emplace_back(get_texture(h));
+    }
+
+    return graph_.pool_.get_frame_buffer(textures);
+}
+
+render_graph::render_graph(transient_pool& pool) : pool_(pool)
+{
+}
+
+render_graph::~render_graph()
+{
+    // Hand back whatever an interrupted execute() left acquired.
+    for(auto& res : resources_)
+    {
+        if(!res.imported && res.tex)
+        {
+            pool_.release(res.key, res.tex);
+        }
+    }
+}
+
+auto render_graph::import_texture(const hpp::string_view& name, const texture::ptr& tex) -> handle
+{
+    handle h{std::uint32_t(resources_.size())};
+
+    auto& res = resources_.emplace_back();
+    res.name = std::string(name);
+    res.type = resource_type::texture;
+    res.tex = tex;
+    res.imported = true;
+
+    return h;
+}
+
+auto render_graph::import_frame_buffer(const hpp::string_view& name, const frame_buffer::ptr& fbo) -> handle
+{
+    handle h{std::uint32_t(resources_.size())};
+
+    auto& res = resources_.emplace_back();
+    res.name = std::string(name);
+    res.type = resource_type::frame_buffer;
+    res.fbo = fbo;
+    res.imported = true;
+
+    return h;
+}
+
+void render_graph::add_pass(const hpp::string_view& name, const setup_func& setup, execute_func execute)
+{
+    assert(!compiled_ && "Passes can't be added after compile()");
+
+    auto index = std::uint32_t(passes_.size());
+
+    auto& p = passes_.emplace_back();
+    p.name = std::string(name);
+    p.execute = std::move(execute);
+
+    builder b(*this, index);
+    setup(b);
+}
+
+void render_graph::compile()
+{
+    assert(!compiled_ && "Graph is already compiled");
+    compiled_ = true;
+
+    auto writes = [](const pass& p, handle h)
+    {
+        return std::any_of(std::begin(p.writes),
+                           std::end(p.writes),
+                           [&](handle w)
+                           {
+                               return w.index == h.index;
+                           });
+    };
+
+    // A pass reading what it writes itself does not keep it alive.
+    for(auto& p : passes_)
+    {
+        p.ref_count = std::uint32_t(p.writes.size());
+        for(const auto& h : p.reads)
+        {
+            if(!writes(p, h))
+            {
+                get_resource(h).ref_count++;
+            }
+        }
+    }
+
+    std::vector<std::uint32_t> unused;
+    for(std::uint32_t i = 0; i < resources_.size(); ++i)
+    {
+        auto& res = resources_[i];
+        if(res.imported)
+        {
+            res.ref_count++;
+        }
+
+        if(res.ref_count == 0)
+        {
+            unused.emplace_back(i);
+        }
+    }
+
+    auto cull = [&](pass& p)
+    {
+        p.culled = true;
+        ++culled_;
+
+        for(const auto& h : p.reads)
+        {
+            if(writes(p, h))
+            {
+                continue;
+            }
+
+            auto& res = get_resource(h);
+            if(--res.ref_count == 0)
+            {
+                unused.emplace_back(h.index);
+            }
+        }
+    };
+
+    for(auto& p : passes_)
+    {
+        if(p.ref_count == 0 && !p.side_effect)
+        {
+            cull(p);
+        }
+    }
+
+    while(!unused.empty())
+    {
+        auto& res = resources_[unused.back()];
+        unused.pop_back();
+
+        for(auto writer : res.writers)
+        {
+            auto& p = passes_[writer];
+            if(p.culled)
+            {
+                continue;
+            }
+
+            if(--p.ref_count == 0 && !p.side_effect)
+            {
+                cull(p);
+            }
+        }
+    }
+
+    acquire_.assign(passes_.size(), {});
+    release_.assign(passes_.size(), {});
+
+    for(std::uint32_t i = 0; i < passes_.size(); ++i)
+    {
+        const auto& p = passes_[i];
+        if(p.culled)
+        {
+            continue;
+        }
+
+        auto use = [&](handle h)
+        {
+            auto& res = get_resource(h);
+            if(res.imported)
+            {
+                return;
+            }
+
+            if(res.first_use == handle::invalid)
+            {
+                res.first_use = i;
+            }
+            res.last_use = i;
+        };
+
+        std::for_each(std::begin(p.reads), std::end(p.reads), use);
+        std::for_each(std::begin(p.writes), std::end(p.writes), use);
+    }
+
+    for(std::uint32_t i = 0; i < resources_.size(); ++i)
+    {
+        const auto& res = resources_[i];
+        if(res.imported || res.first_use == handle::invalid)
+        {
+            continue;
+        }
+
+        assert(writes(passes_[res.first_use], handle{i}) && "Transient texture is read before it is written");
+
+        acquire_[res.first_use].emplace_back(i);
+        release_[res.last_use].emplace_back(i);
+    }
+}
+
+void render_graph::execute()
+{
+    if(!compiled_)
+    {
+        compile();
+    }
+
+    resources res(*this);
+
+    for(std::uint32_t i = 0; i < passes_.size(); ++i)
+    {
+        for(auto index : acquire_[i])
+        {
+            auto& r = resources_[index];
+            r.tex = pool_.acquire(r.key);
+        }
+
+        auto& p = passes_[i];
+        if(!p.culled && p.execute)
+        {
+            p.execute(res);
+        }
+
+        for(auto index : release_[i])
+        {
+            auto& r = resources_[index];
+            pool_.release(r.key, r.tex);
+            r.tex.reset();
+        }
+    }
+}
+
+auto render_graph::get_pass_count() const -> std::size_t
+{
+    return passes_.size();
+}
+
+auto render_graph::get_culled_pass_count() const -> std::size_t
+{
+    return culled_;
+}
+
+auto render_graph::get_resource(handle h) -> resource&
+{
+    assert(h.valid() && h.index < resources_.size() && "Invalid resource handle");
+    return resources_[h.index];
+}
+
+auto render_graph::get_resource(handle h) const -> const resource&
+{
+    assert(h.valid() && h.index < resources_.size() && "Invalid resource handle");
+    return resources_[h.index];
+}
+
+void render_graph::add_unique(std::vector<handle>& handles, handle h)
+{
+    auto it = std::find_if(std::begin(handles),
+                           std::end(handles),
+                           [&](handle other)
+                           {
+                               return other.index == h.index;
+                           });
+    if(it == std::end(handles))
+    {
+        handles.emplace_back(h);
+    }
+}
+
+} // namespace gfx
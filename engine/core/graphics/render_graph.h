@@ -0,0 +1,226 @@
+#pragma once
+
+#include "frame_buffer.h"
+#include "render_view_keys.h"
+#include "texture.h"
+#include "transient_pool.h"
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <hpp/string_view.hpp>
+
+namespace gfx
+{
+
+/**
+ * @class render_graph
+ * @brief Frame graph of render passes and the targets they read and write.
+ *
+ * Passes are added in execution order and declare their resources while being added.
+ * compile() culls passes whose results are never read and computes the lifetime of every
+ * transient texture. execute() takes the transient textures from the pool right before
+ * their first use and gives them back after their last use, so later passes and views can
+ * reuse the memory. Imported resources are owned by the caller and always count as read.
+ */
+class render_graph
+{
+public:
+    /**
+     * @struct handle
+     * @brief Refers to a resource of the graph.
+     */
+    struct handle
+    {
+        static constexpr std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
+
+        auto valid() const -> bool
+        {
+            return index != invalid;
+        }
+
+        std::uint32_t index{invalid};
+    };
+
+    /**
+     * @struct texture_desc
+     * @brief Description of a transient texture.
+     */
+    struct texture_desc
+    {
+        /// Size in pixels.
+        usize32_t size;
+        /// Texture format.
+        texture_format format{texture_format::RGBA8};
+        /// Creation flags.
+        std::uint64_t flags{BGFX_TEXTURE_RT};
+    };
+
+    /**
+     * @class builder
+     * @brief Declares the resources of a pass while it is being added.
+     */
+    class builder
+    {
+    public:
+        /**
+         * @brief Declares a transient texture written by the pass.
+         */
+        auto create(const hpp::string_view& name, const texture_desc& desc) -> handle;
+
+        /**
+         * @brief Declares that the pass reads a resource.
+         */
+        auto read(handle h) -> handle;
+
+        /**
+         * @brief Declares that the pass writes a resource.
+         */
+        auto write(handle h) -> handle;
+
+        /**
+         * @brief Keeps the pass even if nothing reads its results.
+         */
+        void side_effect();
+
+    private:
+        friend class render_graph;
+        builder(render_graph& graph, std::uint32_t pass);
+
+        render_graph& graph_;
+        std::uint32_t pass_{};
+    };
+
+    /**
+     * @class resources
+     * @brief Resolves handles while a pass executes.
+     */
+    class resources
+    {
+    public:
+        /**
+         * @brief Gets the texture of a texture resource.
+         */
+        auto get_texture(handle h) const -> const texture::ptr&;
+
+        /**
+         * @brief Gets an imported frame buffer.
+         */
+        auto get_frame_buffer(handle h) const -> const frame_buffer::ptr&;
+
+        /**
+         * @brief Gets a frame buffer with the textures of the resources as attachments.
+         */
+        auto get_frame_buffer(std::initializer_list<handle> attachments) const -> frame_buffer::ptr;
+
+    private:
+        friend class render_graph;
+        explicit resources(render_graph& graph);
+
+        render_graph& graph_;
+    };
+
+    using setup_func = std::function<void(builder&)>;
+    using execute_func = std::function<void(const resources&)>;
+
+    explicit render_graph(transient_pool& pool);
+    ~render_graph();
+
+    render_graph(const render_graph&) = delete;
+    auto operator=(const render_graph&) -> render_graph& = delete;
+
+    /**
+     * @brief Adds a texture owned by the caller.
+     */
+    auto import_texture(const hpp::string_view& name, const texture::ptr& tex) -> handle;
+
+    /**
+     * @brief Adds a frame buffer owned by the caller.
+     */
+    auto import_frame_buffer(const hpp::string_view& name, const frame_buffer::ptr& fbo) -> handle;
+
+    /**
+     * @brief Adds a pass. The setup callback is invoked immediately to declare its resources.
+     * @param name The name of the pass.
+     * @param setup Declares the resources.
+     * @param execute Records the pass, only called if the pass is not culled.
+     */
+    void add_pass(const hpp::string_view& name, const setup_func& setup, execute_func execute);
+
+    /**
+     * @brief Culls unused passes and computes the lifetime of transient textures.
+     */
+    void compile();
+
+    /**
+     * @brief Executes the passes that were not culled in the order they were added.
+     */
+    void execute();
+
+    /**
+     * @brief Gets the number of added passes.
+     */
+    auto get_pass_count() const -> std::size_t;
+
+    /**
+     * @brief Gets the number of passes culled by compile().
+     */
+    auto get_culled_pass_count() const -> std::size_t;
+
+private:
+    enum class resource_type : std::uint8_t
+    {
+        texture,
+        frame_buffer,
+    };
+
+    struct resource
+    {
+        std::string name;
+        resource_type type{resource_type::texture};
+        /// Key of a transient texture.
+        texture_key key;
+        texture::ptr tex;
+        frame_buffer::ptr fbo;
+        /// Passes writing the resource.
+        std::vector<std::uint32_t> writers;
+        /// Number of passes reading it, used for culling.
+        std::uint32_t ref_count{};
+        /// First and last pass using a transient texture.
+        std::uint32_t first_use{handle::invalid};
+        std::uint32_t last_use{};
+        bool imported{};
+    };
+
+    struct pass
+    {
+        std::string name;
+        execute_func execute;
+        std::vector<handle> reads;
+        std::vector<handle> writes;
+        /// Number of written resources that are read, used for culling.
+        std::uint32_t ref_count{};
+        bool side_effect{};
+        bool culled{};
+    };
+
+    auto get_resource(handle h) -> resource&;
+    auto get_resource(handle h) const -> const resource&;
+    static void add_unique(std::vector<handle>& handles, handle h);
+
+    transient_pool& pool_;
+    std::vector<resource> resources_;
+    std::vector<pass> passes_;
+    /// Transient textures to acquire before each pass.
+    std::vector<std::vector<std::uint32_t>> acquire_;
+    /// Transient textures to release after each pass.
+    std::vector<std::vector<std::uint32_t>> release_;
+    std::size_t culled_{};
+    bool compiled_{};
+};
+
+} // namespace gfx
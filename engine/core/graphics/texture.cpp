@@ -1,14 +1,18 @@
 #include "texture.h"
 #include "utils/bgfx_utils.h"
+
+#include <utility>
+
 namespace gfx
 {
 
 texture::texture(const char* _path,
                  std::uint64_t _flags,
                  std::uint8_t _skip /*= 0 */,
-                 texture_info* _info /*= nullptr*/)
+                 texture_info* _info /*= nullptr*/,
+                 texture_info* _src_info /*= nullptr*/)
 {
-    handle_ = loadTexture(_path, _flags, _skip, &info);
+    handle_ = loadTexture(_path, _flags, _skip, &info, nullptr, _src_info);
 
     if(_info != nullptr)
     {
@@ -74,4 +78,11 @@ auto texture::is_render_target() const -> bool
 {
     return 0 != (flags & BGFX_TEXTURE_RT_MASK);
 }
+
+void texture::swap(texture& other) noexcept
+{
+    std::swap(handle_, other.handle_);
+    std::swap(info, other.info);
+    std::swap(flags, other.flags);
+}
 } // namespace gfx
@@ -21,7 +21,8 @@ struct texture : public handle_impl<texture, texture_handle>
     texture(const char* _path,
             std::uint64_t _flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
             std::uint8_t _skip = 0,
-            texture_info* _info = nullptr);
+            texture_info* _info = nullptr,
+            texture_info* _src_info = nullptr);
 
     //-----------------------------------------------------------------------------
     //  Name : Texture ()
@@ -91,6 +92,16 @@ struct texture : public handle_impl<texture, texture_handle>
     //-----------------------------------------------------------------------------
     auto is_render_target() const -> bool;
 
+    //-----------------------------------------------------------------------------
+    //  Name : swap ()
+    /// <summary>
+    /// Exchanges the native handle, info and flags with another texture.
+    /// Used to replace the contents of a shared texture in place, e.g. when
+    /// a different set of mips has been streamed in.
+    /// </summary>
+    //-----------------------------------------------------------------------------
+    void swap(texture& other) noexcept;
+
     /// Texture detail info.
     texture_info info{};
     /// Creation flags.
@@ -0,0 +1,173 @@
+#include "transient_pool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace gfx
+{
+
+auto transient_pool::make_key(const usize32_t& size, texture_format format, std::uint64_t flags) -> texture_key
+{
+    texture_key key;
+    calc_texture_size(key.info,
+                      std::uint16_t(size.width),
+                      std::uint16_t(size.height),
+                      1,
+                      false,
+                      false,
+                      1,
+                      format);
+    key.flags = flags;
+    return key;
+}
+
+auto transient_pool::acquire(const texture_key& key) -> texture::ptr
+{
+    auto& entries = textures_[key];
+    for(auto& e : entries)
+    {
+        if(!e.in_use)
+        {
+            e.in_use = true;
+            e.last_used = frame_;
+            return e.tex;
+        }
+    }
+
+    auto& e = entries.emplace_back();
+    e.tex = std::make_shared<texture>(key.info.width, key.info.height, false, 1, key.info.format, key.flags);
+    e.in_use = true;
+    e.last_used = frame_;
+    return e.tex;
+}
+
+void transient_pool::release(const texture_key& key, const texture::ptr& tex)
+{
+    auto it = textures_.find(key);
+    if(it == textures_.end())
+    {
+        assert(false && "Releasing a texture that does not belong to the pool");
+        return;
+    }
+
+    for(auto& e : it->second)
+    {
+        if(e.tex == tex)
+        {
+            e.in_use = false;
+            e.last_used = frame_;
+            return;
+        }
+    }
+
+    assert(false && "Releasing a texture that does not belong to the pool");
+}
+
+auto transient_pool::get_frame_buffer(const std::vector<texture::ptr>& textures) -> frame_buffer::ptr
+{
+    fbo_key key;
+    key.textures = textures;
+
+    auto& e = frame_buffers_[key];
+    if(!e.fbo)
+    {
+        e.fbo = std::make_shared<frame_buffer>();
+        e.fbo->populate(textures);
+    }
+    e.last_used = frame_;
+
+    return e.fbo;
+}
+
+void transient_pool::end_frame()
+{
+    ++frame_;
+
+    auto is_expired = [&](std::uint64_t last_used)
+    {
+        return last_used + max_idle_frames_ < frame_;
+    };
+
+    // Frame buffers go first, they hold references to the textures.
+    for(auto it = frame_buffers_.begin(); it != frame_buffers_.end();)
+    {
+        if(is_expired(it->second.last_used))
+        {
+            it = frame_buffers_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for(auto it = textures_.begin(); it != textures_.end();)
+    {
+        auto& entries = it->second;
+        entries.erase(std::remove_if(std::begin(entries),
+                                     std::end(entries),
+                                     [&](const texture_entry& e)
+                                     {
+                                         return !e.in_use && is_expired(e.last_used) && e.tex.use_count() == 1;
+                                     }),
+                      std::end(entries));
+
+        if(entries.empty())
+        {
+            it = textures_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void transient_pool::clear()
+{
+    frame_buffers_.clear();
+
+    for(auto it = textures_.begin(); it != textures_.end();)
+    {
+        auto& entries = it->second;
+        entries.erase(std::remove_if(std::begin(entries),
+                                     std::end(entries),
+                                     [](const texture_entry& e)
+                                     {
+                                         return !e.in_use;
+                                     }),
+                      std::end(entries));
+
+        if(entries.empty())
+        {
+            it = textures_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void transient_pool::set_max_idle_frames(std::uint32_t frames)
+{
+    max_idle_frames_ = frames;
+}
+
+auto transient_pool::get_stats() const -> stats
+{
+    stats result;
+    for(const auto& kvp : textures_)
+    {
+        for(const auto& e : kvp.second)
+        {
+            ++result.textures;
+            result.textures_in_use += e.in_use ? 1 : 0;
+            result.bytes += e.tex->info.storageSize;
+        }
+    }
+    result.frame_buffers = std::uint32_t(frame_buffers_.size());
+    return result;
+}
+
+} // namespace gfx
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "frame_buffer.h"
+#include "render_view_keys.h"
+#include "texture.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace gfx
+{
+
+/**
+ * @class transient_pool
+ * @brief Shared pool of render targets that only live for a part of a frame.
+ *
+ * Targets are matched by size, format and flags. A released target can be handed out again
+ * to a later pass of the same or another view in the same frame, since views execute in
+ * submission order. Targets and frame buffers that stay unused for a few frames are destroyed.
+ */
+class transient_pool
+{
+public:
+    /**
+     * @struct stats
+     * @brief Pool usage for debugging.
+     */
+    struct stats
+    {
+        /// Number of pooled textures.
+        std::uint32_t textures{};
+        /// Number of pooled textures currently handed out.
+        std::uint32_t textures_in_use{};
+        /// Number of cached frame buffers.
+        std::uint32_t frame_buffers{};
+        /// Approximate memory of all pooled textures.
+        std::uint64_t bytes{};
+    };
+
+    /**
+     * @brief Makes a key for a render target.
+     * @param size The size in pixels.
+     * @param format The texture format.
+     * @param flags The texture creation flags.
+     */
+    static auto make_key(const usize32_t& size, texture_format format, std::uint64_t flags) -> texture_key;
+
+    /**
+     * @brief Gets an unused texture matching the key or creates one.
+     * The texture stays reserved until it is released.
+     */
+    auto acquire(const texture_key& key) -> texture::ptr;
+
+    /**
+     * @brief Returns a texture obtained by acquire to the pool.
+     * @param key The key it was acquired with.
+     * @param tex The texture.
+     */
+    void release(const texture_key& key, const texture::ptr& tex);
+
+    /**
+     * @brief Gets a cached frame buffer for the attachments, creating it on first use.
+     */
+    auto get_frame_buffer(const std::vector<texture::ptr>& textures) -> frame_buffer::ptr;
+
+    /**
+     * @brief Advances the frame counter and destroys everything unused for longer than max_idle_frames.
+     */
+    void end_frame();
+
+    /**
+     * @brief Destroys all unused textures and frame buffers.
+     */
+    void clear();
+
+    /**
+     * @brief Sets after how many unused frames textures and frame buffers are destroyed.
+     */
+    void set_max_idle_frames(std::uint32_t frames);
+
+    /**
+     * @brief Gets the current pool usage.
+     */
+    auto get_stats() const -> stats;
+
+private:
+    struct texture_entry
+    {
+        texture::ptr tex;
+        std::uint64_t last_used{};
+        bool in_use{};
+    };
+
+    struct fbo_entry
+    {
+        frame_buffer::ptr fbo;
+        std::uint64_t last_used{};
+    };
+
+    /// Pooled textures by their key.
+    std::unordered_map<texture_key, std::vector<texture_entry>> textures_;
+    /// Frame buffers made of pooled and imported textures.
+    std::unordered_map<fbo_key, fbo_entry> frame_buffers_;
+    /// Number of ended frames.
+    std::uint64_t frame_{};
+    /// Unused frames after which entries are destroyed.
+    std::uint32_t max_idle_frames_{3};
+};
+
+} // namespace gfx
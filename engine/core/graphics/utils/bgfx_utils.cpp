@@ -230,9 +230,9 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
                                 uint64_t _flags,
                                 uint8_t _skip,
                                 bgfx::TextureInfo* _info,
-                                bimg::Orientation::Enum* _orientation)
+                                bimg::Orientation::Enum* _orientation,
+                                bgfx::TextureInfo* _srcInfo)
 {
-    BX_UNUSED(_skip);
     bgfx::TextureHandle handle = BGFX_INVALID_HANDLE;
 
     uint32_t size;
@@ -248,23 +248,83 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
                 *_orientation = imageContainer->m_orientation;
             }
 
-            const bgfx::Memory* mem = bgfx::makeRef(
-                imageContainer->m_data
-                , imageContainer->m_size
-                , imageReleaseCb
-                , imageContainer
-                );
+            if (NULL != _srcInfo)
+            {
+                bgfx::calcTextureSize(
+                    *_srcInfo
+                    , uint16_t(imageContainer->m_width)
+                    , uint16_t(imageContainer->m_height)
+                    , uint16_t(imageContainer->m_depth)
+                    , imageContainer->m_cubeMap
+                    , 1 < imageContainer->m_numMips
+                    , imageContainer->m_numLayers
+                    , bgfx::TextureFormat::Enum(imageContainer->m_format)
+                    );
+            }
+
+            // Skipping top mips is only supported for plain 2d textures (and arrays).
+            const bool canSkip = !imageContainer->m_cubeMap && 1 >= imageContainer->m_depth;
+            const uint8_t skip = canSkip ? bx::min<uint8_t>(_skip, uint8_t(imageContainer->m_numMips - 1) ) : 0;
+
+            uint16_t width = uint16_t(imageContainer->m_width);
+            uint16_t height = uint16_t(imageContainer->m_height);
+            uint8_t numMips = imageContainer->m_numMips;
+
+            const bgfx::Memory* mem = NULL;
+            if (0 == skip)
+            {
+                mem = bgfx::makeRef(
+                    imageContainer->m_data
+                    , imageContainer->m_size
+                    , imageReleaseCb
+                    , imageContainer
+                    );
+            }
+            else
+            {
+                bimg::ImageMip top;
+                bimg::imageGetRawData(*imageContainer, 0, skip, imageContainer->m_data, imageContainer->m_size, top);
+                width = uint16_t(top.m_width);
+                height = uint16_t(top.m_height);
+                numMips = uint8_t(imageContainer->m_numMips - skip);
+
+                // Layout expected by bgfx is all mips of layer 0, then all mips of layer 1 and so on.
+                uint32_t memSize = 0;
+                for (uint16_t side = 0; side < imageContainer->m_numLayers; ++side)
+                {
+                    for (uint8_t lod = skip; lod < imageContainer->m_numMips; ++lod)
+                    {
+                        bimg::ImageMip mip;
+                        bimg::imageGetRawData(*imageContainer, side, lod, imageContainer->m_data, imageContainer->m_size, mip);
+                        memSize += mip.m_size;
+                    }
+                }
+
+                mem = bgfx::alloc(memSize);
+
+                uint32_t offset = 0;
+                for (uint16_t side = 0; side < imageContainer->m_numLayers; ++side)
+                {
+                    for (uint8_t lod = skip; lod < imageContainer->m_numMips; ++lod)
+                    {
+                        bimg::ImageMip mip;
+                        bimg::imageGetRawData(*imageContainer, side, lod, imageContainer->m_data, imageContainer->m_size, mip);
+                        bx::memCopy(mem->data + offset, mip.m_data, mip.m_size);
+                        offset += mip.m_size;
+                    }
+                }
+            }
             unload(data);
 
             if (NULL != _info)
             {
                 bgfx::calcTextureSize(
                     *_info
-                    , uint16_t(imageContainer->m_width)
-                    , uint16_t(imageContainer->m_height)
+                    , width
+                    , height
                     , uint16_t(imageContainer->m_depth)
                     , imageContainer->m_cubeMap
-                    , 1 < imageContainer->m_numMips
+                    , 1 < numMips
                     , imageContainer->m_numLayers
                     , bgfx::TextureFormat::Enum(imageContainer->m_format)
                     );
@@ -296,9 +356,9 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
             else if (bgfx::isTextureValid(0, false, imageContainer->m_numLayers, bgfx::TextureFormat::Enum(imageContainer->m_format), _flags) )
             {
                 handle = bgfx::createTexture2D(
-                    uint16_t(imageContainer->m_width)
-                    , uint16_t(imageContainer->m_height)
-                    , 1 < imageContainer->m_numMips
+                    width
+                    , height
+                    , 1 < numMips
                     , imageContainer->m_numLayers
                     , bgfx::TextureFormat::Enum(imageContainer->m_format)
                     , _flags
@@ -306,12 +366,21 @@ bgfx::TextureHandle loadTexture(bx::FileReaderI* _reader,
                     );
             }
 
+            if (0 != skip)
+            {
+                bimg::imageFree(imageContainer);
+            }
+
             if (bgfx::isValid(handle) )
             {
                 const bx::StringView name(_filePath);
                 bgfx::setName(handle, name.getPtr(), name.getLength() );
             }
         }
+        else
+        {
+            unload(data);
+        }
     }
 
     return handle;
@@ -321,10 +390,11 @@ bgfx::TextureHandle loadTexture(const char* _name,
                                 uint64_t _flags,
                                 uint8_t _skip,
                                 bgfx::TextureInfo* _info,
-                                bimg::Orientation::Enum* _orientation)
+                                bimg::Orientation::Enum* _orientation,
+                                bgfx::TextureInfo* _srcInfo)
 {
     entry::FileReader reader;
-    return loadTexture(&reader, _name, _flags, _skip, _info, _orientation);
+    return loadTexture(&reader, _name, _flags, _skip, _info, _orientation, _srcInfo);
 }
 
 bimg::ImageContainer* imageLoad(const void* data, uint32_t size, bgfx::TextureFormat::Enum _dstFormat)
@@ -32,12 +32,15 @@ bgfx::ShaderHandle loadShader(const char* _name);
 ///
 bgfx::ProgramHandle loadProgram(const char* _vsName, const char* _fsName);
 
-///
+/// Loads a texture from file. _skip drops that many top mips of 2d textures before
+/// creation, _info receives the created texture info and _srcInfo the one of the
+/// complete image as stored on disk.
 bgfx::TextureHandle loadTexture(const char* _name,
                                 uint64_t _flags = BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
                                 uint8_t _skip = 0,
                                 bgfx::TextureInfo* _info = NULL,
-                                bimg::Orientation::Enum* _orientation = NULL);
+                                bimg::Orientation::Enum* _orientation = NULL,
+                                bgfx::TextureInfo* _srcInfo = NULL);
 
 ///
 bimg::ImageContainer* imageLoad(const void* data, uint32_t size, bgfx::TextureFormat::Enum _dstFormat = bgfx::TextureFormat::Count);
@@ -1,9 +1,18 @@
 #include "logging.h"
 
 #include <base/platform/config.hpp>
+#include <spdlog/details/os.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #if ACE_PLATFORM_WINDOWS
 #include <spdlog/sinks/msvc_sink.h>
 namespace spdlog
@@ -48,6 +57,298 @@ using platform_sink_st = stdout_sink_st;
 
 namespace ace
 {
+namespace
+{
+
+/**
+ * @struct thread_buffer
+ * @brief Single producer, single consumer ring of deferred records owned by one thread.
+ */
+struct thread_buffer
+{
+    static constexpr size_t capacity = 512;
+
+    std::array<detail::log_record, capacity> records;
+    /// Written by the owning thread.
+    alignas(64) std::atomic<size_t> head{0};
+    /// Written by the background thread.
+    alignas(64) std::atomic<size_t> tail{0};
+    /// The owning thread exited, the buffer is released once it is drained.
+    std::atomic<bool> orphaned{false};
+};
+
+struct async_state
+{
+    /// Held while records are written, by the worker or by a synchronous record.
+    std::mutex write_mutex;
+
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    std::thread worker;
+    std::atomic<bool> running{false};
+
+    std::atomic<std::uint64_t> sequence{0};
+};
+
+auto get_async_state() -> async_state&
+{
+    static async_state state;
+    return state;
+}
+
+struct thread_buffer_owner
+{
+    ~thread_buffer_owner()
+    {
+        if(buffer)
+        {
+            buffer->orphaned = true;
+        }
+    }
+
+    std::shared_ptr<thread_buffer> buffer;
+};
+
+auto get_thread_buffer() -> thread_buffer&
+{
+    thread_local thread_buffer_owner owner;
+    if(!owner.buffer)
+    {
+        owner.buffer = std::make_shared<thread_buffer>();
+
+        auto& state = get_async_state();
+        std::lock_guard<std::mutex> lock(state.buffers_mutex);
+        state.buffers.emplace_back(owner.buffer);
+    }
+
+    return *owner.buffer;
+}
+
+void write_records(async_state& state)
+{
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(state.buffers_mutex);
+        buffers = state.buffers;
+    }
+
+    struct pending
+    {
+        detail::log_record* record{};
+        thread_buffer* buffer{};
+    };
+
+    std::vector<pending> batch;
+    std::vector<size_t> heads(buffers.size());
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        auto& buffer = *buffers[i];
+        heads[i] = buffer.head.load(std::memory_order_acquire);
+        for(size_t pos = buffer.tail.load(std::memory_order_relaxed); pos < heads[i]; ++pos)
+        {
+            batch.emplace_back(pending{&buffer.records[pos % thread_buffer::capacity], &buffer});
+        }
+    }
+
+    // Records of different threads are interleaved in the order they were logged.
+    std::sort(std::begin(batch),
+              std::end(batch),
+              [](const pending& lhs, const pending& rhs)
+              {
+                  return lhs.record->sequence < rhs.record->sequence;
+              });
+
+    // Written through the sinks of the logger to keep the thread id of the record,
+    // the level and flush level of the logger still apply.
+    auto logger = spdlog::get(APPLOG);
+
+    bool flush = false;
+    memory_buf_t formatted;
+    for(const auto& p : batch)
+    {
+        auto& record = *p.record;
+
+        if(!logger || !logger->should_log(record.lvl))
+        {
+            record.destroy(record.payload);
+            continue;
+        }
+
+        formatted.clear();
+        record.format(record.payload, formatted);
+        record.destroy(record.payload);
+
+        details::log_msg msg(record.time,
+                             record.location,
+                             logger->name(),
+                             record.lvl,
+                             string_view_t(formatted.data(), formatted.size()));
+        msg.thread_id = record.thread_id;
+        for(auto& sink : logger->sinks())
+        {
+            if(sink->should_log(record.lvl))
+            {
+                sink->log(msg);
+            }
+        }
+
+        flush |= record.lvl >= logger->flush_level() && record.lvl != level::off;
+    }
+
+    if(flush)
+    {
+        logger->flush();
+    }
+
+    for(size_t i = 0; i < buffers.size(); ++i)
+    {
+        buffers[i]->tail.store(heads[i], std::memory_order_release);
+    }
+
+    std::lock_guard<std::mutex> lock(state.buffers_mutex);
+    state.buffers.erase(std::remove_if(std::begin(state.buffers),
+                                       std::end(state.buffers),
+                                       [](const std::shared_ptr<thread_buffer>& buffer)
+                                       {
+                                           return buffer->orphaned &&
+                                                  buffer->tail.load(std::memory_order_relaxed) ==
+                                                      buffer->head.load(std::memory_order_acquire);
+                                       }),
+                        std::end(state.buffers));
+}
+
+void run_worker(async_state& state)
+{
+    while(state.running)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state.write_mutex);
+            write_records(state);
+        }
+
+        std::unique_lock<std::mutex> lock(state.wake_mutex);
+        state.wake.wait_for(lock, std::chrono::milliseconds(10));
+    }
+}
+
+} // namespace
+
+void set_log_level(log_category category, level::level_enum lvl)
+{
+    detail::category_levels[size_t(category)] = int(lvl);
+}
+
+auto get_log_level(log_category category) -> level::level_enum
+{
+    return level::level_enum(detail::category_levels[size_t(category)].load());
+}
+
+void set_async_logging(bool enabled)
+{
+    auto& state = get_async_state();
+    if(enabled == state.running)
+    {
+        return;
+    }
+
+    if(enabled)
+    {
+        state.running = true;
+        state.worker = std::thread(run_worker, std::ref(state));
+        detail::async_logging = true;
+        return;
+    }
+
+    detail::async_logging = false;
+    state.running = false;
+    state.wake.notify_one();
+    if(state.worker.joinable())
+    {
+        state.worker.join();
+    }
+
+    // Whatever was committed meanwhile.
+    std::lock_guard<std::mutex> lock(state.write_mutex);
+    write_records(state);
+}
+
+auto is_async_logging() -> bool
+{
+    return detail::async_logging;
+}
+
+namespace detail
+{
+
+void set_record_location(log_record& record, const source_loc& loc)
+{
+    auto copy = [](const char* src, auto& dst, bool keep_tail)
+    {
+        if(src == nullptr)
+        {
+            return static_cast<const char*>(nullptr);
+        }
+
+        std::string_view view(src);
+        if(view.size() >= dst.size())
+        {
+            // Paths keep their end, names their start.
+            view = keep_tail ? view.substr(view.size() - dst.size() + 1) : view.substr(0, dst.size() - 1);
+        }
+
+        std::copy(view.begin(), view.end(), dst.begin());
+        dst[view.size()] = '\0';
+        return static_cast<const char*>(dst.data());
+    };
+
+    record.location.filename = copy(loc.filename, record.file, true);
+    record.location.funcname = copy(loc.funcname, record.function, false);
+    record.location.line = loc.line;
+}
+
+auto drain_records() -> std::unique_lock<std::mutex>
+{
+    auto& state = get_async_state();
+
+    std::unique_lock<std::mutex> lock(state.write_mutex);
+    write_records(state);
+    return lock;
+}
+
+auto acquire_record() -> log_record*
+{
+    auto& buffer = get_thread_buffer();
+    auto head = buffer.head.load(std::memory_order_relaxed);
+    auto tail = buffer.tail.load(std::memory_order_acquire);
+    if(head - tail >= thread_buffer::capacity)
+    {
+        return nullptr;
+    }
+
+    return &buffer.records[head % thread_buffer::capacity];
+}
+
+void commit_record(log_record* record)
+{
+    auto& state = get_async_state();
+
+    record->time = log_clock::now();
+    record->thread_id = details::os::thread_id();
+    record->sequence = state.sequence++;
+
+    auto& buffer = get_thread_buffer();
+    buffer.head.store(buffer.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    if(record->lvl >= level::err)
+    {
+        state.wake.notify_one();
+    }
+}
+
+} // namespace detail
 
 auto get_mutable_logging_container() -> std::shared_ptr<spdlog::sinks::dist_sink_mt>
 {
@@ -65,12 +366,14 @@ logging::logging(const std::string& output_file)
     logging_container->add_sink(console_sink);
     logging_container->add_sink(file_sink);
     auto logger = std::make_shared<spdlog::logger>(APPLOG, logging_container);
+    logger->flush_on(spdlog::level::err);
     spdlog::initialize_logger(logger);
     spdlog::set_level(spdlog::level::trace);
 }
 
 logging::~logging()
 {
+    set_async_logging(false);
     spdlog::shutdown();
 }
 } // namespace ace
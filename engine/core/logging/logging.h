@@ -7,35 +7,198 @@
 #include <spdlog/fmt/ranges.h>
 
 #include <hpp/source_location.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
 namespace ace
 {
 using namespace spdlog;
 
+#define APPLOG "Log"
+
+/**
+ * @enum log_category
+ * @brief Groups of log calls whose level can be changed at runtime.
+ */
+enum class log_category : std::uint8_t
+{
+    general, ///< APPLOG_* calls.
+    perf,    ///< APPLOG_*_PERF stopwatches.
+
+    count
+};
+
+/**
+ * @brief Sets the min level of a category. Calls below it are skipped before their arguments are evaluated.
+ */
+void set_log_level(log_category category, level::level_enum lvl);
+auto get_log_level(log_category category) -> level::level_enum;
+
+/**
+ * @brief Enables asynchronous logging.
+ * Call sites copy their arguments into a buffer of the calling thread and a background
+ * thread formats and writes the records in order. Falls back to synchronous logging
+ * for records which don't fit or when the buffer of the thread is full, the queued
+ * records are written first.
+ */
+void set_async_logging(bool enabled);
+auto is_async_logging() -> bool;
+
+namespace detail
+{
+
+inline std::array<std::atomic<int>, size_t(log_category::count)> category_levels{};
+inline std::atomic<bool> async_logging{false};
+
+inline auto should_log(log_category category, level::level_enum lvl) -> bool
+{
+    return int(lvl) >= category_levels[size_t(category)].load(std::memory_order_relaxed);
+}
+
+/**
+ * @struct log_record
+ * @brief A deferred record. The captured arguments live in the payload until the background thread formats them.
+ */
+struct log_record
+{
+    static constexpr size_t payload_size = 192;
+    static constexpr size_t file_size = 128;
+    static constexpr size_t function_size = 64;
+
+    using format_fn_t = void (*)(void* payload, memory_buf_t& out);
+    using destroy_fn_t = void (*)(void* payload);
+
+    log_clock::time_point time{};
+    source_loc location{};
+    level::level_enum lvl{level::off};
+    size_t thread_id{};
+    std::uint64_t sequence{};
+    format_fn_t format{};
+    destroy_fn_t destroy{};
+    /// The location strings are copied, the caller's may not outlive the call.
+    std::array<char, file_size> file{};
+    std::array<char, function_size> function{};
+    alignas(std::max_align_t) unsigned char payload[payload_size];
+};
+
+/**
+ * @brief Copies a source location into the record, the location of the record points to the copies.
+ */
+void set_record_location(log_record& record, const source_loc& loc);
+
+/**
+ * @brief Gets the next free record of the calling thread, nullptr if its buffer is full.
+ */
+auto acquire_record() -> log_record*;
+
+/**
+ * @brief Hands the record acquired last by the calling thread to the background thread.
+ */
+void commit_record(log_record* record);
 
-#define APPLOG               "Log"
-#define APPLOG_TRACE(...)    SPDLOG_LOGGER_CALL(spdlog::get(APPLOG), spdlog::level::trace, __VA_ARGS__)
-#define APPLOG_INFO(...)     SPDLOG_LOGGER_CALL(spdlog::get(APPLOG), spdlog::level::info, __VA_ARGS__)
-#define APPLOG_WARNING(...)  SPDLOG_LOGGER_CALL(spdlog::get(APPLOG), spdlog::level::warn, __VA_ARGS__)
-#define APPLOG_ERROR(...)    SPDLOG_LOGGER_CALL(spdlog::get(APPLOG), spdlog::level::err, __VA_ARGS__)
-#define APPLOG_CRITICAL(...) SPDLOG_LOGGER_CALL(spdlog::get(APPLOG), spdlog::level::critical, __VA_ARGS__)
+/**
+ * @brief Writes every committed record and keeps the writer locked, so a synchronous
+ * record logged while the lock is held can't overtake them.
+ */
+auto drain_records() -> std::unique_lock<std::mutex>;
 
+/// Strings are copied, views and pointers into them may not outlive the call.
+template<typename T>
+using log_capture_t =
+    std::conditional_t<std::is_convertible_v<const std::decay_t<T>&, std::string_view>, std::string, std::decay_t<T>>;
+
+template<typename Payload>
+void format_payload(void* payload, memory_buf_t& out)
+{
+    std::apply(
+        [&](const string_view_t& fmt_str, auto&... args)
+        {
+            fmt::vformat_to(fmt::appender(out), fmt_str, fmt::make_format_args(args...));
+        },
+        *static_cast<Payload*>(payload));
+}
+
+template<typename Payload>
+void destroy_payload(void* payload)
+{
+    static_cast<Payload*>(payload)->~Payload();
+}
+
+template<typename... Args>
+void log(source_loc loc, level::level_enum lvl, format_string_t<Args...> fmt_str, Args&&... args)
+{
+    using payload_t = std::tuple<string_view_t, log_capture_t<Args>...>;
+
+    if constexpr(sizeof(payload_t) <= log_record::payload_size && alignof(payload_t) <= alignof(std::max_align_t))
+    {
+        if(async_logging.load(std::memory_order_relaxed))
+        {
+            if(auto* record = acquire_record())
+            {
+                new(record->payload) payload_t(string_view_t(fmt_str.get().data(), fmt_str.get().size()),
+                                               log_capture_t<Args>(std::forward<Args>(args))...);
+                set_record_location(*record, loc);
+                record->lvl = lvl;
+                record->format = &format_payload<payload_t>;
+                record->destroy = &destroy_payload<payload_t>;
+                commit_record(record);
+                return;
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock;
+    if(async_logging.load(std::memory_order_relaxed))
+    {
+        lock = drain_records();
+    }
+
+    spdlog::get(APPLOG)->log(loc, lvl, fmt_str, std::forward<Args>(args)...);
+}
+
+template<typename T>
+void log(source_loc loc, level::level_enum lvl, const T& msg)
+{
+    detail::log(loc, lvl, "{}", msg);
+}
+
+} // namespace detail
+
+#define APPLOG_CALL(CATEGORY, LEVEL, LOC, ...)                                                                         \
+    (ace::detail::should_log(CATEGORY, LEVEL) ? ace::detail::log(LOC, LEVEL, __VA_ARGS__) : void())
+
+#define APPLOG_CALL_GENERAL(LEVEL, ...)                                                                                \
+    APPLOG_CALL(ace::log_category::general,                                                                            \
+                LEVEL,                                                                                                 \
+                (spdlog::source_loc{__FILE__, __LINE__, SPDLOG_FUNCTION}),                                             \
+                __VA_ARGS__)
+
+#define APPLOG_TRACE(...)    APPLOG_CALL_GENERAL(spdlog::level::trace, __VA_ARGS__)
+#define APPLOG_INFO(...)     APPLOG_CALL_GENERAL(spdlog::level::info, __VA_ARGS__)
+#define APPLOG_WARNING(...)  APPLOG_CALL_GENERAL(spdlog::level::warn, __VA_ARGS__)
+#define APPLOG_ERROR(...)    APPLOG_CALL_GENERAL(spdlog::level::err, __VA_ARGS__)
+#define APPLOG_CRITICAL(...) APPLOG_CALL_GENERAL(spdlog::level::critical, __VA_ARGS__)
+
+#define APPLOG_CALL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, LEVEL, ...)                                                      \
+    APPLOG_CALL(ace::log_category::general, LEVEL, (spdlog::source_loc{FILE_LOC, LINE_LOC, FUNC_LOC}), __VA_ARGS__)
 
-#ifndef SPDLOG_NO_SOURCE_LOC
-#define SPDLOG_LOGGER_CALL_LOC(logger, file, line, func, level, ...)                                                   \
-    (logger)->log(spdlog::source_loc{file, line, func}, level, __VA_ARGS__)
-#else
-#define SPDLOG_LOGGER_CALL_LOC(logger, level, ...) (logger)->log(spdlog::source_loc{}, level, __VA_ARGS__)
-#endif
 #define APPLOG_TRACE_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, ...)                                                            \
-    SPDLOG_LOGGER_CALL_LOC(spdlog::get(APPLOG), FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::trace, __VA_ARGS__)
+    APPLOG_CALL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::trace, __VA_ARGS__)
 #define APPLOG_INFO_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, ...)                                                             \
-    SPDLOG_LOGGER_CALL_LOC(spdlog::get(APPLOG), FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::info, __VA_ARGS__)
+    APPLOG_CALL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::info, __VA_ARGS__)
 #define APPLOG_WARNING_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, ...)                                                          \
-    SPDLOG_LOGGER_CALL_LOC(spdlog::get(APPLOG), FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::warn, __VA_ARGS__)
+    APPLOG_CALL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::warn, __VA_ARGS__)
 #define APPLOG_ERROR_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, ...)                                                            \
-    SPDLOG_LOGGER_CALL_LOC(spdlog::get(APPLOG), FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::err, __VA_ARGS__)
+    APPLOG_CALL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::err, __VA_ARGS__)
 #define APPLOG_CRITICAL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, ...)                                                         \
-    SPDLOG_LOGGER_CALL_LOC(spdlog::get(APPLOG), FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::critical, __VA_ARGS__)
+    APPLOG_CALL_LOC(FILE_LOC, LINE_LOC, FUNC_LOC, spdlog::level::critical, __VA_ARGS__)
 
 auto get_mutable_logging_container() -> std::shared_ptr<spdlog::sinks::dist_sink_mt>;
 
@@ -52,7 +215,9 @@ struct log_stopwatch
     using clock_t = std::chrono::high_resolution_clock;
     using timepoint_t = clock_t::time_point;
 
-    timepoint_t start = clock_t::now();
+    /// Disabled stopwatches don't read the clock.
+    bool enabled = detail::should_log(log_category::perf, lvl);
+    timepoint_t start = enabled ? clock_t::now() : timepoint_t{};
     const char* func_{};
     hpp::source_location location_;
 
@@ -65,10 +230,15 @@ struct log_stopwatch
 
     ~log_stopwatch()
     {
+        if(!enabled)
+        {
+            return;
+        }
+
         auto end = clock_t::now();
         auto dur = std::chrono::duration_cast<T>(end - start);
 
-        SPDLOG_LOGGER_CALL_LOC(spdlog::get(APPLOG), location_.file_name(), int(location_.line()), func_, lvl, "{} : {}", func_, dur);
+        detail::log(spdlog::source_loc{location_.file_name(), int(location_.line()), func_}, lvl, "{} : {}", func_, dur);
     }
 
 };
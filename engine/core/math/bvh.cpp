@@ -0,0 +1,173 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace math
+{
+
+void bvh::build(const std::vector<bbox>& item_bounds, std::uint32_t max_leaf_items)
+{
+    clear();
+
+    if(item_bounds.empty())
+    {
+        return;
+    }
+
+    const auto item_count = static_cast<std::uint32_t>(item_bounds.size());
+    max_leaf_items = std::max<std::uint32_t>(max_leaf_items, 1);
+
+    items_.resize(item_count);
+    std::iota(std::begin(items_), std::end(items_), 0u);
+
+    std::vector<vec3> centers(item_count);
+    for(std::uint32_t i = 0; i < item_count; ++i)
+    {
+        centers[i] = item_bounds[i].get_center();
+    }
+
+    nodes_.reserve(item_count * 2);
+    nodes_.emplace_back(node{{}, 0, item_count});
+
+    std::vector<std::uint32_t> pending{0};
+    while(!pending.empty())
+    {
+        const auto index = pending.back();
+        pending.pop_back();
+
+        // Copied, nodes_ may grow below.
+        const auto first = nodes_[index].first;
+        const auto count = nodes_[index].count;
+
+        bbox bounds;
+        bbox center_bounds;
+        for(std::uint32_t i = first; i < first + count; ++i)
+        {
+            const auto& item = item_bounds[items_[i]];
+            bounds.add_point(item.min);
+            bounds.add_point(item.max);
+            center_bounds.add_point(centers[items_[i]]);
+        }
+        nodes_[index].bounds = bounds;
+
+        if(count <= max_leaf_items)
+        {
+            continue;
+        }
+
+        const auto extents = center_bounds.get_dimensions();
+        int axis = 0;
+        if(extents.y > extents[axis])
+        {
+            axis = 1;
+        }
+        if(extents.z > extents[axis])
+        {
+            axis = 2;
+        }
+
+        // All centers coincide, no split can separate them.
+        if(extents[axis] <= 0.0f)
+        {
+            continue;
+        }
+
+        const auto middle = first + count / 2;
+        std::nth_element(std::begin(items_) + first,
+                         std::begin(items_) + middle,
+                         std::begin(items_) + first + count,
+                         [&](std::uint32_t lhs, std::uint32_t rhs)
+                         {
+                             return centers[lhs][axis] < centers[rhs][axis];
+                         });
+
+        const auto left = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.emplace_back(node{{}, first, middle - first});
+        nodes_.emplace_back(node{{}, middle, first + count - middle});
+
+        nodes_[index].first = left;
+        nodes_[index].count = 0;
+
+        pending.emplace_back(left);
+        pending.emplace_back(left + 1);
+    }
+}
+
+void bvh::clear()
+{
+    nodes_.clear();
+    items_.clear();
+}
+
+auto bvh::empty() const -> bool
+{
+    return items_.empty();
+}
+
+auto bvh::get_nodes() const -> const std::vector<node>&
+{
+    return nodes_;
+}
+
+auto bvh::get_items() const -> const std::vector<std::uint32_t>&
+{
+    return items_;
+}
+
+auto bvh::intersect_ray(const bbox& bounds,
+                        const vec3& origin,
+                        const vec3& inv_direction,
+                        float max_distance,
+                        float& distance) -> bool
+{
+    const vec3 t0 = (bounds.min - origin) * inv_direction;
+    const vec3 t1 = (bounds.max - origin) * inv_direction;
+    const vec3 t_near = glm::min(t0, t1);
+    const vec3 t_far = glm::max(t0, t1);
+
+    const float enter = glm::max(glm::max(t_near.x, t_near.y), glm::max(t_near.z, 0.0f));
+    const float exit = glm::min(glm::min(t_far.x, t_far.y), glm::min(t_far.z, max_distance));
+
+    distance = enter;
+    return enter <= exit;
+}
+
+auto bvh::intersect_triangle(const vec3& origin,
+                             const vec3& direction,
+                             const vec3& v0,
+                             const vec3& v1,
+                             const vec3& v2,
+                             float& distance) -> bool
+{
+    // Moller-Trumbore
+    const vec3 edge1 = v1 - v0;
+    const vec3 edge2 = v2 - v0;
+    const vec3 p = glm::cross(direction, edge2);
+    const float det = glm::dot(edge1, p);
+
+    if(glm::abs(det) < glm::epsilon<float>() * glm::epsilon<float>())
+    {
+        return false;
+    }
+
+    const float inv_det = 1.0f / det;
+    const vec3 s = origin - v0;
+    const float u = glm::dot(s, p) * inv_det;
+    if(u < 0.0f || u > 1.0f)
+    {
+        return false;
+    }
+
+    const vec3 q = glm::cross(s, edge1);
+    const float v = glm::dot(direction, q) * inv_det;
+    if(v < 0.0f || u + v > 1.0f)
+    {
+        return false;
+    }
+
+    distance = glm::dot(edge2, q) * inv_det;
+    return distance >= 0.0f;
+}
+
+} // namespace math
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "bbox.h"
+#include "math_types.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace math
+{
+using namespace glm;
+
+/**
+ * @class bvh
+ * @brief Bounding volume hierarchy over a set of axis aligned boxes.
+ *
+ * Built top down by splitting the items at the median of their centers along the
+ * longest axis. Leaves reference a range of item indices and traversal reports the
+ * items of every leaf that passes the node test.
+ */
+class bvh
+{
+public:
+    /**
+     * @brief A node of the hierarchy.
+     */
+    struct node
+    {
+        /// Bounds of all items below the node.
+        bbox bounds;
+        /// First item for leaves, index of the left child for inner nodes. The right child follows it.
+        std::uint32_t first{};
+        /// Number of items of a leaf, zero for inner nodes.
+        std::uint32_t count{};
+    };
+
+    /// Max depth of the traversal stack.
+    static constexpr std::size_t max_depth = 64;
+
+    /**
+     * @brief Builds the hierarchy.
+     * @param item_bounds The bounds of every item. Items are referenced by their index.
+     * @param max_leaf_items Leaves with at most this many items are not split further.
+     */
+    void build(const std::vector<bbox>& item_bounds, std::uint32_t max_leaf_items = 4);
+
+    /**
+     * @brief Removes all nodes and items.
+     */
+    void clear();
+
+    /**
+     * @brief Checks if the hierarchy has no items.
+     */
+    auto empty() const -> bool;
+
+    /**
+     * @brief Gets the nodes, the root is the first one.
+     */
+    auto get_nodes() const -> const std::vector<node>&;
+
+    /**
+     * @brief Gets the item indices referenced by the leaves.
+     */
+    auto get_items() const -> const std::vector<std::uint32_t>&;
+
+    /**
+     * @brief Casts a ray through the hierarchy, visiting the closest nodes first.
+     * @param origin The ray origin.
+     * @param direction The ray direction, distances are measured in its length.
+     * @param max_distance Items further than this are skipped.
+     * @param visitor Called as visitor(item, max_distance) for items whose leaf is hit.
+     * It can lower max_distance when the item is hit to skip everything behind it.
+     */
+    template<typename Visitor>
+    void raycast(const vec3& origin, const vec3& direction, float max_distance, Visitor&& visitor) const;
+
+    /**
+     * @brief Visits the items of every leaf for which the test passes on all its parents.
+     * @param test Called as test(bounds), returns false to skip a node.
+     * @param visitor Called as visitor(item).
+     */
+    template<typename Test, typename Visitor>
+    void query(Test&& test, Visitor&& visitor) const;
+
+    /**
+     * @brief Slab test of a ray against a box.
+     * @param bounds The box.
+     * @param origin The ray origin.
+     * @param inv_direction Reciprocal of the ray direction.
+     * @param max_distance The end of the ray.
+     * @param distance Distance where the ray enters the box, zero when it starts inside.
+     * @return True if the box is hit within [0, max_distance].
+     */
+    static auto intersect_ray(const bbox& bounds,
+                              const vec3& origin,
+                              const vec3& inv_direction,
+                              float max_distance,
+                              float& distance) -> bool;
+
+    /**
+     * @brief Intersects a ray with a double sided triangle.
+     * @param origin The ray origin.
+     * @param direction The ray direction.
+     * @param v0 First vertex.
+     * @param v1 Second vertex.
+     * @param v2 Third vertex.
+     * @param distance Distance of the hit along the ray.
+     * @return True if the triangle is hit in front of the origin.
+     */
+    static auto intersect_triangle(const vec3& origin,
+                                   const vec3& direction,
+                                   const vec3& v0,
+                                   const vec3& v1,
+                                   const vec3& v2,
+                                   float& distance) -> bool;
+
+private:
+    /// Nodes, the root is the first one.
+    std::vector<node> nodes_;
+    /// Item indices, every leaf references a range of it.
+    std::vector<std::uint32_t> items_;
+};
+
+template<typename Visitor>
+void bvh::raycast(const vec3& origin, const vec3& direction, float max_distance, Visitor&& visitor) const
+{
+    if(nodes_.empty())
+    {
+        return;
+    }
+
+    const vec3 inv_direction = 1.0f / direction;
+
+    float distance{};
+    if(!intersect_ray(nodes_.front().bounds, origin, inv_direction, max_distance, distance))
+    {
+        return;
+    }
+
+    std::array<std::pair<std::uint32_t, float>, max_depth> stack;
+    std::size_t size = 0;
+    stack[size++] = {0, distance};
+
+    while(size > 0)
+    {
+        const auto [index, entry] = stack[--size];
+
+        // The ray may have been shortened since the node was pushed.
+        if(entry > max_distance)
+        {
+            continue;
+        }
+
+        const auto& n = nodes_[index];
+        if(n.count > 0)
+        {
+            for(std::uint32_t i = n.first; i < n.first + n.count; ++i)
+            {
+                visitor(items_[i], max_distance);
+            }
+            continue;
+        }
+
+        float left_distance{};
+        float right_distance{};
+        bool left = intersect_ray(nodes_[n.first].bounds, origin, inv_direction, max_distance, left_distance);
+        bool right = intersect_ray(nodes_[n.first + 1].bounds, origin, inv_direction, max_distance, right_distance);
+
+        if(left && right)
+        {
+            // Push the far child first so the near one is visited first.
+            if(left_distance <= right_distance)
+            {
+                stack[size++] = {n.first + 1, right_distance};
+                stack[size++] = {n.first, left_distance};
+            }
+            else
+            {
+                stack[size++] = {n.first, left_distance};
+                stack[size++] = {n.first + 1, right_distance};
+            }
+        }
+        else if(left)
+        {
+            stack[size++] = {n.first, left_distance};
+        }
+        else if(right)
+        {
+            stack[size++] = {n.first + 1, right_distance};
+        }
+    }
+}
+
+template<typename Test, typename Visitor>
+void bvh::query(Test&& test, Visitor&& visitor) const
+{
+    if(nodes_.empty())
+    {
+        return;
+    }
+
+    std::array<std::uint32_t, max_depth> stack;
+    std::size_t size = 0;
+    stack[size++] = 0;
+
+    while(size > 0)
+    {
+        const auto& n = nodes_[stack[--size]];
+        if(!test(n.bounds))
+        {
+            continue;
+        }
+
+        if(n.count > 0)
+        {
+            for(std::uint32_t i = n.first; i < n.first + n.count; ++i)
+            {
+                visitor(items_[i]);
+            }
+            continue;
+        }
+
+        stack[size++] = n.first + 1;
+        stack[size++] = n.first;
+    }
+}
+
+} // namespace math
@@ -2,6 +2,7 @@
 
 #include "bbox.h"
 #include "bsphere.h"
+#include "bvh.h"
 #include "frustum.h"
 #include "math_types.h"
 #include "plane.h"
@@ -0,0 +1,305 @@
+#include "animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ace
+{
+namespace
+{
+
+constexpr float quantize_range = 65535.0f;
+constexpr float rotation_range = 32767.0f;
+// The three smallest components of a unit quaternion lie within +-1/sqrt(2).
+constexpr float rotation_bound = 0.70710678f;
+
+/**
+ * @brief Walks the keys forward and returns the value at the given time.
+ * Resampling visits increasing times so the key index only ever moves forward.
+ */
+template<typename T>
+auto resample(const std::vector<animation_channel::key<T>>& keys, animation_channel::seconds_t time, size_t& index)
+    -> T
+{
+    if(keys.empty())
+    {
+        if constexpr(std::is_same_v<T, math::quat>)
+        {
+            return math::identity<math::quat>();
+        }
+        return {};
+    }
+
+    while(index + 1 < keys.size() && keys[index + 1].time <= time)
+    {
+        ++index;
+    }
+
+    const auto& key1 = keys[index];
+    if(index + 1 == keys.size() || time <= key1.time)
+    {
+        return key1.value;
+    }
+
+    const auto& key2 = keys[index + 1];
+    float factor = (time.count() - key1.time.count()) / (key2.time.count() - key1.time.count());
+
+    if constexpr(std::is_same_v<T, math::quat>)
+    {
+        return math::slerp(key1.value, key2.value, factor);
+    }
+    else
+    {
+        return math::lerp(key1.value, key2.value, factor);
+    }
+}
+
+auto quantize(float value, float min, float extent) -> std::uint16_t
+{
+    if(extent <= 0.0f)
+    {
+        return 0;
+    }
+    float normalized = std::clamp((value - min) / extent, 0.0f, 1.0f);
+    return static_cast<std::uint16_t>(std::lround(normalized * quantize_range));
+}
+
+auto dequantize(std::uint16_t value, float min, float extent) -> float
+{
+    return min + float(value) * (extent / quantize_range);
+}
+
+void pack_rotation(math::quat q, std::uint16_t* out)
+{
+    q = math::normalize(q);
+
+    int largest = 0;
+    for(int i = 1; i < 4; ++i)
+    {
+        if(std::abs(q[i]) > std::abs(q[largest]))
+        {
+            largest = i;
+        }
+    }
+
+    // q and -q are the same rotation, keep the dropped component positive.
+    if(q[largest] < 0.0f)
+    {
+        q = -q;
+    }
+
+    int written = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        if(i == largest)
+        {
+            continue;
+        }
+        float normalized = std::clamp((q[i] / rotation_bound) * 0.5f + 0.5f, 0.0f, 1.0f);
+        out[written++] = static_cast<std::uint16_t>(std::lround(normalized * rotation_range));
+    }
+
+    // The index of the dropped component goes into the spare top bits.
+    out[0] |= std::uint16_t((largest & 1) << 15);
+    out[1] |= std::uint16_t((largest >> 1) << 15);
+}
+
+auto unpack_rotation(const std::uint16_t* in) -> math::quat
+{
+    int largest = (in[0] >> 15) | ((in[1] >> 15) << 1);
+
+    float values[3];
+    float sum = 0.0f;
+    for(int i = 0; i < 3; ++i)
+    {
+        float normalized = float(in[i] & 0x7fff) / rotation_range;
+        values[i] = (normalized * 2.0f - 1.0f) * rotation_bound;
+        sum += values[i] * values[i];
+    }
+
+    math::quat q;
+    int read = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        q[i] = (i == largest) ? std::sqrt(std::max(0.0f, 1.0f - sum)) : values[read++];
+    }
+    return q;
+}
+
+auto dequantize(const std::uint16_t* in, const math::vec3& min, const math::vec3& extent) -> math::vec3
+{
+    return {dequantize(in[0], min.x, extent.x), dequantize(in[1], min.y, extent.y), dequantize(in[2], min.z, extent.z)};
+}
+
+void decode_frames(const compressed_animation_clip& clip,
+                   std::uint32_t frame,
+                   std::uint32_t next,
+                   animation_cursor& cursor)
+{
+    const size_t channels = clip.get_channel_count();
+    const size_t track = size_t(clip.frame_count) * 3;
+    const size_t from = size_t(frame) * 3;
+    const size_t to = size_t(next) * 3;
+
+    const auto* pos = clip.positions.data();
+    const auto* rot = clip.rotations.data();
+    const auto* scl = clip.scalings.data();
+
+    for(size_t c = 0; c < channels; ++c, pos += track, rot += track, scl += track)
+    {
+        const auto& pmin = clip.position_min[c];
+        const auto& pext = clip.position_extent[c];
+        cursor.from_positions[c] = dequantize(pos + from, pmin, pext);
+        cursor.to_positions[c] = dequantize(pos + to, pmin, pext);
+
+        cursor.from_rotations[c] = unpack_rotation(rot + from);
+        cursor.to_rotations[c] = unpack_rotation(rot + to);
+
+        const auto& smin = clip.scaling_min[c];
+        const auto& sext = clip.scaling_extent[c];
+        cursor.from_scalings[c] = dequantize(scl + from, smin, sext);
+        cursor.to_scalings[c] = dequantize(scl + to, smin, sext);
+    }
+}
+
+} // namespace
+
+auto compress_animation_clip(const animation_clip& clip, float sample_rate) -> compressed_animation_clip
+{
+    compressed_animation_clip result;
+
+    const size_t channels = clip.channels.size();
+    if(channels == 0 || sample_rate <= 0.0f)
+    {
+        return result;
+    }
+
+    const float duration = std::max(clip.duration.count(), 0.0f);
+    const auto intervals = static_cast<std::uint32_t>(std::ceil(duration * sample_rate));
+
+    result.frame_count = intervals + 1;
+    // Snap the rate so the last frame lands exactly on the clip duration.
+    result.sample_rate = (intervals > 0 && duration > 0.0f) ? float(intervals) / duration : sample_rate;
+
+    const size_t frames = result.frame_count;
+
+    std::vector<math::vec3> positions(frames * channels);
+    std::vector<math::quat> rotations(frames * channels);
+    std::vector<math::vec3> scalings(frames * channels);
+
+    result.node_indices.resize(channels);
+    result.position_min.resize(channels);
+    result.position_extent.resize(channels);
+    result.scaling_min.resize(channels);
+    result.scaling_extent.resize(channels);
+
+    for(size_t c = 0; c < channels; ++c)
+    {
+        const auto& channel = clip.channels[c];
+        result.node_indices[c] = static_cast<std::uint32_t>(channel.node_index);
+
+        size_t position_index = 0;
+        size_t rotation_index = 0;
+        size_t scaling_index = 0;
+
+        math::vec3 pmin(std::numeric_limits<float>::max());
+        math::vec3 pmax(std::numeric_limits<float>::lowest());
+        math::vec3 smin(std::numeric_limits<float>::max());
+        math::vec3 smax(std::numeric_limits<float>::lowest());
+
+        for(size_t f = 0; f < frames; ++f)
+        {
+            animation_channel::seconds_t time(std::min(float(f) / result.sample_rate, duration));
+
+            auto& position = positions[c * frames + f];
+            auto& rotation = rotations[c * frames + f];
+            auto& scaling = scalings[c * frames + f];
+
+            position = resample(channel.position_keys, time, position_index);
+            rotation = resample(channel.rotation_keys, time, rotation_index);
+            scaling = channel.scaling_keys.empty() ? math::vec3(1.0f)
+                                                   : resample(channel.scaling_keys, time, scaling_index);
+
+            pmin = math::min(pmin, position);
+            pmax = math::max(pmax, position);
+            smin = math::min(smin, scaling);
+            smax = math::max(smax, scaling);
+        }
+
+        result.position_min[c] = pmin;
+        result.position_extent[c] = pmax - pmin;
+        result.scaling_min[c] = smin;
+        result.scaling_extent[c] = smax - smin;
+    }
+
+    result.positions.resize(frames * channels * 3);
+    result.rotations.resize(frames * channels * 3);
+    result.scalings.resize(frames * channels * 3);
+
+    for(size_t i = 0; i < frames * channels; ++i)
+    {
+        const size_t c = i / frames;
+        auto* pos = result.positions.data() + i * 3;
+        auto* scl = result.scalings.data() + i * 3;
+
+        for(int k = 0; k < 3; ++k)
+        {
+            pos[k] = quantize(positions[i][k], result.position_min[c][k], result.position_extent[c][k]);
+            scl[k] = quantize(scalings[i][k], result.scaling_min[c][k], result.scaling_extent[c][k]);
+        }
+
+        pack_rotation(rotations[i], result.rotations.data() + i * 3);
+    }
+
+    return result;
+}
+
+void strip_animation_keys(animation_clip& clip)
+{
+    for(auto& channel : clip.channels)
+    {
+        channel.position_keys = {};
+        channel.rotation_keys = {};
+        channel.scaling_keys = {};
+    }
+}
+
+void advance_cursor(const compressed_animation_clip& clip,
+                    animation_channel::seconds_t time,
+                    animation_cursor& cursor)
+{
+    const size_t channels = clip.get_channel_count();
+
+    if(cursor.clip != &clip || cursor.from_positions.size() != channels)
+    {
+        cursor.clip = &clip;
+        cursor.valid = false;
+
+        cursor.from_positions.resize(channels);
+        cursor.from_rotations.resize(channels);
+        cursor.from_scalings.resize(channels);
+        cursor.to_positions.resize(channels);
+        cursor.to_rotations.resize(channels);
+        cursor.to_scalings.resize(channels);
+    }
+
+    const auto last = clip.frame_count - 1;
+    float position = std::clamp(time.count() * clip.sample_rate, 0.0f, float(last));
+
+    auto frame = std::min(static_cast<std::uint32_t>(position), last);
+    auto next = std::min(frame + 1, last);
+    cursor.factor = position - float(frame);
+
+    if(cursor.valid && frame == cursor.frame)
+    {
+        return;
+    }
+
+    decode_frames(clip, frame, next, cursor);
+
+    cursor.frame = frame;
+    cursor.valid = true;
+}
+
+} // namespace ace
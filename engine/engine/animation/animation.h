@@ -4,6 +4,7 @@
 #include <math/math.h>
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -49,6 +50,82 @@ struct animation_channel
     std::vector<key<math::vec3>> scaling_keys;
 };
 
+/**
+ * @brief Runtime representation of an animation clip.
+ *
+ * All tracks are resampled at a uniform rate and laid out as structure of arrays, one
+ * contiguous track per channel, so the two frames around a time sit next to each other.
+ * Rotations are packed with the smallest three method into 48 bits and positions/scales
+ * are quantized to 16 bits per component within a per channel range.
+ */
+struct compressed_animation_clip
+{
+    /// Samples per second of the resampled tracks.
+    float sample_rate{};
+
+    /// Number of resampled frames, including the last one at the clip duration.
+    std::uint32_t frame_count{};
+
+    /// Node index of every channel.
+    std::vector<std::uint32_t> node_indices;
+
+    /// Per channel minimum of the position track.
+    std::vector<math::vec3> position_min;
+    /// Per channel size of the position track range.
+    std::vector<math::vec3> position_extent;
+
+    /// Per channel minimum of the scaling track.
+    std::vector<math::vec3> scaling_min;
+    /// Per channel size of the scaling track range.
+    std::vector<math::vec3> scaling_extent;
+
+    /// Quantized positions, [channel][frame][xyz].
+    std::vector<std::uint16_t> positions;
+    /// Smallest three rotations, [channel][frame][3].
+    std::vector<std::uint16_t> rotations;
+    /// Quantized scalings, [channel][frame][xyz].
+    std::vector<std::uint16_t> scalings;
+
+    auto empty() const -> bool
+    {
+        return frame_count == 0 || node_indices.empty();
+    }
+
+    auto get_channel_count() const -> size_t
+    {
+        return node_indices.size();
+    }
+};
+
+/**
+ * @brief Playback state of a compressed clip kept between frames.
+ *
+ * Holds the two decoded frames surrounding the last sampled time. They are decoded again
+ * only when playback crosses into another frame.
+ */
+struct animation_cursor
+{
+    /// The clip the decoded frames belong to.
+    const compressed_animation_clip* clip{};
+
+    /// Index of the frame decoded into the 'from' arrays.
+    std::uint32_t frame{};
+
+    /// Whether the decoded frames are valid.
+    bool valid{};
+
+    std::vector<math::vec3> from_positions;
+    std::vector<math::quat> from_rotations;
+    std::vector<math::vec3> from_scalings;
+
+    std::vector<math::vec3> to_positions;
+    std::vector<math::quat> to_rotations;
+    std::vector<math::vec3> to_scalings;
+
+    /// Interpolation factor between the two decoded frames.
+    float factor{};
+};
+
 /**
  * @brief Struct representing an animation.
  *
@@ -65,7 +142,38 @@ struct animation_clip
     seconds_t duration = seconds_t(0);
 
     /// The node animation_clip channels. Each channel affects a single node.
+    /// Cooked clips keep only the channel names, the keys live in the compressed tracks.
     std::vector<animation_channel> channels;
+
+    /// The resampled and quantized tracks used for playback.
+    compressed_animation_clip compressed;
 };
 
+/**
+ * @brief Builds the runtime representation of the clip.
+ * @param clip The source clip with full keyframes.
+ * @param sample_rate Samples per second of the resampled tracks.
+ * @return The compressed clip.
+ */
+auto compress_animation_clip(const animation_clip& clip, float sample_rate = 30.0f) -> compressed_animation_clip;
+
+/**
+ * @brief Drops the keyframes of every channel once the clip has been compressed.
+ * @param clip The clip to strip.
+ */
+void strip_animation_keys(animation_clip& clip);
+
+/**
+ * @brief Decodes the frames around a time into the cursor.
+ *
+ * Both frames are decoded in a single linear pass over the channel tracks, and nothing is
+ * decoded while the time stays within the frame of the previous call.
+ * @param clip The compressed clip.
+ * @param time The time to sample.
+ * @param cursor The cursor carried between frames.
+ */
+void advance_cursor(const compressed_animation_clip& clip,
+                    animation_channel::seconds_t time,
+                    animation_cursor& cursor);
+
 } // namespace ace
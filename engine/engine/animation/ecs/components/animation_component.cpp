@@ -1,5 +1,8 @@
 #include "animation_component.h"
 #include <hpp/utility/overload.hpp>
+
+#include <algorithm>
+
 namespace ace
 {
 
@@ -296,6 +299,7 @@ void animation_player::blend_to(const asset_handle<animation_clip>& clip,
 
     target_layer_.state.clip = clip;
     target_layer_.state.elapsed = seconds_t(0);
+    target_layer_.state.cursor = {};
 
     // Set blending parameters
     blend_state_.state = blend_over_time{duration};
@@ -359,31 +363,114 @@ void animation_player::update(seconds_t delta_time, const update_callback_t& set
         return;
     }
 
-    // Update times
-    if(playing_ && !paused_)
+    bool throttled = update_interval_ > 1 && !force;
+
+    pending_time_ += delta_time;
+
+    if(throttled && frames_until_sample_ > 0 && !interpolation_to_.nodes.empty())
     {
-        update_state(delta_time, current_layer_.state);
+        // Between two samples, move towards the last sampled pose.
+        float factor = float(update_interval_ - frames_until_sample_) / float(update_interval_);
+        --frames_until_sample_;
 
-        update_state(delta_time, target_layer_.state);
+        blend_poses(interpolation_from_, interpolation_to_, factor, interpolation_pose_);
 
+        for(const auto& node : interpolation_pose_.nodes)
+        {
+            set_transform_callback(node.index, node.transform);
+        }
+        return;
+    }
+
+    update_time(pending_time_);
+    pending_time_ = seconds_t(0);
 
-        // update overtime parameters
-        hpp::visit(hpp::overload(
-                       [&](blend_over_time& state)
-                       {
-                           state.elapsed += delta_time;
-                       },
-                       [](auto& state)
-                       {
+    const auto& final_pose = evaluate_pose();
 
-                       }),
-                   blend_state_.state);
+    const animation_pose* applied_pose = &final_pose;
+    if(throttled)
+    {
+        // Interpolation trails the sampled pose by one interval so it never has to extrapolate.
+        interpolation_from_ = interpolation_to_.nodes.empty() ? final_pose : interpolation_to_;
+        interpolation_to_ = final_pose;
+        frames_until_sample_ = update_interval_ - 1;
+        applied_pose = &interpolation_from_;
+    }
+
+    // Apply the final pose using the callback
+    for(const auto& node : applied_pose->nodes)
+    {
+        set_transform_callback(node.index, node.transform);
+    }
+}
+
+void animation_player::advance(seconds_t delta_time)
+{
+    if((!current_layer_.is_valid() && !target_layer_.is_valid()) || !is_playing())
+    {
+        return;
+    }
+
+    update_time(pending_time_ + delta_time);
+    pending_time_ = seconds_t(0);
+
+    // The last sampled pose is stale once the model becomes visible again.
+    reset_interpolation();
+}
+
+void animation_player::set_update_interval(uint32_t frames)
+{
+    frames = std::max<uint32_t>(frames, 1);
+    if(update_interval_ == frames)
+    {
+        return;
+    }
+
+    update_interval_ = frames;
+    reset_interpolation();
+}
+
+auto animation_player::get_update_interval() const -> uint32_t
+{
+    return update_interval_;
+}
+
+void animation_player::reset_interpolation()
+{
+    frames_until_sample_ = 0;
+    interpolation_to_.nodes.clear();
+}
+
+void animation_player::update_time(seconds_t delta_time)
+{
+    if(!playing_ || paused_)
+    {
+        return;
     }
 
+    update_state(delta_time, current_layer_.state);
+
+    update_state(delta_time, target_layer_.state);
+
+    // update overtime parameters
+    hpp::visit(hpp::overload(
+                   [&](blend_over_time& state)
+                   {
+                       state.elapsed += delta_time;
+                   },
+                   [](auto& state)
+                   {
+
+                   }),
+               blend_state_.state);
+}
+
+auto animation_player::evaluate_pose() -> const animation_pose&
+{
     // Update current layer
     update_pose(current_layer_);
 
-    auto final_pose = &current_layer_.pose;
+    const animation_pose* final_pose = &current_layer_.pose;
 
     // Update target layer
     if(update_pose(target_layer_))
@@ -406,11 +493,7 @@ void animation_player::update(seconds_t delta_time, const update_callback_t& set
         }
     }
 
-    // Apply the final pose using the callback
-    for(const auto& node : final_pose->nodes)
-    {
-        set_transform_callback(node.index, node.transform);
-    }
+    return *final_pose;
 }
 
 auto animation_player::update_pose(animation_layer& layer) -> bool
@@ -426,10 +509,14 @@ auto animation_player::update_pose(animation_layer& layer) -> bool
 
         // Sample animations and blend poses
         state.blend_poses.resize(state.blend_clips.size());
+        state.blend_cursors.resize(state.blend_clips.size());
         for(size_t i = 0; i < state.blend_clips.size(); ++i)
         {
             const auto& clip_weight_pair = state.blend_clips[i];
-            sample_animation(clip_weight_pair.first.get().get(), state.elapsed, state.blend_poses[i]);
+            sample_animation(clip_weight_pair.first.get().get(),
+                             state.elapsed,
+                             state.blend_cursors[i],
+                             state.blend_poses[i]);
         }
 
         // Blend all poses based on their weights
@@ -453,7 +540,7 @@ auto animation_player::update_pose(animation_layer& layer) -> bool
     }
     else if(state.clip)
     {
-        sample_animation(state.clip.get().get(), state.elapsed, pose);
+        sample_animation(state.clip.get().get(), state.elapsed, state.cursor, pose);
         return true;
     }
 
@@ -507,8 +594,36 @@ auto animation_player::compute_blend_factor(float normalized_blend_time) noexcep
 
 void animation_player::sample_animation(const animation_clip* anim_clip,
                                         seconds_t time,
+                                        animation_cursor& cursor,
                                         animation_pose& pose) const noexcept
 {
+    const auto& compressed = anim_clip->compressed;
+    if(!compressed.empty())
+    {
+        advance_cursor(compressed, time, cursor);
+
+        const size_t channels = compressed.get_channel_count();
+        const float factor = cursor.factor;
+
+        pose.nodes.resize(channels);
+        for(size_t i = 0; i < channels; ++i)
+        {
+            // Frames are close together, a normalized lerp is indistinguishable from slerp here.
+            auto to_rotation = cursor.to_rotations[i];
+            if(math::dot(cursor.from_rotations[i], to_rotation) < 0.0f)
+            {
+                to_rotation = -to_rotation;
+            }
+
+            auto& node = pose.nodes[i];
+            node.index = compressed.node_indices[i];
+            node.transform.set_position(math::lerp(cursor.from_positions[i], cursor.to_positions[i], factor));
+            node.transform.set_rotation(math::normalize(math::lerp(cursor.from_rotations[i], to_rotation, factor)));
+            node.transform.set_scale(math::lerp(cursor.from_scalings[i], cursor.to_scalings[i], factor));
+        }
+        return;
+    }
+
     pose.nodes.clear();
     pose.nodes.reserve(anim_clip->channels.size());
 
@@ -566,6 +681,44 @@ auto animation_component::get_culling_mode() const -> const culling_mode&
     return culling_mode_;
 }
 
+void animation_component::set_lod_levels(const std::vector<lod_level>& levels)
+{
+    lod_levels_ = levels;
+
+    // Levels are picked by the first one the screen size reaches.
+    std::stable_sort(std::begin(lod_levels_),
+                     std::end(lod_levels_),
+                     [](const lod_level& lhs, const lod_level& rhs)
+                     {
+                         return lhs.min_screen_percent > rhs.min_screen_percent;
+                     });
+}
+
+auto animation_component::get_lod_levels() const -> const std::vector<lod_level>&
+{
+    return lod_levels_;
+}
+
+auto animation_component::get_lod_level(float screen_percent) const -> const lod_level&
+{
+    static const lod_level full_rate{};
+
+    for(const auto& level : lod_levels_)
+    {
+        if(screen_percent >= level.min_screen_percent)
+        {
+            return level;
+        }
+    }
+
+    return lod_levels_.empty() ? full_rate : lod_levels_.back();
+}
+
+auto animation_component::get_node_depths() -> node_depth_cache&
+{
+    return node_depths_;
+}
+
 auto animation_component::get_player() const -> const animation_player&
 {
     return player_;
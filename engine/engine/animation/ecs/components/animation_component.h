@@ -10,6 +10,8 @@
 #include <hpp/variant.hpp>
 #include <math/math.h>
 
+#include <limits>
+
 namespace ace
 {
 
@@ -64,10 +66,14 @@ struct animation_state
     asset_handle<animation_clip> clip{};
     animation_clip::seconds_t elapsed{};
 
+    /// Decoded frames of the clip carried between updates.
+    animation_cursor cursor{};
+
     // Add blend space support
     std::shared_ptr<blend_space_def> blend_space{};
     std::vector<std::pair<asset_handle<animation_clip>, float>> blend_clips{};
     std::vector<animation_pose> blend_poses{};
+    std::vector<animation_cursor> blend_cursors{};
 };
 
 struct blend_over_time
@@ -155,6 +161,29 @@ public:
      */
     void update(seconds_t delta_time, const update_callback_t& set_transform_callback, bool force = false);
 
+    /**
+     * @brief Advances the animation time without sampling or applying any pose.
+     *
+     * Used while the animated model is culled so playback stays in sync once it is visible again.
+     * @param delta_time The time to advance the animation by.
+     */
+    void advance(seconds_t delta_time);
+
+    /**
+     * @brief Sets how often the animation is sampled.
+     *
+     * With an interval above 1 the pose is sampled every N updates and the updates in between
+     * interpolate towards the last sampled pose.
+     * @param frames The number of updates between two samples.
+     */
+    void set_update_interval(uint32_t frames);
+
+    /**
+     * @brief Gets how often the animation is sampled.
+     * @return The number of updates between two samples.
+     */
+    auto get_update_interval() const -> uint32_t;
+
     /**
      * @brief Returns whether the animation is currently playing.
      *
@@ -183,11 +212,17 @@ private:
     };
 
 
-    void sample_animation(const animation_clip* anim_clip, seconds_t time, animation_pose& pose) const noexcept;
+    void sample_animation(const animation_clip* anim_clip,
+                          seconds_t time,
+                          animation_cursor& cursor,
+                          animation_pose& pose) const noexcept;
     auto compute_blend_factor(float normalized_blend_time) noexcept -> float;
     void update_state(seconds_t delta_time, animation_state& state);
     auto get_blend_progress() const -> float;
     auto update_pose(animation_layer& layer) -> bool;
+    auto evaluate_pose() -> const animation_pose&;
+    void update_time(seconds_t delta_time);
+    void reset_interpolation();
 
 
     animation_layer current_layer_{};
@@ -197,10 +232,33 @@ private:
     animation_pose blend_pose_{};
     blend_state blend_state_{};
 
+    /// Reduced rate sampling
+    uint32_t update_interval_{1};
+    uint32_t frames_until_sample_{};
+    seconds_t pending_time_{};
+    animation_pose interpolation_from_{};
+    animation_pose interpolation_to_{};
+    animation_pose interpolation_pose_{};
+
     bool playing_{};
     bool paused_{};
 };
 
+/**
+ * @brief Update settings used by renderer based culling for a range of screen sizes.
+ */
+struct animation_lod_level
+{
+    /// Minimum screen height of the model, in percent of the viewport, for this level.
+    float min_screen_percent{};
+
+    /// The animation is sampled every N frames and interpolated in between.
+    uint32_t update_interval{1};
+
+    /// Armature nodes deeper than this keep their last pose.
+    uint32_t max_node_depth{std::numeric_limits<uint32_t>::max()};
+};
+
 class animation_component : public component_crtp<animation_component>
 {
 public:
@@ -210,6 +268,19 @@ public:
         renderer_based,
     };
 
+    using lod_level = animation_lod_level;
+
+    /**
+     * @brief Hierarchy depth of every armature node, cached by the animation system.
+     */
+    struct node_depth_cache
+    {
+        /// Parent of every node when the depths were computed, a change invalidates them.
+        std::vector<entt::entity> parents;
+        /// Depths indexed by node index.
+        std::vector<uint8_t> depths;
+    };
+
     /**
      * @brief Sets whether the animation should autoplay.
      * @param on True to autoplay, false otherwise.
@@ -228,6 +299,26 @@ public:
     void set_culling_mode(const culling_mode& animation);
     auto get_culling_mode() const -> const culling_mode&;
 
+    /**
+     * @brief Sets the LOD levels used with renderer based culling.
+     * @param levels The levels, they are sorted from the largest screen size to the smallest.
+     */
+    void set_lod_levels(const std::vector<lod_level>& levels);
+    auto get_lod_levels() const -> const std::vector<lod_level>&;
+
+    /**
+     * @brief Picks the LOD level for the given screen size.
+     * @param screen_percent Screen height of the model in percent of the viewport.
+     * @return The matching level.
+     */
+    auto get_lod_level(float screen_percent) const -> const lod_level&;
+
+    /**
+     * @brief Gets the cached hierarchy depths of the armature nodes.
+     * @return The cache, kept up to date by the animation system.
+     */
+    auto get_node_depths() -> node_depth_cache&;
+
     auto get_player() const -> const animation_player&;
     auto get_player() -> animation_player&;
 
@@ -238,6 +329,12 @@ private:
 
     culling_mode culling_mode_{culling_mode::always_animate};
     bool auto_play_ = true;
+
+    std::vector<lod_level> lod_levels_{{20.0f, 1},
+                                       {8.0f, 2},
+                                       {3.0f, 3, 8},
+                                       {0.0f, 4, 5}};
+    node_depth_cache node_depths_;
 };
 
 } // namespace ace
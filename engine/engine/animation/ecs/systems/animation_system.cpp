@@ -17,6 +17,57 @@
 namespace ace
 {
 
+namespace
+{
+
+/**
+ * @brief Caches the hierarchy depth of every armature node below the model.
+ * The depths are recomputed when the armature changes or one of its nodes is reparented.
+ */
+void update_node_depths(const model_component& model_comp, animation_component::node_depth_cache& cache)
+{
+    const auto& armature = model_comp.get_armature_entities();
+
+    bool valid = cache.parents.size() == armature.size();
+    for(size_t i = 0; valid && i < armature.size(); ++i)
+    {
+        auto parent = armature[i] ? armature[i].get<transform_component>().get_parent() : entt::handle{};
+        valid = parent.entity() == cache.parents[i];
+    }
+
+    if(valid)
+    {
+        return;
+    }
+
+    auto owner = model_comp.get_owner();
+
+    cache.parents.resize(armature.size());
+    cache.depths.resize(armature.size());
+    for(size_t i = 0; i < armature.size(); ++i)
+    {
+        uint32_t depth = 0;
+
+        entt::handle node = armature[i];
+        cache.parents[i] = node ? node.get<transform_component>().get_parent().entity() : entt::entity{entt::null};
+
+        while(node)
+        {
+            auto parent = node.get<transform_component>().get_parent();
+            if(!parent || parent.entity() == owner.entity())
+            {
+                break;
+            }
+            ++depth;
+            node = parent;
+        }
+
+        cache.depths[i] = uint8_t(std::min<uint32_t>(depth, std::numeric_limits<uint8_t>::max()));
+    }
+}
+
+} // namespace
+
 auto animation_system::init(rtti::context& ctx) -> bool
 {
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
@@ -143,19 +194,47 @@ void animation_system::on_update(scene& scn, delta_t dt, bool force)
                       auto& animation_comp = view.get<animation_component>(entity);
                       auto& model_comp = view.get<model_component>(entity);
 
-                      if(animation_comp.get_culling_mode() == animation_component::culling_mode::renderer_based)
-                      {
-                          return;
-                      }
-
                       auto& player = animation_comp.get_player();
 
                       player.blend_to(animation_comp.get_animation());
 
+                      uint32_t max_node_depth = std::numeric_limits<uint32_t>::max();
+
+                      if(!force &&
+                         animation_comp.get_culling_mode() == animation_component::culling_mode::renderer_based)
+                      {
+                          if(!model_comp.was_used_last_frame())
+                          {
+                              // Not visible, keep the time running but skip sampling entirely.
+                              player.advance(dt);
+                              return;
+                          }
+
+                          const auto& lod = animation_comp.get_lod_level(model_comp.get_render_screen_percent());
+                          player.set_update_interval(lod.update_interval);
+                          max_node_depth = lod.max_node_depth;
+                      }
+                      else
+                      {
+                          player.set_update_interval(1);
+                      }
+
+                      auto& node_depths = animation_comp.get_node_depths();
+                      if(max_node_depth < std::numeric_limits<uint8_t>::max())
+                      {
+                          update_node_depths(model_comp, node_depths);
+                      }
+
                       player.update(
                           dt,
                           [&](/*const std::string& node_id, */ size_t node_index, const math::transform& transform)
                           {
+                              if(node_index < node_depths.depths.size() &&
+                                 node_depths.depths[node_index] > max_node_depth)
+                              {
+                                  return;
+                              }
+
                               auto armature = model_comp.get_armature_by_index(node_index);
                               if(armature)
                               {
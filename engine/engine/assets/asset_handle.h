@@ -22,6 +22,7 @@ template<typename T>
 struct asset_link
 {
     using task_future_t = task_future<std::shared_ptr<T>>;
+    using create_future_t = itc::shared_future<std::shared_ptr<T>>;
     using weak_asset_t = std::weak_ptr<T>;
 
     /// Unique identifier for the asset.
@@ -30,6 +31,8 @@ struct asset_link
     std::string id{};
     /// Task future for the asset.
     task_future_t task{};
+    /// Main thread continuation creating the asset from the result of the task, if any.
+    create_future_t create_task{};
     /// Weak pointer to the asset.
     weak_asset_t weak_asset{};
 };
@@ -125,7 +128,7 @@ struct asset_handle
                 link_->task.change_priority(itc::priority::high());
             }
 
-            auto value = link_->task.get();
+            auto value = link_->create_task.valid() ? link_->create_task.get() : link_->task.get();
 
             if(value)
             {
@@ -153,7 +156,8 @@ struct asset_handle
      */
     auto is_ready() const -> bool
     {
-        return is_valid() && link_->task.is_ready();
+        return is_valid() && link_->task.is_ready() &&
+               (!link_->create_task.valid() || link_->create_task.is_ready());
     }
 
     /**
@@ -173,11 +177,14 @@ struct asset_handle
     /**
      * @brief Sets the internal job future.
      * @param future The task future to set.
+     * @param create_future The main thread continuation creating the asset, if any.
      */
-    void set_internal_job(const typename asset_link_t::task_future_t& future)
+    void set_internal_job(const typename asset_link_t::task_future_t& future,
+                          const typename asset_link_t::create_future_t& create_future = {})
     {
         ensure();
         link_->task = future;
+        link_->create_task = create_future;
         link_->weak_asset = {};
     }
 
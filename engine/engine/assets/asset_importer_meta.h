@@ -0,0 +1,115 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <reflection/registration.h>
+#include <serialization/serialization.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace ace
+{
+
+/**
+ * @struct asset_importer_meta
+ * @brief Base class for per asset import settings stored in the asset meta file.
+ */
+struct asset_importer_meta
+{
+    SERIALIZABLE(asset_importer_meta)
+    REFLECTABLEV(asset_importer_meta)
+
+    using sptr = std::shared_ptr<asset_importer_meta>;
+
+    asset_importer_meta() = default;
+    virtual ~asset_importer_meta() = default;
+};
+
+/**
+ * @struct texture_importer_meta
+ * @brief Import settings used when compiling a texture.
+ */
+struct texture_importer_meta : asset_importer_meta
+{
+    SERIALIZABLE(texture_importer_meta)
+    REFLECTABLEV(texture_importer_meta, asset_importer_meta)
+
+    /**
+     * @enum texture_type
+     * @brief What the texture contains.
+     */
+    enum class texture_type : std::uint8_t
+    {
+        automatic,  ///< Detected from the file name and contents.
+        color,      ///< sRGB color data.
+        normal_map, ///< Tangent space normals.
+        linear,     ///< Linear data like masks, roughness or metalness.
+    };
+
+    /**
+     * @enum compression_format
+     * @brief Format of the compiled texture.
+     */
+    enum class compression_format : std::uint8_t
+    {
+        automatic, ///< Picked from the texture type and alpha channel.
+        none,      ///< Uncompressed BGRA8.
+        bc1,       ///< RGB, 4 bpp.
+        bc3,       ///< RGBA, 8 bpp.
+        bc4,       ///< Single channel, 4 bpp.
+        bc5,       ///< Two channels, 8 bpp.
+        bc7,       ///< High quality RGBA, 8 bpp.
+        etc2,      ///< RGB, 4 bpp.
+        etc2a,     ///< RGBA, 8 bpp.
+        astc4x4,   ///< RGBA, 8 bpp.
+        astc6x6,   ///< RGBA, 3.56 bpp.
+        astc8x8,   ///< RGBA, 2 bpp.
+    };
+
+    /**
+     * @enum compression_quality
+     * @brief Quality preset of the encoder.
+     */
+    enum class compression_quality : std::uint8_t
+    {
+        fast,    ///< Fastest encoding, lowest quality.
+        normal,  ///< Default encoder settings.
+        highest, ///< Slowest encoding, best quality.
+    };
+
+    /// What the texture contains.
+    texture_type type{texture_type::automatic};
+    /// Format of the compiled texture.
+    compression_format format{compression_format::automatic};
+    /// Quality preset of the encoder.
+    compression_quality quality{compression_quality::normal};
+    /// Generate the full mip chain.
+    bool generate_mipmaps{true};
+    /// Max width/height of the compiled texture, 0 keeps the source size.
+    std::uint32_t max_size{0};
+};
+
+/**
+ * @struct audio_importer_meta
+ * @brief Import settings used when compiling an audio clip.
+ */
+struct audio_importer_meta : asset_importer_meta
+{
+    SERIALIZABLE(audio_importer_meta)
+    REFLECTABLEV(audio_importer_meta, asset_importer_meta)
+
+    /**
+     * @enum load_type
+     * @brief How the clip is stored and played.
+     */
+    enum class load_type : std::uint8_t
+    {
+        preload, ///< Uncompressed PCM uploaded to the device as a whole. Best for short effects.
+        stream,  ///< Compressed on disk and streamed to the device in chunks. Best for music and ambience.
+    };
+
+    /// How the clip is stored and played.
+    load_type load{load_type::preload};
+};
+
+} // namespace ace
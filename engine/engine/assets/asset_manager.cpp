@@ -202,6 +202,11 @@ auto asset_manager::get_metadata(const hpp::uuid& uid) -> asset_database::meta
     return {};
 }
 
+auto asset_manager::get_reload_version() const -> std::uint64_t
+{
+    return reload_version_;
+}
+
 void asset_manager::remove_asset_info_for_path(const fs::path& path)
 {
     auto key = fs::convert_to_protocol(path).generic_string();
@@ -3,6 +3,7 @@
 
 #include "asset_flags.h"
 #include "asset_storage.h"
+#include <atomic>
 #include <cassert>
 #include <map>
 #include <mutex>
@@ -109,6 +110,12 @@ public:
      */
     auto get_metadata(const hpp::uuid& uid) -> asset_database::meta;
 
+    /**
+     * @brief Gets a counter bumped whenever an asset is reloaded.
+     * @return The number of reloads so far.
+     */
+    auto get_reload_version() const -> std::uint64_t;
+
     /**
      * @brief Adds a storage for a specific type.
      * @tparam S The type of storage.
@@ -371,6 +378,11 @@ private:
                 handle.invalidate();
             }
 
+            if(flags == load_flags::reload)
+            {
+                ++reload_version_;
+            }
+
             handle.set_internal_ids(uid, key);
             load_func(pool_, handle, key);
         }
@@ -484,6 +496,8 @@ private:
     std::map<std::string, asset_database, std::less<>> databases_{};
     /// Parent asset manager.
     asset_manager* parent_{};
+    /// Number of reloads so far.
+    std::atomic<std::uint64_t> reload_version_{};
 };
 
 } // namespace ace
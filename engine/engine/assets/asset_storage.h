@@ -1,6 +1,7 @@
 #pragma once
 
 #include "asset_handle.h"
+#include "asset_importer_meta.h"
 
 #include <context/context.hpp>
 #include <hpp/event.hpp>
@@ -24,6 +25,8 @@ struct asset_meta
     hpp::uuid uid{};
     /// Type of the asset.
     std::string type{};
+    /// Import settings of the asset, null for types without any.
+    asset_importer_meta::sptr importer{};
 };
 
 /**
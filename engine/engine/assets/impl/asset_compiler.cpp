@@ -1,5 +1,8 @@
 #include "asset_compiler.h"
+#include "asset_extensions.h"
+#include "asset_reader.h"
 #include "importers/mesh_importer.h"
+#include "importers/mesh_processing.h"
 
 #include <bx/error.h>
 #include <bx/process.h>
@@ -7,13 +10,19 @@
 
 #include <graphics/shader.h>
 #include <graphics/texture.h>
+#include <graphics/utils/bgfx_utils.h>
 #include <logging/logging.h>
+#include <math/math.h>
+#include <string_utils/utils.h>
 #include <uuid/uuid.h>
 
+#include <base/hash.hpp>
+
 #include <serialization/associative_archive.h>
 #include <serialization/binary_archive.h>
 
 #include <engine/meta/animation/animation.hpp>
+#include <engine/meta/assets/asset_database.hpp>
 #include <engine/meta/audio/audio_clip.hpp>
 #include <engine/meta/ecs/entity.hpp>
 #include <engine/meta/physics/physics_material.hpp>
@@ -26,8 +35,14 @@
 #include <monopp/mono_jit.h>
 #include <subprocess/subprocess.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
 
 namespace ace::asset_compiler
 {
@@ -78,6 +93,437 @@ auto run_process(const std::string& process, const std::vector<std::string>& arg
 
     return result.retcode == 0;
 }
+
+/**
+ * @struct texture_properties
+ * @brief Properties of a source texture used to pick its compiled format.
+ */
+struct texture_properties
+{
+    /// The resolved texture type, never automatic.
+    texture_importer_meta::texture_type type{texture_importer_meta::texture_type::color};
+    /// Does any texel have alpha below 1.
+    bool has_alpha{};
+    /// Are all channels equal.
+    bool grayscale{};
+};
+
+auto has_normal_map_suffix(const fs::path& path) -> bool
+{
+    auto name = string_utils::to_lower(path.stem().string());
+
+    static const std::array<const char*, 7> suffixes = {
+        "_n",
+        "_nm",
+        "_nrm",
+        "_norm",
+        "_normal",
+        "_normals",
+        "_normalmap",
+    };
+
+    return std::any_of(std::begin(suffixes),
+                       std::end(suffixes),
+                       [&](const char* suffix)
+                       {
+                           return hpp::string_view(name).ends_with(suffix);
+                       });
+}
+
+auto get_texture_properties(const fs::path& path, const texture_importer_meta& settings) -> texture_properties
+{
+    texture_properties properties;
+    properties.type = settings.type;
+
+    bimg::ImageContainer* image = imageLoad(path.string().c_str(), bgfx::TextureFormat::RGBA8);
+    if(image == nullptr)
+    {
+        if(properties.type == texture_importer_meta::texture_type::automatic)
+        {
+            properties.type = has_normal_map_suffix(path) ? texture_importer_meta::texture_type::normal_map
+                                                          : texture_importer_meta::texture_type::color;
+        }
+        return properties;
+    }
+
+    // Sample a grid of texels, enough to classify the texture without touching all of it.
+    const std::uint32_t samples_per_side = std::min<std::uint32_t>(64, std::min(image->m_width, image->m_height));
+    const auto* texels = static_cast<const std::uint8_t*>(image->m_data);
+
+    std::uint32_t samples = 0;
+    std::uint32_t unit_length_samples = 0;
+    std::uint32_t gray_samples = 0;
+    float sum_z = 0.0f;
+
+    for(std::uint32_t y = 0; y < samples_per_side; ++y)
+    {
+        for(std::uint32_t x = 0; x < samples_per_side; ++x)
+        {
+            const auto px = (x * image->m_width) / samples_per_side;
+            const auto py = (y * image->m_height) / samples_per_side;
+            const auto* texel = texels + (py * image->m_width + px) * 4;
+
+            properties.has_alpha |= texel[3] < 255;
+
+            const int dr = int(texel[0]) - int(texel[1]);
+            const int dg = int(texel[1]) - int(texel[2]);
+            if(std::abs(dr) <= 2 && std::abs(dg) <= 2)
+            {
+                gray_samples++;
+            }
+
+            const math::vec3 n = math::vec3(texel[0], texel[1], texel[2]) / 127.5f - 1.0f;
+            const float length = math::length(n);
+            if(length > 0.9f && length < 1.1f)
+            {
+                unit_length_samples++;
+            }
+
+            sum_z += n.z;
+            samples++;
+        }
+    }
+
+    bimg::imageFree(image);
+
+    if(samples > 0)
+    {
+        properties.grayscale = gray_samples == samples;
+
+        if(properties.type == texture_importer_meta::texture_type::automatic)
+        {
+            // Tangent space normals are unit length and mostly point up the z axis.
+            const bool looks_like_normal_map =
+                float(unit_length_samples) >= float(samples) * 0.9f && sum_z / float(samples) > 0.5f;
+
+            properties.type = has_normal_map_suffix(path) || looks_like_normal_map
+                                  ? texture_importer_meta::texture_type::normal_map
+                                  : texture_importer_meta::texture_type::color;
+        }
+    }
+
+    if(properties.type == texture_importer_meta::texture_type::automatic)
+    {
+        properties.type = texture_importer_meta::texture_type::color;
+    }
+
+    return properties;
+}
+
+auto get_texturec_format(const texture_importer_meta& settings, const texture_properties& properties) -> std::string
+{
+    using format = texture_importer_meta::compression_format;
+
+    switch(settings.format)
+    {
+        case format::none:
+            return "BGRA8";
+        case format::bc1:
+            return "BC1";
+        case format::bc3:
+            return "BC3";
+        case format::bc4:
+            return "BC4";
+        case format::bc5:
+            return "BC5";
+        case format::bc7:
+            return "BC7";
+        case format::etc2:
+            return "ETC2";
+        case format::etc2a:
+            return "ETC2A";
+        case format::astc4x4:
+            return "ASTC4x4";
+        case format::astc6x6:
+            return "ASTC6x6";
+        case format::astc8x8:
+            return "ASTC8x8";
+        default:
+            break;
+    }
+
+    if(properties.type == texture_importer_meta::texture_type::normal_map)
+    {
+        return "BC5";
+    }
+
+    if(properties.type == texture_importer_meta::texture_type::linear && properties.grayscale &&
+       !properties.has_alpha)
+    {
+        return "BC4";
+    }
+
+    if(settings.quality == texture_importer_meta::compression_quality::highest)
+    {
+        return "BC7";
+    }
+
+    return properties.has_alpha ? "BC3" : "BC1";
+}
+
+auto get_texturec_quality(texture_importer_meta::compression_quality quality) -> std::string
+{
+    switch(quality)
+    {
+        case texture_importer_meta::compression_quality::fast:
+            return "fastest";
+        case texture_importer_meta::compression_quality::highest:
+            return "highest";
+        default:
+            return "default";
+    }
+}
+
+/// Bump when compiler changes require all assets to be recompiled.
+constexpr std::uint32_t compiler_version = 8;
+
+auto get_compile_key_path(const fs::path& output) -> fs::path
+{
+    auto protocol_path = fs::convert_to_protocol(output).generic_string();
+    auto key_path = fs::resolve_protocol(fs::replace(protocol_path, ":/compiled", ":/cache"));
+    key_path += ".key";
+    return key_path;
+}
+
+auto read_file(const fs::path& path) -> std::string
+{
+    std::ifstream stream(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+auto get_tool_version(const std::string& tool) -> std::string
+{
+    static std::mutex versions_mutex;
+    static std::map<std::string, std::string> versions;
+
+    std::lock_guard<std::mutex> lock(versions_mutex);
+    auto it = versions.find(tool);
+    if(it == versions.end())
+    {
+        std::string version;
+        run_process(tool, {"--version"}, false, version);
+        it = versions.emplace(tool, version).first;
+    }
+
+    return it->second;
+}
+
+auto get_tool(const std::string& ext) -> std::string
+{
+    if(ex::is_format<gfx::shader>(ext))
+    {
+        return "shaderc";
+    }
+
+    if(ex::is_format<gfx::texture>(ext))
+    {
+        return "texturec";
+    }
+
+    return {};
+}
+
+void add_dependency(const fs::path& dependency, std::set<fs::path>& dependencies)
+{
+    fs::error_code err;
+    auto path = fs::absolute(dependency, err).lexically_normal();
+    if(fs::exists(path, err))
+    {
+        dependencies.emplace(path);
+    }
+}
+
+void get_shader_includes(const fs::path& path, std::set<fs::path>& processed)
+{
+    std::ifstream file(path);
+    if(!file.is_open())
+    {
+        return;
+    }
+
+    const std::string include_keyword = "#include";
+
+    std::string line;
+    while(std::getline(file, line))
+    {
+        line.erase(0, line.find_first_not_of(" \t"));
+
+        if(line.compare(0, include_keyword.length(), include_keyword) != 0)
+        {
+            continue;
+        }
+
+        // System includes like <bgfx_shader.sh> belong to the toolchain.
+        size_t start = line.find('"');
+        size_t end = line.rfind('"');
+        if(start == std::string::npos || end == std::string::npos || start >= end)
+        {
+            continue;
+        }
+
+        fs::error_code err;
+        auto include = fs::absolute(path.parent_path() / line.substr(start + 1, end - start - 1), err).lexically_normal();
+        if(processed.insert(include).second)
+        {
+            get_shader_includes(include, processed);
+        }
+    }
+}
+
+void get_mesh_dependencies(const fs::path& path, std::set<fs::path>& dependencies)
+{
+    // Only text formats reference external files that change the import result.
+    const auto ext = string_utils::to_lower(path.extension().string());
+    const auto dir = path.parent_path();
+
+    if(ext == ".obj")
+    {
+        std::ifstream file(path);
+        std::string line;
+        while(std::getline(file, line))
+        {
+            if(hpp::string_view(line).starts_with("mtllib "))
+            {
+                auto mtl = dir / string_utils::trim(line.substr(7));
+                add_dependency(mtl, dependencies);
+
+                // Textures referenced by the material library.
+                std::ifstream mtl_file(mtl);
+                std::string mtl_line;
+                while(std::getline(mtl_file, mtl_line))
+                {
+                    mtl_line = string_utils::trim(mtl_line);
+                    if(hpp::string_view(mtl_line).starts_with("map_") || hpp::string_view(mtl_line).starts_with("bump") ||
+                       hpp::string_view(mtl_line).starts_with("norm"))
+                    {
+                        auto texture = mtl_line.substr(mtl_line.find_last_of(" \t") + 1);
+                        add_dependency(dir / texture, dependencies);
+                    }
+                }
+            }
+        }
+    }
+    else if(ext == ".gltf")
+    {
+        // Buffers and images referenced by uri.
+        auto content = read_file(path);
+        const std::string uri_key = "\"uri\"";
+
+        for(auto pos = content.find(uri_key); pos != std::string::npos; pos = content.find(uri_key, pos + 1))
+        {
+            auto start = content.find('"', content.find(':', pos + uri_key.size()));
+            auto end = start == std::string::npos ? start : content.find('"', start + 1);
+            if(end == std::string::npos)
+            {
+                break;
+            }
+
+            auto uri = content.substr(start + 1, end - start - 1);
+            if(!hpp::string_view(uri).starts_with("data:"))
+            {
+                add_dependency(dir / uri, dependencies);
+            }
+        }
+    }
+}
+} // namespace
+
+auto get_dependencies(const fs::path& key) -> std::vector<fs::path>
+{
+    auto absolute_path = resolve_input_file(key);
+    auto ext = absolute_path.extension().string();
+
+    std::set<fs::path> dependencies;
+
+    if(ex::is_format<gfx::shader>(ext))
+    {
+        get_shader_includes(absolute_path, dependencies);
+    }
+    else if(ex::is_format<mesh>(ext))
+    {
+        get_mesh_dependencies(absolute_path, dependencies);
+    }
+
+    return {dependencies.begin(), dependencies.end()};
+}
+
+auto get_compile_key(const fs::path& key) -> std::string
+{
+    auto absolute_path = resolve_input_file(key);
+
+    // The key is persisted, so it must be the same for every build of the editor.
+    std::uint64_t seed = utils::stable_hash_seed;
+    utils::stable_hash_combine(seed, compiler_version);
+    utils::stable_hash_combine(seed, get_tool_version(get_tool(absolute_path.extension().string())));
+    utils::stable_hash_combine(seed, read_file(absolute_path));
+    utils::stable_hash_combine(seed, read_file(key));
+
+    for(const auto& dependency : get_dependencies(key))
+    {
+        utils::stable_hash_combine(seed, dependency.generic_string());
+        utils::stable_hash_combine(seed, read_file(dependency));
+    }
+
+    return fmt::format("{:016x}", seed);
+}
+
+auto is_up_to_date(const std::string& compile_key, const fs::path& output) -> bool
+{
+    fs::error_code err;
+    if(!fs::exists(output, err))
+    {
+        return false;
+    }
+
+    return load_compile_key(output) == compile_key;
+}
+
+auto load_compile_key(const fs::path& output) -> std::string
+{
+    return read_file(get_compile_key_path(output));
+}
+
+void save_compile_key(const std::string& compile_key, const fs::path& output)
+{
+    auto key_path = get_compile_key_path(output);
+
+    fs::error_code err;
+    fs::create_directories(key_path.parent_path(), err);
+
+    std::ofstream stream(key_path, std::ios::binary);
+    stream << compile_key;
+}
+
+namespace
+{
+auto get_shader_variant_path(const fs::path& key,
+                             const fs::path& source,
+                             const fs::path& varying,
+                             const std::vector<std::string>& args_array) -> fs::path
+{
+    // The variant is looked up by name in later sessions, so the hash must be stable.
+    std::uint64_t seed = utils::stable_hash_seed;
+    utils::stable_hash_combine(seed, get_tool_version("shaderc"));
+    utils::stable_hash_combine(seed, read_file(source));
+    utils::stable_hash_combine(seed, read_file(varying));
+
+    for(const auto& dependency : get_dependencies(key))
+    {
+        utils::stable_hash_combine(seed, read_file(dependency));
+    }
+
+    // Type, platform, profile and defines. The input and output paths are skipped.
+    for(std::size_t i = 4; i < args_array.size(); ++i)
+    {
+        if(args_array[i - 1] != "-i" && args_array[i - 1] != "--varyingdef")
+        {
+            utils::stable_hash_combine(seed, args_array[i]);
+        }
+    }
+
+    auto protocol = fs::extract_protocol(fs::convert_to_protocol(key)).generic_string();
+    return fs::resolve_protocol(protocol + ":/cache/shaders/" + fmt::format("{:016x}", seed) + ".bin");
+}
 } // namespace
 
 template<>
@@ -204,6 +650,19 @@ auto compile<gfx::shader>(asset_manager& am, const fs::path& key, const fs::path
         args_array.emplace_back(str_opt);
     }
 
+    // Variants with the same sources and defines are compiled only once, even across
+    // renderers switching back and forth or the compiled folder being cleared.
+    auto variant_path = get_shader_variant_path(key, absolute_path, varying, args_array);
+    if(fs::exists(variant_path, err))
+    {
+        fs::copy_file(variant_path, output, fs::copy_options::overwrite_existing, err);
+        if(!err)
+        {
+            APPLOG_INFO("Reused cached variant of {0} -> {1}", str_input, output.string());
+            return true;
+        }
+    }
+
     std::string error;
 
     {
@@ -220,10 +679,13 @@ auto compile<gfx::shader>(asset_manager& am, const fs::path& key, const fs::path
     {
         APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
         fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
+
+        fs::create_directories(variant_path.parent_path(), err);
+        fs::copy_file(temp, variant_path, fs::copy_options::overwrite_existing, err);
     }
     fs::remove(temp, err);
 
-    return true;
+    return result;
 }
 
 template<>
@@ -240,18 +702,53 @@ auto compile<gfx::texture>(asset_manager& am, const fs::path& key, const fs::pat
 
     std::string str_output = temp.string();
 
-    const std::vector<std::string> args_array = {
+    texture_importer_meta settings;
+    {
+        asset_meta meta;
+        load_from_file(key.string(), meta);
+
+        if(auto importer = std::dynamic_pointer_cast<texture_importer_meta>(meta.importer))
+        {
+            settings = *importer;
+        }
+    }
+
+    auto properties = get_texture_properties(absolute_path, settings);
+
+    std::vector<std::string> args_array = {
         "-f",
         str_input,
         "-o",
         str_output,
         "--as",
         "ktx",
-        "-m",
         "-t",
-        "BGRA8",
+        get_texturec_format(settings, properties),
+        "-q",
+        get_texturec_quality(settings.quality),
     };
 
+    if(settings.generate_mipmaps)
+    {
+        args_array.emplace_back("-m");
+    }
+
+    if(properties.type == texture_importer_meta::texture_type::normal_map)
+    {
+        args_array.emplace_back("-n");
+    }
+
+    if(properties.type != texture_importer_meta::texture_type::color)
+    {
+        args_array.emplace_back("--linear");
+    }
+
+    if(settings.max_size > 0)
+    {
+        args_array.emplace_back("--max");
+        args_array.emplace_back(std::to_string(settings.max_size));
+    }
+
     std::string error;
 
     {
@@ -267,11 +764,11 @@ auto compile<gfx::texture>(asset_manager& am, const fs::path& key, const fs::pat
     else
     {
         APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
+        fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
     }
-    fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
     fs::remove(temp, err);
 
-    return true;
+    return result;
 }
 
 template<>
@@ -320,6 +817,14 @@ auto compile<mesh>(asset_manager& am, const fs::path& key, const fs::path& outpu
     fs::path file = absolute_path.stem();
     fs::path dir = absolute_path.parent_path();
 
+    // Already processed engine meshes are used as is.
+    if(absolute_path.extension() == ".emesh")
+    {
+        fs::copy_file(absolute_path, output, fs::copy_options::overwrite_existing, err);
+        APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
+        return !err;
+    }
+
     mesh::load_data data;
     std::vector<animation_clip> animations;
     std::vector<importer::imported_material> materials;
@@ -332,11 +837,30 @@ auto compile<mesh>(asset_manager& am, const fs::path& key, const fs::path& outpu
     }
     if(!data.vertex_data.empty())
     {
+        // Generated LODs only exist as compiled assets. Writing them to the data directory
+        // would get them picked up by the watcher and compiled again.
+        auto lods = importer::generate_lods(data);
+        data.generated_lod_count = std::uint32_t(lods.size());
+
         save_to_file_bin(str_output, data);
 
         APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
         fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
         fs::remove(temp, err);
+
+        const auto mesh_key = fs::convert_to_protocol(absolute_path).generic_string();
+        for(size_t i = 0; i < lods.size(); ++i)
+        {
+            temp = fs::temp_directory_path(err);
+            temp.append(hpp::to_string(generate_uuid()) + ".buildtemp");
+            save_to_file_bin(temp.string(), lods[i]);
+
+            const auto lod_key = mesh::get_generated_lod_key(mesh_key, std::uint32_t(i + 1));
+            const auto lod_output = asset_reader::resolve_compiled_path(lod_key);
+            fs::create_directories(lod_output.parent_path(), err);
+            fs::copy_file(temp, lod_output, fs::copy_options::overwrite_existing, err);
+            fs::remove(temp, err);
+        }
     }
 
     {
@@ -408,6 +932,11 @@ auto compile<animation_clip>(asset_manager& am, const fs::path& key, const fs::p
     animation_clip anim;
     {
         load_from_file(str_input, anim);
+
+        // The runtime only samples the compressed tracks, keep just the channel names.
+        anim.compressed = compress_animation_clip(anim);
+        strip_animation_keys(anim);
+
         save_to_file_bin(str_output, anim);
     }
 
@@ -428,10 +957,27 @@ auto compile<prefab>(asset_manager& am, const fs::path& key, const fs::path& out
     auto absolute_path = resolve_input_file(key);
     std::string str_input = absolute_path.string();
 
-    fs::error_code er;
-    fs::copy_file(absolute_path, output, fs::copy_options::overwrite_existing, er);
-    APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
-    return true;
+    fs::error_code err;
+    fs::path temp = fs::temp_directory_path(err);
+    temp /= hpp::to_string(generate_uuid()) + ".buildtemp";
+
+    std::string str_output = temp.string();
+
+    bool loaded = cook_prefab(str_input, str_output);
+
+    if(loaded)
+    {
+        fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
+        APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
+    }
+    else
+    {
+        APPLOG_ERROR("Failed compilation of {0}", str_input);
+    }
+
+    fs::remove(temp, err);
+
+    return loaded;
 }
 
 template<>
@@ -440,29 +986,27 @@ auto compile<scene_prefab>(asset_manager& am, const fs::path& key, const fs::pat
     auto absolute_path = resolve_input_file(key);
     std::string str_input = absolute_path.string();
 
-    // fs::error_code err;
-    // fs::path temp = fs::temp_directory_path(err);
-    // temp /= hpp::to_string(generate_uuid()) + ".buildtemp";
-
-    // std::string str_output = temp.string();
+    fs::error_code err;
+    fs::path temp = fs::temp_directory_path(err);
+    temp /= hpp::to_string(generate_uuid()) + ".buildtemp";
 
-    // {
-    //     scene scn;
-    //     load_from_file(str_input, scn);
-    //     save_to_file_bin(str_output, scn);
-    // }
+    std::string str_output = temp.string();
 
-    // fs::error_code er;
-    // fs::copy_file(temp, output, fs::copy_options::overwrite_existing, er);
-    // APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
+    bool loaded = cook_scene(str_input, str_output);
 
-    // fs::remove(temp, err);
+    if(loaded)
+    {
+        fs::copy_file(temp, output, fs::copy_options::overwrite_existing, err);
+        APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
+    }
+    else
+    {
+        APPLOG_ERROR("Failed compilation of {0}", str_input);
+    }
 
-    fs::error_code er;
-    fs::copy_file(absolute_path, output, fs::copy_options::overwrite_existing, er);
-    APPLOG_INFO("Successful compilation of {0} -> {1}", str_input, output.string());
+    fs::remove(temp, err);
 
-    return true;
+    return loaded;
 }
 
 template<>
@@ -507,6 +1051,17 @@ auto compile<audio_clip>(asset_manager& am, const fs::path& key, const fs::path&
 
     std::string str_output = temp.string();
 
+    audio_importer_meta settings;
+    {
+        asset_meta meta;
+        load_from_file(key.string(), meta);
+
+        if(auto importer = std::dynamic_pointer_cast<audio_importer_meta>(meta.importer))
+        {
+            settings = *importer;
+        }
+    }
+
     audio::sound_data clip;
     {
         std::string error;
@@ -517,7 +1072,9 @@ auto compile<audio_clip>(asset_manager& am, const fs::path& key, const fs::path&
         }
 
         clip.convert_to_mono();
-        save_to_file_bin(str_output, clip);
+
+        bool stream = settings.load == audio_importer_meta::load_type::stream;
+        save_to_file_bin(str_output, encode_audio_clip(std::move(clip), stream));
     }
 
     {
@@ -2,6 +2,9 @@
 #include <engine/assets/asset_manager.h>
 #include <filesystem/filesystem.h>
 
+#include <string>
+#include <vector>
+
 namespace ace
 {
 namespace asset_compiler
@@ -10,5 +13,43 @@ namespace asset_compiler
 template<typename T>
 auto compile(asset_manager& am, const fs::path& key, const fs::path& output_key) -> bool;
 
+/**
+ * @brief Gets the files besides the source that affect the compiled output,
+ * like shader includes or the material libraries, buffers and textures of a mesh.
+ * @param key The asset or its meta file.
+ * @return The absolute paths of the dependencies.
+ */
+auto get_dependencies(const fs::path& key) -> std::vector<fs::path>;
+
+/**
+ * @brief Computes the compile key of an asset. It hashes the contents of the source,
+ * its meta file with the import settings and its dependencies, plus the tool versions.
+ * @param key The meta file of the asset.
+ * @return The compile key.
+ */
+auto get_compile_key(const fs::path& key) -> std::string;
+
+/**
+ * @brief Checks if an output was compiled with the given compile key.
+ * @param compile_key The current compile key of the asset.
+ * @param output The compiled output.
+ * @return True if the output does not need recompiling.
+ */
+auto is_up_to_date(const std::string& compile_key, const fs::path& output) -> bool;
+
+/**
+ * @brief Loads the compile key an output was compiled with.
+ * @param output The compiled output.
+ * @return The compile key, empty if it was never stored.
+ */
+auto load_compile_key(const fs::path& output) -> std::string;
+
+/**
+ * @brief Stores the compile key an output was compiled with.
+ * @param compile_key The compile key computed before compiling.
+ * @param output The compiled output.
+ */
+void save_compile_key(const std::string& compile_key, const fs::path& output);
+
 } // namespace asset_compiler
 } // namespace ace
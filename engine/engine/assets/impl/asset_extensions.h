@@ -52,6 +52,13 @@ inline auto get_suported_formats<ace::audio_clip>() -> const std::vector<std::st
     return formats;
 }
 
+template<>
+inline auto get_suported_dependencies_formats<ace::mesh>() -> const std::vector<std::string>&
+{
+    static std::vector<std::string> formats = {".mtl", ".bin"};
+    return formats;
+}
+
 template<>
 inline auto get_suported_dependencies_formats<gfx::shader>() -> const std::vector<std::string>&
 {
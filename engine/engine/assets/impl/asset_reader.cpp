@@ -10,6 +10,8 @@
 #include <engine/meta/scripting/script.hpp>
 
 #include <engine/assets/asset_manager.h>
+#include <engine/engine.h>
+#include <engine/rendering/texture_streamer.h>
 
 #include <cstdint>
 #include <filesystem/filesystem.h>
@@ -93,8 +95,18 @@ auto load_from_file<gfx::texture>(itc::thread_pool& pool, asset_handle<gfx::text
         return false;
     }
 
-    auto create_resource_func = [compiled_absolute_path]()
+    // Only project textures are streamed. Engine and editor textures are
+    // used by the ui which doesn't report mip requests.
+    bool streamed = hpp::string_view(key).starts_with("app:");
+
+    auto create_resource_func = [compiled_absolute_path, streamed]()
     {
+        if(streamed)
+        {
+            auto& streamer = engine::context().get<texture_streamer>();
+            return streamer.load(compiled_absolute_path);
+        }
+
         return std::make_shared<gfx::texture>(compiled_absolute_path.c_str());
     };
 
@@ -219,7 +231,7 @@ auto load_from_file<prefab>(itc::thread_pool& pool, asset_handle<prefab>& output
     {
         auto pfb = std::make_shared<prefab>();
 
-        auto stream = std::ifstream{compiled_absolute_path};
+        auto stream = std::ifstream{compiled_absolute_path, std::ios::binary};
         pfb->buffer = fs::read_stream_buffer(stream);
         return pfb;
     };
@@ -245,7 +257,7 @@ auto load_from_file<scene_prefab>(itc::thread_pool& pool, asset_handle<scene_pre
     {
         auto pfb = std::make_shared<scene_prefab>();
 
-        auto stream = std::ifstream{compiled_absolute_path};
+        auto stream = std::ifstream{compiled_absolute_path, std::ios::binary};
         pfb->buffer = fs::read_stream_buffer(stream);
         return pfb;
     };
@@ -292,31 +304,21 @@ auto load_from_file<audio_clip>(itc::thread_pool& pool, asset_handle<audio_clip>
         return false;
     }
 
-    auto create_load_func = [compiled_absolute_path]()
+    auto load_data_func = [compiled_absolute_path]()
     {
-        auto data = std::make_shared<audio::sound_data>();
-        load_from_file_bin(compiled_absolute_path, *data);
-        return data;
+        audio_clip_data encoded;
+        load_from_file_bin(compiled_absolute_path, encoded);
+
+        bool stream = encoded.stream;
+        return std::make_pair(decode_audio_clip(std::move(encoded)), stream);
     };
 
-    auto create_resource_func = [compiled_absolute_path]()
+    auto create_resource_func = [](std::pair<audio::sound_data, bool>&& data)
     {
-        audio::sound_data data;
-        load_from_file_bin(compiled_absolute_path, data);
-
-        auto create_job = itc::async(itc::main_thread::get_id(),
-                                     [data = std::move(data)]() mutable
-                                     {
-                                         auto clip = std::make_shared<audio_clip>(std::move(data), false);
-                                         return clip;
-                                     });
-
-        return create_job.get();
+        return std::make_shared<audio_clip>(std::move(data.first), data.second);
     };
 
-    auto job = pool.schedule(create_resource_func).share();
-
-    output.set_internal_job(job);
+    schedule_main_thread_create(pool, output, std::move(load_data_func), std::move(create_resource_func));
 
     return true;
 }
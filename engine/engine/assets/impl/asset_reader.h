@@ -2,6 +2,9 @@
 #include "../../threading/threader.h"
 #include "../asset_handle.h"
 
+#include <memory>
+#include <type_traits>
+
 namespace ace::asset_reader
 {
 
@@ -11,6 +14,45 @@ auto resolve_compiled_path(const std::string& key) -> fs::path;
 template<typename T>
 auto load_from_file(itc::thread_pool& pool, asset_handle<T>& output, const std::string& key) -> bool;
 
+/**
+ * @brief Loads the data of an asset on the pool and creates the asset from it on the main thread.
+ * The creation is chained as a continuation, so no worker waits for the main thread.
+ * Used for resources like audio buffers which can only be created there.
+ * @param pool The pool the data is loaded on.
+ * @param output The handle receiving the asset.
+ * @param load_func Loads the data, runs on the pool.
+ * @param create_func Creates the asset from the loaded data, runs on the main thread.
+ */
+template<typename T, typename LoadF, typename CreateF>
+inline void schedule_main_thread_create(itc::thread_pool& pool,
+                                        asset_handle<T>& output,
+                                        LoadF&& load_func,
+                                        CreateF&& create_func)
+{
+    using data_t = std::decay_t<decltype(load_func())>;
+
+    // The pool stage hands its data over to the continuation, the asset is only produced by the latter.
+    auto data = std::make_shared<data_t>();
+
+    auto job = pool.schedule(
+                       [data, load_func = std::forward<LoadF>(load_func)]() mutable -> std::shared_ptr<T>
+                       {
+                           *data = load_func();
+                           return {};
+                       })
+                   .share();
+
+    auto create_job = job.then(itc::main_thread::get_id(),
+                               [data, create_func = std::forward<CreateF>(create_func)](auto f) mutable
+                               {
+                                   f.get();
+                                   return create_func(std::move(*data));
+                               })
+                          .share();
+
+    output.set_internal_job(job, create_job);
+}
+
 template<typename T>
 inline auto load_from_instance(itc::thread_pool& pool, asset_handle<T>& output, std::shared_ptr<T> instance) -> bool
 {
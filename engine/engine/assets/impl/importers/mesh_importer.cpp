@@ -1,4 +1,5 @@
 #include "mesh_importer.h"
+#include "mesh_processing.h"
 
 #include <graphics/graphics.h>
 #include <logging/logging.h>
@@ -21,6 +22,8 @@
 #include <algorithm>
 #include <execution>
 #include <filesystem/filesystem.h>
+#include <numeric>
+#include <poolstl/poolstl.hpp>
 
 namespace ace
 {
@@ -437,10 +440,8 @@ auto process_matrix(const aiMatrix4x4& assimp_matrix) -> math::mat4
     return matrix;
 }
 
-void process_vertices(aiMesh* mesh, mesh::load_data& load_data)
+void process_vertices(aiMesh* mesh, mesh::submesh& submesh, mesh::load_data& load_data)
 {
-    auto& submesh = load_data.submeshes.back();
-
     // Determine the correct offset to any relevant elements in the vertex
     bool has_position = load_data.vertex_format.has(gfx::attribute::Position);
     bool has_normal = load_data.vertex_format.has(gfx::attribute::Normal);
@@ -449,11 +450,8 @@ void process_vertices(aiMesh* mesh, mesh::load_data& load_data)
     bool has_texcoord0 = load_data.vertex_format.has(gfx::attribute::TexCoord0);
     auto vertex_stride = load_data.vertex_format.getStride();
 
-    std::uint32_t current_vertex = load_data.vertex_count;
-    load_data.vertex_count += mesh->mNumVertices;
-    load_data.vertex_data.resize(load_data.vertex_count * vertex_stride);
-
-    std::uint8_t* current_vertex_ptr = load_data.vertex_data.data() + current_vertex * vertex_stride;
+    // The vertex data is preallocated, every mesh writes its own range.
+    std::uint8_t* current_vertex_ptr = load_data.vertex_data.data() + size_t(submesh.vertex_start) * vertex_stride;
 
     for(size_t i = 0; i < mesh->mNumVertices; ++i, current_vertex_ptr += vertex_stride)
     {
@@ -526,23 +524,20 @@ void process_vertices(aiMesh* mesh, mesh::load_data& load_data)
     }
 }
 
-void process_faces(aiMesh* mesh, std::uint32_t submesh_offset, mesh::load_data& load_data)
+void process_faces(aiMesh* mesh, const mesh::submesh& submesh, mesh::load_data& load_data)
 {
-    load_data.triangle_count += mesh->mNumFaces;
-
-    load_data.triangle_data.reserve(load_data.triangle_data.size() + mesh->mNumFaces);
-
+    // The triangle data is preallocated, every mesh writes its own range.
     for(size_t i = 0; i < mesh->mNumFaces; ++i)
     {
         aiFace face = mesh->mFaces[i];
 
-        auto& triangle = load_data.triangle_data.emplace_back();
+        auto& triangle = load_data.triangle_data[submesh.face_start + i];
         triangle.data_group_id = mesh->mMaterialIndex;
 
         auto num_indices = std::min<size_t>(face.mNumIndices, 3);
         for(size_t j = 0; j < num_indices; ++j)
         {
-            triangle.indices[j] = face.mIndices[j] + submesh_offset;
+            triangle.indices[j] = face.mIndices[j] + submesh.vertex_start;
         }
     }
 }
@@ -599,29 +594,49 @@ void process_bones(aiMesh* mesh, std::uint32_t submesh_offset, mesh::load_data&
     }
 }
 
-void process_mesh(aiMesh* mesh, mesh::load_data& load_data)
-{
-    load_data.submeshes.emplace_back();
-    auto& submesh = load_data.submeshes.back();
-    submesh.vertex_start = load_data.vertex_count;
-    submesh.vertex_count = mesh->mNumVertices;
-    submesh.face_start = load_data.triangle_count;
-    submesh.face_count = mesh->mNumFaces;
-    submesh.data_group_id = mesh->mMaterialIndex;
-    submesh.skinned = mesh->HasBones();
-    load_data.material_count = std::max(load_data.material_count, submesh.data_group_id + 1);
-
-    process_faces(mesh, submesh.vertex_start, load_data);
-    process_bones(mesh, submesh.vertex_start, load_data);
-    process_vertices(mesh, load_data);
-}
-
 void process_meshes(const aiScene* scene, mesh::load_data& load_data)
 {
+    // Lay out all submeshes up front so the meshes can be processed in parallel.
+    load_data.submeshes.resize(scene->mNumMeshes);
     for(size_t i = 0; i < scene->mNumMeshes; ++i)
     {
         aiMesh* mesh = scene->mMeshes[i];
-        process_mesh(mesh, load_data);
+
+        auto& submesh = load_data.submeshes[i];
+        submesh.vertex_start = std::int32_t(load_data.vertex_count);
+        submesh.vertex_count = mesh->mNumVertices;
+        submesh.face_start = std::int32_t(load_data.triangle_count);
+        submesh.face_count = mesh->mNumFaces;
+        submesh.data_group_id = mesh->mMaterialIndex;
+        submesh.skinned = mesh->HasBones();
+        load_data.material_count = std::max(load_data.material_count, submesh.data_group_id + 1);
+
+        load_data.vertex_count += mesh->mNumVertices;
+        load_data.triangle_count += mesh->mNumFaces;
+    }
+
+    load_data.vertex_data.resize(size_t(load_data.vertex_count) * load_data.vertex_format.getStride());
+    load_data.triangle_data.resize(load_data.triangle_count);
+
+    std::vector<size_t> indices(scene->mNumMeshes);
+    std::iota(indices.begin(), indices.end(), size_t(0));
+
+    std::for_each(std::execution::par,
+                  indices.begin(),
+                  indices.end(),
+                  [&](size_t index)
+                  {
+                      aiMesh* mesh = scene->mMeshes[index];
+                      auto& submesh = load_data.submeshes[index];
+
+                      process_faces(mesh, submesh, load_data);
+                      process_vertices(mesh, submesh, load_data);
+                  });
+
+    // Bones are shared between meshes.
+    for(size_t i = 0; i < scene->mNumMeshes; ++i)
+    {
+        process_bones(scene->mMeshes[i], load_data.submeshes[i].vertex_start, load_data);
     }
 }
 
@@ -1658,6 +1673,14 @@ void process_imported_scene(asset_manager& am,
     }
 
     APPLOG_TRACE("Mesh Importer: bbox min {}, max {}", load_data.bbox.min, load_data.bbox.max);
+
+    APPLOG_TRACE("Mesh Importer: Optimizing vertex fetch ...");
+    optimize_vertex_fetch(load_data);
+
+    if(quantize_texcoords(load_data))
+    {
+        APPLOG_TRACE("Mesh Importer: Texture coordinates stored as half floats");
+    }
 }
 
 auto read_file(Assimp::Importer& importer, const fs::path& file, uint32_t flags) -> const aiScene*
@@ -0,0 +1,434 @@
+#include "mesh_processing.h"
+
+#include <graphics/graphics.h>
+#include <logging/logging.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <execution>
+#include <limits>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+#include <poolstl/poolstl.hpp>
+
+namespace ace
+{
+namespace importer
+{
+namespace
+{
+constexpr std::uint32_t invalid_index = std::numeric_limits<std::uint32_t>::max();
+
+/**
+ * @struct simplified_submesh
+ * @brief Result of simplifying a single submesh.
+ */
+struct simplified_submesh
+{
+    /// Source vertices that were kept, in the order they are first referenced.
+    std::vector<std::uint32_t> vertices;
+    /// Triangles with indices local to the kept vertices.
+    std::vector<mesh::triangle> triangles;
+};
+
+auto get_position(const mesh::load_data& data, std::uint32_t vertex) -> math::vec3
+{
+    float position[4];
+    gfx::vertex_unpack(position, gfx::attribute::Position, data.vertex_format, data.vertex_data.data(), vertex);
+    return {position[0], position[1], position[2]};
+}
+
+auto get_normal_octant(const mesh::load_data& data, std::uint32_t vertex) -> std::uint64_t
+{
+    if(!data.vertex_format.has(gfx::attribute::Normal))
+    {
+        return 0;
+    }
+
+    float normal[4];
+    gfx::vertex_unpack(normal, gfx::attribute::Normal, data.vertex_format, data.vertex_data.data(), vertex);
+    return std::uint64_t(normal[0] < 0.0f) | std::uint64_t(normal[1] < 0.0f) << 1 |
+           std::uint64_t(normal[2] < 0.0f) << 2;
+}
+
+auto clone_armature(const std::unique_ptr<mesh::armature_node>& node) -> std::unique_ptr<mesh::armature_node>
+{
+    if(!node)
+    {
+        return nullptr;
+    }
+
+    auto result = std::make_unique<mesh::armature_node>();
+    result->name = node->name;
+    result->local_transform = node->local_transform;
+    result->submeshes = node->submeshes;
+    result->children.reserve(node->children.size());
+    for(const auto& child : node->children)
+    {
+        result->children.emplace_back(clone_armature(child));
+    }
+
+    return result;
+}
+
+auto copy_submesh(const mesh::load_data& data, const mesh::submesh& submesh) -> simplified_submesh
+{
+    simplified_submesh result;
+    result.vertices.resize(submesh.vertex_count);
+    std::iota(result.vertices.begin(), result.vertices.end(), std::uint32_t(submesh.vertex_start));
+
+    result.triangles.reserve(submesh.face_count);
+    for(std::uint32_t i = 0; i < submesh.face_count; ++i)
+    {
+        auto triangle = data.triangle_data[submesh.face_start + i];
+        for(auto& index : triangle.indices)
+        {
+            index -= submesh.vertex_start;
+        }
+        triangle.flags = 0;
+        result.triangles.emplace_back(triangle);
+    }
+
+    return result;
+}
+
+/**
+ * @brief Snaps the vertices of a submesh to a uniform grid, merging all vertices that share
+ * a cell and a normal octant into the first one found, then drops the collapsed triangles.
+ */
+auto cluster_submesh(const mesh::load_data& data, const mesh::submesh& submesh, std::uint32_t resolution)
+    -> simplified_submesh
+{
+    const auto extents = submesh.bbox.max - submesh.bbox.min;
+    float cell_size = std::max({extents.x, extents.y, extents.z}) / float(resolution);
+    if(cell_size <= 0.0f)
+    {
+        cell_size = 1.0f;
+    }
+
+    const auto to_cell = [&](float value, float min)
+    {
+        auto cell = (value - min) / cell_size;
+        return std::uint64_t(std::clamp(cell, 0.0f, float(0xfffff)));
+    };
+
+    std::unordered_map<std::uint64_t, std::uint32_t> clusters;
+    clusters.reserve(submesh.vertex_count);
+
+    std::vector<std::uint32_t> representative(submesh.vertex_count);
+    for(std::uint32_t i = 0; i < submesh.vertex_count; ++i)
+    {
+        auto vertex = submesh.vertex_start + i;
+        auto position = get_position(data, vertex);
+
+        std::uint64_t key = to_cell(position.x, submesh.bbox.min.x);
+        key |= to_cell(position.y, submesh.bbox.min.y) << 20;
+        key |= to_cell(position.z, submesh.bbox.min.z) << 40;
+        key |= get_normal_octant(data, vertex) << 60;
+
+        representative[i] = clusters.emplace(key, i).first->second;
+    }
+
+    simplified_submesh result;
+    std::vector<std::uint32_t> remap(submesh.vertex_count, invalid_index);
+    std::set<std::array<std::uint32_t, 3>> unique_triangles;
+
+    for(std::uint32_t i = 0; i < submesh.face_count; ++i)
+    {
+        const auto& source = data.triangle_data[submesh.face_start + i];
+
+        std::array<std::uint32_t, 3> indices{};
+        for(size_t j = 0; j < indices.size(); ++j)
+        {
+            indices[j] = representative[source.indices[j] - submesh.vertex_start];
+        }
+
+        if(indices[0] == indices[1] || indices[1] == indices[2] || indices[0] == indices[2])
+        {
+            continue;
+        }
+
+        // Rotate the smallest index first, keeping the winding, so two sided geometry survives.
+        auto rotated = indices;
+        std::rotate(rotated.begin(), std::min_element(rotated.begin(), rotated.end()), rotated.end());
+        if(!unique_triangles.emplace(rotated).second)
+        {
+            continue;
+        }
+
+        auto& triangle = result.triangles.emplace_back();
+        triangle.data_group_id = source.data_group_id;
+        for(size_t j = 0; j < indices.size(); ++j)
+        {
+            auto& local = remap[indices[j]];
+            if(local == invalid_index)
+            {
+                local = std::uint32_t(result.vertices.size());
+                result.vertices.emplace_back(submesh.vertex_start + indices[j]);
+            }
+            triangle.indices[j] = local;
+        }
+    }
+
+    return result;
+}
+
+auto simplify_submesh(const mesh::load_data& data, const mesh::submesh& submesh, const mesh_lod_settings& settings)
+    -> simplified_submesh
+{
+    if(submesh.face_count < settings.min_submesh_triangles)
+    {
+        return copy_submesh(data, submesh);
+    }
+
+    const auto target = std::uint32_t(float(submesh.face_count) * settings.reduction);
+
+    // The triangle count grows with the grid resolution, search for the finest grid under the target.
+    std::uint32_t low = 1;
+    std::uint32_t high = 1024;
+    simplified_submesh best;
+    while(low <= high)
+    {
+        auto resolution = low + (high - low) / 2;
+        auto candidate = cluster_submesh(data, submesh, resolution);
+        if(candidate.triangles.size() <= target)
+        {
+            best = std::move(candidate);
+            low = resolution + 1;
+        }
+        else
+        {
+            high = resolution - 1;
+        }
+    }
+
+    if(best.triangles.empty())
+    {
+        return copy_submesh(data, submesh);
+    }
+
+    return best;
+}
+
+auto simplify(const mesh::load_data& data, const mesh_lod_settings& settings) -> mesh::load_data
+{
+    std::vector<simplified_submesh> parts(data.submeshes.size());
+    std::vector<size_t> indices(data.submeshes.size());
+    std::iota(indices.begin(), indices.end(), size_t(0));
+
+    std::for_each(std::execution::par,
+                  indices.begin(),
+                  indices.end(),
+                  [&](size_t index)
+                  {
+                      parts[index] = simplify_submesh(data, data.submeshes[index], settings);
+                  });
+
+    mesh::load_data result;
+    result.vertex_format = data.vertex_format;
+    result.material_count = data.material_count;
+    result.bbox = data.bbox;
+    result.root_node = clone_armature(data.root_node);
+
+    const auto stride = data.vertex_format.getStride();
+    std::vector<std::uint32_t> remap(data.vertex_count, invalid_index);
+
+    for(size_t i = 0; i < parts.size(); ++i)
+    {
+        const auto& part = parts[i];
+
+        auto submesh = data.submeshes[i];
+        submesh.vertex_start = std::int32_t(result.vertex_count);
+        submesh.vertex_count = std::uint32_t(part.vertices.size());
+        submesh.face_start = std::int32_t(result.triangle_count);
+        submesh.face_count = std::uint32_t(part.triangles.size());
+
+        result.vertex_data.resize(size_t(result.vertex_count + submesh.vertex_count) * stride);
+        for(std::uint32_t v = 0; v < submesh.vertex_count; ++v)
+        {
+            auto source = part.vertices[v];
+            auto target = result.vertex_count + v;
+            std::memcpy(result.vertex_data.data() + size_t(target) * stride,
+                        data.vertex_data.data() + size_t(source) * stride,
+                        stride);
+            remap[source] = target;
+        }
+
+        for(auto triangle : part.triangles)
+        {
+            for(auto& index : triangle.indices)
+            {
+                index += submesh.vertex_start;
+            }
+            result.triangle_data.emplace_back(triangle);
+        }
+
+        result.vertex_count += submesh.vertex_count;
+        result.triangle_count += submesh.face_count;
+        result.submeshes.emplace_back(submesh);
+    }
+
+    result.skin_data = data.skin_data;
+    for(auto& bone : result.skin_data.get_bones())
+    {
+        auto& influences = bone.influences;
+        influences.erase(std::remove_if(influences.begin(),
+                                        influences.end(),
+                                        [&](const auto& influence)
+                                        {
+                                            return remap[influence.vertex_index] == invalid_index;
+                                        }),
+                         influences.end());
+
+        for(auto& influence : influences)
+        {
+            influence.vertex_index = remap[influence.vertex_index];
+        }
+    }
+
+    return result;
+}
+} // namespace
+
+void optimize_vertex_fetch(mesh::load_data& data)
+{
+    const auto stride = data.vertex_format.getStride();
+    std::vector<std::uint32_t> remap(data.vertex_count, invalid_index);
+    std::vector<std::uint8_t> vertex_data(data.vertex_data.size());
+
+    std::for_each(std::execution::par,
+                  data.submeshes.begin(),
+                  data.submeshes.end(),
+                  [&](const mesh::submesh& submesh)
+                  {
+                      auto next = std::uint32_t(submesh.vertex_start);
+                      const auto assign = [&](std::uint32_t vertex)
+                      {
+                          if(remap[vertex] == invalid_index)
+                          {
+                              std::memcpy(vertex_data.data() + size_t(next) * stride,
+                                          data.vertex_data.data() + size_t(vertex) * stride,
+                                          stride);
+                              remap[vertex] = next++;
+                          }
+                      };
+
+                      for(std::uint32_t i = 0; i < submesh.face_count; ++i)
+                      {
+                          for(auto index : data.triangle_data[submesh.face_start + i].indices)
+                          {
+                              assign(index);
+                          }
+                      }
+
+                      // Unreferenced vertices go last in their original order.
+                      for(std::uint32_t i = 0; i < submesh.vertex_count; ++i)
+                      {
+                          assign(submesh.vertex_start + i);
+                      }
+
+                      for(std::uint32_t i = 0; i < submesh.face_count; ++i)
+                      {
+                          for(auto& index : data.triangle_data[submesh.face_start + i].indices)
+                          {
+                              index = remap[index];
+                          }
+                      }
+                  });
+
+    data.vertex_data = std::move(vertex_data);
+
+    for(auto& bone : data.skin_data.get_bones())
+    {
+        for(auto& influence : bone.influences)
+        {
+            influence.vertex_index = remap[influence.vertex_index];
+        }
+    }
+}
+
+auto generate_lods(const mesh::load_data& data, const mesh_lod_settings& settings) -> std::vector<mesh::load_data>
+{
+    std::vector<mesh::load_data> lods;
+
+    const mesh::load_data* previous = &data;
+    for(std::uint32_t i = 0; i < settings.max_lods; ++i)
+    {
+        if(previous->triangle_count < settings.min_triangles)
+        {
+            break;
+        }
+
+        auto lod = simplify(*previous, settings);
+
+        // Stop once the simplifier can no longer make a meaningful difference.
+        if(float(lod.triangle_count) > float(previous->triangle_count) * 0.9f)
+        {
+            break;
+        }
+
+        APPLOG_TRACE("Mesh Importer: LOD{} {} -> {} triangles", i + 1, previous->triangle_count, lod.triangle_count);
+
+        lods.emplace_back(std::move(lod));
+        previous = &lods.back();
+    }
+
+    return lods;
+}
+
+auto quantize_texcoords(mesh::load_data& data) -> bool
+{
+    std::uint8_t num{};
+    gfx::attribute_type type{};
+    bool normalized{};
+    bool as_int{};
+    data.vertex_format.decode(gfx::attribute::TexCoord0, num, type, normalized, as_int);
+    if(!data.vertex_format.has(gfx::attribute::TexCoord0) || type != gfx::attribute_type::Float)
+    {
+        return false;
+    }
+
+    for(std::uint32_t i = 0; i < data.vertex_count; ++i)
+    {
+        float uv[4];
+        gfx::vertex_unpack(uv, gfx::attribute::TexCoord0, data.vertex_format, data.vertex_data.data(), i);
+        if(std::abs(uv[0]) > 1.0f || std::abs(uv[1]) > 1.0f)
+        {
+            return false;
+        }
+    }
+
+    gfx::vertex_layout layout;
+    layout.begin();
+    for(std::uint32_t attr = 0; attr < gfx::attribute::Count; ++attr)
+    {
+        auto attribute = gfx::attribute(attr);
+        if(!data.vertex_format.has(attribute))
+        {
+            continue;
+        }
+
+        data.vertex_format.decode(attribute, num, type, normalized, as_int);
+        if(attribute == gfx::attribute::TexCoord0)
+        {
+            type = gfx::attribute_type::Half;
+        }
+        layout.add(attribute, num, type, normalized, as_int);
+    }
+    layout.end();
+
+    std::vector<std::uint8_t> vertex_data(size_t(data.vertex_count) * layout.getStride());
+    gfx::vertex_convert(layout, vertex_data.data(), data.vertex_format, data.vertex_data.data(), data.vertex_count);
+
+    data.vertex_format = layout;
+    data.vertex_data = std::move(vertex_data);
+
+    return true;
+}
+
+} // namespace importer
+} // namespace ace
@@ -0,0 +1,57 @@
+#pragma once
+#include <engine/rendering/mesh.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ace
+{
+namespace importer
+{
+
+/**
+ * @struct mesh_lod_settings
+ * @brief Controls the automatic generation of simplified LOD chains.
+ */
+struct mesh_lod_settings
+{
+    /// Max number of generated LODs, not counting the source mesh.
+    std::uint32_t max_lods{3};
+    /// Target triangle ratio of each LOD relative to the previous one.
+    float reduction{0.5f};
+    /// Submeshes with fewer triangles are copied as is.
+    std::uint32_t min_submesh_triangles{32};
+    /// Generation stops once a LOD has fewer triangles than this.
+    std::uint32_t min_triangles{256};
+};
+
+/**
+ * @brief Reorders the vertices of every submesh in the order they are first referenced
+ * by its triangles, so the GPU fetches vertex memory mostly linearly.
+ * Submeshes are processed in parallel.
+ * @param data The mesh data to optimize in place.
+ */
+void optimize_vertex_fetch(mesh::load_data& data);
+
+/**
+ * @brief Generates a chain of simplified LODs using vertex clustering.
+ * Every LOD keeps the submesh layout, materials, armature and skinning of the source,
+ * with vertices snapped to existing source vertices so their attributes stay intact.
+ * Submeshes are simplified in parallel.
+ * @param data The source mesh data.
+ * @param settings The LOD generation settings.
+ * @return The generated LODs, from the most to the least detailed.
+ */
+auto generate_lods(const mesh::load_data& data, const mesh_lod_settings& settings = {})
+    -> std::vector<mesh::load_data>;
+
+/**
+ * @brief Stores texture coordinates as half floats when all of them are within [-1, 1],
+ * where half precision is about a texel of a 2048 texture.
+ * @param data The mesh data to convert in place.
+ * @return True if the data was converted to the quantized layout.
+ */
+auto quantize_texcoords(mesh::load_data& data) -> bool;
+
+} // namespace importer
+} // namespace ace
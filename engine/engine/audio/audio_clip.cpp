@@ -1,6 +1,215 @@
 #include "audio_clip.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <execution>
+#include <numeric>
+
+#include <poolstl/poolstl.hpp>
+
 namespace ace
 {
+namespace
+{
+
+constexpr std::uint32_t adpcm_samples_per_block = 2048;
+// Predictor sample, step index and a padding byte.
+constexpr size_t adpcm_header_size = 4;
+
+constexpr std::array<int, 16> adpcm_index_table{-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8};
+
+constexpr std::array<int, 89> adpcm_step_table{
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767};
+
+struct adpcm_state
+{
+    int predictor{};
+    int index{};
+};
+
+auto get_adpcm_block_size(std::uint32_t samples_per_block) -> size_t
+{
+    // The first sample lives in the header, the rest are packed two per byte.
+    return adpcm_header_size + samples_per_block / 2;
+}
+
+auto adpcm_delta(int step, int nibble) -> int
+{
+    int delta = step >> 3;
+    if(nibble & 4)
+    {
+        delta += step;
+    }
+    if(nibble & 2)
+    {
+        delta += step >> 1;
+    }
+    if(nibble & 1)
+    {
+        delta += step >> 2;
+    }
+    return (nibble & 8) ? -delta : delta;
+}
+
+void adpcm_advance(adpcm_state& state, int nibble)
+{
+    state.predictor = std::clamp(state.predictor + adpcm_delta(adpcm_step_table[state.index], nibble), -32768, 32767);
+    state.index = std::clamp(state.index + adpcm_index_table[nibble], 0, int(adpcm_step_table.size()) - 1);
+}
+
+auto adpcm_encode_sample(adpcm_state& state, int sample) -> int
+{
+    int step = adpcm_step_table[state.index];
+    int diff = sample - state.predictor;
+
+    int nibble = 0;
+    if(diff < 0)
+    {
+        nibble = 8;
+        diff = -diff;
+    }
+
+    for(int bit = 4; bit > 0; bit >>= 1)
+    {
+        if(diff >= step)
+        {
+            nibble |= bit;
+            diff -= step;
+        }
+        step >>= 1;
+    }
+
+    // Track the state exactly as the decoder will see it.
+    adpcm_advance(state, nibble);
+    return nibble;
+}
+
+auto encode_adpcm(const std::vector<std::int16_t>& samples) -> std::vector<std::uint8_t>
+{
+    const size_t blocks = (samples.size() + adpcm_samples_per_block - 1) / adpcm_samples_per_block;
+    const size_t block_size = get_adpcm_block_size(adpcm_samples_per_block);
+
+    std::vector<std::uint8_t> result(blocks * block_size, 0);
+
+    adpcm_state state;
+    for(size_t b = 0; b < blocks; ++b)
+    {
+        const size_t first = b * adpcm_samples_per_block;
+        const size_t count = std::min<size_t>(adpcm_samples_per_block, samples.size() - first);
+        auto* block = result.data() + b * block_size;
+
+        // Every block restarts from an exact sample so blocks decode independently.
+        state.predictor = samples[first];
+
+        auto predictor = static_cast<std::uint16_t>(samples[first]);
+        block[0] = std::uint8_t(predictor & 0xff);
+        block[1] = std::uint8_t(predictor >> 8);
+        block[2] = std::uint8_t(state.index);
+
+        auto* nibbles = block + adpcm_header_size;
+        for(size_t i = 1; i < count; ++i)
+        {
+            auto nibble = adpcm_encode_sample(state, samples[first + i]);
+
+            auto pos = i - 1;
+            nibbles[pos / 2] |= std::uint8_t((pos % 2) ? (nibble << 4) : nibble);
+        }
+    }
+
+    return result;
+}
+
+void decode_adpcm_block(const std::uint8_t* block, size_t count, std::int16_t* out)
+{
+    adpcm_state state;
+    state.predictor = std::int16_t(std::uint16_t(block[0]) | (std::uint16_t(block[1]) << 8));
+    state.index = std::min<int>(block[2], int(adpcm_step_table.size()) - 1);
+
+    out[0] = std::int16_t(state.predictor);
+
+    const auto* nibbles = block + adpcm_header_size;
+    for(size_t i = 1; i < count; ++i)
+    {
+        auto pos = i - 1;
+        int nibble = (pos % 2) ? (nibbles[pos / 2] >> 4) : (nibbles[pos / 2] & 0x0f);
+
+        adpcm_advance(state, nibble);
+        out[i] = std::int16_t(state.predictor);
+    }
+}
+
+auto decode_adpcm(const audio_clip_data& clip) -> std::vector<std::uint8_t>
+{
+    const size_t total = clip.info.frames * clip.info.channels;
+    const size_t spb = clip.samples_per_block;
+    const size_t block_size = get_adpcm_block_size(clip.samples_per_block);
+    const size_t blocks = std::min((total + spb - 1) / spb, clip.data.size() / block_size);
+
+    std::vector<std::int16_t> samples(total, 0);
+
+    std::vector<size_t> indices(blocks);
+    std::iota(indices.begin(), indices.end(), size_t(0));
+
+    std::for_each(std::execution::par,
+                  indices.begin(),
+                  indices.end(),
+                  [&](size_t b)
+                  {
+                      const size_t first = b * spb;
+                      const size_t count = std::min(spb, total - first);
+                      decode_adpcm_block(clip.data.data() + b * block_size, count, samples.data() + first);
+                  });
+
+    std::vector<std::uint8_t> result(samples.size() * sizeof(std::int16_t));
+    std::memcpy(result.data(), samples.data(), result.size());
+    return result;
+}
+
+} // namespace
+
+auto encode_audio_clip(audio::sound_data&& sound, bool stream) -> audio_clip_data
+{
+    audio_clip_data clip;
+    clip.info = sound.info;
+    clip.stream = stream;
+
+    bool compress = stream && sound.info.bits_per_sample == 16 && sound.info.channels == 1 && sound.info.frames > 0;
+    if(!compress)
+    {
+        clip.data = std::move(sound.data);
+        return clip;
+    }
+
+    std::vector<std::int16_t> samples(sound.data.size() / sizeof(std::int16_t));
+    std::memcpy(samples.data(), sound.data.data(), samples.size() * sizeof(std::int16_t));
+
+    clip.codec = audio_codec::ima_adpcm;
+    clip.samples_per_block = adpcm_samples_per_block;
+    clip.data = encode_adpcm(samples);
+    return clip;
+}
+
+auto decode_audio_clip(audio_clip_data&& clip) -> audio::sound_data
+{
+    audio::sound_data sound;
+    sound.info = clip.info;
+
+    if(clip.codec == audio_codec::ima_adpcm && clip.samples_per_block > 0)
+    {
+        sound.data = decode_adpcm(clip);
+    }
+    else
+    {
+        sound.data = std::move(clip.data);
+    }
+
+    return sound;
+}
 
 } // namespace ace
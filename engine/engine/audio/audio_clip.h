@@ -4,6 +4,9 @@
 #include <audiopp/sound.h>
 #include <audiopp/sound_data.h>
 
+#include <cstdint>
+#include <vector>
+
 namespace ace
 {
 
@@ -18,4 +21,48 @@ struct audio_clip : public audio::sound
     using base_type::base_type;
 };
 
+/**
+ * @enum audio_codec
+ * @brief Encoding of the samples of a compiled audio clip.
+ */
+enum class audio_codec : std::uint8_t
+{
+    pcm,       ///< Raw samples.
+    ima_adpcm, ///< 4 bits per sample, 16 bit mono source only.
+};
+
+/**
+ * @struct audio_clip_data
+ * @brief Compiled representation of an audio clip.
+ */
+struct audio_clip_data
+{
+    /// Format of the decoded samples.
+    audio::sound_info info;
+    /// Encoding of the data.
+    audio_codec codec{audio_codec::pcm};
+    /// Stream the clip to the device in chunks instead of uploading it as a whole.
+    bool stream{};
+    /// Samples per independently decodable block, 0 for pcm.
+    std::uint32_t samples_per_block{};
+    /// The encoded samples.
+    std::vector<std::uint8_t> data;
+};
+
+/**
+ * @brief Encodes decoded samples for storage.
+ * Streamed clips are compressed with IMA ADPCM when the format allows it.
+ * @param sound The decoded samples.
+ * @param stream Whether the clip is streamed.
+ * @return The encoded clip.
+ */
+auto encode_audio_clip(audio::sound_data&& sound, bool stream) -> audio_clip_data;
+
+/**
+ * @brief Decodes a compiled clip back to samples. Blocks are decoded in parallel.
+ * @param clip The encoded clip.
+ * @return The decoded samples.
+ */
+auto decode_audio_clip(audio_clip_data&& clip) -> audio::sound_data;
+
 } // namespace ace
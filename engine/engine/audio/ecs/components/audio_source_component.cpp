@@ -1,5 +1,8 @@
 #include "audio_source_component.h"
 #include <audiopp/exception.h>
+
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 namespace ace
@@ -8,6 +11,9 @@ namespace ace
 void audio_source_component::on_play_begin()
 {
     source_.reset();
+    virtual_ = false;
+    virtual_paused_ = false;
+    virtual_position_ = {};
 
     if(get_autoplay())
     {
@@ -16,6 +22,8 @@ void audio_source_component::on_play_begin()
 }
 void audio_source_component::on_play_end()
 {
+    virtual_ = false;
+
     if(source_)
     {
         source_->stop();
@@ -25,12 +33,20 @@ void audio_source_component::on_play_end()
 
 void audio_source_component::update(const math::transform& t, delta_t dt)
 {
+    auto pos = t.get_position();
+    position_ = pos;
+
+    if(virtual_)
+    {
+        update_virtual(dt);
+        return;
+    }
+
     if(!source_)
     {
         return;
     }
     source_->update(std::chrono::milliseconds(16));
-    auto pos = t.get_position();
     auto forward = t.z_unit_axis();
     auto up = t.y_unit_axis();
     source_->set_position({{pos.x, pos.y, pos.z}});
@@ -127,6 +143,12 @@ const frange_t& audio_source_component::get_range() const
 
 void audio_source_component::set_playback_position(audio::duration_t offset)
 {
+    if(virtual_)
+    {
+        virtual_position_ = offset;
+        return;
+    }
+
     if(!source_)
     {
         return;
@@ -136,6 +158,11 @@ void audio_source_component::set_playback_position(audio::duration_t offset)
 
 auto audio_source_component::get_playback_position() const -> audio::duration_t
 {
+    if(virtual_)
+    {
+        return virtual_position_;
+    }
+
     if(!source_)
     {
         return {};
@@ -145,6 +172,11 @@ auto audio_source_component::get_playback_position() const -> audio::duration_t
 
 auto audio_source_component::get_playback_duration() const -> audio::duration_t
 {
+    if(virtual_)
+    {
+        return get_sound_duration();
+    }
+
     if(!source_)
     {
         return {};
@@ -155,10 +187,16 @@ auto audio_source_component::get_playback_duration() const -> audio::duration_t
 
 void audio_source_component::play()
 {
+    virtual_ = false;
+    virtual_paused_ = false;
+    virtual_position_ = {};
+
     if(!source_)
     {
         if(!create_source())
         {
+            // Out of device voices, play virtually until the voice manager promotes it.
+            virtual_ = is_sound_valid();
             return;
         }
     }
@@ -172,6 +210,10 @@ void audio_source_component::play()
 
 void audio_source_component::stop()
 {
+    virtual_ = false;
+    virtual_paused_ = false;
+    virtual_position_ = {};
+
     if(!source_)
     {
         return;
@@ -181,6 +223,12 @@ void audio_source_component::stop()
 
 void audio_source_component::pause()
 {
+    if(virtual_)
+    {
+        virtual_paused_ = true;
+        return;
+    }
+
     if(!source_)
     {
         return;
@@ -190,6 +238,12 @@ void audio_source_component::pause()
 
 void audio_source_component::resume()
 {
+    if(virtual_)
+    {
+        virtual_paused_ = false;
+        return;
+    }
+
     if(!source_)
     {
         return;
@@ -227,6 +281,11 @@ auto audio_source_component::is_muted() const -> bool
 
 auto audio_source_component::is_playing() const -> bool
 {
+    if(virtual_)
+    {
+        return !virtual_paused_;
+    }
+
     if(!source_)
     {
         return false;
@@ -236,6 +295,11 @@ auto audio_source_component::is_playing() const -> bool
 
 auto audio_source_component::is_paused() const -> bool
 {
+    if(virtual_)
+    {
+        return virtual_paused_;
+    }
+
     if(!source_)
     {
         return false;
@@ -272,6 +336,127 @@ auto audio_source_component::has_bound_sound() const -> bool
     return source_->has_bound_sound();
 }
 
+void audio_source_component::set_priority(int priority)
+{
+    priority_ = math::clamp(priority, 0, 256);
+}
+
+auto audio_source_component::get_priority() const -> int
+{
+    return priority_;
+}
+
+auto audio_source_component::get_audibility(const math::vec3& listener) const -> float
+{
+    if(muted_ || !is_playing())
+    {
+        return 0.0f;
+    }
+
+    float distance = math::distance(position_, listener);
+    if(distance > range_.max)
+    {
+        return 0.0f;
+    }
+
+    // Clamped inverse distance, the default model of the device.
+    distance = math::clamp(distance, range_.min, range_.max);
+    float denominator = range_.min + volume_rolloff_ * (distance - range_.min);
+    float gain = denominator > 0.0f ? range_.min / denominator : 1.0f;
+
+    return volume_ * gain;
+}
+
+auto audio_source_component::is_virtual() const -> bool
+{
+    return virtual_;
+}
+
+auto audio_source_component::is_real() const -> bool
+{
+    return source_ && source_->is_playing();
+}
+
+void audio_source_component::make_virtual()
+{
+    if(!is_real())
+    {
+        return;
+    }
+
+    virtual_position_ = source_->get_playback_position();
+    virtual_paused_ = false;
+    virtual_ = true;
+
+    source_->stop();
+    source_.reset();
+}
+
+auto audio_source_component::make_real() -> bool
+{
+    if(!virtual_ || virtual_paused_)
+    {
+        return false;
+    }
+
+    if(!source_ && !create_source())
+    {
+        return false;
+    }
+
+    auto position = virtual_position_;
+    virtual_ = false;
+    virtual_position_ = {};
+
+    if(sound_)
+    {
+        source_->bind(*sound_.get());
+        source_->set_playback_position(position);
+        source_->play();
+    }
+
+    return true;
+}
+
+void audio_source_component::update_virtual(delta_t dt)
+{
+    if(virtual_paused_)
+    {
+        return;
+    }
+
+    auto duration = get_sound_duration();
+
+    virtual_position_ += std::chrono::duration_cast<audio::duration_t>(delta_t(dt.count() * pitch_));
+    if(virtual_position_ < duration)
+    {
+        return;
+    }
+
+    if(loop_ && duration.count() > 0)
+    {
+        auto position = std::chrono::duration<double>(virtual_position_).count();
+        auto length = std::chrono::duration<double>(duration).count();
+        virtual_position_ =
+            std::chrono::duration_cast<audio::duration_t>(std::chrono::duration<double>(std::fmod(position, length)));
+    }
+    else
+    {
+        virtual_ = false;
+        virtual_position_ = {};
+    }
+}
+
+auto audio_source_component::get_sound_duration() const -> audio::duration_t
+{
+    if(!sound_)
+    {
+        return {};
+    }
+
+    return sound_.get()->get_info().duration;
+}
+
 void audio_source_component::apply_all()
 {
     set_loop(loop_);
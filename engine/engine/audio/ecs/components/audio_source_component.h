@@ -185,6 +185,49 @@ public:
      */
     auto has_bound_sound() const -> bool;
 
+    /**
+     * @brief Sets the voice priority of the audio source.
+     * @param priority The priority. Valid range: [0, 256], 0 is the most important.
+     */
+    void set_priority(int priority);
+
+    /**
+     * @brief Gets the voice priority of the audio source.
+     * @return The priority.
+     */
+    auto get_priority() const -> int;
+
+    /**
+     * @brief Gets how loud the source is heard from the given position,
+     * using the same clamped inverse distance model as the device.
+     * @param listener The listener position.
+     * @return The audibility, 0 for muted, stopped or out of range sources.
+     */
+    auto get_audibility(const math::vec3& listener) const -> float;
+
+    /**
+     * @brief Checks if the source is playing without a device voice.
+     * @return True if virtual, false otherwise.
+     */
+    auto is_virtual() const -> bool;
+
+    /**
+     * @brief Checks if the source holds a device voice.
+     * @return True if real, false otherwise.
+     */
+    auto is_real() const -> bool;
+
+    /**
+     * @brief Releases the device voice, keeping the playback position simulated.
+     */
+    void make_virtual();
+
+    /**
+     * @brief Acquires a device voice and resumes at the simulated playback position.
+     * @return True if a voice was acquired, false otherwise.
+     */
+    auto make_real() -> bool;
+
 private:
     /**
      * @brief Applies all settings to the audio source.
@@ -203,6 +246,18 @@ private:
      */
     auto create_source() -> bool;
 
+    /**
+     * @brief Advances the simulated playback position of a virtual source.
+     * @param dt The delta time.
+     */
+    void update_virtual(delta_t dt);
+
+    /**
+     * @brief Gets the duration of the bound sound.
+     * @return The duration.
+     */
+    auto get_sound_duration() const -> audio::duration_t;
+
     bool auto_play_ = true;                 ///< Indicates if the audio source should autoplay.
     bool loop_ = true;                      ///< Indicates if the audio source should loop.
     bool muted_ = false;                    ///< Indicates if the audio source is muted.
@@ -210,6 +265,11 @@ private:
     float pitch_ = 1.0f;                    ///< The pitch level of the audio source. Range: [0.5, 2.0].
     float volume_rolloff_ = 1.0f;           ///< The volume rolloff factor of the audio source. Range: [0.0, 10.0].
     frange_t range_ = {1.0f, 20.0f};        ///< The range of the audio source.
+    int priority_ = 128;                    ///< The voice priority, 0 is the most important. Range: [0, 256].
+    bool virtual_ = false;                  ///< Indicates if the source plays without a device voice.
+    bool virtual_paused_ = false;           ///< Indicates if the virtual playback is paused.
+    audio::duration_t virtual_position_{};  ///< The simulated playback position while virtual.
+    math::vec3 position_{};                 ///< The world position from the last update.
     std::shared_ptr<audio::source> source_; ///< The audio source object.
     asset_handle<audio_clip> sound_;        ///< The audio clip bound to the audio source.
 };
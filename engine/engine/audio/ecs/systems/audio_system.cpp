@@ -9,12 +9,17 @@
 #include <audiopp/logger.h>
 #include <logging/logging.h>
 
+#include <algorithm>
+
 namespace ace
 {
 
 namespace
 {
 
+// Real voices score a bit higher so sources near the cut don't swap every frame.
+constexpr float real_voice_bias = 1.1f;
+
 void on_create_component(entt::registry& r, const entt::entity e)
 {
     auto& comp = r.get<audio_source_component>(e);
@@ -70,6 +75,86 @@ auto audio_system::deinit(rtti::context& ctx) -> bool
     return true;
 }
 
+void audio_system::set_max_real_voices(size_t count)
+{
+    max_real_voices_ = count;
+}
+
+auto audio_system::get_max_real_voices() const -> size_t
+{
+    return max_real_voices_;
+}
+
+void audio_system::update_voices(entt::registry& registry)
+{
+    bool has_listener = false;
+    math::vec3 listener{};
+    registry.view<transform_component, audio_listener_component>().each(
+        [&](auto e, auto&& transform, auto&& comp)
+        {
+            if(!has_listener)
+            {
+                listener = transform.get_transform_global().get_position();
+                has_listener = true;
+            }
+        });
+
+    if(!has_listener)
+    {
+        return;
+    }
+
+    voices_.clear();
+    registry.view<audio_source_component>().each(
+        [&](auto e, auto&& comp)
+        {
+            if(!comp.is_playing())
+            {
+                return;
+            }
+
+            auto& v = voices_.emplace_back();
+            v.source = &comp;
+            v.priority = comp.get_priority();
+            v.audibility = comp.get_audibility(listener);
+            if(comp.is_real())
+            {
+                v.audibility *= real_voice_bias;
+            }
+        });
+
+    // Priority first, then audibility.
+    auto real_count = std::min(voices_.size(), max_real_voices_);
+    std::nth_element(voices_.begin(),
+                     voices_.begin() + real_count,
+                     voices_.end(),
+                     [](const voice& lhs, const voice& rhs)
+                     {
+                         if(lhs.priority != rhs.priority)
+                         {
+                             return lhs.priority < rhs.priority;
+                         }
+                         return lhs.audibility > rhs.audibility;
+                     });
+
+    // Demote first so the promoted sources find free device voices.
+    for(size_t i = 0; i < voices_.size(); ++i)
+    {
+        if(i >= real_count || voices_[i].audibility <= 0.0f)
+        {
+            voices_[i].source->make_virtual();
+        }
+    }
+
+    for(size_t i = 0; i < real_count; ++i)
+    {
+        if(voices_[i].audibility > 0.0f && voices_[i].source->is_virtual())
+        {
+            voices_[i].source->make_real();
+        }
+    }
+}
+
 void audio_system::on_play_begin(rtti::context& ctx)
 {
     auto& ec = ctx.get<ecs>();
@@ -156,6 +241,8 @@ void audio_system::on_frame_update(rtti::context& ctx, delta_t dt)
         {
             comp.update(transform.get_transform_global(), dt);
         });
+
+    update_voices(registry);
 }
 
 } // namespace ace
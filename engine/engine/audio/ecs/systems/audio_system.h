@@ -4,10 +4,15 @@
 #include <audiopp/device.h>
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
+#include <entt/entity/fwd.hpp>
+
+#include <vector>
 
 namespace ace
 {
 
+class audio_source_component;
+
 /**
  * @class audio_system
  * @brief Manages the audio operations and integrates with the audio backend.
@@ -29,7 +34,40 @@ public:
      */
     auto deinit(rtti::context& ctx) -> bool;
 
+    /**
+     * @brief Sets how many sources can hold a device voice at once.
+     * The least audible playing sources beyond that are virtualized.
+     * @param count The max number of real voices.
+     */
+    void set_max_real_voices(size_t count);
+
+    /**
+     * @brief Gets how many sources can hold a device voice at once.
+     * @return The max number of real voices.
+     */
+    auto get_max_real_voices() const -> size_t;
+
 private:
+    /**
+     * @struct voice
+     * @brief A playing source scored by the voice manager.
+     */
+    struct voice
+    {
+        /// The scored source.
+        audio_source_component* source{};
+        /// The voice priority, lower is more important.
+        int priority{};
+        /// How loud the source is heard by the listener.
+        float audibility{};
+    };
+
+    /**
+     * @brief Keeps the most audible playing sources as real voices and virtualizes the rest.
+     * @param registry The registry holding the sources.
+     */
+    void update_voices(entt::registry& registry);
+
     /**
      * @brief Updates the audio system for each frame.
      * @param ctx The context for the update.
@@ -71,6 +109,10 @@ private:
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
     /// The audio device used for playback.
     std::unique_ptr<audio::device> device_;
+    /// The max number of sources holding a device voice.
+    size_t max_real_voices_{32};
+    /// Scratch list of the playing sources, reused every frame.
+    std::vector<voice> voices_;
 };
 
 } // namespace ace
@@ -247,6 +247,13 @@ auto defaults::create_mesh_entity_at(rtti::context& ctx, scene& scn, const std::
     model mdl;
     mdl.set_lod(asset, 0);
 
+    // Pick up the LODs generated when the mesh was imported.
+    const auto lod_count = asset.get()->get_generated_lod_count();
+    for(uint32_t lod = 1; lod <= lod_count; ++lod)
+    {
+        mdl.set_lod(am.get_asset<mesh>(mesh::get_generated_lod_key(key, lod)), lod);
+    }
+
     std::string name = fs::path(key).stem().string();
     auto object = scn.create_entity(name);
 
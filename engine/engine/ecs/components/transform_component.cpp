@@ -37,18 +37,41 @@ auto check_parent(entt::handle e, entt::handle parent) -> bool
     return true;
 }
 
+namespace
+{
+void mark_hierarchy_changed(entt::registry& r)
+{
+    auto version = r.ctx().find<hierarchy_version>();
+    if(!version)
+    {
+        version = &r.ctx().emplace<hierarchy_version>();
+    }
+    ++version->value;
+}
+} // namespace
+
+auto get_hierarchy_version(const entt::registry& r) -> std::uint64_t
+{
+    auto version = r.ctx().find<hierarchy_version>();
+    return version ? version->value : 0;
+}
+
 void transform_component::on_create_component(entt::registry& r, const entt::entity e)
 {
     entt::handle entity(r, e);
 
     auto& component = entity.get<transform_component>();
     component.set_owner(entity);
+
+    mark_hierarchy_changed(r);
 }
 
 void transform_component::on_destroy_component(entt::registry& r, const entt::entity e)
 {
     entt::handle entity(r, e);
 
+    mark_hierarchy_changed(r);
+
     auto& component = entity.get<transform_component>();
 
     if(component.parent_)
@@ -494,6 +517,8 @@ auto transform_component::set_parent(const entt::handle& p, bool global_stays) -
         old_parent.get<transform_component>().remove_child(get_owner(), *this);
     }
 
+    mark_hierarchy_changed(*get_owner().registry());
+
     return true;
 }
 
@@ -606,6 +631,11 @@ auto transform_component::get_children() const noexcept -> const std::vector<ent
 void transform_component::set_children(const std::vector<entt::handle>& children)
 {
     children_ = children;
+
+    if(auto owner = get_owner())
+    {
+        mark_hierarchy_changed(*owner.registry());
+    }
 }
 
 void transform_component::on_dirty_transform(bool dirty) noexcept
@@ -2,6 +2,7 @@
 
 #include "basic_component.h"
 #include <bitset>
+#include <cstdint>
 #include <math/math.h>
 
 namespace ace
@@ -15,6 +16,24 @@ struct root_component : public component_crtp<root_component>
 {
 };
 
+/**
+ * @struct hierarchy_version
+ * @brief Registry context value bumped whenever entities are added to, removed from or moved within the hierarchy.
+ *
+ * Lets tools cache views of the hierarchy and rebuild them only when it actually changed.
+ */
+struct hierarchy_version
+{
+    std::uint64_t value{};
+};
+
+/**
+ * @brief Gets the current hierarchy version of a registry.
+ * @param r The registry.
+ * @return The version, 0 if the hierarchy was never modified.
+ */
+auto get_hierarchy_version(const entt::registry& r) -> std::uint64_t;
+
 /**
  * @class transform_component
  * @brief Component that handles transformations (position, rotation, scale, etc.) in the ACE framework.
@@ -1,6 +1,10 @@
 #include "ecs.h"
 
+#include <engine/ecs/components/transform_component.h>
+#include <engine/engine.h>
 #include <engine/events.h>
+#include <engine/meta/ecs/entity.hpp>
+#include <engine/threading/threader.h>
 #include <logging/logging.h>
 
 namespace ace
@@ -10,6 +14,9 @@ auto ecs::init(rtti::context& ctx) -> bool
 {
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
 
+    auto& ev = ctx.get<events>();
+    ev.on_frame_begin.connect(sentinel_, this, &ecs::on_frame_begin);
+
     return true;
 }
 
@@ -24,6 +31,8 @@ auto ecs::deinit(rtti::context& ctx) -> bool
 
 void ecs::unload_scene()
 {
+    pending_loads_.clear();
+    sub_scenes_.clear();
     scene_.unload();
 }
 
@@ -37,4 +46,203 @@ auto ecs::get_scene() const -> const scene&
     return scene_;
 }
 
+auto ecs::load_scene_async(const asset_handle<scene_prefab>& pfb, bool additive) -> scene_load_id
+{
+    auto id = next_load_id_++;
+
+    if(!additive)
+    {
+        // Everything requested before would be replaced anyway.
+        pending_loads_.clear();
+    }
+
+    auto& load = pending_loads_[id];
+    load.source = pfb;
+    load.additive = additive;
+
+    return id;
+}
+
+void ecs::unload_sub_scene(scene_load_id id)
+{
+    auto pending = pending_loads_.find(id);
+    if(pending != pending_loads_.end())
+    {
+        // Clones of roots not committed yet are still empty.
+        for(auto& [src, clone] : pending->second.clones)
+        {
+            if(clone.valid() && !clone.all_of<transform_component>())
+            {
+                clone.destroy();
+            }
+        }
+
+        pending_loads_.erase(pending);
+    }
+
+    auto it = sub_scenes_.find(id);
+    if(it == sub_scenes_.end())
+    {
+        return;
+    }
+
+    for(auto& root : it->second)
+    {
+        // Destroying a transform destroys its children as well.
+        if(root.valid())
+        {
+            root.destroy();
+        }
+    }
+
+    sub_scenes_.erase(it);
+}
+
+auto ecs::get_load_progress(scene_load_id id) const -> float
+{
+    auto it = pending_loads_.find(id);
+    if(it == pending_loads_.end())
+    {
+        return 1.0f;
+    }
+
+    const auto& load = it->second;
+    if(!load.decoded || load.roots.empty())
+    {
+        return 0.0f;
+    }
+
+    return float(load.committed) / float(load.roots.size());
+}
+
+auto ecs::is_loading() const -> bool
+{
+    return !pending_loads_.empty();
+}
+
+void ecs::set_load_budget(std::chrono::microseconds budget)
+{
+    load_budget_ = budget;
+}
+
+void ecs::on_scene_decoded(scene_load_id id, std::shared_ptr<entt::registry> decoded)
+{
+    auto it = pending_loads_.find(id);
+    if(it == pending_loads_.end())
+    {
+        return;
+    }
+
+    auto& load = it->second;
+    load.decoded = std::move(decoded);
+    load.decoded->view<transform_component, root_component>().each(
+        [&](auto e, auto&& comp1, auto&& comp2)
+        {
+            load.roots.emplace_back(e);
+        });
+}
+
+void ecs::on_frame_begin(rtti::context& ctx, delta_t dt)
+{
+    if(pending_loads_.empty())
+    {
+        return;
+    }
+
+    // Decoding starts once the prefab is loaded, so a pool thread never waits on another.
+    auto& thr = ctx.get<threader>();
+    for(auto& [id, load] : pending_loads_)
+    {
+        if(load.decoding || !load.source.is_ready())
+        {
+            continue;
+        }
+
+        load.decoding = true;
+
+        std::weak_ptr<int> weak_sentinel = sentinel_;
+        thr.pool
+            ->schedule(
+                [source = load.source]()
+                {
+                    // Decoding needs owners and roots, the system hooks run when the entities are committed.
+                    auto decoded = std::make_shared<entt::registry>();
+                    scene::connect_owner_hooks(*decoded);
+                    load_from_prefab(source, *decoded);
+                    return decoded;
+                })
+            .then(itc::main_thread::get_id(),
+                  [this, weak_sentinel, id = id](auto f)
+                  {
+                      if(weak_sentinel.expired())
+                      {
+                          return;
+                      }
+
+                      on_scene_decoded(id, f.get());
+                  });
+    }
+
+    // Loads are committed in request order, one root hierarchy at a time,
+    // until the budget for this frame is spent.
+    auto start = std::chrono::steady_clock::now();
+    while(!pending_loads_.empty())
+    {
+        auto it = pending_loads_.begin();
+        auto id = it->first;
+        auto& load = it->second;
+
+        if(!load.decoded)
+        {
+            return;
+        }
+
+        if(load.committed == 0 && !load.additive)
+        {
+            sub_scenes_.clear();
+            scene_.unload();
+        }
+
+        const auto& src = *load.decoded;
+        auto& dst = *scene_.registry;
+        if(load.committed == 0 && load.clones.empty())
+        {
+            for(auto e : src.view<transform_component>())
+            {
+                load.clones.emplace(e, entt::handle(dst, dst.create()));
+            }
+        }
+
+        while(load.committed < load.roots.size())
+        {
+            auto root = load.roots[load.committed++];
+            clone_entity_from_registry(entt::const_handle(src, root), load.clones);
+
+            auto obj = load.clones.at(root);
+
+            if(load.additive)
+            {
+                sub_scenes_[id].emplace_back(obj);
+            }
+
+            if(std::chrono::steady_clock::now() - start >= load_budget_)
+            {
+                return;
+            }
+        }
+
+        if(!load.additive)
+        {
+            scene_.source = load.source;
+        }
+
+        APPLOG_INFO("Loaded scene {} ({} roots)", load.source.id(), load.roots.size());
+
+        pending_loads_.erase(it);
+
+        auto& ev = ctx.get<events>();
+        ev.on_scene_loaded(ctx, id);
+    }
+}
+
 } // namespace ace
@@ -1,9 +1,18 @@
 #pragma once
 #include "scene.h"
 
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 namespace ace
 {
 
+/// Identifies a scene load started by ecs::load_scene_async.
+using scene_load_id = std::uint64_t;
+
 /**
  * @struct ecs
  * @brief Manages the entity-component-system (ECS) operations for the ACE framework.
@@ -32,10 +41,48 @@ struct ecs
     void on_frame_render(rtti::context& ctx, delta_t dt);
 
     /**
-     * @brief Unloads the current scene.
+     * @brief Unloads the current scene, cancelling any pending loads.
      */
     void unload_scene();
 
+    /**
+     * @brief Starts loading a scene in the background.
+     * The scene is decoded on the thread pool into a plain registry and then committed to
+     * the live scene a few root hierarchies per frame, within the load budget, so component
+     * hooks only run on the main thread. events::on_scene_loaded is fired once all entities
+     * are committed. Systems that act on the whole scene, like starting play, should wait for it.
+     * @param pfb The scene prefab to load.
+     * @param additive If true the entities are added to the current scene as a sub-scene
+     * which can be unloaded on its own, otherwise they replace the current scene.
+     * @return The id of the load, used to query progress and to unload a sub-scene.
+     */
+    auto load_scene_async(const asset_handle<scene_prefab>& pfb, bool additive = false) -> scene_load_id;
+
+    /**
+     * @brief Destroys the entities of an additively loaded sub-scene, or cancels its load.
+     * @param id The id returned by load_scene_async.
+     */
+    void unload_sub_scene(scene_load_id id);
+
+    /**
+     * @brief Gets the progress of a load.
+     * @param id The id returned by load_scene_async.
+     * @return The committed fraction in [0, 1], 1 once the load is done or unknown.
+     */
+    auto get_load_progress(scene_load_id id) const -> float;
+
+    /**
+     * @brief Checks if any scene load is still in flight.
+     * @return True if a load is pending.
+     */
+    auto is_loading() const -> bool;
+
+    /**
+     * @brief Sets the time spent committing loaded entities each frame.
+     * @param budget The per frame budget.
+     */
+    void set_load_budget(std::chrono::microseconds budget);
+
     /**
      * @brief Gets the current scene.
      * @return A reference to the current scene.
@@ -49,11 +96,68 @@ struct ecs
     auto get_scene() const -> const scene&;
 
 private:
+    /**
+     * @struct pending_load
+     * @brief A scene being decoded or committed.
+     */
+    struct pending_load
+    {
+        /// The scene prefab being loaded.
+        asset_handle<scene_prefab> source;
+        /// The decoded entities, set once decoding finishes.
+        std::shared_ptr<entt::registry> decoded;
+        /// Root entities of the decoded scene, in commit order.
+        std::vector<entt::entity> roots;
+        /// Clones of all decoded entities, created before the first root is committed
+        /// so references between roots survive.
+        std::unordered_map<entt::entity, entt::handle> clones;
+        /// Number of roots already committed.
+        size_t committed{};
+        /// Whether the entities are added to the current scene.
+        bool additive{};
+        /// Whether decoding was scheduled.
+        bool decoding{};
+    };
+
+    /**
+     * @brief Schedules decoding and commits decoded entities within the budget.
+     * @param ctx The context.
+     * @param dt The delta time for the frame.
+     */
+    void on_frame_begin(rtti::context& ctx, delta_t dt);
+
+    /**
+     * @brief Called on the main thread once a scene was decoded.
+     * @param id The id of the load.
+     * @param decoded The decoded scene.
+     */
+    void on_scene_decoded(scene_load_id id, std::shared_ptr<entt::registry> decoded);
+
     /**
      * @brief The scene managed by the ECS.
      */
     scene scene_{};
 
+    /**
+     * @brief Loads in flight, in the order they were requested.
+     */
+    std::map<scene_load_id, pending_load> pending_loads_;
+
+    /**
+     * @brief Root entities of the additively loaded sub-scenes.
+     */
+    std::map<scene_load_id, std::vector<entt::handle>> sub_scenes_;
+
+    /**
+     * @brief Id of the next load.
+     */
+    scene_load_id next_load_id_{1};
+
+    /**
+     * @brief Time spent committing loaded entities each frame.
+     */
+    std::chrono::microseconds load_budget_{2000};
+
     /**
      * @brief Sentinel value to manage shared resources.
      */
@@ -10,6 +10,8 @@
 namespace ace
 {
 
+struct prefab_template;
+
 /**
  * @struct prefab
  * @brief Represents a generic prefab with a buffer for serialized data.
@@ -20,6 +22,13 @@ struct prefab
      * @brief Buffer to store serialized data of the prefab.
      */
     fs::stream_buffer<std::vector<uint8_t>> buffer{};
+
+    /**
+     * @brief Entities decoded from the buffer on first instantiation.
+     * Every instance is cloned from them instead of parsing the buffer again.
+     * Only accessed through get_prefab_template, which builds it under a lock.
+     */
+    std::shared_ptr<prefab_template> instance_template{};
 };
 
 /**
@@ -54,11 +54,7 @@ auto clone_entity_impl(entt::registry& r, entt::handle entity) -> entt::handle
 scene::scene()
 {
     registry = std::make_unique<entt::registry>();
-    registry->on_construct<transform_component>().connect<&transform_component::on_create_component>();
-    registry->on_destroy<transform_component>().connect<&transform_component::on_destroy_component>();
-
-    registry->on_construct<model_component>().connect<&model_component::on_create_component>();
-    registry->on_destroy<model_component>().connect<&model_component::on_destroy_component>();
+    connect_owner_hooks(*registry);
 
     registry->on_construct<animation_component>().connect<&animation_system::on_create_component>();
     registry->on_destroy<animation_component>().connect<&animation_system::on_destroy_component>();
@@ -67,6 +63,15 @@ scene::scene()
     registry->on_destroy<physics_component>().connect<&physics_system::on_destroy_component>();
 }
 
+void scene::connect_owner_hooks(entt::registry& r)
+{
+    r.on_construct<transform_component>().connect<&transform_component::on_create_component>();
+    r.on_destroy<transform_component>().connect<&transform_component::on_destroy_component>();
+
+    r.on_construct<model_component>().connect<&model_component::on_create_component>();
+    r.on_destroy<model_component>().connect<&model_component::on_destroy_component>();
+}
+
 scene::~scene()
 {
     unload();
@@ -94,6 +99,18 @@ auto scene::instantiate(const asset_handle<prefab>& pfb) -> entt::handle
     return load_from_prefab(pfb, *registry);
 }
 
+auto scene::instantiate_n(const asset_handle<prefab>& pfb, const std::vector<math::transform>& transforms)
+    -> std::vector<entt::handle>
+{
+    auto instances = load_from_prefab_n(pfb, *registry, transforms.size());
+    for(size_t i = 0; i < instances.size(); ++i)
+    {
+        instances[i].get<transform_component>().set_transform_local(transforms[i]);
+    }
+
+    return instances;
+}
+
 auto scene::create_entity(entt::registry& r, const std::string& tag, entt::handle parent) -> entt::handle
 {
     entt::handle ent(r, r.create());
@@ -119,7 +136,7 @@ auto scene::clone_entity(entt::handle clone_from, bool keep_parent) -> entt::han
 
     auto* reg = clone_from.registry();
     entt::handle clone_to(*reg, reg->create());
-    clone_entity_from_stream(clone_from, clone_to);
+    clone_entity_from_registry(clone_from, clone_to);
     if(keep_parent)
     {
         // get cloned from transform
@@ -171,7 +188,7 @@ auto scene::clone_entity(entt::handle clone_from, bool keep_parent) -> entt::han
 
 void scene::clone_scene(const scene& src_scene, scene& dst_scene)
 {
-    clone_scene_from_stream(src_scene, dst_scene);
+    clone_scene_from_registry(src_scene, dst_scene);
 }
 
 auto scene::create_entity(entt::entity e) -> entt::handle
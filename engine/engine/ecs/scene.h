@@ -6,6 +6,9 @@
 #include <context/context.hpp>
 #include <engine/assets/asset_handle.h>
 #include <entt/entt.hpp>
+#include <math/math.h>
+
+#include <vector>
 
 using namespace entt::literals;
 
@@ -47,6 +50,15 @@ struct scene
      */
     auto instantiate(const asset_handle<prefab>& pfb) -> entt::handle;
 
+    /**
+     * @brief Instantiates a prefab many times in the scene, creating all entities in bulk.
+     * @param pfb The asset handle to the prefab.
+     * @param transforms The local transform of each instance's root.
+     * @return Handles to the instantiated root entities, one per transform.
+     */
+    auto instantiate_n(const asset_handle<prefab>& pfb, const std::vector<math::transform>& transforms)
+        -> std::vector<entt::handle>;
+
     /**
      * @brief Creates an entity in the scene.
      * @param e The entity identifier.
@@ -93,6 +105,14 @@ struct scene
      */
     static void clone_scene(const scene& src_scene, scene& dst_scene);
 
+    /**
+     * @brief Connects the hooks that set the owners of components and keep the hierarchy up to date.
+     *
+     * Registries that only decode entities need them as well, without the hooks of the systems.
+     * @param r The registry to connect.
+     */
+    static void connect_owner_hooks(entt::registry& r);
+
     /**
      * @brief The source prefab asset handle for the scene.
      */
@@ -104,6 +124,19 @@ struct scene
     std::unique_ptr<entt::registry> registry{};
 };
 
+/**
+ * @struct prefab_template
+ * @brief Decoded entities of a prefab, kept in a scene of their own so they never
+ * show up in a live scene. Instances are cloned from them.
+ */
+struct prefab_template
+{
+    /// Holds the decoded entities.
+    scene entities;
+    /// The decoded entities in hierarchy order, the root first.
+    std::vector<entt::entity> hierarchy;
+};
+
 #define TAG_COMPONENT(name) entt::tag<name##_hs>
 
 } // namespace ace
@@ -3,6 +3,7 @@
 #include <engine/defaults/defaults.h>
 #include <engine/profiler/profiler.h>
 #include <engine/rendering/renderer.h>
+#include <engine/rendering/texture_streamer.h>
 #include <engine/scripting/script_system.h>
 #include <engine/threading/threader.h>
 
@@ -58,10 +59,13 @@ auto engine::create(rtti::context& ctx, cmd_line::parser& parser) -> bool
         });
 
     ctx.add<logging>();
+    parser.set_optional<bool>("l", "async_log", false, "Format and write logs on a background thread.");
+
     ctx.add<simulation>();
     ctx.add<events>();
     ctx.add<threader>();
     ctx.add<renderer>(ctx, parser);
+    ctx.add<texture_streamer>();
     ctx.add<audio_system>();
     ctx.add<asset_manager>(ctx);
     ctx.add<ecs>();
@@ -83,6 +87,10 @@ auto engine::init_core(const cmd_line::parser& parser) -> bool
 
     //    APPLOG_INFO(parser.usage());
 
+    bool async_log = false;
+    parser.try_get("async_log", async_log);
+    set_async_logging(async_log);
+
     if(!ctx.get<threader>().init(ctx))
     {
         return false;
@@ -93,6 +101,11 @@ auto engine::init_core(const cmd_line::parser& parser) -> bool
         return false;
     }
 
+    if(!ctx.get<texture_streamer>().init(ctx))
+    {
+        return false;
+    }
+
     if(!ctx.get<audio_system>().init(ctx))
     {
         return false;
@@ -227,6 +240,11 @@ auto engine::deinit() -> bool
         return false;
     }
 
+    if(!ctx.get<texture_streamer>().deinit(ctx))
+    {
+        return false;
+    }
+
     if(!ctx.get<renderer>().deinit(ctx))
     {
         return false;
@@ -257,6 +275,7 @@ auto engine::destroy() -> bool
 
     ctx.remove<asset_manager>();
     ctx.remove<audio_system>();
+    ctx.remove<texture_streamer>();
     ctx.remove<renderer>();
     ctx.remove<events>();
     ctx.remove<simulation>();
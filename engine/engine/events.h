@@ -6,6 +6,8 @@
 #include <hpp/event.hpp>
 #include <ospp/event.h>
 
+#include <cstdint>
+
 namespace ace
 {
 
@@ -25,6 +27,9 @@ struct events
     hpp::event<void(rtti::context&)> on_resume;
     hpp::event<void(rtti::context&)> on_skip_next_frame;
 
+    /// scene events, with the id returned by ecs::load_scene_async
+    hpp::event<void(rtti::context&, std::uint64_t)> on_scene_loaded;
+
     /// os events
     hpp::event<void(rtti::context&, const os::event& e)> on_os_event;
 
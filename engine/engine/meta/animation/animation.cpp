@@ -44,11 +44,44 @@ LOAD(animation_channel)
 LOAD_INSTANTIATE(animation_channel, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(animation_channel, ser20::iarchive_binary_t);
 
+SAVE(compressed_animation_clip)
+{
+    try_save(ar, ser20::make_nvp("sample_rate", obj.sample_rate));
+    try_save(ar, ser20::make_nvp("frame_count", obj.frame_count));
+    try_save(ar, ser20::make_nvp("node_indices", obj.node_indices));
+    try_save(ar, ser20::make_nvp("position_min", obj.position_min));
+    try_save(ar, ser20::make_nvp("position_extent", obj.position_extent));
+    try_save(ar, ser20::make_nvp("scaling_min", obj.scaling_min));
+    try_save(ar, ser20::make_nvp("scaling_extent", obj.scaling_extent));
+    try_save(ar, ser20::make_nvp("positions", obj.positions));
+    try_save(ar, ser20::make_nvp("rotations", obj.rotations));
+    try_save(ar, ser20::make_nvp("scalings", obj.scalings));
+}
+SAVE_INSTANTIATE(compressed_animation_clip, ser20::oarchive_associative_t);
+SAVE_INSTANTIATE(compressed_animation_clip, ser20::oarchive_binary_t);
+
+LOAD(compressed_animation_clip)
+{
+    try_load(ar, ser20::make_nvp("sample_rate", obj.sample_rate));
+    try_load(ar, ser20::make_nvp("frame_count", obj.frame_count));
+    try_load(ar, ser20::make_nvp("node_indices", obj.node_indices));
+    try_load(ar, ser20::make_nvp("position_min", obj.position_min));
+    try_load(ar, ser20::make_nvp("position_extent", obj.position_extent));
+    try_load(ar, ser20::make_nvp("scaling_min", obj.scaling_min));
+    try_load(ar, ser20::make_nvp("scaling_extent", obj.scaling_extent));
+    try_load(ar, ser20::make_nvp("positions", obj.positions));
+    try_load(ar, ser20::make_nvp("rotations", obj.rotations));
+    try_load(ar, ser20::make_nvp("scalings", obj.scalings));
+}
+LOAD_INSTANTIATE(compressed_animation_clip, ser20::iarchive_associative_t);
+LOAD_INSTANTIATE(compressed_animation_clip, ser20::iarchive_binary_t);
+
 SAVE(animation_clip)
 {
     try_save(ar, ser20::make_nvp("name", obj.name));
     try_save(ar, ser20::make_nvp("duration", obj.duration));
     try_save(ar, ser20::make_nvp("channels", obj.channels));
+    try_save(ar, ser20::make_nvp("compressed", obj.compressed));
 }
 SAVE_INSTANTIATE(animation_clip, ser20::oarchive_associative_t);
 SAVE_INSTANTIATE(animation_clip, ser20::oarchive_binary_t);
@@ -58,6 +91,7 @@ LOAD(animation_clip)
     try_load(ar, ser20::make_nvp("name", obj.name));
     try_load(ar, ser20::make_nvp("duration", obj.duration));
     try_load(ar, ser20::make_nvp("channels", obj.channels));
+    try_load(ar, ser20::make_nvp("compressed", obj.compressed));
 }
 LOAD_INSTANTIATE(animation_clip, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(animation_clip, ser20::iarchive_binary_t);
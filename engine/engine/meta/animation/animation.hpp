@@ -13,6 +13,9 @@ SAVE_EXTERN(animation_clip);
 LOAD_EXTERN(animation_clip);
 REFLECT_EXTERN(animation_clip);
 
+SAVE_EXTERN(compressed_animation_clip);
+LOAD_EXTERN(compressed_animation_clip);
+
 SAVE_EXTERN(animation_channel);
 LOAD_EXTERN(animation_channel);
 REFLECT_EXTERN(animation_channel);
@@ -1,4 +1,5 @@
 #include "asset_database.hpp"
+#include "asset_importer_meta.hpp"
 
 #include <engine/meta/core/common/basetypes.hpp>
 
@@ -87,7 +88,7 @@ SAVE(asset_meta)
 {
     try_save(ar, ser20::make_nvp("type", obj.type));
     try_save(ar, ser20::make_nvp("uid", obj.uid));
-
+    try_save(ar, ser20::make_nvp("importer", obj.importer));
 }
 SAVE_INSTANTIATE(asset_meta, ser20::oarchive_associative_t);
 SAVE_INSTANTIATE(asset_meta, ser20::oarchive_binary_t);
@@ -96,6 +97,7 @@ LOAD(asset_meta)
 {
     try_load(ar, ser20::make_nvp("type", obj.type));
     try_load(ar, ser20::make_nvp("uid", obj.uid));
+    try_load(ar, ser20::make_nvp("importer", obj.importer));
 }
 LOAD_INSTANTIATE(asset_meta, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(asset_meta, ser20::iarchive_binary_t);
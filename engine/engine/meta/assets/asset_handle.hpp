@@ -8,6 +8,19 @@
 #include <reflection/reflection.h>
 #include <serialization/serialization.h>
 
+namespace ace
+{
+/**
+ * @brief Thread local switch to load asset handles by uid only, without requesting the asset.
+ * Used when archives are only converted, like when cooking scenes and prefabs.
+ */
+inline auto load_asset_handles_by_uid() -> bool&
+{
+    thread_local bool by_uid = false;
+    return by_uid;
+}
+} // namespace ace
+
 namespace ser20
 {
 
@@ -27,6 +40,11 @@ inline void LOAD_FUNCTION_NAME(Archive& ar, asset_handle<T>& obj)
     {
         obj = {};
     }
+    else if(ace::load_asset_handles_by_uid())
+    {
+        obj = {};
+        obj.set_internal_ids(uid);
+    }
     else
     {
         auto& ctx = ace::engine::context();
@@ -0,0 +1,120 @@
+#include "asset_importer_meta.hpp"
+
+namespace ace
+{
+
+REFLECT(asset_importer_meta)
+{
+    rttr::registration::class_<asset_importer_meta>("asset_importer_meta");
+}
+
+SAVE(asset_importer_meta)
+{
+}
+SAVE_INSTANTIATE(asset_importer_meta, ser20::oarchive_associative_t);
+SAVE_INSTANTIATE(asset_importer_meta, ser20::oarchive_binary_t);
+
+LOAD(asset_importer_meta)
+{
+}
+LOAD_INSTANTIATE(asset_importer_meta, ser20::iarchive_associative_t);
+LOAD_INSTANTIATE(asset_importer_meta, ser20::iarchive_binary_t);
+
+REFLECT(texture_importer_meta)
+{
+    rttr::registration::enumeration<texture_importer_meta::texture_type>("texture_type")(
+        rttr::value("Automatic", texture_importer_meta::texture_type::automatic),
+        rttr::value("Color", texture_importer_meta::texture_type::color),
+        rttr::value("Normal Map", texture_importer_meta::texture_type::normal_map),
+        rttr::value("Linear", texture_importer_meta::texture_type::linear));
+
+    rttr::registration::enumeration<texture_importer_meta::compression_format>("compression_format")(
+        rttr::value("Automatic", texture_importer_meta::compression_format::automatic),
+        rttr::value("None", texture_importer_meta::compression_format::none),
+        rttr::value("BC1", texture_importer_meta::compression_format::bc1),
+        rttr::value("BC3", texture_importer_meta::compression_format::bc3),
+        rttr::value("BC4", texture_importer_meta::compression_format::bc4),
+        rttr::value("BC5", texture_importer_meta::compression_format::bc5),
+        rttr::value("BC7", texture_importer_meta::compression_format::bc7),
+        rttr::value("ETC2", texture_importer_meta::compression_format::etc2),
+        rttr::value("ETC2A", texture_importer_meta::compression_format::etc2a),
+        rttr::value("ASTC 4x4", texture_importer_meta::compression_format::astc4x4),
+        rttr::value("ASTC 6x6", texture_importer_meta::compression_format::astc6x6),
+        rttr::value("ASTC 8x8", texture_importer_meta::compression_format::astc8x8));
+
+    rttr::registration::enumeration<texture_importer_meta::compression_quality>("compression_quality")(
+        rttr::value("Fast", texture_importer_meta::compression_quality::fast),
+        rttr::value("Normal", texture_importer_meta::compression_quality::normal),
+        rttr::value("Highest", texture_importer_meta::compression_quality::highest));
+
+    rttr::registration::class_<texture_importer_meta>("texture_importer_meta")
+        .property("type", &texture_importer_meta::type)(
+            rttr::metadata("pretty_name", "Texture Type"),
+            rttr::metadata("tooltip", "Automatic detects normal maps from the file name and contents."))
+        .property("format", &texture_importer_meta::format)(
+            rttr::metadata("pretty_name", "Compression"),
+            rttr::metadata("tooltip",
+                           "Automatic picks BC1/BC3 for color, BC5 for normal maps and BC4 for single channel data."))
+        .property("quality", &texture_importer_meta::quality)(rttr::metadata("pretty_name", "Quality"))
+        .property("generate_mipmaps",
+                  &texture_importer_meta::generate_mipmaps)(rttr::metadata("pretty_name", "Generate Mipmaps"))
+        .property("max_size", &texture_importer_meta::max_size)(
+            rttr::metadata("pretty_name", "Max Size"),
+            rttr::metadata("tooltip", "Max width/height of the compiled texture. 0 keeps the source size."));
+}
+
+SAVE(texture_importer_meta)
+{
+    try_save(ar, ser20::make_nvp("base_type", ser20::base_class<asset_importer_meta>(&obj)));
+    try_save(ar, ser20::make_nvp("type", obj.type));
+    try_save(ar, ser20::make_nvp("format", obj.format));
+    try_save(ar, ser20::make_nvp("quality", obj.quality));
+    try_save(ar, ser20::make_nvp("generate_mipmaps", obj.generate_mipmaps));
+    try_save(ar, ser20::make_nvp("max_size", obj.max_size));
+}
+SAVE_INSTANTIATE(texture_importer_meta, ser20::oarchive_associative_t);
+SAVE_INSTANTIATE(texture_importer_meta, ser20::oarchive_binary_t);
+
+LOAD(texture_importer_meta)
+{
+    try_load(ar, ser20::make_nvp("base_type", ser20::base_class<asset_importer_meta>(&obj)));
+    try_load(ar, ser20::make_nvp("type", obj.type));
+    try_load(ar, ser20::make_nvp("format", obj.format));
+    try_load(ar, ser20::make_nvp("quality", obj.quality));
+    try_load(ar, ser20::make_nvp("generate_mipmaps", obj.generate_mipmaps));
+    try_load(ar, ser20::make_nvp("max_size", obj.max_size));
+}
+LOAD_INSTANTIATE(texture_importer_meta, ser20::iarchive_associative_t);
+LOAD_INSTANTIATE(texture_importer_meta, ser20::iarchive_binary_t);
+
+REFLECT(audio_importer_meta)
+{
+    rttr::registration::enumeration<audio_importer_meta::load_type>("load_type")(
+        rttr::value("Preload", audio_importer_meta::load_type::preload),
+        rttr::value("Stream", audio_importer_meta::load_type::stream));
+
+    rttr::registration::class_<audio_importer_meta>("audio_importer_meta")
+        .property("load", &audio_importer_meta::load)(
+            rttr::metadata("pretty_name", "Load Type"),
+            rttr::metadata("tooltip",
+                           "Preload keeps uncompressed samples for short effects.\n"
+                           "Stream compresses the clip and feeds it to the device in chunks, for music and ambience."));
+}
+
+SAVE(audio_importer_meta)
+{
+    try_save(ar, ser20::make_nvp("base_type", ser20::base_class<asset_importer_meta>(&obj)));
+    try_save(ar, ser20::make_nvp("load", obj.load));
+}
+SAVE_INSTANTIATE(audio_importer_meta, ser20::oarchive_associative_t);
+SAVE_INSTANTIATE(audio_importer_meta, ser20::oarchive_binary_t);
+
+LOAD(audio_importer_meta)
+{
+    try_load(ar, ser20::make_nvp("base_type", ser20::base_class<asset_importer_meta>(&obj)));
+    try_load(ar, ser20::make_nvp("load", obj.load));
+}
+LOAD_INSTANTIATE(audio_importer_meta, ser20::iarchive_associative_t);
+LOAD_INSTANTIATE(audio_importer_meta, ser20::iarchive_binary_t);
+
+} // namespace ace
@@ -0,0 +1,26 @@
+#pragma once
+#include <engine/assets/asset_importer_meta.h>
+
+#include <reflection/reflection.h>
+#include <serialization/serialization.h>
+
+namespace ace
+{
+SAVE_EXTERN(asset_importer_meta);
+LOAD_EXTERN(asset_importer_meta);
+REFLECT_EXTERN(asset_importer_meta);
+
+SAVE_EXTERN(texture_importer_meta);
+LOAD_EXTERN(texture_importer_meta);
+REFLECT_EXTERN(texture_importer_meta);
+
+SAVE_EXTERN(audio_importer_meta);
+LOAD_EXTERN(audio_importer_meta);
+REFLECT_EXTERN(audio_importer_meta);
+
+} // namespace ace
+
+#include <serialization/associative_archive.h>
+#include <serialization/binary_archive.h>
+SERIALIZE_REGISTER_TYPE_WITH_NAME(ace::texture_importer_meta, "texture_importer_meta")
+SERIALIZE_REGISTER_TYPE_WITH_NAME(ace::audio_importer_meta, "audio_importer_meta")
@@ -82,6 +82,26 @@ LOAD(audio_clip)
 }
 LOAD_INSTANTIATE(audio_clip, ser20::iarchive_binary_t);
 
+SAVE(audio_clip_data)
+{
+    try_save(ar, ser20::make_nvp("info", obj.info));
+    try_save(ar, ser20::make_nvp("codec", obj.codec));
+    try_save(ar, ser20::make_nvp("stream", obj.stream));
+    try_save(ar, ser20::make_nvp("samples_per_block", obj.samples_per_block));
+    try_save(ar, ser20::make_nvp("data", obj.data));
+}
+SAVE_INSTANTIATE(audio_clip_data, ser20::oarchive_binary_t);
+
+LOAD(audio_clip_data)
+{
+    try_load(ar, ser20::make_nvp("info", obj.info));
+    try_load(ar, ser20::make_nvp("codec", obj.codec));
+    try_load(ar, ser20::make_nvp("stream", obj.stream));
+    try_load(ar, ser20::make_nvp("samples_per_block", obj.samples_per_block));
+    try_load(ar, ser20::make_nvp("data", obj.data));
+}
+LOAD_INSTANTIATE(audio_clip_data, ser20::iarchive_binary_t);
+
 void save_to_file(const std::string& absolute_path, const audio::sound_data& obj)
 {
     // std::ofstream stream(absolute_path);
@@ -123,4 +143,24 @@ void load_from_file_bin(const std::string& absolute_path, audio::sound_data& obj
         try_load(ar, ser20::make_nvp("sound_data", obj));
     }
 }
+
+void save_to_file_bin(const std::string& absolute_path, const audio_clip_data& obj)
+{
+    std::ofstream stream(absolute_path, std::ios::binary);
+    if(stream.good())
+    {
+        ser20::oarchive_binary_t ar(stream);
+        try_save(ar, ser20::make_nvp("audio_clip_data", obj));
+    }
+}
+
+void load_from_file_bin(const std::string& absolute_path, audio_clip_data& obj)
+{
+    std::ifstream stream(absolute_path, std::ios::binary);
+    if(stream.good())
+    {
+        ser20::iarchive_binary_t ar(stream);
+        try_load(ar, ser20::make_nvp("audio_clip_data", obj));
+    }
+}
 } // namespace ace
@@ -11,9 +11,15 @@ SAVE_EXTERN(audio_clip);
 LOAD_EXTERN(audio_clip);
 REFLECT_EXTERN(audio_clip);
 
+SAVE_EXTERN(audio_clip_data);
+LOAD_EXTERN(audio_clip_data);
+
 void save_to_file(const std::string& absolute_path, const audio::sound_data& obj);
 void save_to_file_bin(const std::string& absolute_path, const audio::sound_data& obj);
 auto load_from_file(const std::string& absolute_path, audio::sound_data& obj, std::string& err) -> bool;
 void load_from_file_bin(const std::string& absolute_path, audio::sound_data& obj);
 
+void save_to_file_bin(const std::string& absolute_path, const audio_clip_data& obj);
+void load_from_file_bin(const std::string& absolute_path, audio_clip_data& obj);
+
 } // namespace ace
@@ -7,6 +7,42 @@
 namespace ace
 {
 
+REFLECT(animation_lod_level)
+{
+    rttr::registration::class_<animation_lod_level>("animation_lod_level")(rttr::metadata("pretty_name", "LOD Level"))
+        .constructor<>()()
+        .property("min_screen_percent", &animation_lod_level::min_screen_percent)(
+            rttr::metadata("pretty_name", "Min Screen Percent"),
+            rttr::metadata("tooltip", "Minimum screen height of the model, in percent of the viewport."),
+            rttr::metadata("min", 0.0f),
+            rttr::metadata("max", 100.0f))
+        .property("update_interval", &animation_lod_level::update_interval)(
+            rttr::metadata("pretty_name", "Update Interval"),
+            rttr::metadata("tooltip", "The animation is sampled every N frames and interpolated in between."),
+            rttr::metadata("min", 1))
+        .property("max_node_depth", &animation_lod_level::max_node_depth)(
+            rttr::metadata("pretty_name", "Max Node Depth"),
+            rttr::metadata("tooltip", "Armature nodes deeper than this keep their last pose."));
+}
+
+SAVE(animation_lod_level)
+{
+    try_save(ar, ser20::make_nvp("min_screen_percent", obj.min_screen_percent));
+    try_save(ar, ser20::make_nvp("update_interval", obj.update_interval));
+    try_save(ar, ser20::make_nvp("max_node_depth", obj.max_node_depth));
+}
+SAVE_INSTANTIATE(animation_lod_level, ser20::oarchive_associative_t);
+SAVE_INSTANTIATE(animation_lod_level, ser20::oarchive_binary_t);
+
+LOAD(animation_lod_level)
+{
+    try_load(ar, ser20::make_nvp("min_screen_percent", obj.min_screen_percent));
+    try_load(ar, ser20::make_nvp("update_interval", obj.update_interval));
+    try_load(ar, ser20::make_nvp("max_node_depth", obj.max_node_depth));
+}
+LOAD_INSTANTIATE(animation_lod_level, ser20::iarchive_associative_t);
+LOAD_INSTANTIATE(animation_lod_level, ser20::iarchive_binary_t);
+
 REFLECT(animation_component)
 {
     rttr::registration::enumeration<animation_component::culling_mode>("animation_component::culling_mode")(
@@ -23,12 +59,17 @@ REFLECT(animation_component)
             rttr::metadata("tooltip", "Controls whether the animation should auto start."))
         .property("culling_mode", &animation_component::get_culling_mode, &animation_component::set_culling_mode)(
             rttr::metadata("pretty_name", "Culling Mode"),
-            rttr::metadata("tooltip", "Controls how the animation logic should be culled."));
+            rttr::metadata("tooltip", "Controls how the animation logic should be culled."))
+        .property("lod_levels", &animation_component::get_lod_levels, &animation_component::set_lod_levels)(
+            rttr::metadata("pretty_name", "LOD Levels"),
+            rttr::metadata("tooltip", "Update rate and depth by screen size, used by renderer based culling."));
 }
 
 SAVE(animation_component)
 {
     try_save(ar, ser20::make_nvp("animation", obj.get_animation()));
+    try_save(ar, ser20::make_nvp("culling_mode", obj.get_culling_mode()));
+    try_save(ar, ser20::make_nvp("lod_levels", obj.get_lod_levels()));
 }
 SAVE_INSTANTIATE(animation_component, ser20::oarchive_associative_t);
 SAVE_INSTANTIATE(animation_component, ser20::oarchive_binary_t);
@@ -40,6 +81,18 @@ LOAD(animation_component)
     {
         obj.set_animation(animation);
     }
+
+    animation_component::culling_mode culling_mode{};
+    if(try_load(ar, ser20::make_nvp("culling_mode", culling_mode)))
+    {
+        obj.set_culling_mode(culling_mode);
+    }
+
+    std::vector<animation_component::lod_level> lod_levels;
+    if(try_load(ar, ser20::make_nvp("lod_levels", lod_levels)))
+    {
+        obj.set_lod_levels(lod_levels);
+    }
 }
 LOAD_INSTANTIATE(animation_component, ser20::iarchive_associative_t);
 LOAD_INSTANTIATE(animation_component, ser20::iarchive_binary_t);
@@ -6,6 +6,10 @@
 
 namespace ace
 {
+SAVE_EXTERN(animation_lod_level);
+LOAD_EXTERN(animation_lod_level);
+REFLECT_EXTERN(animation_lod_level);
+
 SAVE_EXTERN(animation_component);
 LOAD_EXTERN(animation_component);
 REFLECT_EXTERN(animation_component);
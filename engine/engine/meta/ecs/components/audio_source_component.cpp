@@ -36,6 +36,13 @@ REFLECT(audio_source_component)
                                                                rttr::metadata("max", 10.0f))
         .property("range", &audio_source_component::get_range, &audio_source_component::set_range)(
             rttr::metadata("pretty_name", "Range"))
+        .property("priority", &audio_source_component::get_priority, &audio_source_component::set_priority)(
+            rttr::metadata("pretty_name", "Priority"),
+            rttr::metadata("tooltip",
+                           "0 is the most important. When too many sources play, the least important and "
+                           "least audible ones are virtualized."),
+            rttr::metadata("min", 0),
+            rttr::metadata("max", 256))
         .property("sound", &audio_source_component::get_sound, &audio_source_component::set_sound)(
             rttr::metadata("pretty_name", "Sound"));
     ;
@@ -49,6 +56,7 @@ SAVE(audio_source_component)
     try_save(ar, ser20::make_nvp("pitch", obj.get_pitch()));
     try_save(ar, ser20::make_nvp("volume_rolloff", obj.get_volume_rolloff()));
     try_save(ar, ser20::make_nvp("range", obj.get_range()));
+    try_save(ar, ser20::make_nvp("priority", obj.get_priority()));
     try_save(ar, ser20::make_nvp("sound", obj.get_sound()));
 }
 SAVE_INSTANTIATE(audio_source_component, ser20::oarchive_associative_t);
@@ -92,6 +100,12 @@ LOAD(audio_source_component)
         obj.set_range(range);
     }
 
+    int priority{128};
+    if(try_load(ar, ser20::make_nvp("priority", priority)))
+    {
+        obj.set_priority(priority);
+    }
+
     asset_handle<audio_clip> sound;
     if(try_load(ar, ser20::make_nvp("sound", sound)))
     {
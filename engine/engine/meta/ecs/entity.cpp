@@ -4,14 +4,22 @@
 #include <serialization/archives/yaml.hpp>
 #include <serialization/associative_archive.h>
 #include <serialization/binary_archive.h>
+#include <serialization/types/string.hpp>
+#include <serialization/types/vector.hpp>
 
 #include "components/all_components.h"
+#include <engine/meta/assets/asset_handle.hpp>
 
 #include "entt/entity/fwd.hpp"
 #include "logging/logging.h"
 
 #include <hpp/utility.hpp>
+#include <algorithm>
+#include <array>
+#include <mutex>
 #include <sstream>
+#include <type_traits>
+#include <unordered_map>
 
 namespace ace
 {
@@ -178,6 +186,172 @@ namespace ace
 namespace
 {
 
+/**
+ * @struct clone_mapping
+ * @brief Maps entities of the source registry to their clones in the destination one.
+ */
+struct clone_mapping
+{
+    auto remap(entt::const_handle src) const -> entt::handle
+    {
+        auto it = entities.find(src.entity());
+        if(it == entities.end())
+        {
+            return {};
+        }
+        return it->second;
+    }
+
+    std::unordered_map<entt::entity, entt::handle> entities;
+};
+
+/**
+ * @brief Components owning runtime resources like voices, render targets, shadow maps,
+ * physics bodies or playback state get fresh ones, and only their reflected properties
+ * are copied through the setters, same as when they are loaded.
+ */
+template<typename T>
+constexpr auto is_cloned_by_properties() -> bool
+{
+    return std::is_same_v<T, camera_component> || std::is_same_v<T, light_component> ||
+           std::is_same_v<T, reflection_probe_component> || std::is_same_v<T, physics_component> ||
+           std::is_same_v<T, animation_component> || std::is_same_v<T, audio_source_component> ||
+           std::is_same_v<T, audio_listener_component>;
+}
+
+template<typename T>
+void copy_properties(const T& src, T& dst)
+{
+    static const auto properties = rttr::type::get<T>().get_properties();
+    for(const auto& prop : properties)
+    {
+        if(!prop.is_readonly())
+        {
+            prop.set_value(dst, prop.get_value(src));
+        }
+    }
+}
+
+template<typename T>
+void clone_component(const T& src, entt::handle dst, const clone_mapping& mapping)
+{
+    if constexpr(is_cloned_by_properties<T>())
+    {
+        auto& component = dst.emplace_or_replace<T>();
+        copy_properties(src, component);
+    }
+    else if constexpr(std::is_same_v<T, transform_component>)
+    {
+        // The hierarchy is linked once all transforms exist.
+        auto& component = dst.emplace_or_replace<T>(src);
+        component._clear_relationships();
+    }
+    else if constexpr(std::is_same_v<T, model_component>)
+    {
+        auto& component = dst.emplace_or_replace<T>(src);
+
+        std::vector<entt::handle> armature_entities;
+        armature_entities.reserve(src.get_armature_entities().size());
+        for(const auto& e : src.get_armature_entities())
+        {
+            auto mapped = mapping.remap(e);
+            if(!mapped)
+            {
+                // Let the armature be discovered again from the hierarchy.
+                armature_entities.clear();
+                break;
+            }
+            armature_entities.emplace_back(mapped);
+        }
+        component.set_armature_entities(armature_entities);
+    }
+    else
+    {
+        dst.emplace_or_replace<T>(src);
+    }
+}
+
+void link_hierarchy(const entt::registry& src, const std::vector<entt::entity>& entities, const clone_mapping& mapping)
+{
+    for(auto e : entities)
+    {
+        const auto* transform = src.try_get<transform_component>(e);
+        if(!transform)
+        {
+            continue;
+        }
+
+        auto parent = mapping.remap(entt::const_handle(src, e));
+        for(const auto& child : transform->get_children())
+        {
+            auto mapped = mapping.remap(child);
+            if(mapped)
+            {
+                mapped.get<transform_component>().set_parent(parent, false);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copies the components of the given entities into their mapped clones.
+ * Every component type is processed as a whole, walking either its pool or the
+ * entities, whichever is smaller. Pools are never walked while cloning into the
+ * same registry since they grow during the copy.
+ */
+void clone_entities(const entt::registry& src,
+                    const std::vector<entt::entity>& entities,
+                    const clone_mapping& mapping,
+                    bool same_registry)
+{
+    hpp::for_each_tuple_type<ace::all_serializeable_components>(
+        [&](auto index)
+        {
+            using ctype = std::tuple_element_t<decltype(index)::value, ace::all_serializeable_components>;
+
+            // Walking the pool is only valid when the mapping holds just the cloned entities.
+            auto view = src.view<ctype>();
+            if(!same_registry && mapping.entities.size() == entities.size() && view.size() < entities.size())
+            {
+                for(auto e : view)
+                {
+                    auto it = mapping.entities.find(e);
+                    if(it != mapping.entities.end())
+                    {
+                        clone_component(view.template get<ctype>(e), it->second, mapping);
+                    }
+                }
+            }
+            else
+            {
+                for(auto e : entities)
+                {
+                    if(const auto* component = src.try_get<ctype>(e))
+                    {
+                        clone_component(*component, mapping.entities.at(e), mapping);
+                    }
+                }
+            }
+
+            // Link parents right after the transforms, components created later expect them.
+            if constexpr(std::is_same_v<ctype, transform_component>)
+            {
+                link_hierarchy(src, entities, mapping);
+            }
+        });
+}
+
+void collect_hierarchy(entt::const_handle obj, std::vector<entt::entity>& entities)
+{
+    entities.emplace_back(obj.entity());
+
+    const auto& children = obj.get<transform_component>().get_children();
+    for(const auto& child : children)
+    {
+        collect_hierarchy(child, entities);
+    }
+}
+
 void flatten_hierarchy(entt::const_handle obj, std::vector<entity_data<entt::const_handle>>& entities)
 {
     auto& trans_comp = obj.get<transform_component>();
@@ -289,17 +463,406 @@ void save_to_archive(Archive& ar, const entt::registry& reg)
 }
 
 template<typename Archive>
-void load_from_archive(Archive& ar, entt::registry& reg)
+auto load_from_archive(Archive& ar, entt::registry& reg) -> bool
 {
     reg.clear();
     size_t count = 0;
-    try_load(ar, ser20::make_nvp("entities_count", count));
+    if(!try_load(ar, ser20::make_nvp("entities_count", count)))
+    {
+        return false;
+    }
 
     for(size_t i = 0; i < count; ++i)
     {
         entt::handle e(reg, reg.create());
         load_from_archive(ar, e);
     }
+
+    return true;
+}
+
+/// Leading bytes of a cooked scene or prefab, telling it apart from the json source.
+constexpr std::array<char, 4> cooked_magic{'A', 'C', 'E', 'S'};
+/// Bumped whenever the cooked layout or the serialization of a component changes.
+constexpr std::uint32_t cooked_version = 4;
+
+auto is_cooked(const std::vector<uint8_t>& data) -> bool
+{
+    return data.size() >= cooked_magic.size() &&
+           std::equal(cooked_magic.begin(), cooked_magic.end(), reinterpret_cast<const char*>(data.data()));
+}
+
+/**
+ * @struct cooked_block
+ * @brief All components of one type, stored as the indices of their entities
+ * followed by the components themselves in the same order.
+ */
+struct cooked_block
+{
+    /// Pretty name of the component type.
+    std::string name;
+    /// Indices into the cooked entity list.
+    std::vector<std::uint32_t> entities;
+    /// Binary archive of the components.
+    std::string data;
+};
+
+template<typename T>
+auto get_block_name() -> const std::string&
+{
+    static const std::string name = rttr::get_pretty_name(rttr::type::get<T>());
+    return name;
+}
+
+template<typename T>
+auto save_block(const entt::registry& reg,
+                const std::vector<entt::entity>& entities,
+                std::vector<std::string>& tags,
+                std::unordered_map<std::string, std::uint32_t>& tag_indices) -> cooked_block
+{
+    cooked_block block;
+    block.name = get_block_name<T>();
+
+    std::ostringstream stream;
+    {
+        ser20::oarchive_binary_t ar(stream);
+        for(size_t i = 0; i < entities.size(); ++i)
+        {
+            const auto* component = reg.try_get<T>(entities[i]);
+            if(!component)
+            {
+                continue;
+            }
+
+            block.entities.emplace_back(static_cast<std::uint32_t>(i));
+
+            if constexpr(std::is_same_v<T, tag_component>)
+            {
+                auto [it, inserted] = tag_indices.emplace(component->tag, static_cast<std::uint32_t>(tags.size()));
+                if(inserted)
+                {
+                    tags.emplace_back(component->tag);
+                }
+                try_save(ar, ser20::make_nvp("tag", it->second));
+            }
+            else
+            {
+                try_save(ar, ser20::make_nvp(block.name, *component));
+            }
+        }
+    }
+
+    block.data = stream.str();
+    return block;
+}
+
+template<typename T>
+void load_block(cooked_block& block, const std::vector<std::string>& tags, const std::vector<entt::handle>& entities)
+{
+    std::istringstream stream(std::move(block.data));
+    ser20::iarchive_binary_t ar(stream);
+
+    for(auto index : block.entities)
+    {
+        if(index >= entities.size())
+        {
+            APPLOG_ERROR("Corrupted {0} block, entity index {1} is out of range.", block.name, index);
+            return;
+        }
+
+        auto& component = entities[index].emplace_or_replace<T>();
+
+        if constexpr(std::is_same_v<T, tag_component>)
+        {
+            std::uint32_t tag_index{};
+            try_load(ar, ser20::make_nvp("tag", tag_index));
+            if(tag_index < tags.size())
+            {
+                component.tag = tags[tag_index];
+            }
+        }
+        else
+        {
+            try_load(ar, ser20::make_nvp(block.name, component));
+        }
+    }
+}
+
+using block_loader_t = void (*)(cooked_block&, const std::vector<std::string>&, const std::vector<entt::handle>&);
+
+auto get_block_loaders() -> const std::unordered_map<std::string, block_loader_t>&
+{
+    static const auto loaders = []()
+    {
+        std::unordered_map<std::string, block_loader_t> result;
+        hpp::for_each_tuple_type<ace::all_serializeable_components>(
+            [&](auto index)
+            {
+                using ctype = std::tuple_element_t<decltype(index)::value, ace::all_serializeable_components>;
+                result.emplace(get_block_name<ctype>(), &load_block<ctype>);
+            });
+        return result;
+    }();
+
+    return loaders;
+}
+
+/**
+ * @brief Saves the entities in the cooked format: the entity list, a string table
+ * for the tags and one block per component type. Entities must be ordered parent first.
+ */
+void save_cooked(std::ostream& stream, const entt::registry& reg, const std::vector<entt::entity>& entities)
+{
+    std::vector<std::string> tags;
+    std::unordered_map<std::string, std::uint32_t> tag_indices;
+    std::vector<cooked_block> blocks;
+
+    hpp::for_each_tuple_type<ace::all_serializeable_components>(
+        [&](auto index)
+        {
+            using ctype = std::tuple_element_t<decltype(index)::value, ace::all_serializeable_components>;
+
+            auto block = save_block<ctype>(reg, entities, tags, tag_indices);
+            if(!block.entities.empty())
+            {
+                blocks.emplace_back(std::move(block));
+            }
+        });
+
+    stream.write(cooked_magic.data(), cooked_magic.size());
+
+    ser20::oarchive_binary_t ar(stream);
+    try_save(ar, ser20::make_nvp("version", cooked_version));
+    try_save(ar, ser20::make_nvp("entities", entities));
+    try_save(ar, ser20::make_nvp("tags", tags));
+    try_save(ar, ser20::make_nvp("blocks_count", static_cast<std::uint32_t>(blocks.size())));
+    for(const auto& block : blocks)
+    {
+        try_save(ar, ser20::make_nvp("name", block.name));
+        try_save(ar, ser20::make_nvp("entities", block.entities));
+        try_save(ar, ser20::make_nvp("data", block.data));
+    }
+}
+
+/**
+ * @brief Loads entities saved by save_cooked. A valid root is used for the first entity.
+ * Blocks of unknown component types are skipped.
+ * @return The loaded entities in their saved order, empty on failure.
+ */
+auto load_cooked(std::istream& stream,
+                 entt::registry& registry,
+                 entt::handle root,
+                 const std::function<void(entt::handle)>& on_create = {}) -> std::vector<entt::handle>
+{
+    std::vector<entt::handle> result;
+
+    std::array<char, 4> magic{};
+    stream.read(magic.data(), magic.size());
+    if(!stream.good() || magic != cooked_magic)
+    {
+        APPLOG_ERROR("Not a cooked scene or prefab.");
+        return result;
+    }
+
+    ser20::iarchive_binary_t ar(stream);
+
+    std::uint32_t version{};
+    try_load(ar, ser20::make_nvp("version", version));
+    if(version != cooked_version)
+    {
+        APPLOG_ERROR("Unsupported cooked version {0}, expected {1}. The asset must be recompiled.",
+                     version,
+                     cooked_version);
+        return result;
+    }
+
+    std::vector<entt::entity> ids;
+    try_load(ar, ser20::make_nvp("entities", ids));
+
+    std::vector<std::string> tags;
+    try_load(ar, ser20::make_nvp("tags", tags));
+
+    std::uint32_t blocks_count{};
+    try_load(ar, ser20::make_nvp("blocks_count", blocks_count));
+
+    if(ids.empty())
+    {
+        return result;
+    }
+
+    std::vector<entt::entity> created(ids.size());
+    size_t first = 0;
+    if(root)
+    {
+        created[first++] = root.entity();
+    }
+    registry.create(created.begin() + first, created.end());
+
+    entity_loader loader;
+    loader.reg = &registry;
+
+    result.reserve(created.size());
+    for(size_t i = 0; i < created.size(); ++i)
+    {
+        auto& obj = result.emplace_back(registry, created[i]);
+        loader.mapping[ids[i]] = obj;
+    }
+
+    set_loader(loader);
+
+    const auto& loaders = get_block_loaders();
+    for(std::uint32_t i = 0; i < blocks_count; ++i)
+    {
+        cooked_block block;
+        try_load(ar, ser20::make_nvp("name", block.name));
+        try_load(ar, ser20::make_nvp("entities", block.entities));
+        try_load(ar, ser20::make_nvp("data", block.data));
+
+        auto it = loaders.find(block.name);
+        if(it == loaders.end())
+        {
+            APPLOG_WARNING("Skipping unknown component block {0}.", block.name);
+            continue;
+        }
+
+        it->second(block, tags, result);
+    }
+
+    reset_loader();
+
+    if(on_create)
+    {
+        for(const auto& e : result)
+        {
+            on_create(e);
+        }
+    }
+
+    return result;
+}
+
+void save_cooked(std::ostream& stream, entt::const_handle obj)
+{
+    bool is_root = obj.all_of<root_component>();
+    if(!is_root)
+    {
+        const_handle_cast(obj).emplace<root_component>();
+    }
+
+    std::vector<entt::entity> entities;
+    collect_hierarchy(obj, entities);
+    save_cooked(stream, *obj.registry(), entities);
+
+    if(!is_root)
+    {
+        const_handle_cast(obj).erase<root_component>();
+    }
+}
+
+void save_cooked(std::ostream& stream, const entt::registry& reg)
+{
+    std::vector<entt::entity> entities;
+    reg.view<transform_component, root_component>().each(
+        [&](auto e, auto&& comp1, auto&& comp2)
+        {
+            collect_hierarchy(entt::const_handle(reg, e), entities);
+        });
+
+    save_cooked(stream, reg, entities);
+}
+
+void save_cooked(std::ostream& stream, const scene& scn)
+{
+    save_cooked(stream, *scn.registry);
+}
+
+/**
+ * @struct asset_uid_scope
+ * @brief Loads asset handles by uid only while alive, see load_asset_handles_by_uid.
+ */
+struct asset_uid_scope
+{
+    asset_uid_scope() : previous(load_asset_handles_by_uid())
+    {
+        load_asset_handles_by_uid() = true;
+    }
+
+    ~asset_uid_scope()
+    {
+        load_asset_handles_by_uid() = previous;
+    }
+
+    bool previous{};
+};
+
+auto build_prefab_template(const asset_handle<prefab>& pfb) -> std::shared_ptr<prefab_template>
+{
+    APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    auto templ = std::make_shared<prefab_template>();
+    auto& registry = *templ->entities.registry;
+
+    auto on_create = [&pfb](entt::handle obj)
+    {
+        if(obj)
+        {
+            auto& pfb_comp = obj.get_or_emplace<prefab_component>();
+            pfb_comp.source = pfb;
+        }
+    };
+
+    entt::handle root;
+    const auto& prefab = pfb.get();
+    if(is_cooked(prefab->buffer.data))
+    {
+        auto buffer = prefab->buffer.get_stream_buf();
+        std::istream stream(&buffer);
+        auto entities = load_cooked(stream, registry, {}, on_create);
+        if(!entities.empty())
+        {
+            root = entities.front();
+        }
+    }
+    else
+    {
+        const auto& buffer = prefab->buffer.data;
+        if(!buffer.empty())
+        {
+            auto ar = ser20::create_iarchive_associative(buffer.data(), buffer.size());
+            root = load_from_archive_start(ar, registry, on_create);
+        }
+    }
+
+    if(root)
+    {
+        collect_hierarchy(root, templ->hierarchy);
+    }
+
+    return templ;
+}
+
+/**
+ * @brief Gets the decoded template of a prefab, decoding it on first use.
+ * Cooked and json buffers are told apart by their leading bytes.
+ * Prefabs can be instantiated from any thread, the template is built once under a lock.
+ */
+auto get_prefab_template(const asset_handle<prefab>& pfb) -> std::shared_ptr<prefab_template>
+{
+    const auto& prefab = pfb.get();
+    if(!prefab)
+    {
+        return nullptr;
+    }
+
+    static std::mutex template_mutex;
+    std::lock_guard<std::mutex> lock(template_mutex);
+
+    if(!prefab->instance_template)
+    {
+        prefab->instance_template = build_prefab_template(pfb);
+    }
+
+    return prefab->instance_template;
 }
 
 } // namespace
@@ -326,9 +889,7 @@ void save_to_stream_bin(std::ostream& stream, entt::const_handle obj)
 {
     if(stream.good())
     {
-        ser20::oarchive_binary_t ar(stream);
-
-        save_to_archive(ar, obj);
+        save_cooked(stream, obj);
     }
 }
 
@@ -372,8 +933,11 @@ void load_from_stream_bin(std::istream& stream, entt::handle& obj)
     {
         APPLOG_INFO_PERF(std::chrono::microseconds);
 
-        ser20::iarchive_binary_t ar(stream);
-        load_from_archive(ar, obj);
+        auto entities = load_cooked(stream, *obj.registry(), obj);
+        if(!entities.empty())
+        {
+            obj = entities.front();
+        }
     }
 }
 
@@ -387,57 +951,57 @@ void load_from_file_bin(const std::string& absolute_path, entt::handle& obj)
 
 auto load_from_prefab(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle
 {
-    entt::handle obj;
-
-    const auto& prefab = pfb.get();
-    const auto& buffer = prefab->buffer.data;
-
-    if(!buffer.empty())
+    auto instances = load_from_prefab_n(pfb, registry, 1);
+    if(instances.empty())
     {
-        APPLOG_INFO_PERF(std::chrono::microseconds);
-
-        auto ar = ser20::create_iarchive_associative(buffer.data(), buffer.size());
-
-        auto on_create = [&pfb](entt::handle obj)
-        {
-            if(obj)
-            {
-                auto& pfb_comp = obj.get_or_emplace<prefab_component>();
-                pfb_comp.source = pfb;
-            }
-        };
-
-        obj = load_from_archive_start(ar, registry, on_create);
+        return {};
     }
 
-    return obj;
+    return instances.front();
 }
+
 auto load_from_prefab_bin(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle
 {
-    entt::handle obj;
+    return load_from_prefab(pfb, registry);
+}
 
-    const auto& prefab = pfb.get();
-    auto buffer = prefab->buffer.get_stream_buf();
-    std::istream stream(&buffer);
-    if(stream.good())
+auto load_from_prefab_n(const asset_handle<prefab>& pfb, entt::registry& registry, size_t count)
+    -> std::vector<entt::handle>
+{
+    std::vector<entt::handle> instances;
+
+    const auto& templ = get_prefab_template(pfb);
+    if(!templ || templ->hierarchy.empty() || count == 0)
     {
-        APPLOG_INFO_PERF(std::chrono::microseconds);
+        return instances;
+    }
+
+    APPLOG_INFO_PERF(std::chrono::microseconds);
 
-        ser20::iarchive_binary_t ar(stream);
+    const auto& hierarchy = templ->hierarchy;
+    const auto& src = *templ->entities.registry;
 
-        auto on_create = [&pfb](entt::handle obj)
+    std::vector<entt::entity> created(hierarchy.size() * count);
+    registry.create(created.begin(), created.end());
+
+    instances.reserve(count);
+
+    clone_mapping mapping;
+    mapping.entities.reserve(hierarchy.size());
+    for(size_t i = 0; i < count; ++i)
+    {
+        mapping.entities.clear();
+        for(size_t j = 0; j < hierarchy.size(); ++j)
         {
-            if(obj)
-            {
-                auto& pfb_comp = obj.get_or_emplace<prefab_component>();
-                pfb_comp.source = pfb;
-            }
-        };
+            mapping.entities.emplace(hierarchy[j], entt::handle(registry, created[i * hierarchy.size() + j]));
+        }
+
+        clone_entities(src, hierarchy, mapping, false);
 
-        obj = load_from_archive_start(ar, registry, on_create);
+        instances.emplace_back(registry, created[i * hierarchy.size()]);
     }
 
-    return obj;
+    return instances;
 }
 
 void clone_entity_from_stream(entt::const_handle src_obj, entt::handle& dst_obj)
@@ -453,6 +1017,40 @@ void clone_entity_from_stream(entt::const_handle src_obj, entt::handle& dst_obj)
     load_from(ss, dst_obj);
 }
 
+void clone_entity_from_registry(entt::const_handle src_obj, entt::handle& dst_obj)
+{
+    APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    std::vector<entt::entity> entities;
+    collect_hierarchy(src_obj, entities);
+
+    auto& dst = *dst_obj.registry();
+
+    clone_mapping mapping;
+    mapping.entities.reserve(entities.size());
+    mapping.entities.emplace(src_obj.entity(), dst_obj);
+    for(size_t i = 1; i < entities.size(); ++i)
+    {
+        mapping.entities.emplace(entities[i], entt::handle(dst, dst.create()));
+    }
+
+    clone_entities(*src_obj.registry(), entities, mapping, src_obj.registry() == dst_obj.registry());
+}
+
+void clone_entity_from_registry(entt::const_handle src_obj, std::unordered_map<entt::entity, entt::handle>& clones)
+{
+    APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    std::vector<entt::entity> entities;
+    collect_hierarchy(src_obj, entities);
+
+    // Borrow the clones for the copy, they are handed back untouched.
+    clone_mapping mapping;
+    mapping.entities.swap(clones);
+    clone_entities(*src_obj.registry(), entities, mapping, false);
+    mapping.entities.swap(clones);
+}
+
 void save_to_stream(std::ostream& stream, const scene& scn)
 {
     if(stream.good())
@@ -476,8 +1074,7 @@ void save_to_stream_bin(std::ostream& stream, const scene& scn)
     {
         APPLOG_INFO_PERF(std::chrono::microseconds);
 
-        ser20::oarchive_binary_t ar(stream);
-        save_to_archive(ar, *scn.registry);
+        save_cooked(stream, scn);
     }
 }
 void save_to_file_bin(const std::string& absolute_path, const scene& scn)
@@ -515,13 +1112,17 @@ void load_from_file(const std::string& absolute_path, scene& scn)
     load_from_stream(stream, scn);
 }
 void load_from_stream_bin(std::istream& stream, scene& scn)
+{
+    load_from_stream_bin(stream, *scn.registry);
+}
+void load_from_stream_bin(std::istream& stream, entt::registry& registry)
 {
     if(stream.good())
     {
         APPLOG_INFO_PERF(std::chrono::microseconds);
 
-        ser20::iarchive_binary_t ar(stream);
-        load_from_archive(ar, *scn.registry);
+        registry.clear();
+        load_cooked(stream, registry, {});
     }
 }
 void load_from_file_bin(const std::string& absolute_path, scene& scn)
@@ -533,20 +1134,33 @@ void load_from_file_bin(const std::string& absolute_path, scene& scn)
 }
 
 auto load_from_prefab(const asset_handle<scene_prefab>& pfb, scene& scn) -> bool
+{
+    return load_from_prefab(pfb, *scn.registry);
+}
+auto load_from_prefab(const asset_handle<scene_prefab>& pfb, entt::registry& registry) -> bool
 {
     const auto& prefab = pfb.get();
     const auto& buffer = prefab->buffer.data;
 
+    if(is_cooked(buffer))
+    {
+        return load_from_prefab_bin(pfb, registry);
+    }
+
     if(!buffer.empty())
     {
         APPLOG_INFO_PERF(std::chrono::microseconds);
         auto ar = ser20::create_iarchive_associative(buffer.data(), buffer.size());
-        load_from_archive(ar, *scn.registry);
+        load_from_archive(ar, registry);
     }
 
     return true;
 }
 auto load_from_prefab_bin(const asset_handle<scene_prefab>& pfb, scene& scn) -> bool
+{
+    return load_from_prefab_bin(pfb, *scn.registry);
+}
+auto load_from_prefab_bin(const asset_handle<scene_prefab>& pfb, entt::registry& registry) -> bool
 {
     const auto& prefab = pfb.get();
     auto buffer = prefab->buffer.get_stream_buf();
@@ -558,7 +1172,7 @@ auto load_from_prefab_bin(const asset_handle<scene_prefab>& pfb, scene& scn) ->
         return false;
     }
 
-    load_from_stream_bin(stream, scn);
+    load_from_stream_bin(stream, registry);
 
     return true;
 }
@@ -586,4 +1200,94 @@ void clone_scene_from_stream(const scene& src_scene, scene& dst_scene)
             load_from(ss, e_clone_obj);
         });
 }
+
+void clone_scene_from_registry(const scene& src_scene, scene& dst_scene)
+{
+    dst_scene.unload();
+
+    auto& src = *src_scene.registry;
+    auto& dst = *dst_scene.registry;
+
+    APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    // Same set of entities as the root hierarchies saved by the stream clone.
+    auto view = src.view<transform_component>();
+
+    std::vector<entt::entity> entities;
+    entities.reserve(view.size());
+
+    clone_mapping mapping;
+    mapping.entities.reserve(view.size());
+
+    for(auto e : view)
+    {
+        entities.emplace_back(e);
+        mapping.entities.emplace(e, entt::handle(dst, dst.create()));
+    }
+
+    clone_entities(src, entities, mapping, &src == &dst);
+}
+
+auto cook_prefab(const std::string& source_path, const std::string& cooked_path) -> bool
+{
+    APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    std::ifstream stream(source_path);
+    if(!stream.good())
+    {
+        return false;
+    }
+
+    // Components only pass through a private registry. Owners and roots are still needed to save them,
+    // the hooks of the systems are left out.
+    asset_uid_scope uid_scope;
+    entt::registry registry;
+    scene::connect_owner_hooks(registry);
+
+    auto ar = ser20::create_iarchive_associative(stream);
+    auto root = load_from_archive_start(ar, registry);
+    if(!root || !root.all_of<transform_component>())
+    {
+        return false;
+    }
+
+    std::ofstream output(cooked_path, std::ios::binary);
+    if(!output.good())
+    {
+        return false;
+    }
+
+    save_cooked(output, root);
+    return output.good();
+}
+
+auto cook_scene(const std::string& source_path, const std::string& cooked_path) -> bool
+{
+    APPLOG_INFO_PERF(std::chrono::microseconds);
+
+    std::ifstream stream(source_path);
+    if(!stream.good())
+    {
+        return false;
+    }
+
+    asset_uid_scope uid_scope;
+    entt::registry registry;
+    scene::connect_owner_hooks(registry);
+
+    auto ar = ser20::create_iarchive_associative(stream);
+    if(!load_from_archive(ar, registry))
+    {
+        return false;
+    }
+
+    std::ofstream output(cooked_path, std::ios::binary);
+    if(!output.good())
+    {
+        return false;
+    }
+
+    save_cooked(output, registry);
+    return output.good();
+}
 } // namespace ace
@@ -6,6 +6,7 @@
 #include <serialization/serialization.h>
 
 #include <string_view>
+#include <unordered_map>
 
 namespace ace
 {
@@ -35,8 +36,14 @@ void load_from_file_bin(const std::string& absolute_path, entt::handle& obj);
 
 auto load_from_prefab(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle;
 auto load_from_prefab_bin(const asset_handle<prefab>& pfb, entt::registry& registry) -> entt::handle;
+auto load_from_prefab_n(const asset_handle<prefab>& pfb, entt::registry& registry, size_t count)
+    -> std::vector<entt::handle>;
 
 void clone_entity_from_stream(entt::const_handle src_obj, entt::handle& dst_obj);
+void clone_entity_from_registry(entt::const_handle src_obj, entt::handle& dst_obj);
+// Clones a hierarchy into entities created up front, so references to entities cloned
+// in other calls are kept. clones maps every source entity to its clone.
+void clone_entity_from_registry(entt::const_handle src_obj, std::unordered_map<entt::entity, entt::handle>& clones);
 
 void save_to_stream(std::ostream& stream, const scene& scn);
 void save_to_file(const std::string& absolute_path, const scene& scn);
@@ -49,12 +56,22 @@ void load_from_stream(std::istream& stream, scene& scn);
 
 void load_from_file(const std::string& absolute_path, scene& scn);
 void load_from_stream_bin(std::istream& stream, scene& scn);
+void load_from_stream_bin(std::istream& stream, entt::registry& registry);
 void load_from_file_bin(const std::string& absolute_path, scene& scn);
 
 auto load_from_prefab(const asset_handle<scene_prefab>& pfb, scene& scn) -> bool;
 auto load_from_prefab_bin(const asset_handle<scene_prefab>& pfb, scene& scn) -> bool;
+// Load into a plain registry, none of the scene hooks run.
+auto load_from_prefab(const asset_handle<scene_prefab>& pfb, entt::registry& registry) -> bool;
+auto load_from_prefab_bin(const asset_handle<scene_prefab>& pfb, entt::registry& registry) -> bool;
 
 void clone_scene_from_stream(const scene& src_scene, scene& dst_scene);
+void clone_scene_from_registry(const scene& src_scene, scene& dst_scene);
+
+// Convert json prefabs and scenes to the cooked format without creating a scene or loading
+// any referenced assets, so they are safe to call from compile workers.
+auto cook_prefab(const std::string& source_path, const std::string& cooked_path) -> bool;
+auto cook_scene(const std::string& source_path, const std::string& cooked_path) -> bool;
 
 
 template<typename Stream, typename T>
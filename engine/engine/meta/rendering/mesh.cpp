@@ -179,6 +179,7 @@ SAVE(mesh::load_data)
     try_save(ar, ser20::make_nvp("skin_data", obj.skin_data));
     try_save(ar, ser20::make_nvp("root_node", obj.root_node));
     try_save(ar, ser20::make_nvp("bbox", obj.bbox));
+    try_save(ar, ser20::make_nvp("generated_lod_count", obj.generated_lod_count));
 
 }
 SAVE_INSTANTIATE(mesh::load_data, ser20::oarchive_binary_t);
@@ -196,6 +197,7 @@ LOAD(mesh::load_data)
     try_load(ar, ser20::make_nvp("skin_data", obj.skin_data));
     try_load(ar, ser20::make_nvp("root_node", obj.root_node));
     try_load(ar, ser20::make_nvp("bbox", obj.bbox));
+    try_load(ar, ser20::make_nvp("generated_lod_count", obj.generated_lod_count));
 
 }
 LOAD_INSTANTIATE(mesh::load_data, ser20::iarchive_binary_t);
@@ -1,6 +1,7 @@
 #include "model_component.h"
 #include <engine/ecs/components/id_component.h>
 #include <engine/ecs/components/transform_component.h>
+#include <engine/rendering/skinning.h>
 
 #define POOLSTL_STD_SUPPLEMENT 1
 #include <poolstl/poolstl.hpp>
@@ -172,7 +173,7 @@ auto model_component::create_armature() -> bool
     return false;
 }
 
-auto model_component::update_armature() -> bool
+auto model_component::update_armature(skinning_batch* batch) -> bool
 {
     auto lod = model_.get_lod(0);
     if(!lod)
@@ -194,12 +195,38 @@ auto model_component::update_armature() -> bool
     if(skin_data.has_bones())
     {
         const auto& palettes = mesh->get_bone_palettes();
-        skinning_pose_.resize(palettes.size());
+
+        // Lay out all palettes back to back in a single buffer.
+        skinning_pose_.offsets.resize(palettes.size());
+        skinning_pose_.counts.resize(palettes.size());
+
+        uint32_t total = 0;
+        for(size_t i = 0; i < palettes.size(); ++i)
+        {
+            auto count = static_cast<uint32_t>(palettes[i].get_bones().size());
+            skinning_pose_.offsets[i] = total;
+            skinning_pose_.counts[i] = count;
+            total += count;
+        }
+        skinning_pose_.transforms.resize(total);
+
         for(size_t i = 0; i < palettes.size(); ++i)
         {
             const auto& palette = palettes[i];
+            auto output = skinning_pose_.transforms.data() + skinning_pose_.offsets[i];
+
             // Apply the bone palette.
-            skinning_pose_[i].transforms = palette.get_skinning_matrices(bone_pose_.transforms, skin_data);
+            if(batch)
+            {
+                batch->add(palette, skin_data, bone_pose_.transforms, output);
+            }
+            else
+            {
+                palette.compute_skinning_matrices(bone_pose_.transforms.data(),
+                                                  bone_pose_.transforms.size(),
+                                                  skin_data,
+                                                  output);
+            }
         }
     }
 
@@ -290,6 +317,24 @@ auto model_component::was_used_last_frame() const noexcept -> bool
     return get_last_render_frame() == gfx::get_render_frame() - 1;
 }
 
+void model_component::set_render_screen_percent(float percent)
+{
+    auto frame = gfx::get_render_frame();
+    if(render_screen_percent_frame_ != frame)
+    {
+        render_screen_percent_frame_ = frame;
+        render_screen_percent_ = percent;
+        return;
+    }
+
+    render_screen_percent_ = math::max(render_screen_percent_, percent);
+}
+
+auto model_component::get_render_screen_percent() const noexcept -> float
+{
+    return render_screen_percent_;
+}
+
 auto model_component::is_skinned() const -> bool
 {
     auto lod = model_.get_lod(0);
@@ -391,7 +436,7 @@ auto model_component::get_bone_transforms() const -> const pose_mat4&
     return bone_pose_;
 }
 
-auto model_component::get_skinning_transforms() const -> const std::vector<pose_mat4>&
+auto model_component::get_skinning_transforms() const -> const skinning_pose&
 {
     return skinning_pose_;
 }
@@ -5,6 +5,7 @@
 namespace ace
 {
 class material;
+class skinning_batch;
 
 /**
  * @class model_component
@@ -95,13 +96,18 @@ public:
     auto get_armature_by_id(const std::string& node_id) const -> entt::handle;
     auto get_armature_by_index(size_t index) const -> entt::handle;
     auto get_bone_by_index(size_t index) const -> entt::handle;
-    auto get_skinning_transforms() const -> const std::vector<pose_mat4>&;
+    auto get_skinning_transforms() const -> const skinning_pose&;
 
     /**
      * @brief Updates the armature of the model.
      */
     auto init_armature() -> bool;
-    auto update_armature() -> bool;
+
+    /**
+     * @brief Updates the armature pose and the skinning matrices.
+     * @param batch When set the skinning palettes are queued into it instead of computed immediately.
+     */
+    auto update_armature(skinning_batch* batch = nullptr) -> bool;
 
     /**
      * @brief Sets the armature entities.
@@ -123,6 +129,19 @@ public:
     auto get_last_render_frame() const noexcept -> uint64_t;
     auto was_used_last_frame() const noexcept -> bool;
 
+    /**
+     * @brief Records the screen height of the model as a percentage of the viewport.
+     * The largest value among all views rendered in the same frame is kept.
+     * @param percent Screen height percentage.
+     */
+    void set_render_screen_percent(float percent);
+
+    /**
+     * @brief Gets the largest screen height percentage of the last rendered frame.
+     * @return Screen height percentage.
+     */
+    auto get_render_screen_percent() const noexcept -> float;
+
     auto is_skinned() const -> bool;
 private:
     auto create_armature() -> bool;
@@ -163,9 +182,9 @@ private:
     pose_mat4 submesh_pose_;
 
     /**
-     * @brief Skinning pose per palette
+     * @brief Skinning matrices of all palettes
      */
-    std::vector<pose_mat4> skinning_pose_;
+    skinning_pose skinning_pose_;
 
     /**
      * @brief World bounds
@@ -173,6 +192,9 @@ private:
     math::bbox world_bounds_;
 
     uint64_t last_render_frame_{};
+
+    uint64_t render_screen_percent_frame_{};
+    float render_screen_percent_{};
 };
 
 struct bone_component : public component_crtp<bone_component>
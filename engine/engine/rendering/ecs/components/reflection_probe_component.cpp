@@ -71,63 +71,127 @@ auto reflection_probe_component::get_render_view(size_t idx) -> gfx::render_view
     return rview_[idx];
 }
 
-auto reflection_probe_component::get_cubemap() -> const  gfx::texture::ptr&
+auto reflection_probe_component::get_cubemap() -> const gfx::texture::ptr&
 {
-    auto& tex = rview_[0].tex_get_or_emplace("CUBEMAP");
-    if(!tex)
+    // Black until the first bake finishes.
+    if(!cubemap_)
     {
-        constexpr uint16_t size = 256;
-        tex = std::make_shared<gfx::texture>(size,
-                                             true,
-                                             1,
-                                             gfx::texture_format::RGBA8S,
-                                             BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_RT);
+        cubemap_ = get_bake_target();
     }
 
-    return tex;
+    return cubemap_;
 }
 
-auto reflection_probe_component::get_cubemap_fbo(size_t face) -> const gfx::frame_buffer::ptr&
+auto reflection_probe_component::get_bake_target() -> const gfx::texture::ptr&
 {
-    auto& fbo = rview_[face].fbo_get_or_emplace("CUBEMAP");
+    if(!bake_target_)
+    {
+        bake_target_ = std::make_shared<gfx::texture>(cubemap_size,
+                                                      true,
+                                                      1,
+                                                      gfx::texture_format::RGBA8,
+                                                      BGFX_TEXTURE_RT);
+    }
+
+    return bake_target_;
+}
+
+auto reflection_probe_component::get_capture_cubemap() -> const gfx::texture::ptr&
+{
+    if(!capture_)
+    {
+        capture_ = std::make_shared<gfx::texture>(cubemap_size,
+                                                  true,
+                                                  1,
+                                                  gfx::texture_format::RGBA8,
+                                                  BGFX_TEXTURE_RT);
+    }
+
+    return capture_;
+}
+
+auto reflection_probe_component::get_capture_fbo(size_t face) -> const gfx::frame_buffer::ptr&
+{
+    auto& fbo = capture_fbo_[face];
     if(!fbo)
     {
         gfx::fbo_attachment att;
         att.layer = face;
-        att.texture = get_cubemap();
+        att.texture = get_capture_cubemap();
 
         fbo = std::make_shared<gfx::frame_buffer>();
         fbo->populate({att});
     }
 
-
     return fbo;
 }
 
-void reflection_probe_component::update()
+auto reflection_probe_component::get_baked_hash() const -> std::uint64_t
+{
+    return baked_hash_;
+}
+
+auto reflection_probe_component::get_content_hash(std::uint64_t version) const -> std::uint64_t
 {
+    return content_version_ == version ? content_hash_ : 0;
+}
 
-    // Check if all faces have been generated; if so, reset the state
-    bool fully_generated = true;
-    for(auto& frame : generated_frame_)
-    {
-        fully_generated &= frame != uint64_t(-1);
-    }
+void reflection_probe_component::set_content_hash(std::uint64_t hash, std::uint64_t version)
+{
+    content_hash_ = hash;
+    content_version_ = version;
+}
 
+void reflection_probe_component::set_baked_cubemap(const gfx::texture::ptr& cubemap, std::uint64_t hash)
+{
+    cubemap_ = cubemap;
+    baked_hash_ = hash;
+    pending_faces_ = 0;
+}
+
+void reflection_probe_component::begin_bake(std::uint64_t hash)
+{
+    bake_hash_ = hash;
+    pending_faces_ = 0x3f;
+}
+
+auto reflection_probe_component::is_baking() const -> bool
+{
+    return pending_faces_ != 0;
+}
 
-    if(fully_generated)
+auto reflection_probe_component::get_next_bake_face() const -> std::uint32_t
+{
+    for(std::uint32_t face = 0; face < 6; ++face)
     {
-        for(auto& frame : generated_frame_)
+        if(pending_faces_ & (1u << face))
         {
-            frame = uint64_t(-1); // Reset to an initial invalid state
+            return face;
         }
     }
 
-    if(fully_generated)
-    {
-        first_generation_ = false;
-    }
-    generated_faces_count_ = 0; // Reset the count of generated faces
+    return 6;
+}
+
+auto reflection_probe_component::set_face_baked(std::uint32_t face) -> bool
+{
+    pending_faces_ &= std::uint8_t(~(1u << face));
+    return pending_faces_ == 0;
+}
+
+auto reflection_probe_component::get_bake_hash() const -> std::uint64_t
+{
+    return bake_hash_;
+}
+
+void reflection_probe_component::finish_bake()
+{
+    cubemap_ = get_bake_target();
+    baked_hash_ = bake_hash_;
+
+    // Bakes are rare, the capture targets are not worth keeping around.
+    capture_fbo_ = {};
+    capture_.reset();
 }
 
 auto reflection_probe_component::get_probe() const -> const reflection_probe&
@@ -147,33 +211,4 @@ void reflection_probe_component::set_probe(const reflection_probe& probe)
     probe_ = probe;
 }
 
-auto reflection_probe_component::already_generated() const -> bool
-{
-    bool generated = true;
-    for(size_t i = 0; i < generated_frame_.size(); ++i)
-    {
-        generated &= already_generated(i);
-    }
-    // Check if all faces have been generated in the current cycle
-    return generated;
-}
-
-auto reflection_probe_component::already_generated(size_t face) const -> bool
-{
-    if(!first_generation_)
-    {
-        if(generated_faces_count_ == faces_per_frame_)
-        {
-            return true;
-        }
-    }
-
-    // Return true if the face has been generated in the current cycle
-    return generated_frame_[face] != uint64_t(-1);
-}
-void reflection_probe_component::set_generation_frame(size_t face, uint64_t frame)
-{
-    generated_frame_[face] = frame;
-    generated_faces_count_++;
-}
 } // namespace ace
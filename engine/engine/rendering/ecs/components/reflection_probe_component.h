@@ -7,6 +7,7 @@
 #include <graphics/render_view.h>
 
 #include <array>
+#include <cstdint>
 
 namespace ace
 {
@@ -59,38 +60,87 @@ public:
     auto get_render_view(size_t idx) -> gfx::render_view&;
 
     /**
-     * @brief Gets the cubemap texture.
+     * @brief Gets the prefiltered cubemap sampled by the lighting, one roughness level per mip.
      * @return A shared pointer to the cubemap texture.
      */
     auto get_cubemap() -> const gfx::texture::ptr&;
 
     /**
-     * @brief Gets the cubemap frame buffer object (FBO).
-     * @return A shared pointer to the cubemap frame buffer object.
+     * @brief Gets the render target cubemap the next bake is prefiltered into.
      */
-    auto get_cubemap_fbo(size_t face) -> const gfx::frame_buffer::ptr&;
+    auto get_bake_target() -> const gfx::texture::ptr&;
 
     /**
-     * @brief Updates the reflection probe component.
+     * @brief Gets the cubemap the faces are captured into.
      */
-    void update();
+    auto get_capture_cubemap() -> const gfx::texture::ptr&;
 
     /**
-     * @brief Check if the cubemap was generated this frame.
-     * @return A bool indicating whether the faces was already generated
+     * @brief Gets the frame buffer of a face of the capture cubemap.
+     * @param[in] face The cube face.
      */
-    auto already_generated() const -> bool;
+    auto get_capture_fbo(size_t face) -> const gfx::frame_buffer::ptr&;
 
     /**
-     * @brief Check if the cubemap's face was generated this frame.
-     * @return A bool indicating whether the face was already generated.
+     * @brief Gets the content hash of the current cubemap, zero if it was never baked.
      */
-    auto already_generated(size_t face) const -> bool;
+    auto get_baked_hash() const -> std::uint64_t;
 
     /**
-     * @brief marks the genrerated face this frame
+     * @brief Gets the content hash computed for a content version of the scene.
+     * @param[in] version The current content version.
+     * @return The hash, zero if it was computed for another version.
      */
-    void set_generation_frame(size_t face, uint64_t frame);
+    auto get_content_hash(std::uint64_t version) const -> std::uint64_t;
+
+    /**
+     * @brief Remembers the content hash so it is only computed again when the scene content changes.
+     * @param[in] hash The content hash.
+     * @param[in] version The content version it was computed for.
+     */
+    void set_content_hash(std::uint64_t hash, std::uint64_t version);
+
+    /**
+     * @brief Uses an already baked cubemap, e.g. one loaded from the cache.
+     * @param[in] cubemap The prefiltered cubemap.
+     * @param[in] hash The content hash it was baked for.
+     */
+    void set_baked_cubemap(const gfx::texture::ptr& cubemap, std::uint64_t hash);
+
+    /**
+     * @brief Starts capturing all faces for new content.
+     * @param[in] hash The content hash of the bake.
+     */
+    void begin_bake(std::uint64_t hash);
+
+    /**
+     * @brief Checks if faces are still to be captured.
+     */
+    auto is_baking() const -> bool;
+
+    /**
+     * @brief Gets the next face to capture.
+     */
+    auto get_next_bake_face() const -> std::uint32_t;
+
+    /**
+     * @brief Marks a face as captured.
+     * @return True if it was the last one.
+     */
+    auto set_face_baked(std::uint32_t face) -> bool;
+
+    /**
+     * @brief Gets the content hash of the bake in progress.
+     */
+    auto get_bake_hash() const -> std::uint64_t;
+
+    /**
+     * @brief Makes the bake target the sampled cubemap and releases the capture targets.
+     */
+    void finish_bake();
+
+    /// Size of the cubemap faces.
+    static constexpr std::uint16_t cubemap_size = 256;
 
 private:
     /**
@@ -103,16 +153,23 @@ private:
      */
     std::array<gfx::render_view, 6> rview_;
 
-    std::array<uint64_t, 6> generated_frame_{uint64_t(-1),
-                                             uint64_t(-1),
-                                             uint64_t(-1),
-                                             uint64_t(-1),
-                                             uint64_t(-1),
-                                             uint64_t(-1)};
-
-    size_t faces_per_frame_ = 1;       // Number of faces to generate per frame
-    size_t generated_faces_count_ = 0; // Number of faces generated in the current cycle
-    bool first_generation_{true};
+    /// Cubemap sampled by the lighting.
+    gfx::texture::ptr cubemap_;
+    /// Render target the bakes are prefiltered into.
+    gfx::texture::ptr bake_target_;
+    /// Faces captured by the bake in progress, mips are generated on resolve.
+    gfx::texture::ptr capture_;
+    std::array<gfx::frame_buffer::ptr, 6> capture_fbo_;
+
+    /// Content hash of cubemap_.
+    std::uint64_t baked_hash_{};
+    /// Last computed content hash and the content version it was computed for.
+    std::uint64_t content_hash_{};
+    std::uint64_t content_version_{};
+    /// Content hash of the bake in progress.
+    std::uint64_t bake_hash_{};
+    /// Bit per face still to be captured.
+    std::uint8_t pending_faces_{};
 };
 
 } // namespace ace
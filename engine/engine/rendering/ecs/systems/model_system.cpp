@@ -33,6 +33,8 @@ void model_system::on_frame_update(scene& scn, delta_t dt)
 
     auto view = scn.registry->view<transform_component, model_component>();
 
+    skinning_batch_.clear();
+
     // this code should be thread safe as each task works with a whole hierarchy and
     // there is no interleaving between tasks.
     std::for_each(std::execution::par,
@@ -48,11 +50,14 @@ void model_system::on_frame_update(scene& scn, delta_t dt)
 
                       if(model_comp.was_used_last_frame() && !just_initted)
                       {
-                          model_comp.update_armature();
+                          model_comp.update_armature(&skinning_batch_);
                       }
 
                       model_comp.update_world_bounds(transform_comp.get_transform_global());
                   });
+
+    // Compute the skinning palettes of all models in one pass.
+    skinning_batch_.execute();
 }
 
 } // namespace ace
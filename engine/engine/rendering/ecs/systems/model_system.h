@@ -3,6 +3,7 @@
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
 #include <engine/ecs/scene.h>
+#include <engine/rendering/skinning.h>
 
 namespace ace
 {
@@ -14,6 +15,9 @@ public:
     void on_frame_update(scene& scn, delta_t dt);
 
 private:
+    /// Skinning palettes of all models updated this frame.
+    skinning_batch skinning_batch_;
+
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 };
 } // namespace ace
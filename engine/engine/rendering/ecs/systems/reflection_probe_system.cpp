@@ -1,15 +1,212 @@
 #include "reflection_probe_system.h"
 #include <engine/events.h>
 
+#include <engine/assets/asset_manager.h>
+#include <engine/rendering/ecs/components/light_component.h>
+#include <engine/rendering/ecs/components/model_component.h>
 #include <engine/rendering/ecs/components/reflection_probe_component.h>
 #include <engine/ecs/components/transform_component.h>
 #include <engine/ecs/ecs.h>
+#include <engine/engine.h>
+#include <engine/rendering/model.h>
+#include <engine/rendering/renderer.h>
+#include <engine/threading/threader.h>
 
+#include <base/hash.hpp>
+#include <filesystem/filesystem.h>
+#include <graphics/render_pass.h>
 #include <logging/logging.h>
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
 namespace ace
 {
 
+namespace
+{
+/// Transform dirty bit consumed by the content version.
+constexpr std::uint8_t reflection_dirty_id = 3;
+
+/**
+ * @struct reflection_content
+ * @brief Registry context value tracking what the probes of a scene capture.
+ */
+struct reflection_content
+{
+    std::uint64_t version{1};
+    std::uint64_t hierarchy{};
+    std::uint64_t reloads{};
+    std::size_t settings{};
+};
+
+/// Hashes the settings of everything probes capture, components have no change events for them.
+auto hash_settings(entt::registry& registry) -> std::size_t
+{
+    std::size_t seed = 0;
+
+    registry.view<model_component>().each(
+        [&](auto e, auto&& model_comp)
+        {
+            utils::hash_combine(seed, model_comp.is_static());
+            utils::hash_combine(seed, model_comp.casts_reflection());
+
+            const auto& model = model_comp.get_model();
+            utils::hash_combine(seed, model.get_lod(0).id());
+            for(const auto& mat : model.get_materials())
+            {
+                utils::hash_combine(seed, mat.id());
+            }
+        });
+
+    registry.view<light_component>().each(
+        [&](auto e, auto&& light_comp)
+        {
+            const auto& light = light_comp.get_light();
+            utils::hash_combine(seed, std::uint8_t(light.type));
+            utils::hash_combine(seed, light.color.value.r);
+            utils::hash_combine(seed, light.color.value.g);
+            utils::hash_combine(seed, light.color.value.b);
+            utils::hash_combine(seed, light.intensity);
+            utils::hash_combine(seed, light.casts_shadows);
+            utils::hash_combine(seed, light.spot_data.get_range());
+            utils::hash_combine(seed, light.spot_data.get_inner_angle());
+            utils::hash_combine(seed, light.spot_data.get_outer_angle());
+            utils::hash_combine(seed, light.point_data.range);
+            utils::hash_combine(seed, light.point_data.exponent_falloff);
+        });
+
+    registry.view<skylight_component>().each(
+        [&](auto e, auto&& sky_comp)
+        {
+            utils::hash_combine(seed, std::uint8_t(sky_comp.get_mode()));
+            utils::hash_combine(seed, sky_comp.get_turbidity());
+        });
+
+    registry.view<reflection_probe_component>().each(
+        [&](auto e, auto&& reflection_probe_comp)
+        {
+            const auto& probe = reflection_probe_comp.get_probe();
+            utils::hash_combine(seed, std::uint8_t(probe.type));
+            utils::hash_combine(seed, std::uint8_t(probe.method));
+            utils::hash_combine(seed, probe.box_data.extents.x);
+            utils::hash_combine(seed, probe.box_data.extents.y);
+            utils::hash_combine(seed, probe.box_data.extents.z);
+            utils::hash_combine(seed, probe.box_data.transition_distance);
+            utils::hash_combine(seed, probe.sphere_data.range);
+        });
+
+    return seed;
+}
+
+constexpr std::uint32_t cache_magic = 0x42505241; // 'ARPB'
+constexpr std::uint32_t cache_version = 1;
+
+struct cache_header
+{
+    std::uint32_t magic{cache_magic};
+    std::uint32_t version{cache_version};
+    std::uint32_t size{};
+    std::uint32_t mips{};
+    std::uint32_t format{};
+    std::uint32_t bytes{};
+};
+
+auto get_cache_dir() -> fs::path
+{
+    const auto key = "app:/cache/reflection_probes";
+    if(!fs::has_known_protocol(key))
+    {
+        return {};
+    }
+
+    return fs::resolve_protocol(key);
+}
+
+auto get_cache_path(const fs::path& dir, std::uint64_t hash) -> fs::path
+{
+    return dir / fmt::format("{:016x}.bin", hash);
+}
+
+auto get_mip_bytes(const gfx::texture_info& info, std::uint32_t mip) -> std::uint32_t
+{
+    const auto size = std::max<std::uint32_t>(1, std::uint32_t(info.width) >> mip);
+    return size * size * info.bitsPerPixel / 8;
+}
+
+void write_cache(const fs::path& dir, std::uint64_t hash, const cache_header& header, const std::vector<std::uint8_t>& data)
+{
+    fs::error_code ec;
+    fs::create_directories(dir, ec);
+
+    const auto path = get_cache_path(dir, hash);
+    auto temp = path;
+    temp.replace_extension(".tmp");
+
+    {
+        std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+        if(!stream)
+        {
+            APPLOG_WARNING("Failed to write reflection probe cache {}", path.string());
+            return;
+        }
+
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+    }
+
+    // Readers never see a partially written file.
+    fs::rename(temp, path, ec);
+    if(ec)
+    {
+        fs::remove(temp, ec);
+    }
+}
+
+/// Removes the least recently used cubemaps beyond a count, loads refresh the write time of a file.
+void trim_cache(const fs::path& dir, std::size_t max_count)
+{
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+
+    fs::error_code ec;
+    for(const auto& entry : fs::directory_iterator(dir, ec))
+    {
+        if(entry.path().extension() != ".bin")
+        {
+            continue;
+        }
+
+        auto time = fs::last_write_time(entry.path(), ec);
+        if(!ec)
+        {
+            files.emplace_back(time, entry.path());
+        }
+    }
+
+    if(files.size() <= max_count)
+    {
+        return;
+    }
+
+    auto end = std::begin(files) + std::ptrdiff_t(files.size() - max_count);
+    std::nth_element(std::begin(files),
+                     end,
+                     std::end(files),
+                     [](const auto& lhs, const auto& rhs)
+                     {
+                         return lhs.first < rhs.first;
+                     });
+
+    std::for_each(std::begin(files),
+                  end,
+                  [&](const auto& file)
+                  {
+                      fs::remove(file.second, ec);
+                  });
+}
+} // namespace
+
 auto reflection_probe_system::init(rtti::context& ctx) -> bool
 {
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
@@ -21,16 +218,275 @@ auto reflection_probe_system::deinit(rtti::context& ctx) -> bool
 {
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
 
+    // Pending reads write into the data of their readback, the renderer keeps it until they are done.
+    auto& rend = ctx.get<renderer>();
+    for(auto& r : readbacks_)
+    {
+        auto frame = r.frame;
+        rend.keep_until(std::make_shared<readback>(std::move(r)), frame);
+    }
+    readbacks_.clear();
+
     return true;
 }
 
 void reflection_probe_system::on_frame_update(scene& scn, delta_t dt)
 {
-    scn.registry->view<transform_component, reflection_probe_component>().each(
-        [&](auto e, auto&& transform, auto&& probe)
+    update_content_version(scn);
+    process_readbacks();
+}
+
+void reflection_probe_system::update_content_version(scene& scn)
+{
+    auto& registry = *scn.registry;
+
+    auto content = registry.ctx().find<reflection_content>();
+    if(!content)
+    {
+        content = &registry.ctx().emplace<reflection_content>();
+    }
+
+    // Only transforms of what probes capture count, moving cameras or dynamic models must not rebake.
+    bool changed = false;
+    auto consume = [&](transform_component& transform_comp, bool captured)
+    {
+        if(transform_comp.is_dirty(reflection_dirty_id))
+        {
+            transform_comp.set_dirty(reflection_dirty_id, false);
+            changed |= captured;
+        }
+    };
+
+    registry.view<transform_component, model_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& model_comp)
+        {
+            consume(transform_comp, model_comp.is_static() && model_comp.casts_reflection());
+        });
+
+    registry.view<transform_component, light_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& light_comp)
+        {
+            consume(transform_comp, true);
+        });
+
+    registry.view<transform_component, reflection_probe_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& reflection_probe_comp)
         {
-            probe.update();
+            consume(transform_comp, true);
         });
+
+    const auto hierarchy = get_hierarchy_version(registry);
+    const auto reloads = engine::context().get<asset_manager>().get_reload_version();
+    const auto settings = hash_settings(registry);
+
+    if(changed || hierarchy != content->hierarchy || reloads != content->reloads || settings != content->settings)
+    {
+        content->hierarchy = hierarchy;
+        content->reloads = reloads;
+        content->settings = settings;
+        ++content->version;
+    }
+}
+
+auto reflection_probe_system::get_content_version(const scene& scn) const -> std::uint64_t
+{
+    auto content = scn.registry->ctx().find<reflection_content>();
+    return content ? content->version : 0;
+}
+
+void reflection_probe_system::set_max_cached(std::size_t count)
+{
+    max_cached_ = std::max<std::size_t>(1, count);
+}
+
+auto reflection_probe_system::get_max_cached() const -> std::size_t
+{
+    return max_cached_;
+}
+
+void reflection_probe_system::set_faces_per_frame(std::uint32_t faces)
+{
+    faces_per_frame_ = std::max<std::uint32_t>(1, faces);
+}
+
+auto reflection_probe_system::get_faces_per_frame() const -> std::uint32_t
+{
+    return faces_per_frame_;
+}
+
+auto reflection_probe_system::consume_face_budget() -> bool
+{
+    const auto frame = gfx::get_render_frame();
+    if(frame != budget_frame_)
+    {
+        budget_frame_ = frame;
+        budget_used_ = 0;
+    }
+
+    if(budget_used_ >= faces_per_frame_)
+    {
+        return false;
+    }
+
+    ++budget_used_;
+    return true;
+}
+
+auto reflection_probe_system::load_cached(std::uint64_t hash) const -> gfx::texture::ptr
+{
+    const auto dir = get_cache_dir();
+    if(dir.empty())
+    {
+        return nullptr;
+    }
+
+    const auto path = get_cache_path(dir, hash);
+
+    fs::error_code ec;
+    if(!fs::exists(path, ec))
+    {
+        return nullptr;
+    }
+
+    // The write time orders the files for eviction, loading counts as a use.
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+    std::ifstream stream(path, std::ios::binary);
+    cache_header header;
+    if(!stream.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        return nullptr;
+    }
+
+    if(header.magic != cache_magic || header.version != cache_version || header.size == 0 ||
+       header.size > std::numeric_limits<std::uint16_t>::max() ||
+       header.format >= std::uint32_t(gfx::texture_format::Count))
+    {
+        return nullptr;
+    }
+
+    const auto format = gfx::texture_format(header.format);
+
+    gfx::texture_info info;
+    gfx::calc_texture_size(info, std::uint16_t(header.size), std::uint16_t(header.size), 1, true, header.mips > 1, 1, format);
+    if(info.numMips != header.mips || info.storageSize != header.bytes)
+    {
+        return nullptr;
+    }
+
+    std::vector<std::uint8_t> data(header.bytes);
+    if(!stream.read(reinterpret_cast<char*>(data.data()), std::streamsize(data.size())))
+    {
+        return nullptr;
+    }
+
+    return std::make_shared<gfx::texture>(std::uint16_t(header.size),
+                                          header.mips > 1,
+                                          1,
+                                          format,
+                                          BGFX_TEXTURE_NONE,
+                                          gfx::copy(data.data(), std::uint32_t(data.size())));
+}
+
+void reflection_probe_system::store_cached(std::uint64_t hash, const gfx::texture::ptr& cubemap)
+{
+    if(!cubemap || get_cache_dir().empty())
+    {
+        return;
+    }
+
+    if(!gfx::is_supported(BGFX_CAPS_TEXTURE_BLIT) || !gfx::is_supported(BGFX_CAPS_TEXTURE_READ_BACK))
+    {
+        return;
+    }
+
+    // Pending reads write into the data of their readback, it must stay alive until they are done.
+    auto pending = std::any_of(std::begin(readbacks_),
+                               std::end(readbacks_),
+                               [&](const readback& r)
+                               {
+                                   return r.hash == hash;
+                               });
+    if(pending)
+    {
+        return;
+    }
+
+    auto& readback = readbacks_.emplace_back();
+    readback.hash = hash;
+    gfx::calc_texture_size(readback.info,
+                           cubemap->info.width,
+                           cubemap->info.height,
+                           1,
+                           true,
+                           cubemap->info.numMips > 1,
+                           1,
+                           cubemap->info.format);
+    readback.data.resize(readback.info.storageSize);
+
+    gfx::render_pass pass("reflection_probe_readback");
+
+    // Render targets can't be read directly, blit every face and mip to a cpu texture first.
+    std::uint32_t offset = 0;
+    for(std::uint16_t face = 0; face < 6; ++face)
+    {
+        for(std::uint8_t mip = 0; mip < readback.info.numMips; ++mip)
+        {
+            const auto size = std::uint16_t(std::max(1, readback.info.width >> mip));
+
+            auto blit = std::make_shared<gfx::texture>(
+                size,
+                size,
+                false,
+                1,
+                readback.info.format,
+                BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK | BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT |
+                    BGFX_SAMPLER_MIP_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+
+            gfx::blit(pass.id, blit->native_handle(), 0, 0, 0, 0, cubemap->native_handle(), mip, 0, 0, face, size, size, 1);
+
+            auto frame = gfx::read_texture(blit->native_handle(), readback.data.data() + offset);
+            readback.frame = std::max(readback.frame, frame);
+            readback.blits.emplace_back(std::move(blit));
+
+            offset += get_mip_bytes(readback.info, mip);
+        }
+    }
+}
+
+void reflection_probe_system::process_readbacks()
+{
+    const auto render_frame = gfx::get_render_frame();
+
+    for(auto it = std::begin(readbacks_); it != std::end(readbacks_);)
+    {
+        auto& readback = *it;
+        if(readback.frame > render_frame)
+        {
+            ++it;
+            continue;
+        }
+
+        auto dir = get_cache_dir();
+        if(!dir.empty())
+        {
+            cache_header header;
+            header.size = readback.info.width;
+            header.mips = readback.info.numMips;
+            header.format = std::uint32_t(readback.info.format);
+            header.bytes = std::uint32_t(readback.data.size());
+
+            auto& thr = engine::context().get<threader>();
+            thr.pool->schedule(
+                [dir = std::move(dir), hash = readback.hash, header, data = std::move(readback.data), max = max_cached_]()
+                {
+                    write_cache(dir, hash, header, data);
+                    trim_cache(dir, max);
+                });
+        }
+
+        it = readbacks_.erase(it);
+    }
 }
 
 } // namespace ace
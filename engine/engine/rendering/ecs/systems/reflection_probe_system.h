@@ -3,6 +3,10 @@
 #include <base/basetypes.hpp>
 #include <context/context.hpp>
 #include <engine/ecs/scene.h>
+#include <graphics/texture.h>
+
+#include <cstdint>
+#include <vector>
 
 namespace ace
 {
@@ -13,7 +17,75 @@ public:
     auto deinit(rtti::context& ctx) -> bool;
 
     void on_frame_update(scene& scn, delta_t dt);
+
+    /**
+     * @brief Sets how many probe faces may be captured per frame, shared by all probes and cameras.
+     */
+    void set_faces_per_frame(std::uint32_t faces);
+
+    /**
+     * @brief Gets how many probe faces may be captured per frame.
+     */
+    auto get_faces_per_frame() const -> std::uint32_t;
+
+    /**
+     * @brief Takes one face from the budget of the current frame.
+     * @return False if the budget is spent.
+     */
+    auto consume_face_budget() -> bool;
+
+    /**
+     * @brief Gets a counter bumped whenever something probes of the scene capture may have changed.
+     * @param scn The scene.
+     * @return The version, 0 if the scene is not tracked and hashes can't be reused.
+     */
+    auto get_content_version(const scene& scn) const -> std::uint64_t;
+
+    /**
+     * @brief Sets how many cubemaps are kept in the cache, the least recently used are removed first.
+     */
+    void set_max_cached(std::size_t count);
+
+    /**
+     * @brief Gets how many cubemaps are kept in the cache.
+     */
+    auto get_max_cached() const -> std::size_t;
+
+    /**
+     * @brief Loads a cubemap baked earlier for the same content.
+     * @param hash The content hash of the probe.
+     * @return The cubemap or nullptr if it is not cached.
+     */
+    auto load_cached(std::uint64_t hash) const -> gfx::texture::ptr;
+
+    /**
+     * @brief Reads a baked cubemap back and writes it to the cache in the background.
+     * @param hash The content hash of the probe.
+     * @param cubemap The prefiltered cubemap.
+     */
+    void store_cached(std::uint64_t hash, const gfx::texture::ptr& cubemap);
+
 private:
-    std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
+    /// A cubemap being read back for the cache.
+    struct readback
+    {
+        std::uint64_t hash{};
+        gfx::texture_info info{};
+        /// Cpu copies of every face and mip.
+        std::vector<gfx::texture::ptr> blits;
+        /// Faces with their mips, in the layout textures are created from.
+        std::vector<std::uint8_t> data;
+        /// Frame at which all reads are done.
+        std::uint32_t frame{};
+    };
+
+    void update_content_version(scene& scn);
+    void process_readbacks();
+
+    std::vector<readback> readbacks_;
+    std::size_t max_cached_{64};
+    std::uint32_t faces_per_frame_{1};
+    std::uint32_t budget_frame_{};
+    std::uint32_t budget_used_{};
 };
 } // namespace ace
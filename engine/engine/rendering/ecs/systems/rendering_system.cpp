@@ -85,4 +85,17 @@ void rendering_system::render_scene(const gfx::frame_buffer::ptr& output, scene&
         });
 }
 
+auto rendering_system::is_lighting_ready(scene& scn) -> bool
+{
+    bool ready = true;
+    scn.registry->view<camera_component>().each(
+        [&](auto e, auto&& camera_comp)
+        {
+            auto& pipeline = camera_comp.get_pipeline_data().get_pipeline();
+            ready &= !pipeline || pipeline->is_lighting_ready(scn);
+        });
+
+    return ready;
+}
+
 } // namespace ace
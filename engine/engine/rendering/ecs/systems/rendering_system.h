@@ -77,6 +77,14 @@ public:
      * @param dt The delta time.
      */
     void render_scene(const gfx::frame_buffer::ptr& output, camera_component& comp, scene& scn, delta_t dt);
+
+    /**
+     * @brief Checks if the pipelines of the scene cameras can draw all of its lights.
+     * Renders that are kept, like thumbnails, should wait for it.
+     * @param scn The scene to check.
+     * @return True if the lighting is ready.
+     */
+    auto is_lighting_ready(scene& scn) -> bool;
 };
 
 } // namespace ace
@@ -248,10 +248,40 @@ public:
         math::vec4 surface_data2{};
 
         surface_data2[0] = metalness_roughness_combined() ? 1.0f : 0.0f;
+        surface_data2[1] = normal_map_two_channel() ? 1.0f : 0.0f;
 
         return surface_data2;
     }
 
+    /**
+     * @brief Checks if the normal map only stores x and y, so z has to be rebuilt when sampling.
+     * @return True if the normal map has two channels.
+     */
+    inline auto normal_map_two_channel() const -> bool
+    {
+        if(!normal_map_.is_ready())
+        {
+            return false;
+        }
+
+        const auto& tex = normal_map_.get();
+        if(!tex)
+        {
+            return false;
+        }
+
+        switch(tex->info.format)
+        {
+            case gfx::texture_format::BC5:
+            case gfx::texture_format::RG8:
+            case gfx::texture_format::RG16:
+            case gfx::texture_format::RG16F:
+                return true;
+            default:
+                return false;
+        }
+    }
+
     inline auto metalness_roughness_combined() const -> bool
     {
         return metalness_map_ == roughness_map_;
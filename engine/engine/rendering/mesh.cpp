@@ -1,6 +1,7 @@
 #include "mesh.h"
 #include "camera.h"
 #include "generator/generator.hpp"
+#include "skinning.h"
 
 #include <graphics/index_buffer.h>
 #include <graphics/vertex_buffer.h>
@@ -110,6 +111,53 @@ void create_mesh(const gfx::vertex_layout& format,
     data.compute_tangents = has_tangents;
 }
 
+// Imported meshes may store half float texture coordinates, widen them
+// back to floats where the renderer can't fetch half vertex attributes.
+void expand_half_attributes(mesh::load_data& data)
+{
+    if(gfx::is_supported(BGFX_CAPS_VERTEX_ATTRIB_HALF))
+    {
+        return;
+    }
+
+    bool has_half = false;
+
+    gfx::vertex_layout layout;
+    layout.begin();
+    for(uint32_t attr = 0; attr < gfx::attribute::Count; ++attr)
+    {
+        auto attribute = gfx::attribute(attr);
+        if(!data.vertex_format.has(attribute))
+        {
+            continue;
+        }
+
+        uint8_t num{};
+        gfx::attribute_type type{};
+        bool normalized{};
+        bool as_int{};
+        data.vertex_format.decode(attribute, num, type, normalized, as_int);
+        if(type == gfx::attribute_type::Half)
+        {
+            type = gfx::attribute_type::Float;
+            has_half = true;
+        }
+        layout.add(attribute, num, type, normalized, as_int);
+    }
+    layout.end();
+
+    if(!has_half)
+    {
+        return;
+    }
+
+    std::vector<uint8_t> vertex_data(size_t(data.vertex_count) * layout.getStride());
+    gfx::vertex_convert(layout, vertex_data.data(), data.vertex_format, data.vertex_data.data(), data.vertex_count);
+
+    data.vertex_format = layout;
+    data.vertex_data = std::move(vertex_data);
+}
+
 } // namespace
 
 mesh::mesh() : hardware_vb_(std::make_shared<gfx::vertex_buffer>()), hardware_ib_(std::make_shared<gfx::index_buffer>())
@@ -138,6 +186,10 @@ void mesh::dispose()
     // Release bone palettes and skin data (if any)
     bone_palettes_.clear();
     skin_bind_data_.clear();
+    {
+        std::lock_guard<std::mutex> lock(submesh_bvhs_mutex_);
+        submesh_bvhs_.clear();
+    }
 
     // Clean up preparation data.
     if(preparation_data_.owns_source)
@@ -724,6 +776,10 @@ auto mesh::load_mesh(load_data&& data) -> bool
 {
     // APPLOG_TRACE_PERF(std::chrono::milliseconds);
 
+    expand_half_attributes(data);
+
+    generated_lod_count_ = data.generated_lod_count;
+
     bool result = true;
     result &= prepare_mesh(data.vertex_format);
     result &= set_bounding_box(data.bbox);
@@ -1416,6 +1472,83 @@ auto mesh::calculate_screen_rect(const math::transform& world, const camera& cam
                      irect32_t::value_type(max.y));
 }
 
+auto mesh::raycast_submesh(uint32_t submesh_index,
+                           const math::vec3& origin,
+                           const math::vec3& direction,
+                           float& distance) const -> bool
+{
+    if(prepare_status_ != mesh_status::prepared || system_vb_ == nullptr || system_ib_ == nullptr ||
+       submesh_index >= mesh_submeshes_.size())
+    {
+        return false;
+    }
+
+    uint16_t position_offset = vertex_format_.getOffset(gfx::attribute::Position);
+    uint16_t vertex_stride = vertex_format_.getStride();
+    const uint8_t* src_vertices_ptr = system_vb_ + position_offset;
+
+    auto get_position = [&](uint32_t index) -> const math::vec3&
+    {
+        return *reinterpret_cast<const math::vec3*>(src_vertices_ptr + (index * vertex_stride));
+    };
+
+    std::unique_lock<std::mutex> lock(submesh_bvhs_mutex_);
+    if(submesh_bvhs_.size() != mesh_submeshes_.size())
+    {
+        submesh_bvhs_.clear();
+        submesh_bvhs_.resize(mesh_submeshes_.size());
+
+        std::vector<math::bbox> triangle_bounds;
+        for(size_t i = 0; i < mesh_submeshes_.size(); ++i)
+        {
+            const auto* submesh = mesh_submeshes_[i];
+
+            triangle_bounds.clear();
+            triangle_bounds.resize(submesh->face_count);
+            for(uint32_t face = 0; face < submesh->face_count; ++face)
+            {
+                const uint32_t* indices = system_ib_ + (submesh->face_start + face) * 3;
+
+                auto& bounds = triangle_bounds[face];
+                bounds.add_point(get_position(indices[0]));
+                bounds.add_point(get_position(indices[1]));
+                bounds.add_point(get_position(indices[2]));
+            }
+
+            submesh_bvhs_[i].build(triangle_bounds);
+        }
+    }
+    // Built once, the casts only read them.
+    lock.unlock();
+
+    const auto* submesh = mesh_submeshes_[submesh_index];
+
+    bool hit = false;
+    submesh_bvhs_[submesh_index].raycast(origin,
+                                         direction,
+                                         distance,
+                                         [&](uint32_t face, float& max_distance)
+                                         {
+                                             const uint32_t* indices = system_ib_ + (submesh->face_start + face) * 3;
+
+                                             float t{};
+                                             if(math::bvh::intersect_triangle(origin,
+                                                                              direction,
+                                                                              get_position(indices[0]),
+                                                                              get_position(indices[1]),
+                                                                              get_position(indices[2]),
+                                                                              t) &&
+                                                t < max_distance)
+                                             {
+                                                 max_distance = t;
+                                                 distance = t;
+                                                 hit = true;
+                                             }
+                                         });
+
+    return hit;
+}
+
 auto mesh::get_submeshes() const -> const submesh_array_t&
 {
     return mesh_submeshes_;
@@ -1485,6 +1618,23 @@ auto mesh::get_bounds() const -> const math::bbox&
     return bbox_;
 }
 
+auto mesh::get_generated_lod_count() const -> uint32_t
+{
+    return generated_lod_count_;
+}
+
+auto mesh::get_generated_lod_key(const std::string& key, uint32_t lod) -> std::string
+{
+    auto stem_end = key.find_last_of('.');
+    const auto dir_end = key.find_last_of('/');
+    if(stem_end == std::string::npos || (dir_end != std::string::npos && stem_end < dir_end))
+    {
+        stem_end = key.size();
+    }
+
+    return key.substr(0, stem_end) + "_lod" + std::to_string(lod) + ".emesh";
+}
+
 auto mesh::get_status() const -> mesh_status
 {
     return prepare_status_;
@@ -2522,44 +2672,64 @@ auto bone_palette::get_skinning_matrices(const std::vector<math::transform>& nod
 
 auto bone_palette::get_skinning_matrices(const std::vector<math::mat4>& node_transforms,
                                          const skin_bind_data& bind_data) const -> const std::vector<math::mat4>&
+{
+    thread_local static std::vector<math::mat4> skinning_transforms_;
+    skinning_transforms_.resize(bones_.size(), math::identity<math::mat4>());
+
+    compute_skinning_matrices(node_transforms.data(), node_transforms.size(), bind_data, skinning_transforms_.data());
+
+    return skinning_transforms_;
+}
+
+void bone_palette::compute_skinning_matrices(const math::mat4* node_transforms,
+                                             size_t node_count,
+                                             const skin_bind_data& bind_data,
+                                             math::mat4* output) const
 {
     // Retrieve the main list of bones from the skin bind data that will
     // be referenced by the palette's bone index list.
     const auto& bind_list = bind_data.get_bones();
 
-    // Compute transformation matrix for each bone in the palette
-    auto count = std::min(bones_.size(), node_transforms.size());
-    thread_local static std::vector<math::mat4> skinning_transforms_;
-    skinning_transforms_.resize(bones_.size(), math::identity<math::mat4>());
-
-    for(size_t i = 0; i < count; ++i)
+    for(size_t i = 0; i < bones_.size(); ++i)
     {
         auto bone = bones_[i];
-        const auto& bone_transform = node_transforms[bone];
-        const auto& bone_data = bind_list[bone];
-        auto& transform = skinning_transforms_[i];
-        transform = bone_transform * bone_data.bind_pose_transform.get_matrix();
+        if(bone >= node_count || bone >= bind_list.size())
+        {
+            output[i] = math::identity<math::mat4>();
+            continue;
+        }
+
+        multiply_matrices(node_transforms[bone], bind_list[bone].bind_pose_transform.get_matrix(), output[i]);
 
     } // Next Bone
+}
 
-    return skinning_transforms_;
+void bone_palette::add_bone(uint32_t bone_index)
+{
+    if(bone_index >= bones_lut_.size())
+    {
+        bones_lut_.resize(bone_index + 1, invalid_index);
+    }
+
+    if(bones_lut_[bone_index] == invalid_index)
+    {
+        bones_lut_[bone_index] = static_cast<uint32_t>(bones_.size());
+        bones_.push_back(bone_index);
+    }
 }
 
-void bone_palette::assign_bones(bone_index_map_t& bones, std::vector<uint32_t>& faces)
+auto bone_palette::has_bone(uint32_t bone_index) const -> bool
 {
-    bone_index_map_t::iterator it_bone, it_bone2;
+    return bone_index < bones_lut_.size() && bones_lut_[bone_index] != invalid_index;
+}
 
+void bone_palette::assign_bones(bone_index_map_t& bones, std::vector<uint32_t>& faces)
+{
     // Iterate through newly specified input bones and add any unique ones to the
     // palette.
-    for(it_bone = bones.begin(); it_bone != bones.end(); ++it_bone)
+    for(const auto& bone : bones)
     {
-        it_bone2 = bones_lut_.find(it_bone->first);
-        if(it_bone2 == bones_lut_.end())
-        {
-            bones_lut_[it_bone->first] = static_cast<uint32_t>(bones_.size());
-            bones_.push_back(it_bone->first);
-
-        } // End if not already added
+        add_bone(bone.first);
 
     } // Next Bone
 
@@ -2572,11 +2742,8 @@ void bone_palette::assign_bones(bone_index_map_t& bones, std::vector<uint32_t>&
 
 void bone_palette::assign_bones(std::vector<bool>& bones, std::vector<uint32_t>& faces)
 {
-    bone_index_map_t::iterator it_bone, it_bone2;
-
     // Iterate through newly specified input bones and add any unique ones to the
     // palette.
-    // for(it_bone = bones.begin(); it_bone != bones.end(); ++it_bone)
     for(size_t i = 0, j = bones.size(); i < j; ++i)
     {
         if(!bones[i])
@@ -2584,13 +2751,7 @@ void bone_palette::assign_bones(std::vector<bool>& bones, std::vector<uint32_t>&
             continue;
         }
 
-        it_bone2 = bones_lut_.find(i);
-        if(it_bone2 == bones_lut_.end())
-        {
-            bones_lut_[i] = static_cast<uint32_t>(bones_.size());
-            bones_.push_back(i);
-
-        } // End if not already added
+        add_bone(static_cast<uint32_t>(i));
 
     } // Next Bone
 
@@ -2603,23 +2764,15 @@ void bone_palette::assign_bones(std::vector<bool>& bones, std::vector<uint32_t>&
 
 void bone_palette::assign_bones(const std::vector<uint32_t>& bones)
 {
-    bone_index_map_t::iterator it_bone;
-
     // Clear out prior data.
     bones_.clear();
     bones_lut_.clear();
 
     // Iterate through newly specified input bones and add any unique ones to the
     // palette.
-    for(size_t i = 0; i < bones.size(); ++i)
+    for(auto bone : bones)
     {
-        it_bone = bones_lut_.find(bones[i]);
-        if(it_bone == bones_lut_.end())
-        {
-            bones_lut_[bones[i]] = static_cast<uint32_t>(bones_.size());
-            bones_.push_back(bones[i]);
-
-        } // End if not already added
+        add_bone(bone);
 
     } // Next Bone
 }
@@ -2649,11 +2802,9 @@ void bone_palette::compute_palette_fit(bone_index_map_t& input,
 
     // Iterate through newly specified input bones and see how many
     // indices it has in common with our existing set.
-    bone_index_map_t::iterator it_bone, it_bone2;
-    for(it_bone = input.begin(); it_bone != input.end(); ++it_bone)
+    for(const auto& bone : input)
     {
-        it_bone2 = bones_lut_.find(it_bone->first);
-        if(it_bone2 != bones_lut_.end())
+        if(has_bone(bone.first))
             common_bones++;
         else
             additional_bones++;
@@ -2663,10 +2814,9 @@ void bone_palette::compute_palette_fit(bone_index_map_t& input,
 
 auto bone_palette::translate_bone_to_palette(uint32_t bone_index) const -> uint32_t
 {
-    auto it_bone = bones_lut_.find(bone_index);
-    if(it_bone == bones_lut_.end())
-        return 0xFFFFFFFF;
-    return it_bone->second;
+    if(bone_index >= bones_lut_.size())
+        return invalid_index;
+    return bones_lut_[bone_index];
 }
 
 auto bone_palette::get_data_group() const -> uint32_t
@@ -2841,8 +2991,10 @@ void mesh::build_optimized_index_buffer(const submesh* submesh,
     // First allocate enough room for the optimization information for each vertex
     // and triangle
     uint32_t vertex_count = (max_vertex - min_vertex) + 1;
-    auto vertex_info_ptr = new optimizer_vertex_info[vertex_count];
-    auto triangle_info_ptr = new optimizer_triangle_info[submesh->face_count];
+    std::vector<optimizer_vertex_info> vertex_info(vertex_count);
+    std::vector<optimizer_triangle_info> triangle_info(submesh->face_count);
+    auto vertex_info_ptr = vertex_info.data();
+    auto triangle_info_ptr = triangle_info.data();
 
     // The first pass is to initialize the vertex information with information
     // about the
@@ -3059,10 +3211,6 @@ void mesh::build_optimized_index_buffer(const submesh* submesh,
         } // Next entry in the vertex cache
 
     } // Next triangle to Add
-
-    // Destroy the temporary arrays
-    checked_array_delete(vertex_info_ptr);
-    checked_array_delete(triangle_info_ptr);
 }
 
 auto mesh::find_vertex_optimizer_score(const optimizer_vertex_info* vertex_info_ptr) -> float
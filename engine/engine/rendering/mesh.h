@@ -8,6 +8,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace ace
@@ -195,6 +196,19 @@ public:
     auto get_skinning_matrices(const std::vector<math::mat4>& node_transforms, const skin_bind_data& bind_data) const
         -> const std::vector<math::mat4>&;
 
+    /**
+     * @brief Computes the skinning matrices of the palette into a caller provided buffer.
+     *
+     * @param node_transforms The node transforms.
+     * @param node_count The number of node transforms.
+     * @param bind_data The skin bind data.
+     * @param output Destination with room for get_bones().size() matrices.
+     */
+    void compute_skinning_matrices(const math::mat4* node_transforms,
+                                   size_t node_count,
+                                   const skin_bind_data& bind_data,
+                                   math::mat4* output) const;
+
     /**
      * @brief Determines the relevant "fit" information that can be used to discover if and how the specified
      * combination of bones will fit into this palette.
@@ -289,8 +303,25 @@ public:
     void clear_influenced_faces();
 
 protected:
-    ///< Sorted list of bones in this palette.
-    bone_index_map_t bones_lut_;
+    ///< Value of unused entries in the bone lookup table.
+    static constexpr uint32_t invalid_index = 0xFFFFFFFF;
+
+    /**
+     * @brief Adds a bone to the palette unless it is already part of it.
+     *
+     * @param bone_index The bone index.
+     */
+    void add_bone(uint32_t bone_index);
+
+    /**
+     * @brief Checks if a bone is part of the palette.
+     *
+     * @param bone_index The bone index.
+     */
+    auto has_bone(uint32_t bone_index) const -> bool;
+
+    ///< Position in the palette of every bone index, indexed directly by the bone index.
+    std::vector<uint32_t> bones_lut_;
     ///< Main palette of indices that reference the bones outlined in the main skin binding data.
     std::vector<uint32_t> bones_;
     ///< List of faces assigned to this palette.
@@ -404,6 +435,9 @@ public:
         std::unique_ptr<armature_node> root_node = nullptr;
 
         math::bbox bbox{};
+
+        ///< Number of simplified LODs generated on import, see get_generated_lod_key.
+        uint32_t generated_lod_count = 0;
     };
 
     /**
@@ -779,6 +813,22 @@ public:
      */
     auto calculate_screen_rect(const math::transform& world, const camera& cam) const -> irect32_t;
 
+    /**
+     * @brief Casts a ray against the triangles of a submesh.
+     * The triangle bvh of every submesh is built from the system buffers on first use,
+     * concurrent casts wait for it.
+     *
+     * @param submesh_index The submesh to test.
+     * @param origin The ray origin in mesh space.
+     * @param direction The ray direction in mesh space, distances are measured in its length.
+     * @param distance In the max distance, out the distance to the closest hit.
+     * @return bool True if a triangle was hit closer than the input distance.
+     */
+    auto raycast_submesh(uint32_t submesh_index,
+                         const math::vec3& origin,
+                         const math::vec3& direction,
+                         float& distance) const -> bool;
+
     /**
      * @brief Retrieves information about the submesh of the mesh associated with the specified data group identifier.
      *
@@ -794,6 +844,23 @@ public:
      */
     auto get_bounds() const -> const math::bbox&;
 
+    /**
+     * @brief Gets the number of simplified LODs generated when the mesh was imported.
+     *
+     * @return uint32_t The number of generated LODs, not counting the mesh itself.
+     */
+    auto get_generated_lod_count() const -> uint32_t;
+
+    /**
+     * @brief Gets the asset key of a LOD generated for a mesh on import.
+     * Generated LODs only exist as compiled assets, they have no source file.
+     *
+     * @param key The key of the source mesh.
+     * @param lod The LOD index, starting at 1.
+     * @return std::string The key of the LOD.
+     */
+    static auto get_generated_lod_key(const std::string& key, uint32_t lod) -> std::string;
+
     /**
      * @brief Gets the preparation status for this mesh.
      *
@@ -1058,6 +1125,8 @@ protected:
     bool optimize_mesh_ = false;
     ///< Axis aligned bounding box describing object dimensions in object space.
     math::bbox bbox_;
+    ///< Number of simplified LODs generated on import.
+    uint32_t generated_lod_count_ = 0;
     ///< Total number of faces in the prepared mesh.
     uint32_t face_count_ = 0;
     ///< Total number of vertices in the prepared mesh.
@@ -1074,6 +1143,10 @@ protected:
     bone_palette_array_t bone_palettes_;
     ///< List of armature nodes.
     std::unique_ptr<armature_node> root_ = nullptr;
+    ///< Triangle hierarchy of every submesh used for ray casts, built on first use.
+    mutable std::vector<math::bvh> submesh_bvhs_;
+    ///< Guards the first build of the submesh bvhs.
+    mutable std::mutex submesh_bvhs_mutex_;
 };
 
 } // namespace ace
@@ -120,7 +120,7 @@ void model::set_lod_limits(const std::vector<urange32_t>& limits)
 void model::submit(const math::mat4& world_transform,
                    const pose_mat4& submesh_transforms,
                    const pose_mat4& bone_transforms,
-                   const std::vector<pose_mat4>& skinning_matrices_per_palette,
+                   const skinning_pose& skinning_matrices_per_palette,
                    unsigned int lod,
                    const submit_callbacks& callbacks) const
 {
@@ -217,7 +217,7 @@ void model::submit(const math::mat4& world_transform,
 
         auto render_submesh_skinned = [this](const std::shared_ptr<ace::mesh>& mesh,
                                              uint32_t group_id,
-                                             const std::vector<pose_mat4>& skinning_matrices_per_palette,
+                                             const skinning_pose& skinning_matrices_per_palette,
                                              submit_callbacks::params& params,
                                              const submit_callbacks& callbacks)
         {
@@ -237,8 +237,16 @@ void model::submit(const math::mat4& world_transform,
             for(const auto& index : indices)
             {
                 const auto& submesh = submeshes[index];
-                const auto& skinning_matrices = skinning_matrices_per_palette[index];
-                gfx::set_world_transform(skinning_matrices.transforms);
+                if(index < skinning_matrices_per_palette.offsets.size())
+                {
+                    const auto offset = skinning_matrices_per_palette.offsets[index];
+                    const auto count = skinning_matrices_per_palette.counts[index];
+                    if(count > 0)
+                    {
+                        gfx::set_world_transform(skinning_matrices_per_palette.transforms.data() + offset,
+                                                 static_cast<std::uint16_t>(count));
+                    }
+                }
 
                 mesh->bind_render_buffers_for_submesh(submesh);
                 params.preserve_state = &index != &indices.back();
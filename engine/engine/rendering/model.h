@@ -27,6 +27,27 @@ struct pose_mat4
     std::vector<math::mat4> transforms;
 };
 
+/**
+ * @brief Skinning matrices of every bone palette of a mesh, stored back to back.
+ */
+struct skinning_pose
+{
+    /**
+     * @brief Matrices of all palettes in one contiguous buffer ready for upload.
+     */
+    std::vector<math::mat4> transforms;
+
+    /**
+     * @brief Index of the first matrix of every palette.
+     */
+    std::vector<uint32_t> offsets;
+
+    /**
+     * @brief Number of matrices of every palette.
+     */
+    std::vector<uint32_t> counts;
+};
+
 struct pose_transform
 {
     /**
@@ -151,7 +172,7 @@ public:
     void submit(const math::mat4& world_transform,
                 const pose_mat4& submesh_transforms,
                 const pose_mat4& bone_transforms,
-                const std::vector<pose_mat4>& skinning_matrices_per_palette,
+                const skinning_pose& skinning_matrices_per_palette,
                 unsigned int lod,
                 const submit_callbacks& callbacks) const;
 
@@ -1,10 +1,12 @@
 #include "pipeline.h"
 #include <engine/assets/asset_manager.h>
+#include <engine/assets/impl/asset_reader.h>
 #include <engine/ecs/components/transform_component.h>
 #include <engine/rendering/ecs/components/camera_component.h>
 #include <engine/rendering/ecs/components/light_component.h>
 #include <engine/rendering/ecs/components/model_component.h>
 #include <engine/rendering/ecs/components/reflection_probe_component.h>
+#include <engine/rendering/ecs/systems/reflection_probe_system.h>
 
 #include <engine/engine.h>
 #include <engine/rendering/camera.h>
@@ -12,10 +14,14 @@
 #include <engine/rendering/mesh.h>
 #include <engine/rendering/model.h>
 #include <engine/rendering/renderer.h>
+#include <engine/rendering/texture_streamer.h>
 
 #include <engine/profiler/profiler.h>
 
+#include <base/hash.hpp>
+#include <filesystem/filesystem.h>
 #include <graphics/index_buffer.h>
+#include <graphics/render_graph.h>
 #include <graphics/render_pass.h>
 #include <graphics/render_view.h>
 #include <graphics/texture.h>
@@ -45,91 +51,28 @@ auto create_or_resize_d_buffer(gfx::render_view& rview, const usize32_t& viewpor
     return depth;
 }
 
-auto create_or_resize_g_buffer(gfx::render_view& rview, const usize32_t& viewport_size) -> const gfx::frame_buffer::ptr&
+/// Attachments of the g-buffer.
+struct g_buffer_handles
 {
-    auto& depth = create_or_resize_d_buffer(rview, viewport_size);
-
-    auto& fbo = rview.fbo_get_or_emplace("GBUFFER");
-    if(!fbo || (fbo && fbo->get_size() != viewport_size))
-    {
-        auto tex0 = std::make_shared<gfx::texture>(viewport_size.width,
-                                                   viewport_size.height,
-                                                   false,
-                                                   1,
-                                                   gfx::texture_format::RGBA8,
-                                                   BGFX_TEXTURE_COMPUTE_WRITE | BGFX_TEXTURE_RT);
-
-        auto tex1 = std::make_shared<gfx::texture>(viewport_size.width,
-                                                   viewport_size.height,
-                                                   false,
-                                                   1,
-                                                   gfx::texture_format::RGBA16F,
-                                                   BGFX_TEXTURE_RT);
-
-        auto tex2 = std::make_shared<gfx::texture>(viewport_size.width,
-                                                   viewport_size.height,
-                                                   false,
-                                                   1,
-                                                   gfx::texture_format::RGBA8,
-                                                   BGFX_TEXTURE_RT);
-
-        auto tex3 = std::make_shared<gfx::texture>(viewport_size.width,
-                                                   viewport_size.height,
-                                                   false,
-                                                   1,
-                                                   gfx::texture_format::RGBA8,
-                                                   BGFX_TEXTURE_RT);
-
-        fbo = std::make_shared<gfx::frame_buffer>();
-        fbo->populate({tex0, tex1, tex2, tex3, depth});
-    }
-
-    return fbo;
-}
+    std::array<gfx::render_graph::handle, 4> color;
+    gfx::render_graph::handle depth;
+};
 
-auto create_or_resize_l_buffer(gfx::render_view& rview, const usize32_t& viewport_size) -> const gfx::frame_buffer::ptr&
+auto get_g_buffer(const gfx::render_graph::resources& res, const g_buffer_handles& gbuffer) -> gfx::frame_buffer::ptr
 {
-    auto& depth = create_or_resize_d_buffer(rview, viewport_size);
-
-    auto& fbo = rview.fbo_get_or_emplace("LBUFFER");
-    if(!fbo || (fbo && fbo->get_size() != viewport_size))
-    {
-        auto tex = std::make_shared<gfx::texture>(viewport_size.width,
-                                                  viewport_size.height,
-                                                  false,
-                                                  1,
-                                                  gfx::texture_format::RGBA16F,
-                                                  BGFX_TEXTURE_RT);
-
-        fbo = std::make_shared<gfx::frame_buffer>();
-        fbo->populate({tex});
-
-        auto& fbo_depth = rview.fbo_get_or_emplace("LBUFFER_DEPTH");
-        fbo_depth = std::make_shared<gfx::frame_buffer>();
-        fbo_depth->populate({tex, depth});
-    }
-
-    return fbo;
+    return res.get_frame_buffer(
+        {gbuffer.color[0], gbuffer.color[1], gbuffer.color[2], gbuffer.color[3], gbuffer.depth});
 }
 
-auto create_or_resize_r_buffer(gfx::render_view& rview, const usize32_t& viewport_size) -> const gfx::frame_buffer::ptr&
+void read_g_buffer(gfx::render_graph::builder& builder, const g_buffer_handles& gbuffer)
 {
-    auto& fbo = rview.fbo_get_or_emplace("RBUFFER");
-    if(!fbo || (fbo && fbo->get_size() != viewport_size))
+    for(const auto& h : gbuffer.color)
     {
-        auto tex = std::make_shared<gfx::texture>(viewport_size.width,
-                                                  viewport_size.height,
-                                                  false,
-                                                  1,
-                                                  gfx::texture_format::RGBA16F,
-                                                  BGFX_TEXTURE_RT);
-
-        fbo = std::make_shared<gfx::frame_buffer>();
-        fbo->populate({tex});
+        builder.read(h);
     }
-
-    return fbo;
+    builder.read(gbuffer.depth);
 }
+
 auto create_or_resize_o_buffer(gfx::render_view& rview, const usize32_t& viewport_size) -> const gfx::frame_buffer::ptr&
 {
     auto& depth = create_or_resize_d_buffer(rview, viewport_size);
@@ -155,26 +98,23 @@ auto create_or_resize_o_buffer(gfx::render_view& rview, const usize32_t& viewpor
     return fbo;
 }
 
+auto get_screen_percent(const irect32_t& rect, const camera& cam) -> float
+{
+    const auto& viewport = cam.get_viewport_size();
+
+    return math::clamp((float(rect.height()) / float(viewport.height)) * 100.0f, 0.0f, 100.0f);
+}
+
 auto update_lod_data(lod_data& data,
                      const std::vector<urange32_t>& lod_limits,
                      std::size_t total_lods,
                      float transition_time,
                      float dt,
-                     const asset_handle<mesh>& mesh,
-                     const math::transform& world,
-                     const camera& cam) -> bool
+                     float percent) -> bool
 {
-    if(!mesh)
-        return false;
-
     if(total_lods <= 1)
         return true;
 
-    const auto& viewport = cam.get_viewport_size();
-    auto rect = mesh.get()->calculate_screen_rect(world, cam);
-
-    float percent = math::clamp((float(rect.height()) / float(viewport.height)) * 100.0f, 0.0f, 100.0f);
-
     std::size_t lod = 0;
     for(size_t i = 0; i < lod_limits.size(); ++i)
     {
@@ -204,34 +144,145 @@ auto update_lod_data(lod_data& data,
     return true;
 }
 
-auto should_rebuild_reflections(const visibility_set_models_t& visibility_set, const reflection_probe& probe) -> bool
+void request_material_mips(std::vector<texture_streamer::texel_request>& requests,
+                           const pbr_material& mat,
+                           float screen_size)
 {
-    if(probe.method == reflect_method::environment)
-        return true;
+    const auto& tiling = mat.get_tiling();
+    const float screen_texels = screen_size * math::max(tiling.x, tiling.y);
+
+    for(const auto* map : {&mat.get_color_map(),
+                           &mat.get_normal_map(),
+                           &mat.get_roughness_map(),
+                           &mat.get_metalness_map(),
+                           &mat.get_ao_map(),
+                           &mat.get_emissive_map()})
+    {
+        if(map->is_ready())
+        {
+            requests.push_back({map->get().get(), screen_texels});
+        }
+    }
+}
 
-    for(const auto& element : visibility_set)
+void hash_transform(std::uint64_t& seed, const math::transform& t)
+{
+    const auto& m = t.get_matrix();
+    for(int c = 0; c < 4; ++c)
     {
-        const auto& transform_comp_ref = element.get<transform_component>();
-        const auto& model_comp_ref = element.get<model_component>();
+        for(int r = 0; r < 4; ++r)
+        {
+            utils::stable_hash_combine(seed, m[c][r]);
+        }
+    }
+}
 
-        const auto& world_transform = transform_comp_ref.get_transform_global();
-        const auto& world_bounds = model_comp_ref.get_world_bounds();
-        const auto& local_bounds = model_comp_ref.get_local_bounds();
+void hash_probe(std::uint64_t& seed, const reflection_probe& probe, const math::transform& world_transform)
+{
+    utils::stable_hash_combine(seed, std::uint8_t(probe.type));
+    utils::stable_hash_combine(seed, std::uint8_t(probe.method));
+    utils::stable_hash_combine(seed, probe.box_data.extents.x);
+    utils::stable_hash_combine(seed, probe.box_data.extents.y);
+    utils::stable_hash_combine(seed, probe.box_data.extents.z);
+    utils::stable_hash_combine(seed, probe.box_data.transition_distance);
+    utils::stable_hash_combine(seed, probe.sphere_data.range);
+    hash_transform(seed, world_transform);
+}
 
-        bool result = false;
+/// Hashes an asset by key and by when it was last compiled, so edits of its content change the hash.
+/// Returns false while the asset is still loading.
+template<typename T>
+auto hash_asset(std::uint64_t& seed, const asset_handle<T>& handle) -> bool
+{
+    const auto& key = handle.id();
+    utils::stable_hash_combine(seed, key);
 
-        for(std::uint32_t i = 0; i < 6; ++i)
+    if(!key.empty() && fs::has_known_protocol(key))
+    {
+        fs::error_code ec;
+        auto time = fs::last_write_time(asset_reader::resolve_compiled_path(key), ec);
+        if(ec)
         {
-            const auto& camera = camera::get_face_camera(i, world_transform);
-            // result |= camera.test_obb(local_bounds, world_transform);
-            result |= camera.test_aabb(world_bounds);
+            time = fs::last_write_time(fs::resolve_protocol(key), ec);
         }
 
-        if(result)
-            return true;
+        if(!ec)
+        {
+            utils::stable_hash_combine(seed, time.time_since_epoch().count());
+        }
     }
 
-    return false;
+    return !handle || handle.is_ready();
+}
+
+/// Hashes everything a probe captures, so it is only baked again when its content changes.
+/// @param assets_ready Set to false if an asset the probe captures is still loading.
+auto get_reflection_hash(scene& scn,
+                         const reflection_probe& probe,
+                         const math::transform& world_transform,
+                         const math::bbox& probe_world_bounds,
+                         const visibility_set_models_t& static_models,
+                         bool& assets_ready) -> std::uint64_t
+{
+    // The hash names the cached bake on disk, so it must be the same for every build.
+    std::uint64_t seed = utils::stable_hash_seed;
+    hash_probe(seed, probe, world_transform);
+
+    if(probe.method != reflect_method::environment)
+    {
+        for(const auto& element : static_models)
+        {
+            const auto& model_comp_ref = element.get<model_component>();
+            if(!probe_world_bounds.intersect(model_comp_ref.get_world_bounds()))
+            {
+                continue;
+            }
+
+            const auto& model = model_comp_ref.get_model();
+            assets_ready &= hash_asset(seed, model.get_lod(0));
+            for(const auto& mat : model.get_materials())
+            {
+                assets_ready &= hash_asset(seed, mat);
+            }
+            hash_transform(seed, element.get<transform_component>().get_transform_global());
+        }
+    }
+
+    scn.registry->view<transform_component, light_component>().each(
+        [&](auto e, auto&& transform_comp, auto&& light_comp)
+        {
+            const auto& light = light_comp.get_light();
+            const auto& light_transform = transform_comp.get_transform_global();
+
+            if(light.type != light_type::directional &&
+               !probe_world_bounds.intersect(math::bbox::mul(light_comp.get_bounds(), light_transform)))
+            {
+                return;
+            }
+
+            utils::stable_hash_combine(seed, std::uint8_t(light.type));
+            utils::stable_hash_combine(seed, light.color.value.r);
+            utils::stable_hash_combine(seed, light.color.value.g);
+            utils::stable_hash_combine(seed, light.color.value.b);
+            utils::stable_hash_combine(seed, light.intensity);
+            utils::stable_hash_combine(seed, light.casts_shadows);
+            utils::stable_hash_combine(seed, light.spot_data.get_range());
+            utils::stable_hash_combine(seed, light.spot_data.get_inner_angle());
+            utils::stable_hash_combine(seed, light.spot_data.get_outer_angle());
+            utils::stable_hash_combine(seed, light.point_data.range);
+            utils::stable_hash_combine(seed, light.point_data.exponent_falloff);
+            hash_transform(seed, light_transform);
+        });
+
+    scn.registry->view<skylight_component>().each(
+        [&](auto e, auto&& sky_comp)
+        {
+            utils::stable_hash_combine(seed, std::uint8_t(sky_comp.get_mode()));
+            utils::stable_hash_combine(seed, sky_comp.get_turbidity());
+        });
+
+    // Zero means never baked.
+    return seed == 0 ? 1 : seed;
 }
 
 auto should_rebuild_shadows(const visibility_set_models_t& visibility_set,
@@ -256,14 +307,59 @@ auto should_rebuild_shadows(const visibility_set_models_t& visibility_set,
 }
 } // namespace
 
-auto deferred::get_light_program(const light& l) const -> const color_lighting&
+auto deferred::get_light_program(const light& l) -> const color_lighting&
 {
-    return color_lighting_[uint8_t(l.type)][uint8_t(l.shadow_params.depth)][uint8_t(l.shadow_params.type)];
+    return get_or_create_program(
+        color_lighting_[uint8_t(l.type)][uint8_t(l.shadow_params.depth)][uint8_t(l.shadow_params.type)]);
 }
 
-auto deferred::get_light_program_no_shadows(const light& l) const -> const color_lighting&
+auto deferred::get_light_program_no_shadows(const light& l) -> const color_lighting&
 {
-    return color_lighting_no_shadow_[uint8_t(l.type)];
+    return get_or_create_program(color_lighting_no_shadow_[uint8_t(l.type)]);
+}
+
+auto deferred::is_lighting_ready(scene& scn) -> bool
+{
+    // Requesting the variants starts loading them, both the ones with and without shadows may be drawn.
+    bool ready = true;
+    scn.registry->view<light_component>().each(
+        [&](auto e, auto&& light_comp)
+        {
+            const auto& light = light_comp.get_light();
+            ready &= get_light_program_no_shadows(light).program != nullptr;
+            if(light.casts_shadows)
+            {
+                ready &= get_light_program(light).program != nullptr;
+            }
+        });
+
+    return ready;
+}
+
+auto deferred::get_or_create_program(color_lighting& variant) -> const color_lighting&
+{
+    if(variant.program || variant.fs.empty())
+    {
+        return variant;
+    }
+
+    // The shaders load in the background, the program is only created once both are ready
+    // so the frame never waits on them.
+    if(!variant.vs_shader || !variant.fs_shader)
+    {
+        auto& am = engine::context().get<asset_manager>();
+
+        variant.vs_shader = am.get_asset<gfx::shader>("engine:/data/shaders/" + variant.vs + ".sc");
+        variant.fs_shader = am.get_asset<gfx::shader>("engine:/data/shaders/" + variant.fs + ".sc");
+    }
+
+    if(variant.vs_shader.is_ready() && variant.fs_shader.is_ready())
+    {
+        variant.program = std::make_shared<gpu_program>(variant.vs_shader, variant.fs_shader);
+        variant.cache_uniforms();
+    }
+
+    return variant;
 }
 
 void deferred::submit_material(geom_program& program, const pbr_material& mat)
@@ -314,19 +410,17 @@ void deferred::build_reflections(scene& scn, const camera& camera, delta_t dt)
 {
     APP_SCOPE_PERF("Reflection Generation Pass");
 
-    auto query = visibility_query::is_dirty | visibility_query::is_static | visibility_query::is_reflection_caster;
+    auto& probe_system = engine::context().get<reflection_probe_system>();
+
+    // Probes capture static casters only, so the bake is keyed by a hash of its content
+    // rather than by what changed this frame. The hash is computed again only when the content version changes.
+    const auto content_version = probe_system.get_content_version(scn);
+    bool queried = false;
+    visibility_set_models_t static_models;
 
-    auto dirty_models = gather_visible_models(scn, nullptr, query);
     scn.registry->view<transform_component, reflection_probe_component>().each(
         [&](auto e, auto&& transform_comp, auto&& reflection_probe_comp)
         {
-            if(reflection_probe_comp.already_generated())
-            {
-                return;
-            }
-
-            // reflection_probe_comp.set_generation_frame(gfx::get_render_frame());
-
             const auto& world_transform = transform_comp.get_transform_global();
 
             const auto& bounds = reflection_probe_comp.get_bounds();
@@ -336,46 +430,107 @@ void deferred::build_reflections(scene& scn, const camera& camera, delta_t dt)
             }
 
             const auto& probe = reflection_probe_comp.get_probe();
+            bool not_environment = probe.method != reflect_method::environment;
 
-            bool should_rebuild = should_rebuild_reflections(dirty_models, probe);
-
-            // If reflections shouldn't be rebuilt - continue.
-            if(!should_rebuild)
-                return;
-
+            if(!reflection_probe_comp.is_baking())
             {
-                // iterate trough each cube face
-                for(std::uint32_t face = 0; face < 6; ++face)
+                auto hash = reflection_probe_comp.get_content_hash(content_version);
+                if(hash == 0)
                 {
-                    if(reflection_probe_comp.already_generated(face))
+                    if(not_environment && !queried)
+                    {
+                        static_models = gather_visible_models(scn,
+                                                              nullptr,
+                                                              visibility_query::is_static |
+                                                                  visibility_query::is_reflection_caster);
+                        queried = true;
+                    }
+
+                    bool assets_ready = true;
+                    hash = get_reflection_hash(scn,
+                                               probe,
+                                               world_transform,
+                                               math::bbox::mul(bounds, world_transform),
+                                               static_models,
+                                               assets_ready);
+
+                    // A bake of half loaded content would be cached under the final hash.
+                    if(!assets_ready)
+                    {
+                        return;
+                    }
+
+                    if(content_version != 0)
                     {
-                        continue;
+                        reflection_probe_comp.set_content_hash(hash, content_version);
                     }
+                }
+
+                if(hash == reflection_probe_comp.get_baked_hash())
+                {
+                    return;
+                }
+
+                if(auto cached = probe_system.load_cached(hash))
+                {
+                    reflection_probe_comp.set_baked_cubemap(cached, hash);
+                    return;
+                }
 
-                    reflection_probe_comp.set_generation_frame(face, gfx::get_render_frame());
+                // Faces captured before the programs load would be cached unlit or unfiltered.
+                if(!ibl_prefilter_pass_.is_ready() || !is_lighting_ready(scn))
+                {
+                    return;
+                }
 
-                    auto camera = camera::get_face_camera(face, world_transform);
-                    camera.set_far_clip(probe.get_face_extents(face, world_transform));
-                    auto& rview = reflection_probe_comp.get_render_view(face);
-                    const auto& cubemap_fbo = reflection_probe_comp.get_cubemap_fbo(face);
+                reflection_probe_comp.begin_bake(hash);
+            }
 
-                    camera.set_viewport_size(usize32_t(cubemap_fbo->get_size()));
-                    visibility_set_models_t visibility_set;
+            // The faces are spread over several frames, the previous cubemap is used meanwhile.
+            while(reflection_probe_comp.is_baking() && probe_system.consume_face_budget())
+            {
+                auto face = reflection_probe_comp.get_next_bake_face();
 
-                    bool not_environment = probe.method != reflect_method::environment;
+                auto camera = camera::get_face_camera(face, world_transform);
+                camera.set_far_clip(probe.get_face_extents(face, world_transform));
+                auto& rview = reflection_probe_comp.get_render_view(face);
+                const auto& capture_fbo = reflection_probe_comp.get_capture_fbo(face);
 
-                    pipeline_flags pflags = pipeline_steps::probe;
-                    visibility_flags vis_flags = visibility_query::is_reflection_caster;
+                camera.set_viewport_size(usize32_t(capture_fbo->get_size()));
 
-                    if(not_environment)
-                    {
-                        pflags |= pipeline_steps::shadow_pass;
-                        pflags |= pipeline_steps::geometry_pass;
-                    }
+                pipeline_flags pflags = pipeline_steps::probe;
+                visibility_flags vis_flags = visibility_query::is_reflection_caster;
+
+                if(not_environment)
+                {
+                    pflags |= pipeline_steps::shadow_pass;
+                    pflags |= pipeline_steps::geometry_pass;
+                }
+
+                gfx::render_pass::push_scope("build.reflecitons");
+                run_pipeline(capture_fbo, scn, camera, rview, dt, vis_flags, pflags);
+                gfx::render_pass::pop_scope();
+
+                if(reflection_probe_comp.set_face_baked(face))
+                {
+                    ibl_prefilter_pass::run_params params;
+                    params.input = reflection_probe_comp.get_capture_cubemap();
+                    params.output = reflection_probe_comp.get_bake_target();
 
                     gfx::render_pass::push_scope("build.reflecitons");
-                    run_pipeline(cubemap_fbo, scn, camera, rview, dt, vis_flags, pflags);
+                    bool prefiltered = ibl_prefilter_pass_.run(params);
                     gfx::render_pass::pop_scope();
+
+                    auto hash = reflection_probe_comp.get_bake_hash();
+                    if(!prefiltered)
+                    {
+                        // The bake target was never written, capture the faces again.
+                        reflection_probe_comp.begin_bake(hash);
+                        break;
+                    }
+
+                    reflection_probe_comp.finish_bake();
+                    probe_system.store_cached(hash, reflection_probe_comp.get_cubemap());
                 }
             }
         });
@@ -491,8 +646,9 @@ void deferred::run_pipeline_impl(pipeline_flags pipeline,
     APP_SCOPE_PERF("Full Pass");
 
     visibility_set_models_t visibility_set;
-    gfx::frame_buffer::ptr target = nullptr;
 
+    // Probe faces are rendered by nested pipelines. They are done before the graph
+    // below takes its targets from the pool, so both share the same memory.
     bool apply_reflecitons = pipeline & pipeline_steps::reflection_probe;
     bool apply_shadows = pipeline & pipeline_steps::shadow_pass;
     if(apply_reflecitons)
@@ -505,40 +661,214 @@ void deferred::run_pipeline_impl(pipeline_flags pipeline,
         build_shadows(scn, camera);
     }
 
-    const auto& viewport_size = camera.get_viewport_size();
-    create_or_resize_d_buffer(rview, viewport_size);
-    create_or_resize_g_buffer(rview, viewport_size);
-    create_or_resize_l_buffer(rview, viewport_size);
-    create_or_resize_r_buffer(rview, viewport_size);
-
     if(pipeline & pipeline_steps::geometry_pass)
     {
         visibility_set = gather_visible_models(scn, &camera.get_frustum(), query);
+
+        if(pipeline & pipeline_steps::occlusion_culling)
+        {
+            cull_occluded_models(visibility_set, camera);
+        }
+    }
+
+    const auto& viewport_size = camera.get_viewport_size();
+
+    gfx::render_graph graph(engine::context().get<renderer>().get_transient_pool());
+
+    // Views that expose their depth through OBUFFER_DEPTH render into it directly,
+    // all other views use a pooled one.
+    g_buffer_handles gbuffer;
+    const auto& view_depth = rview.tex_safe_get("DEPTH");
+    if(view_depth && view_depth->get_size() == viewport_size)
+    {
+        gbuffer.depth = graph.import_texture("DEPTH", view_depth);
+    }
+
+    auto output_handle = graph.import_frame_buffer("OUTPUT", output);
+
+    gfx::render_graph::handle rbuffer;
+    gfx::render_graph::handle lbuffer;
+
+    graph.add_pass(
+        "G-Buffer Pass",
+        [&](gfx::render_graph::builder& builder)
+        {
+            if(gbuffer.depth.valid())
+            {
+                builder.write(gbuffer.depth);
+            }
+            else
+            {
+                gbuffer.depth = builder.create("DEPTH", {viewport_size, gfx::texture_format::D32, BGFX_TEXTURE_RT});
+            }
+
+            gbuffer.color[0] = builder.create(
+                "GBUFFER0",
+                {viewport_size, gfx::texture_format::RGBA8, BGFX_TEXTURE_COMPUTE_WRITE | BGFX_TEXTURE_RT});
+            gbuffer.color[1] =
+                builder.create("GBUFFER1", {viewport_size, gfx::texture_format::RGBA16F, BGFX_TEXTURE_RT});
+            gbuffer.color[2] = builder.create("GBUFFER2", {viewport_size, gfx::texture_format::RGBA8, BGFX_TEXTURE_RT});
+            gbuffer.color[3] = builder.create("GBUFFER3", {viewport_size, gfx::texture_format::RGBA8, BGFX_TEXTURE_RT});
+        },
+        [&](const gfx::render_graph::resources& res)
+        {
+            run_g_buffer_pass(visibility_set, camera, get_g_buffer(res, gbuffer), dt);
+        });
+
+    // The reduced depth is read back and culls the models of the next frames.
+    std::vector<gfx::render_graph::handle> hiz_levels;
+    if((pipeline & pipeline_steps::occlusion_culling) && hiz_pass_.can_run())
+    {
+        graph.add_pass(
+            "Hi-Z Pass",
+            [&](gfx::render_graph::builder& builder)
+            {
+                builder.read(gbuffer.depth);
+                for(const auto& size : hiz_pass::get_level_sizes(viewport_size))
+                {
+                    hiz_levels.emplace_back(builder.create("HIZ", {size, gfx::texture_format::R32F, BGFX_TEXTURE_RT}));
+                }
+                builder.side_effect();
+            },
+            [&](const gfx::render_graph::resources& res)
+            {
+                hiz_pass::run_params params;
+                params.depth = res.get_texture(gbuffer.depth);
+                for(const auto& h : hiz_levels)
+                {
+                    params.levels.emplace_back(res.get_frame_buffer({h}));
+                }
+                params.view_proj = camera.get_view_projection().get_matrix();
+
+                hiz_pass_.run(params);
+            });
     }
-    run_g_buffer_pass(visibility_set, camera, rview, dt);
 
     if(pipeline & pipeline_steps::assao)
     {
-        run_assao_pass(visibility_set, camera, rview, dt);
+        graph.add_pass(
+            "Assao Pass",
+            [&](gfx::render_graph::builder& builder)
+            {
+                read_g_buffer(builder, gbuffer);
+                builder.write(gbuffer.color[0]);
+            },
+            [&](const gfx::render_graph::resources& res)
+            {
+                run_assao_pass(visibility_set, camera, get_g_buffer(res, gbuffer), dt);
+            });
     }
 
-    run_reflection_probe_pass(scn, camera, rview, dt);
+    graph.add_pass(
+        "Reflection Probe Pass",
+        [&](gfx::render_graph::builder& builder)
+        {
+            read_g_buffer(builder, gbuffer);
+            rbuffer = builder.create("RBUFFER", {viewport_size, gfx::texture_format::RGBA16F, BGFX_TEXTURE_RT});
+        },
+        [&](const gfx::render_graph::resources& res)
+        {
+            run_reflection_probe_pass(scn, camera, get_g_buffer(res, gbuffer), res.get_frame_buffer({rbuffer}), dt);
+        });
 
-    target = run_lighting_pass(scn, camera, rview, apply_shadows, dt);
+    graph.add_pass(
+        "Lighting Pass",
+        [&](gfx::render_graph::builder& builder)
+        {
+            read_g_buffer(builder, gbuffer);
+            builder.read(rbuffer);
+            lbuffer = builder.create("LBUFFER", {viewport_size, gfx::texture_format::RGBA16F, BGFX_TEXTURE_RT});
+        },
+        [&](const gfx::render_graph::resources& res)
+        {
+            run_lighting_pass(scn,
+                              camera,
+                              get_g_buffer(res, gbuffer),
+                              res.get_frame_buffer({rbuffer}),
+                              res.get_frame_buffer({lbuffer}),
+                              apply_shadows,
+                              dt);
+        });
 
-    run_atmospherics_pass(target, scn, camera, rview, dt);
+    graph.add_pass(
+        "Atmospheric Pass",
+        [&](gfx::render_graph::builder& builder)
+        {
+            builder.read(gbuffer.depth);
+            builder.write(lbuffer);
+        },
+        [&](const gfx::render_graph::resources& res)
+        {
+            run_atmospherics_pass(res.get_frame_buffer({lbuffer, gbuffer.depth}), scn, camera, dt);
+        });
 
-    run_tonemapping_pass(target, output);
+    graph.add_pass(
+        "Tonemapping Pass",
+        [&](gfx::render_graph::builder& builder)
+        {
+            builder.read(lbuffer);
+            builder.write(output_handle);
+        },
+        [&](const gfx::render_graph::resources& res)
+        {
+            run_tonemapping_pass(res.get_frame_buffer({lbuffer}), res.get_frame_buffer(output_handle));
+        });
 
     if(debug_pass_ >= 0 && (pipeline == pipeline_steps::full))
     {
-        run_debug_visualization_pass(camera, rview, output);
+        graph.add_pass(
+            "Debug Visualization Pass",
+            [&](gfx::render_graph::builder& builder)
+            {
+                read_g_buffer(builder, gbuffer);
+                builder.read(rbuffer);
+                builder.write(output_handle);
+            },
+            [&](const gfx::render_graph::resources& res)
+            {
+                run_debug_visualization_pass(camera,
+                                             get_g_buffer(res, gbuffer),
+                                             res.get_frame_buffer({rbuffer}),
+                                             res.get_frame_buffer(output_handle));
+            });
+    }
+
+    graph.compile();
+    graph.execute();
+}
+
+void deferred::cull_occluded_models(visibility_set_models_t& visibility_set, const camera& camera)
+{
+    APP_SCOPE_PERF("Occlusion Culling");
+
+    hiz_pass_.update(occlusion_buffer_);
+
+    if(!occlusion_buffer_.is_usable(camera.get_viewport_size(), gfx::get_render_frame()))
+    {
+        return;
     }
+
+    const auto tested = std::uint32_t(visibility_set.size());
+
+    visibility_set.erase(std::remove_if(std::begin(visibility_set),
+                                        std::end(visibility_set),
+                                        [&](const entt::handle& element)
+                                        {
+                                            const auto& transform_comp_ref = element.get<transform_component>();
+                                            const auto& model_comp_ref = element.get<model_component>();
+
+                                            return occlusion_buffer_.is_occluded(model_comp_ref.get_local_bounds(),
+                                                                                 transform_comp_ref.get_transform_global());
+                                        }),
+                         std::end(visibility_set));
+
+    const auto culled = tested - std::uint32_t(visibility_set.size());
+    engine::context().get<renderer>().add_occlusion_stats(tested, culled);
 }
 
 void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
                                  const camera& camera,
-                                 gfx::render_view& rview,
+                                 const gfx::frame_buffer::ptr& gbuffer,
                                  delta_t dt)
 {
     APP_SCOPE_PERF("G-Buffer Pass");
@@ -547,7 +877,7 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
     const auto& proj = camera.get_projection();
     const auto& viewport_size = camera.get_viewport_size();
 
-    const auto& gbuffer = rview.fbo_get("GBUFFER");
+    mip_requests_.clear();
 
     gfx::render_pass pass("g_buffer_fill");
     pass.clear();
@@ -575,14 +905,16 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
         if(!base_mesh)
             continue;
 
+        // Screen space size drives the lod selection and the texel density requested from the texture streamer.
+        const auto screen_rect = base_mesh.get()->calculate_screen_rect(world_transform, camera);
+        const auto screen_percent = get_screen_percent(screen_rect, camera);
+
         if(false == update_lod_data(lod_runtime_data,
                                     lod_limits,
                                     lod_count,
                                     transition_time,
                                     dt.count(),
-                                    base_mesh,
-                                    world_transform,
-                                    camera))
+                                    screen_percent))
             continue;
 
         const auto current_time = lod_runtime_data.current_time;
@@ -599,6 +931,8 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
 
         auto camera_pos = camera.get_position();
 
+        const auto screen_size = float(math::max(screen_rect.width(), screen_rect.height()));
+
         model::submit_callbacks callbacks;
         callbacks.setup_begin = [&](const model::submit_callbacks::params& submit_params)
         {
@@ -623,6 +957,7 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
             if(rttr::type::get(mat) == rttr::type::get<pbr_material>())
             {
                 const auto& pbr = static_cast<const pbr_material&>(mat);
+                request_material_mips(mip_requests_, pbr, screen_size);
                 submit_material(prog, pbr);
             }
             else
@@ -640,6 +975,10 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
         };
 
         model_comp.set_last_render_frame(gfx::get_render_frame());
+
+        // Drives the animation LOD of renderer based animators.
+        model_comp.set_render_screen_percent(screen_percent);
+
         model.submit(world_transform,
                      submesh_transforms,
                      bone_transforms,
@@ -664,17 +1003,18 @@ void deferred::run_g_buffer_pass(const visibility_set_models_t& visibility_set,
         }
     }
     gfx::discard();
+
+    // One lock on the streamer per pass rather than one per material.
+    engine::context().get<texture_streamer>().request(mip_requests_);
 }
 
 void deferred::run_assao_pass(const visibility_set_models_t& visibility_set,
                               const camera& camera,
-                              gfx::render_view& rview,
+                              const gfx::frame_buffer::ptr& gbuffer,
                               delta_t dt)
 {
     APP_SCOPE_PERF("Assao Pass");
 
-    const auto& gbuffer = rview.fbo_get("GBUFFER");
-
     auto color_ao = gbuffer->get_texture(0);
     auto normal = gbuffer->get_texture(1);
     auto depth = gbuffer->get_texture(4);
@@ -687,11 +1027,13 @@ void deferred::run_assao_pass(const visibility_set_models_t& visibility_set,
     assao_pass_.run(camera, params);
 }
 
-auto deferred::run_lighting_pass(scene& scn,
+void deferred::run_lighting_pass(scene& scn,
                                  const camera& camera,
-                                 gfx::render_view& rview,
+                                 const gfx::frame_buffer::ptr& gbuffer,
+                                 const gfx::frame_buffer::ptr& rbuffer,
+                                 const gfx::frame_buffer::ptr& lbuffer,
                                  bool apply_shadows,
-                                 delta_t dt) -> gfx::frame_buffer::ptr
+                                 delta_t dt)
 {
     APP_SCOPE_PERF("Lighting Pass");
 
@@ -701,10 +1043,6 @@ auto deferred::run_lighting_pass(scene& scn,
 
     const auto& viewport_size = camera.get_viewport_size();
 
-    const auto& gbuffer = rview.fbo_get("GBUFFER");
-    const auto& rbuffer = rview.fbo_safe_get("RBUFFER");
-    const auto& lbuffer = rview.fbo_get("LBUFFER");
-
     const auto buffer_size = lbuffer->get_size();
 
     gfx::render_pass pass("light_buffer_fill");
@@ -738,6 +1076,11 @@ auto deferred::run_lighting_pass(scene& scn,
             bool has_shadows = light.casts_shadows && apply_shadows;
 
             const auto& lprogram = has_shadows ? get_light_program(light) : get_light_program_no_shadows(light);
+            if(!lprogram.program)
+            {
+                // Its shaders are still loading.
+                return;
+            }
 
             lprogram.program->begin();
 
@@ -797,11 +1140,13 @@ auto deferred::run_lighting_pass(scene& scn,
         });
 
     gfx::discard();
-
-    return lbuffer;
 }
 
-void deferred::run_reflection_probe_pass(scene& scn, const camera& camera, gfx::render_view& rview, delta_t dt)
+void deferred::run_reflection_probe_pass(scene& scn,
+                                         const camera& camera,
+                                         const gfx::frame_buffer::ptr& gbuffer,
+                                         const gfx::frame_buffer::ptr& rbuffer,
+                                         delta_t dt)
 {
     APP_SCOPE_PERF("Reflection Probe Pass");
 
@@ -810,8 +1155,6 @@ void deferred::run_reflection_probe_pass(scene& scn, const camera& camera, gfx::
     const auto& camera_pos = camera.get_position();
 
     const auto& viewport_size = camera.get_viewport_size();
-    const auto& gbuffer = rview.fbo_get("GBUFFER");
-    const auto& rbuffer = rview.fbo_get("RBUFFER");
 
     const auto buffer_size = rbuffer->get_size();
 
@@ -931,10 +1274,9 @@ void deferred::run_reflection_probe_pass(scene& scn, const camera& camera, gfx::
     gfx::discard();
 }
 
-void deferred::run_atmospherics_pass(gfx::frame_buffer::ptr input,
+void deferred::run_atmospherics_pass(const gfx::frame_buffer::ptr& input,
                                      scene& scn,
                                      const camera& camera,
-                                     gfx::render_view& rview,
                                      delta_t dt)
 {
     APP_SCOPE_PERF("Atmospheric Pass");
@@ -983,15 +1325,13 @@ void deferred::run_atmospherics_pass(gfx::frame_buffer::ptr input,
     auto c = camera;
     c.set_projection_mode(projection_mode::perspective);
 
-    auto lbuffer_depth = rview.fbo_get("LBUFFER_DEPTH");
-
     switch(mode)
     {
         case skylight_component::sky_mode::perez:
-            atmospheric_pass_perez_.run(lbuffer_depth, c, dt, params_perez);
+            atmospheric_pass_perez_.run(input, c, dt, params_perez);
             break;
         default:
-            atmospheric_pass_.run(lbuffer_depth, c, dt, params);
+            atmospheric_pass_.run(input, c, dt, params);
             break;
     }
 }
@@ -1011,14 +1351,12 @@ void deferred::run_tonemapping_pass(const gfx::frame_buffer::ptr& input, const g
 }
 
 void deferred::run_debug_visualization_pass(const camera& camera,
-                                            gfx::render_view& rview,
+                                            const gfx::frame_buffer::ptr& gbuffer,
+                                            const gfx::frame_buffer::ptr& rbuffer,
                                             const gfx::frame_buffer::ptr& output)
 {
     const auto& view = camera.get_view();
     const auto& proj = camera.get_projection();
-    const auto& gbuffer = rview.fbo_get("GBUFFER");
-    const auto& rbuffer = rview.fbo_safe_get("RBUFFER");
-    // const auto& lbuffer = rview.fbo_get("LBUFFER");
 
     gfx::render_pass pass("debug_visualization_pass");
     pass.bind(output.get());
@@ -1089,65 +1427,27 @@ auto deferred::init(rtti::context& ctx) -> bool
     debug_visualization_program_.cache_uniforms();
 
     // Color lighting.
+    // Only the variants are declared here, their programs are created the first time
+    // a light needs them so unused shadow permutations are never loaded.
+    const std::array<std::string, uint8_t(light_type::count)> light_names = {"spot", "point", "directional"};
+    const std::array<std::string, uint8_t(sm_impl::count)> impl_names = {"hard", "pcf", "pcss", "vsm", "esm"};
+    const std::array<std::string, uint8_t(sm_depth::count)> depth_suffixes = {"", "_linear"};
 
-    // clang-format off
-    color_lighting_no_shadow_[uint8_t(light_type::spot)].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::hard)].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_hard");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::pcf) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_pcf");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::pcss) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_pcss");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::vsm) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_vsm");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::esm) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_esm");
-
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::hard)].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_hard_linear");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::pcf) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_pcf_linear");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::pcss) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_pcss_linear");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::vsm) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_vsm_linear");
-    color_lighting_[uint8_t(light_type::spot)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::esm) ].program = loadProgram("vs_clip_quad", "fs_deferred_spot_light_esm_linear");
-
-    color_lighting_no_shadow_[uint8_t(light_type::point)].program = loadProgram("vs_clip_quad", "fs_deferred_point_light");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::hard)].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_hard");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::pcf) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_pcf");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::pcss) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_pcss");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::vsm) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_vsm");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::esm) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_esm");
-
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::hard)].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_hard_linear");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::pcf) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_pcf_linear");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::pcss) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_pcss_linear");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::vsm) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_vsm_linear");
-    color_lighting_[uint8_t(light_type::point)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::esm) ].program = loadProgram("vs_clip_quad", "fs_deferred_point_light_esm_linear");
-
-    color_lighting_no_shadow_[uint8_t(light_type::directional)].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::hard)].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_hard");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::pcf) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_pcf");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::pcss) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_pcss");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::vsm) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_vsm");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::invz)][uint8_t(sm_impl::esm) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_esm");
-
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::hard)].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_hard_linear");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::pcf) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_pcf_linear");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::pcss) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_pcss_linear");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::vsm) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_vsm_linear");
-    color_lighting_[uint8_t(light_type::directional)][uint8_t(sm_depth::linear)][uint8_t(sm_impl::esm) ].program = loadProgram("vs_clip_quad", "fs_deferred_directional_light_esm_linear");
-    // clang-format on
-
-    for(auto& byLightType : color_lighting_no_shadow_)
+    for(size_t light_idx = 0; light_idx < light_names.size(); ++light_idx)
     {
-        if(byLightType.program)
-        {
-            byLightType.cache_uniforms();
-        }
-    }
-    for(auto& byLightType : color_lighting_)
-    {
-        for(auto& byDepthType : byLightType)
+        auto light_fs = "fs_deferred_" + light_names[light_idx] + "_light";
+
+        auto& no_shadow = color_lighting_no_shadow_[light_idx];
+        no_shadow.vs = "vs_clip_quad";
+        no_shadow.fs = light_fs;
+
+        for(size_t depth_idx = 0; depth_idx < depth_suffixes.size(); ++depth_idx)
         {
-            for(auto& bySmImpl : byDepthType)
+            for(size_t impl_idx = 0; impl_idx < impl_names.size(); ++impl_idx)
             {
-                if(bySmImpl.program)
-                {
-                    bySmImpl.cache_uniforms();
-                }
+                auto& variant = color_lighting_[light_idx][depth_idx][impl_idx];
+                variant.vs = "vs_clip_quad";
+                variant.fs = light_fs + "_" + impl_names[impl_idx] + depth_suffixes[depth_idx];
             }
         }
     }
@@ -1157,6 +1457,8 @@ auto deferred::init(rtti::context& ctx) -> bool
     atmospheric_pass_.init(ctx);
     atmospheric_pass_perez_.init(ctx);
     tonemapping_pass_.init(ctx);
+    ibl_prefilter_pass_.init(ctx);
+    hiz_pass_.init(ctx);
     assao_pass_.init(ctx);
     return true;
 }
@@ -6,10 +6,13 @@
 #include <engine/rendering/ecs/components/model_component.h>
 #include <engine/rendering/gpu_program.h>
 #include <engine/rendering/light.h>
+#include <engine/rendering/texture_streamer.h>
 
 #include <engine/rendering/pipeline/passes/assao_pass.h>
 #include <engine/rendering/pipeline/passes/atmospheric_pass.h>
 #include <engine/rendering/pipeline/passes/atmospheric_pass_perez.h>
+#include <engine/rendering/pipeline/passes/hiz_pass.h>
+#include <engine/rendering/pipeline/passes/ibl_prefilter_pass.h>
 #include <engine/rendering/pipeline/passes/tonemapping_pass.h>
 
 namespace ace
@@ -41,6 +44,7 @@ public:
                       visibility_flags query,
                       pipeline_flags pflags) override;
     void set_debug_pass(int pass) override;
+    auto is_lighting_ready(scene& scn) -> bool override;
 
     enum pipeline_steps : uint32_t
     {
@@ -51,8 +55,9 @@ public:
         atmospheric = 1 << 5,
         assao = 1 << 6,
         tonemapping = 1 << 7,
+        occlusion_culling = 1 << 8,
 
-        full = geometry_pass | shadow_pass | reflection_probe | lighting | atmospheric | assao,
+        full = geometry_pass | shadow_pass | reflection_probe | lighting | atmospheric | assao | occlusion_culling,
         probe = lighting | atmospheric,
     };
 
@@ -64,30 +69,41 @@ public:
                            delta_t dt,
                            visibility_flags query);
 
+    /**
+     * @brief Removes the models hidden behind the depth of an earlier frame.
+     */
+    void cull_occluded_models(visibility_set_models_t& visibility_set, const camera& camera);
+
     void run_g_buffer_pass(const visibility_set_models_t& visibility_set,
                            const camera& camera,
-                           gfx::render_view& rview,
+                           const gfx::frame_buffer::ptr& gbuffer,
                            delta_t dt);
 
     void run_assao_pass(const visibility_set_models_t& visibility_set,
                         const camera& camera,
-                        gfx::render_view& rview,
+                        const gfx::frame_buffer::ptr& gbuffer,
                         delta_t dt);
 
-    auto run_lighting_pass(scene& scn, const camera& camera, gfx::render_view& rview, bool apply_shadows, delta_t dt)
-        -> gfx::frame_buffer::ptr;
+    void run_lighting_pass(scene& scn,
+                           const camera& camera,
+                           const gfx::frame_buffer::ptr& gbuffer,
+                           const gfx::frame_buffer::ptr& rbuffer,
+                           const gfx::frame_buffer::ptr& lbuffer,
+                           bool apply_shadows,
+                           delta_t dt);
 
-    void run_reflection_probe_pass(scene& scn, const camera& camera, gfx::render_view& rview, delta_t dt);
+    void run_reflection_probe_pass(scene& scn,
+                                   const camera& camera,
+                                   const gfx::frame_buffer::ptr& gbuffer,
+                                   const gfx::frame_buffer::ptr& rbuffer,
+                                   delta_t dt);
 
-    void run_atmospherics_pass(gfx::frame_buffer::ptr input,
-                               scene& scn,
-                               const camera& camera,
-                               gfx::render_view& rview,
-                               delta_t dt);
+    void run_atmospherics_pass(const gfx::frame_buffer::ptr& input, scene& scn, const camera& camera, delta_t dt);
 
     void run_tonemapping_pass(const gfx::frame_buffer::ptr& input, const gfx::frame_buffer::ptr& output);
     void run_debug_visualization_pass(const camera& camera,
-                                      gfx::render_view& rview,
+                                      const gfx::frame_buffer::ptr& gbuffer,
+                                      const gfx::frame_buffer::ptr& rbuffer,
                                       const gfx::frame_buffer::ptr& output);
 
     void build_reflections(scene& scn, const camera& camera, delta_t dt);
@@ -211,6 +227,15 @@ private:
         std::array<gfx::program::uniform_ptr, 7> s_tex;
 
         std::shared_ptr<gpu_program> program;
+
+        /// Vertex shader of the variant, the program is created on first use.
+        std::string vs;
+        /// Fragment shader of the variant.
+        std::string fs;
+
+        /// Shaders requested on first use.
+        asset_handle<gfx::shader> vs_shader;
+        asset_handle<gfx::shader> fs_shader;
     };
 
     struct debug_visualization_program : uniforms_cache
@@ -233,8 +258,9 @@ private:
 
     } debug_visualization_program_;
 
-    auto get_light_program(const light& l) const -> const color_lighting&;
-    auto get_light_program_no_shadows(const light& l) const -> const color_lighting&;
+    auto get_light_program(const light& l) -> const color_lighting&;
+    auto get_light_program_no_shadows(const light& l) -> const color_lighting&;
+    auto get_or_create_program(color_lighting& variant) -> const color_lighting&;
     void submit_material(geom_program& program, const pbr_material& mat);
 
     color_lighting color_lighting_[uint8_t(light_type::count)][uint8_t(sm_depth::count)][uint8_t(sm_impl::count)];
@@ -245,8 +271,15 @@ private:
     atmospheric_pass atmospheric_pass_{};
     atmospheric_pass_perez atmospheric_pass_perez_{};
     tonemapping_pass tonemapping_pass_{};
+    ibl_prefilter_pass ibl_prefilter_pass_{};
+    hiz_pass hiz_pass_{};
+    /// Depth of an earlier frame of this view, used to cull occluded models.
+    occlusion_buffer occlusion_buffer_{};
     assao_pass assao_pass_{};
 
+    /// Mip requests gathered during the g-buffer pass, handed to the streamer at once.
+    std::vector<texture_streamer::texel_request> mip_requests_;
+
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
     int debug_pass_{-1};
 };
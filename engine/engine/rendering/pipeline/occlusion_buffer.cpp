@@ -0,0 +1,178 @@
+#include "occlusion_buffer.h"
+
+#include <algorithm>
+
+namespace ace
+{
+namespace rendering
+{
+
+void occlusion_buffer::build(const params& p, std::uint32_t width, std::uint32_t height, const float* data)
+{
+    params_ = p;
+    levels_.clear();
+
+    if(width == 0 || height == 0 || data == nullptr)
+    {
+        return;
+    }
+
+    auto& base = levels_.emplace_back();
+    base.width = width;
+    base.height = height;
+    base.depth.assign(data, data + std::size_t(width) * height);
+
+    // Same reduction as the gpu one: the last texel of a level also covers the unpaired
+    // texel of an odd sized parent.
+    while(levels_.back().width > 1 || levels_.back().height > 1)
+    {
+        const auto& src = levels_.back();
+
+        level dst;
+        dst.width = std::max<std::uint32_t>(1, src.width / 2);
+        dst.height = std::max<std::uint32_t>(1, src.height / 2);
+        dst.depth.resize(std::size_t(dst.width) * dst.height);
+
+        for(std::uint32_t y = 0; y < dst.height; ++y)
+        {
+            const auto y0 = y * 2;
+            const auto y1 = y + 1 == dst.height ? src.height - 1 : y0 + 1;
+
+            for(std::uint32_t x = 0; x < dst.width; ++x)
+            {
+                const auto x0 = x * 2;
+                const auto x1 = x + 1 == dst.width ? src.width - 1 : x0 + 1;
+
+                float depth = 0.0f;
+                for(auto sy = y0; sy <= y1; ++sy)
+                {
+                    for(auto sx = x0; sx <= x1; ++sx)
+                    {
+                        depth = std::max(depth, src.depth[std::size_t(sy) * src.width + sx]);
+                    }
+                }
+
+                dst.depth[std::size_t(y) * dst.width + x] = depth;
+            }
+        }
+
+        levels_.emplace_back(std::move(dst));
+    }
+}
+
+void occlusion_buffer::clear()
+{
+    levels_.clear();
+}
+
+auto occlusion_buffer::is_usable(const usize32_t& viewport_size, std::uint32_t frame) const -> bool
+{
+    if(levels_.empty() || params_.viewport_size != viewport_size)
+    {
+        return false;
+    }
+
+    return frame - params_.frame <= max_age_;
+}
+
+auto occlusion_buffer::is_occluded(const math::bbox& bounds, const math::transform& world) const -> bool
+{
+    if(levels_.empty())
+    {
+        return false;
+    }
+
+    const auto mvp = params_.view_proj * world.get_matrix();
+
+    math::vec2 ndc_min(1.0f, 1.0f);
+    math::vec2 ndc_max(-1.0f, -1.0f);
+    float nearest = 1.0f;
+
+    for(std::uint32_t i = 0; i < 8; ++i)
+    {
+        const math::vec4 corner((i & 1) ? bounds.max.x : bounds.min.x,
+                                (i & 2) ? bounds.max.y : bounds.min.y,
+                                (i & 4) ? bounds.max.z : bounds.min.z,
+                                1.0f);
+
+        const auto clip = mvp * corner;
+
+        // Crossing the near plane, the projected rect is meaningless.
+        if(clip.w <= math::epsilon<float>())
+        {
+            return false;
+        }
+
+        const auto ndc = math::vec3(clip) / clip.w;
+        if(ndc.x < -1.0f || ndc.x > 1.0f || ndc.y < -1.0f || ndc.y > 1.0f)
+        {
+            // Partly outside of the view the depth was taken from.
+            return false;
+        }
+
+        const float depth = params_.homogeneous_depth ? ndc.z * 0.5f + 0.5f : ndc.z;
+        if(depth < 0.0f)
+        {
+            return false;
+        }
+
+        ndc_min = math::min(ndc_min, math::vec2(ndc));
+        ndc_max = math::max(ndc_max, math::vec2(ndc));
+        nearest = std::min(nearest, depth);
+    }
+
+    // Screen pixels covered by the box.
+    const float w = float(params_.viewport_size.width);
+    const float h = float(params_.viewport_size.height);
+
+    auto to_row = [&](float ndc_y)
+    {
+        const float v = ndc_y * 0.5f + 0.5f;
+        return params_.origin_bottom_left ? v * h : (1.0f - v) * h;
+    };
+
+    const auto px0 = std::uint32_t(std::max(0.0f, (ndc_min.x * 0.5f + 0.5f) * w));
+    const auto px1 = std::uint32_t(std::max(0.0f, (ndc_max.x * 0.5f + 0.5f) * w));
+    const auto py0 = std::uint32_t(std::max(0.0f, std::min(to_row(ndc_min.y), to_row(ndc_max.y))));
+    const auto py1 = std::uint32_t(std::max(0.0f, std::max(to_row(ndc_min.y), to_row(ndc_max.y))));
+
+    // Texels of the base level.
+    const auto& base = levels_.front();
+    auto tx0 = std::min(px0 >> params_.reduction, base.width - 1);
+    auto tx1 = std::min(px1 >> params_.reduction, base.width - 1);
+    auto ty0 = std::min(py0 >> params_.reduction, base.height - 1);
+    auto ty1 = std::min(py1 >> params_.reduction, base.height - 1);
+
+    // Go up until the rect covers at most 2x2 texels.
+    std::size_t mip = 0;
+    while(mip + 1 < levels_.size() && (tx1 - tx0 > 1 || ty1 - ty0 > 1))
+    {
+        ++mip;
+        const auto& lvl = levels_[mip];
+        tx0 = std::min(tx0 >> 1, lvl.width - 1);
+        tx1 = std::min(tx1 >> 1, lvl.width - 1);
+        ty0 = std::min(ty0 >> 1, lvl.height - 1);
+        ty1 = std::min(ty1 >> 1, lvl.height - 1);
+    }
+
+    const auto& lvl = levels_[mip];
+
+    float farthest = 0.0f;
+    for(auto y = ty0; y <= ty1; ++y)
+    {
+        for(auto x = tx0; x <= tx1; ++x)
+        {
+            farthest = std::max(farthest, lvl.depth[std::size_t(y) * lvl.width + x]);
+        }
+    }
+
+    return nearest > farthest;
+}
+
+void occlusion_buffer::set_max_age(std::uint32_t frames)
+{
+    max_age_ = frames;
+}
+
+} // namespace rendering
+} // namespace ace
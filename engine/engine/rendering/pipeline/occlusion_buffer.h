@@ -0,0 +1,93 @@
+#pragma once
+
+#include <base/basetypes.hpp>
+#include <math/math.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ace
+{
+namespace rendering
+{
+
+/**
+ * @class occlusion_buffer
+ * @brief Cpu copy of a hierarchical depth buffer used to cull occluded models.
+ *
+ * Every texel holds the farthest depth of the screen pixels it covers. The buffer is read back
+ * from the depth of an earlier frame, so bounds are projected with the view projection of that
+ * frame. Anything not entirely on screen and in front of the camera in that frame is visible.
+ */
+class occlusion_buffer
+{
+public:
+    /**
+     * @struct params
+     * @brief Describes the depth the buffer is built from.
+     */
+    struct params
+    {
+        /// Size of the depth buffer the data was reduced from.
+        usize32_t viewport_size;
+        /// Number of halvings between the viewport and the data.
+        std::uint32_t reduction{};
+        /// View projection the depth was rendered with.
+        math::mat4 view_proj{1.0f};
+        /// Render frame the depth was rendered at.
+        std::uint32_t frame{};
+        /// Whether the first row of the data is the bottom of the screen.
+        bool origin_bottom_left{};
+        /// Whether clip space depth is in the -1..1 range.
+        bool homogeneous_depth{};
+    };
+
+    /**
+     * @brief Builds the pyramid from the farthest depths of a reduced depth buffer.
+     * @param p Describes the source depth.
+     * @param width The width of the data.
+     * @param height The height of the data.
+     * @param data The depths, row by row.
+     */
+    void build(const params& p, std::uint32_t width, std::uint32_t height, const float* data);
+
+    /**
+     * @brief Drops the buffer, nothing is culled until it is built again.
+     */
+    void clear();
+
+    /**
+     * @brief Checks if the buffer can be used to cull at the given frame.
+     * @param viewport_size The size of the view being culled.
+     * @param frame The current render frame.
+     */
+    auto is_usable(const usize32_t& viewport_size, std::uint32_t frame) const -> bool;
+
+    /**
+     * @brief Tests if a box is hidden behind the depth of the buffer.
+     * @param bounds The local bounds.
+     * @param world The world transform of the bounds.
+     * @return True if the box is known to be hidden.
+     */
+    auto is_occluded(const math::bbox& bounds, const math::transform& world) const -> bool;
+
+    /**
+     * @brief Sets after how many frames an unrefreshed buffer stops being used.
+     */
+    void set_max_age(std::uint32_t frames);
+
+private:
+    struct level
+    {
+        std::uint32_t width{};
+        std::uint32_t height{};
+        std::vector<float> depth;
+    };
+
+    params params_;
+    std::vector<level> levels_;
+    std::uint32_t max_age_{8};
+};
+
+} // namespace rendering
+} // namespace ace
@@ -0,0 +1,137 @@
+#include "hiz_pass.h"
+#include <engine/assets/asset_manager.h>
+#include <engine/engine.h>
+#include <engine/rendering/renderer.h>
+#include <graphics/render_pass.h>
+#include <graphics/texture.h>
+
+#include <algorithm>
+
+namespace ace
+{
+
+auto hiz_pass::init(rtti::context& ctx) -> bool
+{
+    auto& am = ctx.get<asset_manager>();
+
+    auto vs_clip_quad = am.get_asset<gfx::shader>("engine:/data/shaders/vs_clip_quad.sc");
+    auto fs_hiz_downsample = am.get_asset<gfx::shader>("engine:/data/shaders/hiz/fs_hiz_downsample.sc");
+
+    hiz_program_.program = std::make_unique<gpu_program>(vs_clip_quad, fs_hiz_downsample);
+    hiz_program_.cache_uniforms();
+
+    return true;
+}
+
+auto hiz_pass::can_run() const -> bool
+{
+    if(readback_)
+    {
+        return false;
+    }
+
+    if(!gfx::is_supported(BGFX_CAPS_TEXTURE_BLIT) || !gfx::is_supported(BGFX_CAPS_TEXTURE_READ_BACK))
+    {
+        return false;
+    }
+
+    const auto caps = gfx::get_caps();
+    return 0 != (caps->formats[gfx::texture_format::R32F] & BGFX_CAPS_FORMAT_TEXTURE_FRAMEBUFFER);
+}
+
+auto hiz_pass::get_level_sizes(const usize32_t& viewport_size) -> std::vector<usize32_t>
+{
+    std::vector<usize32_t> sizes;
+
+    auto size = viewport_size;
+    do
+    {
+        size.width = std::max<std::uint32_t>(1, size.width / 2);
+        size.height = std::max<std::uint32_t>(1, size.height / 2);
+        sizes.emplace_back(size);
+    } while(size.width > max_readback_width);
+
+    return sizes;
+}
+
+void hiz_pass::run(const run_params& params)
+{
+    if(!params.depth || params.levels.empty() || !hiz_program_.program->is_valid())
+    {
+        return;
+    }
+
+    auto input = params.depth;
+    for(const auto& level : params.levels)
+    {
+        const auto source_size = input->get_size();
+        const auto target_size = level->get_size();
+
+        gfx::render_pass pass("hiz_downsample_pass");
+        pass.bind(level.get());
+
+        hiz_program_.program->begin();
+
+        float data0[4] = {float(source_size.width),
+                          float(source_size.height),
+                          float(target_size.width),
+                          float(target_size.height)};
+        gfx::set_uniform(hiz_program_.u_data0, data0);
+        gfx::set_texture(hiz_program_.s_input,
+                         0,
+                         input,
+                         BGFX_SAMPLER_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+
+        auto topology = gfx::clip_quad(1.0f);
+        gfx::set_state(topology | BGFX_STATE_WRITE_R);
+        gfx::submit(pass.id, hiz_program_.program->native_handle());
+        gfx::set_state(BGFX_STATE_DEFAULT);
+
+        hiz_program_.program->end();
+
+        input = level->get_texture();
+    }
+
+    const auto& last = params.levels.back()->get_texture();
+    const auto size = last->get_size();
+
+    readback_ = std::make_shared<readback>();
+    readback_->data.resize(std::size_t(size.width) * size.height);
+    readback_->params.viewport_size = params.depth->get_size();
+    readback_->params.reduction = std::uint32_t(params.levels.size());
+    readback_->params.view_proj = params.view_proj;
+    readback_->params.frame = gfx::get_render_frame();
+    readback_->params.origin_bottom_left = gfx::is_origin_bottom_left();
+    readback_->params.homogeneous_depth = gfx::is_homogeneous_depth();
+
+    // Render targets can't be read directly, blit to a cpu texture first.
+    readback_->blit = std::make_shared<gfx::texture>(
+        std::uint16_t(size.width),
+        std::uint16_t(size.height),
+        false,
+        1,
+        last->info.format,
+        BGFX_TEXTURE_BLIT_DST | BGFX_TEXTURE_READ_BACK | BGFX_SAMPLER_MIN_POINT | BGFX_SAMPLER_MAG_POINT |
+            BGFX_SAMPLER_MIP_POINT | BGFX_SAMPLER_U_CLAMP | BGFX_SAMPLER_V_CLAMP);
+
+    gfx::render_pass pass("hiz_readback");
+    gfx::blit(pass.id, readback_->blit->native_handle(), 0, 0, last->native_handle());
+    readback_->frame = gfx::read_texture(readback_->blit->native_handle(), readback_->data.data());
+
+    // The render thread writes into the data until the read is done, even if the view is destroyed meanwhile.
+    engine::context().get<renderer>().keep_until(readback_, readback_->frame);
+}
+
+void hiz_pass::update(rendering::occlusion_buffer& buffer)
+{
+    if(!readback_ || readback_->frame > gfx::get_render_frame())
+    {
+        return;
+    }
+
+    const auto size = readback_->blit->get_size();
+    buffer.build(readback_->params, size.width, size.height, readback_->data.data());
+
+    readback_.reset();
+}
+} // namespace ace
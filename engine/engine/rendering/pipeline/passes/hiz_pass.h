@@ -0,0 +1,82 @@
+#pragma once
+
+#include <engine/rendering/gpu_program.h>
+#include <engine/rendering/pipeline/occlusion_buffer.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class hiz_pass
+ * @brief Reduces a depth buffer to its farthest depths and reads the result back for culling.
+ *
+ * The depth is halved until it is small enough to read back cheaply. Only one read back is in
+ * flight at a time, results are handed to an occlusion_buffer by update() once they arrive.
+ */
+class hiz_pass
+{
+public:
+    struct run_params
+    {
+        /// Depth buffer of the view.
+        gfx::texture::ptr depth;
+        /// Reduction targets, sized by get_level_sizes.
+        std::vector<gfx::frame_buffer::ptr> levels;
+        /// View projection the depth was rendered with.
+        math::mat4 view_proj{1.0f};
+    };
+
+    auto init(rtti::context& ctx) -> bool;
+
+    /**
+     * @brief Checks if the pass can run, i.e. read backs are supported and none is in flight.
+     */
+    auto can_run() const -> bool;
+
+    /**
+     * @brief Gets the sizes of the reduction targets for a viewport, the last one is read back.
+     */
+    static auto get_level_sizes(const usize32_t& viewport_size) -> std::vector<usize32_t>;
+
+    void run(const run_params& params);
+
+    /**
+     * @brief Builds the buffer from a finished read back, if there is one.
+     */
+    void update(rendering::occlusion_buffer& buffer);
+
+    /// Largest width read back.
+    static constexpr std::uint32_t max_readback_width = 256;
+
+private:
+    struct hiz_program : uniforms_cache
+    {
+        void cache_uniforms()
+        {
+            cache_uniform(program.get(), u_data0, "u_data0");
+            cache_uniform(program.get(), s_input, "s_input");
+        }
+
+        gfx::program::uniform_ptr u_data0;
+        gfx::program::uniform_ptr s_input;
+
+        std::unique_ptr<gpu_program> program;
+
+    } hiz_program_;
+
+    struct readback
+    {
+        gfx::texture::ptr blit;
+        std::vector<float> data;
+        rendering::occlusion_buffer::params params;
+        /// Frame at which the read is done.
+        std::uint32_t frame{};
+    };
+
+    /// Shared with the renderer until the read is done, the pass may go away with its view before that.
+    std::shared_ptr<readback> readback_;
+};
+} // namespace ace
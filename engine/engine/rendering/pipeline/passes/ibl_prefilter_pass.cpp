@@ -0,0 +1,82 @@
+#include "ibl_prefilter_pass.h"
+#include <engine/assets/asset_manager.h>
+#include <graphics/render_pass.h>
+#include <graphics/texture.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ace
+{
+
+namespace
+{
+// Inverse of ComputeReflectionCaptureMipFromRoughnessEx.
+auto get_mip_roughness(std::uint32_t mip, std::uint32_t mips) -> float
+{
+    const float t = float(mip) / float(mips);
+    return (1.7f - std::sqrt(2.89f - 2.8f * t)) / 1.4f;
+}
+} // namespace
+
+auto ibl_prefilter_pass::init(rtti::context& ctx) -> bool
+{
+    auto& am = ctx.get<asset_manager>();
+
+    auto vs_clip_quad = am.get_asset<gfx::shader>("engine:/data/shaders/vs_clip_quad.sc");
+    auto fs_prefilter = am.get_asset<gfx::shader>("engine:/data/shaders/reflection_probe/fs_prefilter_cubemap.sc");
+
+    prefilter_program_.program = std::make_unique<gpu_program>(vs_clip_quad, fs_prefilter);
+    prefilter_program_.cache_uniforms();
+
+    return true;
+}
+
+auto ibl_prefilter_pass::is_ready() const -> bool
+{
+    return prefilter_program_.program->is_valid();
+}
+
+auto ibl_prefilter_pass::run(const run_params& params) -> bool
+{
+    if(!params.input || !params.output || !is_ready())
+    {
+        return false;
+    }
+
+    const auto& input_info = params.input->info;
+    const auto& output_info = params.output->info;
+
+    for(std::uint8_t mip = 0; mip < output_info.numMips; ++mip)
+    {
+        const auto size = std::uint16_t(std::max(1, output_info.width >> mip));
+        const float roughness = get_mip_roughness(mip, output_info.numMips);
+
+        for(std::uint16_t face = 0; face < 6; ++face)
+        {
+            auto fbo = std::make_shared<gfx::frame_buffer>();
+            fbo->populate({gfx::fbo_attachment{params.output, mip, face}});
+
+            gfx::render_pass pass("ibl_prefilter_pass");
+            pass.bind(fbo.get());
+
+            prefilter_program_.program->begin();
+
+            float data0[4] = {float(face), roughness, float(input_info.width), float(input_info.numMips)};
+            gfx::set_uniform(prefilter_program_.u_data0, data0);
+            gfx::set_texture(prefilter_program_.s_tex_cube, 0, params.input);
+
+            gfx::set_scissor(0, 0, size, size);
+            auto topology = gfx::clip_quad(1.0f);
+            gfx::set_state(topology | BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_A);
+            gfx::submit(pass.id, prefilter_program_.program->native_handle());
+            gfx::set_state(BGFX_STATE_DEFAULT);
+
+            prefilter_program_.program->end();
+        }
+    }
+
+    gfx::discard();
+    return true;
+}
+} // namespace ace
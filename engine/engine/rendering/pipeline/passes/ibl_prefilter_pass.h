@@ -0,0 +1,55 @@
+#pragma once
+
+#include <engine/rendering/gpu_program.h>
+
+namespace ace
+{
+
+/**
+ * @class ibl_prefilter_pass
+ * @brief Convolves a captured cubemap with the GGX lobe, one roughness level per mip.
+ *
+ * The mip levels match ComputeReflectionCaptureMipFromRoughnessEx used by the probe lighting,
+ * so the lighting reads the lobe of its roughness instead of a box filtered mip chain.
+ */
+class ibl_prefilter_pass
+{
+public:
+    struct run_params
+    {
+        /// Captured cubemap with a full mip chain.
+        gfx::texture::ptr input;
+        /// Render target cubemap with mips, of the same size.
+        gfx::texture::ptr output;
+    };
+
+    auto init(rtti::context& ctx) -> bool;
+
+    /**
+     * @brief Checks if the program is loaded.
+     */
+    auto is_ready() const -> bool;
+
+    /**
+     * @brief Prefilters the input into the output.
+     * @return False if nothing was drawn, e.g. while the program is loading.
+     */
+    auto run(const run_params& params) -> bool;
+
+private:
+    struct prefilter_program : uniforms_cache
+    {
+        void cache_uniforms()
+        {
+            cache_uniform(program.get(), u_data0, "u_data0");
+            cache_uniform(program.get(), s_tex_cube, "s_tex_cube");
+        }
+
+        gfx::program::uniform_ptr u_data0;
+        gfx::program::uniform_ptr s_tex_cube;
+
+        std::unique_ptr<gpu_program> program;
+
+    } prefilter_program_;
+};
+} // namespace ace
@@ -119,6 +119,13 @@ public:
                               visibility_flags query = visibility_query::not_specified,
                               pipeline_flags pflags = 0) = 0;
 
+    /**
+     * @brief Checks if the programs lighting the scene are loaded. Lights are skipped until they are,
+     * so renders that are kept (thumbnails, probe caches) should wait for it.
+     * @param scn The scene to check.
+     * @return True if every light can be drawn.
+     */
+    virtual auto is_lighting_ready(scene& scn) -> bool = 0;
 
     virtual void set_debug_pass(int pass) = 0;
 };
@@ -9,6 +9,8 @@
 
 #include <logging/logging.h>
 
+#include <algorithm>
+
 namespace ace
 {
 renderer::renderer(rtti::context& ctx, cmd_line::parser& parser)
@@ -88,6 +90,15 @@ auto renderer::deinit(rtti::context& ctx) -> bool
 {
     APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
 
+    // Pending reads still write into the kept resources, let them finish before the backend goes away.
+    while(!kept_resources_.empty())
+    {
+        gfx::frame();
+        release_kept_resources();
+    }
+
+    transient_pool_.clear();
+
     return true;
 }
 
@@ -247,6 +258,39 @@ void renderer::set_vsync(bool vsync)
     gfx::reset(sz.w, sz.h, reset_flags_);
 }
 
+auto renderer::get_transient_pool() -> gfx::transient_pool&
+{
+    return transient_pool_;
+}
+
+void renderer::add_occlusion_stats(std::uint32_t tested, std::uint32_t culled)
+{
+    occlusion_stats_frame_.tested += tested;
+    occlusion_stats_frame_.culled += culled;
+}
+
+auto renderer::get_occlusion_stats() const -> const occlusion_stats&
+{
+    return occlusion_stats_;
+}
+
+void renderer::keep_until(std::shared_ptr<void> resource, std::uint32_t frame)
+{
+    kept_resources_.push_back({std::move(resource), frame});
+}
+
+void renderer::release_kept_resources()
+{
+    const auto render_frame = gfx::get_render_frame();
+    kept_resources_.erase(std::remove_if(std::begin(kept_resources_),
+                                         std::end(kept_resources_),
+                                         [&](const kept_resource& kept)
+                                         {
+                                             return kept.frame <= render_frame;
+                                         }),
+                          std::end(kept_resources_));
+}
+
 void renderer::frame_begin(rtti::context& /*ctx*/, delta_t /*dt*/)
 {
     auto& window = get_main_window();
@@ -261,6 +305,12 @@ void renderer::frame_end(rtti::context& /*ctx*/, delta_t /*dt*/)
 
     gfx::frame();
 
+    transient_pool_.end_frame();
+    release_kept_resources();
+
+    occlusion_stats_ = occlusion_stats_frame_;
+    occlusion_stats_frame_ = {};
+
     // if(!request_screenshot_.empty())
     // {
     //     gfx::request_screen_shot(get_main_window()->get_surface()->native_handle(), request_screenshot_.c_str());
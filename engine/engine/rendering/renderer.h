@@ -3,12 +3,14 @@
 
 #include "render_window.h"
 #include <graphics/shader.h>
+#include <graphics/transient_pool.h>
 
 #include <base/basetypes.hpp>
 #include <cmd_line/parser.h>
 #include <context/context.hpp>
 
 #include <memory>
+#include <vector>
 
 namespace ace
 {
@@ -17,6 +19,16 @@ struct renderer
 {
     using render_window_t = std::unique_ptr<render_window>;
 
+    /**
+     * @struct occlusion_stats
+     * @brief Models tested against and culled by the occlusion buffers of all views in a frame.
+     */
+    struct occlusion_stats
+    {
+        std::uint32_t tested{};
+        std::uint32_t culled{};
+    };
+
     renderer(rtti::context& ctx, cmd_line::parser& parser);
     ~renderer();
 
@@ -33,6 +45,29 @@ struct renderer
     auto get_vsync() const -> bool;
     void set_vsync(bool vsync);
 
+    /**
+     * @brief Gets the pool of render targets shared by the pipelines of all views.
+     */
+    auto get_transient_pool() -> gfx::transient_pool&;
+
+    /**
+     * @brief Adds the occlusion culling results of a view to the current frame.
+     */
+    void add_occlusion_stats(std::uint32_t tested, std::uint32_t culled);
+
+    /**
+     * @brief Gets the occlusion culling results of the last frame.
+     */
+    auto get_occlusion_stats() const -> const occlusion_stats&;
+
+    /**
+     * @brief Keeps a resource alive until the render thread reached a frame, e.g. the buffer of a pending read back
+     * whose owner goes away before the read is done.
+     * @param resource The resource.
+     * @param frame The render frame after which it is released.
+     */
+    void keep_until(std::shared_ptr<void> resource, std::uint32_t frame);
+
 protected:
     auto init_backend(const cmd_line::parser& parser) -> bool;
 
@@ -43,12 +78,26 @@ protected:
     auto get_renderer_type(const cmd_line::parser& parser) const -> gfx::renderer_type;
     auto get_reset_flags(const cmd_line::parser& parser) const -> uint32_t;
     auto get_reset_flags(bool vsync) const -> uint32_t;
+    void release_kept_resources();
 
     uint32_t reset_flags_{};
     /// engine windows
     std::unique_ptr<os::window> init_window_{};
     std::unique_ptr<render_window> render_window_{};
     std::string request_screenshot_{};
+    /// Render targets shared by all views for the duration of their passes.
+    gfx::transient_pool transient_pool_{};
+    /// Occlusion culling results of the current and the last frame.
+    occlusion_stats occlusion_stats_frame_{};
+    occlusion_stats occlusion_stats_{};
+
+    struct kept_resource
+    {
+        std::shared_ptr<void> resource;
+        std::uint32_t frame{};
+    };
+    /// Resources released once the render thread reached their frame.
+    std::vector<kept_resource> kept_resources_;
 
     std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
 };
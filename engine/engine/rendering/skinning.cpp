@@ -0,0 +1,46 @@
+#include "skinning.h"
+#include "mesh.h"
+
+#include <algorithm>
+#include <execution>
+
+#define POOLSTL_STD_SUPPLEMENT 1
+#include <poolstl/poolstl.hpp>
+
+namespace ace
+{
+
+void skinning_batch::clear()
+{
+    jobs_.clear();
+}
+
+void skinning_batch::add(const bone_palette& palette,
+                         const skin_bind_data& bind_data,
+                         const std::vector<math::mat4>& bone_transforms,
+                         math::mat4* output)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.emplace_back(job{&palette, &bind_data, &bone_transforms, output});
+}
+
+void skinning_batch::execute()
+{
+    std::for_each(std::execution::par,
+                  jobs_.begin(),
+                  jobs_.end(),
+                  [](const job& j)
+                  {
+                      j.palette->compute_skinning_matrices(j.bone_transforms->data(),
+                                                           j.bone_transforms->size(),
+                                                           *j.bind_data,
+                                                           j.output);
+                  });
+}
+
+auto skinning_batch::size() const -> size_t
+{
+    return jobs_.size();
+}
+
+} // namespace ace
@@ -0,0 +1,107 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <math/math.h>
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ACE_SKINNING_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace ace
+{
+class bone_palette;
+class skin_bind_data;
+
+/**
+ * @brief Multiplies two column major matrices, out = lhs * rhs.
+ *
+ * Every column of the result is a sum of the lhs columns scaled by one rhs column,
+ * which maps to four SSE multiply-adds per column. Out may alias either input.
+ */
+inline void multiply_matrices(const math::mat4& lhs, const math::mat4& rhs, math::mat4& out)
+{
+#if defined(ACE_SKINNING_SSE)
+    const float* a = math::value_ptr(lhs);
+    const float* b = math::value_ptr(rhs);
+
+    const __m128 a0 = _mm_loadu_ps(a + 0);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+
+    __m128 columns[4];
+    for(int j = 0; j < 4; ++j)
+    {
+        const float* bj = b + j * 4;
+        __m128 xy = _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(bj[0])), _mm_mul_ps(a1, _mm_set1_ps(bj[1])));
+        __m128 zw = _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(bj[2])), _mm_mul_ps(a3, _mm_set1_ps(bj[3])));
+        columns[j] = _mm_add_ps(xy, zw);
+    }
+
+    float* o = math::value_ptr(out);
+    _mm_storeu_ps(o + 0, columns[0]);
+    _mm_storeu_ps(o + 4, columns[1]);
+    _mm_storeu_ps(o + 8, columns[2]);
+    _mm_storeu_ps(o + 12, columns[3]);
+#else
+    out = lhs * rhs;
+#endif
+}
+
+/**
+ * @class skinning_batch
+ * @brief Collects the bone palettes of many skinned models and computes their skinning matrices together.
+ *
+ * Palettes are queued while the armatures are updated and computed afterwards in a single
+ * parallel pass, each one writing straight into the contiguous buffer of its model.
+ */
+class skinning_batch
+{
+public:
+    /**
+     * @brief Removes all queued palettes.
+     */
+    void clear();
+
+    /**
+     * @brief Queues a palette. Safe to call from multiple threads.
+     *
+     * @param palette The bone palette.
+     * @param bind_data The skin bind data the palette refers to.
+     * @param bone_transforms The global transforms of the bones. Must outlive execute().
+     * @param output Destination with room for all bones of the palette. Must outlive execute().
+     */
+    void add(const bone_palette& palette,
+             const skin_bind_data& bind_data,
+             const std::vector<math::mat4>& bone_transforms,
+             math::mat4* output);
+
+    /**
+     * @brief Computes all queued palettes in parallel.
+     */
+    void execute();
+
+    /**
+     * @brief Gets the number of queued palettes.
+     */
+    auto size() const -> size_t;
+
+private:
+    struct job
+    {
+        const bone_palette* palette{};
+        const skin_bind_data* bind_data{};
+        const std::vector<math::mat4>* bone_transforms{};
+        math::mat4* output{};
+    };
+
+    std::vector<job> jobs_;
+    std::mutex mutex_;
+};
+
+} // namespace ace
@@ -0,0 +1,385 @@
+#include "texture_streamer.h"
+#include <engine/engine.h>
+#include <engine/events.h>
+#include <engine/threading/threader.h>
+
+#include <logging/logging.h>
+#include <math/math.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace ace
+{
+
+auto texture_streamer::init(rtti::context& ctx) -> bool
+{
+    APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
+
+    auto& ev = ctx.get<events>();
+    ev.on_frame_end.connect(sentinel_, 1000, this, &texture_streamer::on_frame_end);
+
+    return true;
+}
+
+auto texture_streamer::deinit(rtti::context& ctx) -> bool
+{
+    APPLOG_INFO("{}::{}", hpp::type_name_str(*this), __func__);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+
+    return true;
+}
+
+auto texture_streamer::load(const std::string& path) -> std::shared_ptr<gfx::texture>
+{
+    gfx::texture_info source_info{};
+    auto tex = std::make_shared<gfx::texture>(path.c_str(),
+                                              BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE,
+                                              initial_skip_,
+                                              nullptr,
+                                              &source_info);
+
+    // Nothing to stream for textures without mips, cubemaps or volumes.
+    if(!tex->is_valid() || source_info.numMips <= 1 || source_info.cubeMap || source_info.depth > 1)
+    {
+        return tex;
+    }
+
+    entry e;
+    e.texture = tex;
+    e.path = path;
+    e.source_info = source_info;
+    e.resident_skip = std::uint8_t(source_info.numMips - tex->info.numMips);
+    e.requested_skip = get_max_skip(e);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    e.last_request_frame = frame_;
+    entries_[tex.get()] = std::move(e);
+
+    return tex;
+}
+
+void texture_streamer::request(const gfx::texture::ptr& tex, float screen_texels)
+{
+    if(!tex)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    request_locked(tex.get(), screen_texels);
+}
+
+void texture_streamer::request(const std::vector<texel_request>& requests)
+{
+    if(requests.empty())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(const auto& r : requests)
+    {
+        request_locked(r.texture, r.screen_texels);
+    }
+}
+
+void texture_streamer::request_locked(const gfx::texture* key, float screen_texels)
+{
+    auto it = entries_.find(key);
+    if(it == entries_.end())
+    {
+        return;
+    }
+
+    auto& e = it->second;
+    auto skip = get_skip_for_texels(e, screen_texels);
+
+    if(e.last_request_frame != frame_)
+    {
+        e.last_request_frame = frame_;
+        e.requested_skip = skip;
+    }
+    else
+    {
+        e.requested_skip = std::min(e.requested_skip, skip);
+    }
+}
+
+void texture_streamer::set_budget(std::uint64_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+}
+
+auto texture_streamer::get_budget() const -> std::uint64_t
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+auto texture_streamer::get_stats() const -> const residency_stats&
+{
+    return stats_;
+}
+
+auto texture_streamer::get_max_skip(const entry& e) const -> std::uint8_t
+{
+    return std::uint8_t(e.source_info.numMips - 1);
+}
+
+auto texture_streamer::get_skip_for_texels(const entry& e, float screen_texels) const -> std::uint8_t
+{
+    const auto max_skip = get_max_skip(e);
+    if(screen_texels <= 0.0f)
+    {
+        return max_skip;
+    }
+
+    const float size = float(std::max(e.source_info.width, e.source_info.height));
+    const float ratio = size / screen_texels;
+    if(ratio <= 1.0f)
+    {
+        return 0;
+    }
+
+    const auto skip = std::uint32_t(math::floor(math::log2(ratio)));
+    return std::uint8_t(std::min<std::uint32_t>(skip, max_skip));
+}
+
+auto texture_streamer::get_size_for_skip(const entry& e, std::uint8_t skip) const -> std::uint64_t
+{
+    // Each dropped mip divides the size of the chain by roughly four.
+    return std::uint64_t(e.source_info.storageSize) >> (2u * skip);
+}
+
+auto texture_streamer::mark_reload(const gfx::texture* key, entry& e, std::uint8_t skip) -> reload_request
+{
+    e.pending = true;
+    e.pending_skip = skip;
+
+    reload_request request;
+    request.key = key;
+    request.path = e.path;
+    request.skip = skip;
+
+    if(auto tex = e.texture.lock())
+    {
+        request.flags = tex->flags;
+    }
+
+    return request;
+}
+
+void texture_streamer::dispatch_reload(const reload_request& request)
+{
+    auto& thr = engine::context().get<threader>();
+
+    std::weak_ptr<int> weak_sentinel = sentinel_;
+    thr.pool
+        ->schedule(
+            [path = request.path, flags = request.flags, skip = request.skip]()
+            {
+                return std::make_shared<gfx::texture>(path.c_str(), flags, skip);
+            })
+        .then(itc::main_thread::get_id(),
+              [this, weak_sentinel, key = request.key, skip = request.skip](auto f)
+              {
+                  if(weak_sentinel.expired())
+                  {
+                      return;
+                  }
+
+                  on_reloaded(key, skip, f.get());
+              });
+}
+
+void texture_streamer::on_reloaded(const gfx::texture* key, std::uint8_t skip, std::shared_ptr<gfx::texture> loaded)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if(it == entries_.end())
+    {
+        return;
+    }
+
+    auto& e = it->second;
+    if(!e.pending || e.pending_skip != skip)
+    {
+        return;
+    }
+
+    e.pending = false;
+
+    auto tex = e.texture.lock();
+    if(!tex || !loaded || !loaded->is_valid())
+    {
+        return;
+    }
+
+    // The previous mips are released together with 'loaded'.
+    tex->swap(*loaded);
+    e.resident_skip = std::uint8_t(e.source_info.numMips - tex->info.numMips);
+}
+
+auto texture_streamer::update_residency() -> std::vector<reload_request>
+{
+    struct candidate
+    {
+        const gfx::texture* key{};
+        entry* e{};
+        std::uint8_t target_skip{};
+    };
+
+    std::vector<reload_request> reloads;
+
+    residency_stats stats{};
+    stats.budget_bytes = budget_;
+
+    std::vector<candidate> upgrades;
+    std::vector<candidate> evictions;
+
+    for(auto it = entries_.begin(); it != entries_.end();)
+    {
+        auto& e = it->second;
+        auto tex = e.texture.lock();
+        if(!tex)
+        {
+            it = entries_.erase(it);
+            continue;
+        }
+
+        const bool requested = e.last_request_frame == frame_;
+        const bool stale = frame_ - e.last_request_frame > eviction_delay_frames_;
+        const auto wanted_skip = requested ? e.requested_skip : e.resident_skip;
+        const auto evicted_skip = std::min(initial_skip_, get_max_skip(e));
+
+        stats.textures++;
+        stats.resident_bytes += tex->info.storageSize;
+        stats.full_bytes += e.source_info.storageSize;
+        stats.wanted_bytes += get_size_for_skip(e, wanted_skip);
+
+        if(e.resident_skip == 0)
+        {
+            stats.fully_resident++;
+        }
+
+        if(e.pending)
+        {
+            stats.pending++;
+        }
+        else if(wanted_skip < e.resident_skip)
+        {
+            upgrades.push_back({it->first, &e, wanted_skip});
+        }
+        else if(stale && e.resident_skip < evicted_skip)
+        {
+            evictions.push_back({it->first, &e, evicted_skip});
+        }
+
+        ++it;
+    }
+
+    // Stream in what is missing the most detail first.
+    std::sort(std::begin(upgrades),
+              std::end(upgrades),
+              [](const auto& lhs, const auto& rhs)
+              {
+                  return (lhs.e->resident_skip - lhs.target_skip) > (rhs.e->resident_skip - rhs.target_skip);
+              });
+
+    // Evict the least recently used first.
+    std::sort(std::begin(evictions),
+              std::end(evictions),
+              [](const auto& lhs, const auto& rhs)
+              {
+                  return lhs.e->last_request_frame < rhs.e->last_request_frame;
+              });
+
+    auto projected_bytes = stats.resident_bytes;
+    auto reloads_left = max_reloads_per_frame_;
+    std::size_t eviction_index = 0;
+
+    auto evict_next = [&]() -> bool
+    {
+        if(eviction_index >= evictions.size() || reloads_left == 0)
+        {
+            return false;
+        }
+
+        auto& victim = evictions[eviction_index++];
+        auto freed = get_size_for_skip(*victim.e, victim.e->resident_skip) -
+                     get_size_for_skip(*victim.e, victim.target_skip);
+
+        reloads.emplace_back(mark_reload(victim.key, *victim.e, victim.target_skip));
+        projected_bytes -= std::min(projected_bytes, freed);
+        reloads_left--;
+        stats.evicted++;
+        return true;
+    };
+
+    for(auto& upgrade : upgrades)
+    {
+        if(reloads_left == 0)
+        {
+            break;
+        }
+
+        auto& e = *upgrade.e;
+        const auto current_bytes = get_size_for_skip(e, e.resident_skip);
+
+        // Make room, keeping at least one reload for the upgrade itself.
+        while(projected_bytes + get_size_for_skip(e, upgrade.target_skip) - current_bytes > budget_ &&
+              reloads_left > 1 && evict_next())
+        {
+        }
+
+        // Settle for fewer mips if the full request does not fit.
+        auto target_skip = upgrade.target_skip;
+        while(target_skip < e.resident_skip &&
+              projected_bytes + get_size_for_skip(e, target_skip) - current_bytes > budget_)
+        {
+            target_skip++;
+        }
+
+        if(target_skip >= e.resident_skip)
+        {
+            continue;
+        }
+
+        reloads.emplace_back(mark_reload(upgrade.key, e, target_skip));
+        projected_bytes += get_size_for_skip(e, target_skip) - current_bytes;
+        reloads_left--;
+        stats.streamed_in++;
+    }
+
+    // The budget might have been lowered.
+    while(projected_bytes > budget_ && evict_next())
+    {
+    }
+
+    stats_ = stats;
+    frame_++;
+
+    return reloads;
+}
+
+void texture_streamer::on_frame_end(rtti::context& ctx, delta_t dt)
+{
+    // Reloads are dispatched after the lock is released since their
+    // completion handlers need it as well.
+    auto reloads = [&]()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return update_residency();
+    }();
+
+    for(const auto& request : reloads)
+    {
+        dispatch_reload(request);
+    }
+}
+
+} // namespace ace
@@ -0,0 +1,189 @@
+#pragma once
+#include <engine/engine_export.h>
+
+#include <base/basetypes.hpp>
+#include <context/context.hpp>
+#include <graphics/texture.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ace
+{
+
+/**
+ * @class texture_streamer
+ * @brief Manages mip residency of file backed textures.
+ *
+ * Textures are created with their top mips dropped. Renderers report how many
+ * texels a texture covers on screen and the streamer schedules reloads with
+ * more (or less) mips on the thread pool, keeping the total resident size of
+ * streamed textures under a global memory budget. Streamed in mips replace the
+ * contents of the shared texture in place, so handles held by materials stay valid.
+ */
+class texture_streamer
+{
+public:
+    /**
+     * @struct residency_stats
+     * @brief Residency information for the statistics panel.
+     */
+    struct residency_stats
+    {
+        /// Bytes of all currently resident mips of streamed textures.
+        std::uint64_t resident_bytes{};
+        /// Bytes all streamed textures would take with their full mip chain.
+        std::uint64_t full_bytes{};
+        /// Bytes the streamer would like to be resident to satisfy all requests.
+        std::uint64_t wanted_bytes{};
+        /// The memory budget for streamed textures.
+        std::uint64_t budget_bytes{};
+        /// Number of streamed textures.
+        std::uint32_t textures{};
+        /// Number of textures with all their mips resident.
+        std::uint32_t fully_resident{};
+        /// Number of reloads currently in flight.
+        std::uint32_t pending{};
+        /// Number of mip upgrades scheduled last frame.
+        std::uint32_t streamed_in{};
+        /// Number of mip downgrades scheduled last frame.
+        std::uint32_t evicted{};
+    };
+
+    /**
+     * @struct texel_request
+     * @brief A batched texel request, see request().
+     */
+    struct texel_request
+    {
+        /// The texture, must stay alive until the request is made.
+        const gfx::texture* texture{};
+        /// The number of texels along the largest side covered on screen.
+        float screen_texels{};
+    };
+
+    auto init(rtti::context& ctx) -> bool;
+    auto deinit(rtti::context& ctx) -> bool;
+
+    /**
+     * @brief Creates a streamed texture with only its low mips resident.
+     * Can be called from any thread.
+     * @param path The absolute path of the compiled texture.
+     * @return The created texture.
+     */
+    auto load(const std::string& path) -> std::shared_ptr<gfx::texture>;
+
+    /**
+     * @brief Reports how many texels of a texture are needed on screen.
+     * The highest request per frame wins. Textures that are not streamed are ignored.
+     * @param tex The texture.
+     * @param screen_texels The number of texels along the largest side covered on screen.
+     */
+    void request(const gfx::texture::ptr& tex, float screen_texels);
+
+    /**
+     * @brief Reports a batch of texel requests under a single lock.
+     * @param requests The requests.
+     */
+    void request(const std::vector<texel_request>& requests);
+
+    /**
+     * @brief Sets the memory budget for streamed textures.
+     * @param bytes The budget in bytes.
+     */
+    void set_budget(std::uint64_t bytes);
+
+    /**
+     * @brief Gets the memory budget for streamed textures.
+     * @return The budget in bytes.
+     */
+    auto get_budget() const -> std::uint64_t;
+
+    /**
+     * @brief Gets the residency stats as of the last processed frame.
+     * @return The residency stats.
+     */
+    auto get_stats() const -> const residency_stats&;
+
+private:
+    /**
+     * @struct entry
+     * @brief Residency state of a single streamed texture.
+     */
+    struct entry
+    {
+        /// The shared texture whose contents get replaced.
+        std::weak_ptr<gfx::texture> texture;
+        /// Path to the compiled texture.
+        std::string path;
+        /// Info of the complete image.
+        gfx::texture_info source_info{};
+        /// Number of top mips currently not resident.
+        std::uint8_t resident_skip{};
+        /// Lowest skip requested during the current frame.
+        std::uint8_t requested_skip{};
+        /// Skip of the reload in flight.
+        std::uint8_t pending_skip{};
+        /// Is there a reload in flight.
+        bool pending{};
+        /// Last frame this texture was requested.
+        std::uint64_t last_request_frame{};
+    };
+
+    /**
+     * @struct reload_request
+     * @brief A reload of a texture with a different number of skipped mips.
+     */
+    struct reload_request
+    {
+        const gfx::texture* key{};
+        std::string path;
+        std::uint64_t flags{BGFX_TEXTURE_NONE | BGFX_SAMPLER_NONE};
+        std::uint8_t skip{};
+    };
+
+    void on_frame_end(rtti::context& ctx, delta_t dt);
+
+    /**
+     * @brief Records a texel request. Expects the mutex to be locked.
+     */
+    void request_locked(const gfx::texture* key, float screen_texels);
+
+    /**
+     * @brief Decides which textures to stream in or evict this frame. Expects the mutex to be locked.
+     * @return The reloads to dispatch.
+     */
+    auto update_residency() -> std::vector<reload_request>;
+
+    auto get_max_skip(const entry& e) const -> std::uint8_t;
+    auto get_skip_for_texels(const entry& e, float screen_texels) const -> std::uint8_t;
+    auto get_size_for_skip(const entry& e, std::uint8_t skip) const -> std::uint64_t;
+    auto mark_reload(const gfx::texture* key, entry& e, std::uint8_t skip) -> reload_request;
+    void dispatch_reload(const reload_request& request);
+    void on_reloaded(const gfx::texture* key, std::uint8_t skip, std::shared_ptr<gfx::texture> loaded);
+
+    /// Mutex guarding the entries, loads register from worker threads.
+    mutable std::mutex mutex_;
+    /// Streamed textures.
+    std::unordered_map<const gfx::texture*, entry> entries_;
+    /// Stats of the last processed frame.
+    residency_stats stats_{};
+    /// Memory budget for streamed textures.
+    std::uint64_t budget_{512ull * 1024 * 1024};
+    /// Frame counter.
+    std::uint64_t frame_{};
+    /// Number of top mips dropped on initial load.
+    std::uint8_t initial_skip_{2};
+    /// Frames a texture must be unused before its mips become eviction candidates.
+    std::uint32_t eviction_delay_frames_{120};
+    /// Max reloads scheduled per frame.
+    std::uint32_t max_reloads_per_frame_{4};
+
+    std::shared_ptr<int> sentinel_ = std::make_shared<int>(0);
+};
+
+} // namespace ace
@@ -30,6 +30,7 @@ uniform vec4 u_lod_params;
 #define u_surface_bumpiness u_surface_data.z
 #define u_surface_alpha_test_value u_surface_data.w
 #define u_surface_metalness_roughness_combined u_surface_data2.x
+#define u_surface_normal_map_two_channel u_surface_data2.y
 
 #define u_camear_near u_camera_clip_planes.x
 #define u_camear_far u_camera_clip_planes.y
@@ -67,7 +68,7 @@ void main()
 	float alpha_test_value = u_surface_alpha_test_value;
 
 	vec3 view_direction = u_camera_wpos.xyz - v_wpos;
-	vec3 tangent_space_normal = getTangentSpaceNormal( s_tex_normal, texcoords, bumpiness );
+	vec3 tangent_space_normal = getTangentSpaceNormal( s_tex_normal, texcoords, bumpiness, u_surface_normal_map_two_channel );
 
 	mat3 tangent_to_world_space = computeTangentToWorldSpaceMatrix(normalize(v_wnormal), normalize(view_direction), texcoords.xy);
 	//mat3 tangent_to_world_space = constructTangentToWorldSpaceMatrix(normalize(v_wtangent), normalize(v_wbitangent), normalize(v_wnormal));
@@ -0,0 +1,37 @@
+$input v_texcoord0
+
+#include "../common.sh"
+
+SAMPLER2D(s_input, 0);
+
+uniform vec4 u_data0;
+
+#define u_source_size u_data0.xy
+#define u_target_size u_data0.zw
+
+/** Farthest depth of the source texels covered by a target texel. */
+void main()
+{
+	vec2 Texel = min(floor(v_texcoord0 * u_target_size), u_target_size - 1.0f);
+	vec2 Base = Texel * 2.0f;
+
+	// The last texel of an odd sized source has no pair, the last target texel covers it too.
+	vec2 Extra = step(u_target_size - 1.0f, Texel) * (u_source_size - u_target_size * 2.0f);
+	vec2 Last = min(Base + 1.0f + Extra, u_source_size - 1.0f);
+
+	vec2 InvSize = 1.0f / u_source_size;
+
+	float Depth = 0.0f;
+	for(int y = 0; y < 3; ++y)
+	{
+		float Row = y == 0 ? Base.y : (y == 1 ? Base.y + 1.0f : Last.y);
+		for(int x = 0; x < 3; ++x)
+		{
+			float Column = x == 0 ? Base.x : (x == 1 ? Base.x + 1.0f : Last.x);
+			vec2 UV = (vec2(Column, Row) + 0.5f) * InvSize;
+			Depth = max(Depth, texture2DLod(s_input, UV, 0.0f).x);
+		}
+	}
+
+	gl_FragColor = vec4(Depth, 0.0f, 0.0f, 1.0f);
+}
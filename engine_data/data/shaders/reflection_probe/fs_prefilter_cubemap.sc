@@ -0,0 +1,116 @@
+$input v_texcoord0
+
+#include "../common.sh"
+
+SAMPLERCUBE(s_tex_cube, 0);
+
+uniform vec4 u_data0;
+
+#define u_face int(u_data0.x)
+#define u_roughness u_data0.y
+#define u_source_size u_data0.z
+#define u_source_mips u_data0.w
+
+#define PREFILTER_PI 3.1415926535f
+#define PREFILTER_SAMPLES 64
+
+/** Direction through a texel of a cube face, in the layout the cube is sampled with. */
+vec3 GetCubeDirection(int Face, vec2 UV)
+{
+	vec2 C = UV * 2.0f - 1.0f;
+
+	vec3 Dir;
+	if(Face == 0)      Dir = vec3( 1.0f, -C.y, -C.x);
+	else if(Face == 1) Dir = vec3(-1.0f, -C.y,  C.x);
+	else if(Face == 2) Dir = vec3( C.x,  1.0f,  C.y);
+	else if(Face == 3) Dir = vec3( C.x, -1.0f, -C.y);
+	else if(Face == 4) Dir = vec3( C.x, -C.y,  1.0f);
+	else               Dir = vec3(-C.x, -C.y, -1.0f);
+
+	return normalize(Dir);
+}
+
+/** Van der Corput radical inverse, computed with floats to run on every shader profile. */
+float RadicalInverse(int Index)
+{
+	float Result = 0.0f;
+	float Fraction = 0.5f;
+	int I = Index;
+	for(int Bit = 0; Bit < 8; ++Bit)
+	{
+		if(I - (I / 2) * 2 == 1)
+		{
+			Result += Fraction;
+		}
+		I = I / 2;
+		Fraction *= 0.5f;
+	}
+	return Result;
+}
+
+vec3 ImportanceSampleGGX(vec2 Xi, float Roughness, vec3 N)
+{
+	float a = Roughness * Roughness;
+
+	float Phi = 2.0f * PREFILTER_PI * Xi.x;
+	float CosTheta = sqrt((1.0f - Xi.y) / (1.0f + (a * a - 1.0f) * Xi.y));
+	float SinTheta = sqrt(1.0f - CosTheta * CosTheta);
+
+	vec3 H = vec3(SinTheta * cos(Phi), SinTheta * sin(Phi), CosTheta);
+
+	vec3 Up = abs(N.z) < 0.999f ? vec3(0.0f, 0.0f, 1.0f) : vec3(1.0f, 0.0f, 0.0f);
+	vec3 TangentX = normalize(cross(Up, N));
+	vec3 TangentY = cross(N, TangentX);
+
+	return TangentX * H.x + TangentY * H.y + N * H.z;
+}
+
+float D_GGX(float NoH, float Roughness)
+{
+	float a = Roughness * Roughness;
+	float a2 = a * a;
+	float d = (NoH * a2 - NoH) * NoH + 1.0f;
+	return a2 / (PREFILTER_PI * d * d);
+}
+
+void main()
+{
+	vec3 N = GetCubeDirection(u_face, v_texcoord0);
+
+	BRANCH
+	if(u_roughness <= 0.0f)
+	{
+		gl_FragColor = textureCubeLod(s_tex_cube, N, 0.0f);
+		return;
+	}
+
+	// Solid angle of a source texel, samples with a wider lobe read a coarser mip.
+	float SaTexel = 4.0f * PREFILTER_PI / (6.0f * u_source_size * u_source_size);
+
+	vec3 Color = vec3(0.0f, 0.0f, 0.0f);
+	float Weight = 0.0f;
+
+	for(int i = 0; i < PREFILTER_SAMPLES; ++i)
+	{
+		vec2 Xi = vec2(float(i) / float(PREFILTER_SAMPLES), RadicalInverse(i));
+		vec3 H = ImportanceSampleGGX(Xi, u_roughness, N);
+		vec3 L = 2.0f * dot(N, H) * H - N;
+
+		float NoL = dot(N, L);
+		if(NoL > 0.0f)
+		{
+			// N = V, so the pdf of L reduces to D / 4.
+			float NoH = saturate(dot(N, H));
+			float Pdf = D_GGX(NoH, u_roughness) * 0.25f;
+			float SaSample = 1.0f / (float(PREFILTER_SAMPLES) * Pdf + 0.0001f);
+			float Lod = clamp(0.5f * log2(SaSample / SaTexel) + 1.0f, 0.0f, u_source_mips - 1.0f);
+
+			Color += toLinear(textureCubeLod(s_tex_cube, L, Lod)).xyz * NoL;
+			Weight += NoL;
+		}
+	}
+
+	Color /= max(Weight, 0.0001f);
+
+	gl_FragColor = vec4(toGamma(Color), 1.0f);
+}